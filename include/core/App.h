@@ -1,24 +1,34 @@
 #pragma once
 
 #include "core/AppConfig.h"
+#include "core/FramePacket.h"
 #include "core/GlfwContext.h"
+#include "core/RenderThread.h"
 #include "core/Timer.h"
 #include "core/Window.h"
 #include "input/InputState.h"
 #include "math/Camera.h"
 #include "render/SceneRenderer.h"
+#include "render/GpuTimer.h"
+#include "render/OffscreenParticleTarget.h"
 #include "render/ParticleSystem.h"
+#include "render/RibbonTrails.h"
 #include "render/SkyboxRenderer.h"
 #include "render/TextRenderer.h"
 #include "scene/DemoSceneBuilder.h"
 #include "scene/Scene.h"
+#include "scene/SceneManifest.h"
+#include "util/JobSystem.h"
+#include "util/Random.h"
 #include <glm/gtc/random.hpp>
 
 #include <memory>
 #include <array>
+#include <chrono>
 #include <vector>
-#include <future>
 #include <optional>
+#include <string>
+#include <unordered_set>
 
 namespace cg
 {
@@ -30,6 +40,20 @@ namespace cg
 
     private:
         bool preloadResources();
+        // Cold start: loads the manifest's assets and assembles every scene mesh
+        bool buildSceneMeshes(const SceneManifest::Manifest& manifest, std::vector<Mesh>& meshes, std::string& startupBreakdown);
+        // Finds the flag and lantern meshes in m_scene (warm and cold starts alike)
+        void indexSceneMeshes();
+        // One frame of simulation; all render-side results go to packet
+        void simulate(double deltaSeconds, FramePacket& packet);
+        // Simulates the next frame into a packet and queues it on the render thread
+        void submitFrame();
+        // Applies the packet's changes to the renderers and draws it (main thread)
+        void renderFrame(FramePacket& packet);
+        // Called wherever frames are presented: the render thread, or the main thread without one
+        void recordFrameStats(const FramePacket& packet, double renderMs);
+        // Queues a transform change on the packet being simulated; false for unknown meshes
+        bool setMeshTransform(const std::string& name, const glm::mat4& transform);
         void processInput(double deltaSeconds);
         void updateSkyBlend(double deltaSeconds);
         void updateAirplaneAnimation(double deltaSeconds);
@@ -61,6 +85,24 @@ namespace cg
         double m_skyTime{0.0};
         float m_skyBlend{0.0f};
         double m_lastCameraLogTime{0.0};  // Last time camera info was logged
+        FramePacket* m_simulationPacket{nullptr};  // Target of the update running now
+        std::unordered_set<std::string> m_meshNames;
+
+        struct FrameStats
+        {
+            size_t frames{0};
+            double simulateMs{0.0};
+            double renderMs{0.0};
+            double latencyMs{0.0};  // Event poll to buffer swap
+            double particleGpuMs{0.0};
+            size_t particleGpuSamples{0};
+            size_t particlesVisible{0};
+            size_t particlesOutsideFrustum{0};
+            size_t particlesBelowMinSize{0};
+            std::chrono::steady_clock::time_point windowStart{};
+        };
+        FrameStats m_frameStats;
+        std::unique_ptr<RenderThread> m_renderThread;
         constexpr static double CAMERA_LOG_INTERVAL{0.5};  // Log camera info every 0.5 seconds
         
         // Camera motion state
@@ -74,7 +116,12 @@ namespace cg
         float m_cameraYawWhenAirplaneDisappeared{0.0f};  // Camera yaw when airplane disappeared
         float m_cameraPitchWhenAirplaneDisappeared{0.0f};  // Camera pitch when airplane disappeared
 
+        Random m_random{0};  // Reseeded from the config in run(); simulation thread only
         std::unique_ptr<ParticleSystem> m_particleSystem;
+        std::unique_ptr<OffscreenParticleTarget> m_particleTarget;
+        std::unique_ptr<GpuTimer> m_particleTimer;
+        int m_particleResolutionDivisor{1};
+        std::unique_ptr<RibbonTrails> m_ribbonTrails;
         std::array<float, 5> m_trailSpawnAccumulators{};
 
         // Airplane animation state
@@ -109,8 +156,8 @@ namespace cg
         bool m_flagControlPointMeshExists{false};
         float m_flagControlPointMarkerSize{8.0f};
         glm::vec3 m_flagControlPointColor{1.0f, 0.9f, 0.2f};
-        std::future<FlagUpdateResult> m_flagUpdateFuture;
-        bool m_flagUpdatePending{false};
+        JobSystem::JobHandle m_flagUpdateJob;
+        std::shared_ptr<FlagUpdateResult> m_flagUpdateResult;
 
         struct LanternInstance
         {
@@ -130,11 +177,9 @@ namespace cg
         glm::vec3 evaluateLanternPosition(const LanternInstance& lantern, float t) const;
         glm::vec3 evaluateLanternTangent(const LanternInstance& lantern, float t) const;
         void deactivateLantern(LanternInstance& lantern);
-        std::optional<Mesh> m_lanternPrototype;
         std::vector<std::string> m_lanternMeshNames;
         std::vector<LanternInstance> m_lanternInstances;
         double m_lanternSpawnTimer{0.0};
-        bool m_lanternPrototypeLoaded{false};
     };
 } // namespace cg
 
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "render/SkyboxFormat.h"
+
 #include <string>
 #include <array>
+#include <cstdint>
 #include <glm/glm.hpp>
 
 namespace cg
@@ -12,6 +15,13 @@ namespace cg
         int windowWidth{1920};
         int windowHeight{1080};
         bool enableVSync{true};
+        // Draw on a dedicated render thread while the main thread pumps events and simulates the
+        // next frame. Each queued frame adds a frame of input latency; the frame timing log
+        // shows both sides of that trade.
+        bool enableRenderThread{true};
+        int renderQueueLength{1};  // Simulated frames that may wait for the render thread
+        float frameStatsInterval{5.0f};  // Seconds between frame timing logs (0 disables)
+        uint64_t randomSeed{0};  // Seeds lanterns and particles; 0 picks a new seed every run
         
         // Anti-aliasing (MSAA) config
         int msaaSamples{4};
@@ -31,6 +41,13 @@ namespace cg
         float daySkyboxYOffset{-0.0f};
         float nightSkyboxYOffset{-0.7f};
         float nightSkyboxBrightness{0.5f};
+        // Sky VRAM: RGBA16F 8 B/texel, RGB9E5 4 B/texel, BC6H 1 B/texel (encoded once, cached on disk)
+        SkyboxFormat skyboxFormat{SkyboxFormat::Rgb9E5};
+        int skyboxCubemapFaceSize{0};  // > 0 converts the equirectangular skies to cubemaps
+        std::string skyboxCacheDirectory{"cache/skybox"};
+        // Baked prefiltered environment cubemaps + SH irradiance used for reflections/ambient (0 disables)
+        int environmentMapFaceSize{128};
+        float environmentAmbientWeight{0.5f};
         
         // Skybox cycle config
         float skyDayDuration{15.0f};
@@ -39,6 +56,28 @@ namespace cg
         float skyNightToDayTransition{10000.0f};
         int groundTilesPerSide{150};
 
+        // Mesh cache (.cgmesh) config. Draco sections are several times smaller on disk but
+        // are decoded on worker threads at load time; worth it on slow disks or network shares.
+        bool meshCacheDraco{false};
+        int meshCacheDracoPositionBits{16};
+        int meshCacheDracoSpeed{5};  // 0 = smallest files, 10 = fastest decode
+
+        // Output of the cg_bake tool (content-addressed meshes, textures and skies). Baked
+        // artifacts are preferred over runtime loading whenever their source is unchanged;
+        // an empty path or a directory without an index disables them.
+        std::string bakedAssetDirectory{"cache/baked"};
+        // For installs that ship baked artifacts without their sources: use an artifact even
+        // when its source file is missing. Otherwise such an artifact is ignored.
+        bool bakedAssetsOnly{false};
+
+        // JSON scene manifest (see SceneManifest.h); empty builds the scene from the model,
+        // flag and lantern settings below. The flag animation always follows the flag settings.
+        std::string sceneManifestPath;
+
+        // Whole-scene snapshot written after a cold start and mapped on the next start when
+        // the scene config and input files are unchanged (empty disables)
+        std::string sceneSnapshotPath{"cache/scene.cgscene"};
+
         // Missile (rocket) config
         std::string missileModelPath{"models/plane/rocket/rocket.obj"};
         float missileDropTime{6.0f};
@@ -118,6 +157,20 @@ namespace cg
         float airplaneCameraHeight{600.0f};
         bool airplaneCameraFollowPosition{false};
         
+        // Simulate trail and explosion particles in a compute shader (GL 4.3; falls back to the
+        // CPU). CPU cost no longer grows with the particle count.
+        bool gpuParticleSimulation{false};
+        // Debug check: with GPU simulation, step a few thousand fixed-seed particles through
+        // both simulations at startup and log whether the compute shader matches the CPU.
+        // Costs extra shader compiles and blocking readbacks, so it is off by default.
+        bool verifyGpuParticleSimulation{false};
+        // Draw particles at 1/N of the framebuffer resolution per axis (1, 2 or 4) and upsample
+        // them with a depth-aware filter; P cycles through the three while running
+        int particleResolutionDivisor{2};
+        // CPU-simulated particles whose sprite would be narrower than this many framebuffer
+        // pixels are not uploaded (0 keeps them); off-screen particles never are
+        float particleMinPixelSize{1.0f};
+
         // Airplane trail particle config
         bool enableAirplaneTrails{true};
         float airplaneTrailSpawnRate{40.0f};
@@ -140,6 +193,12 @@ namespace cg
             glm::vec4(0.3f, 0.9f, 0.4f, 0.88f),
             glm::vec4(0.25f, 0.45f, 1.0f, 0.9f)
         };
+        // Draw each contrail as one ribbon instead of particles. Lifetime, initial speed,
+        // emission offset, gravity and colors apply to both; the rest is particles only.
+        bool airplaneTrailRibbons{true};
+        float airplaneTrailRibbonSampleInterval{0.1f};  // Seconds between ribbon points
+        float airplaneTrailRibbonStartWidth{120.0f};
+        float airplaneTrailRibbonEndWidth{260.0f};
 
         // Default camera config
         glm::vec3 defaultCameraPosition{0.0f, 1500.0f, 1500.0f};
@@ -171,6 +230,7 @@ namespace cg
         float timeDisplayScale{2.0f};
         
         // Ancient City model config
+        // OBJ, or an FBX/glTF scene (e.g. a MapFbxExporter level) loaded with its instancing
         std::string ancientCityModelPath{"models/gugong/ancientCity.obj"};
         glm::vec3 ancientCityPosition{0.0f, 30.0f, 0.0f};
         glm::vec3 ancientCityScale{100.0f, 100.0f, 100.0f};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "math/Camera.h"
+#include "render/ParticleSystem.h"
+#include "render/RibbonTrails.h"
+#include "render/SceneRenderer.h"
+#include "scene/Scene.h"
+
+#include <glm/glm.hpp>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cg
+{
+    // Everything needed to draw one simulated frame. The main thread fills packets and the
+    // render thread draws them (see RenderThread), so drawing never reads live simulation
+    // state.
+    //
+    // Mesh transforms and vertex updates are changes, applied once and cleared when the
+    // frame is drawn; the rest describes the whole frame and is overwritten every update.
+    struct FramePacket
+    {
+        Camera camera;
+        double time{0.0};
+        float skyBlend{0.0f};
+        int framebufferWidth{0};  // Queried on the main thread, as GLFW requires
+        int framebufferHeight{0};
+        std::vector<std::pair<std::string, glm::mat4>> meshTransforms;
+        std::vector<SceneRenderer::LanternLight> lanternLights;
+        std::vector<Vertex> flagVertices;  // Empty when the flag did not change
+        std::vector<Vertex> flagControlPointVertices;
+        ParticleSystem::Frame particles;
+        int particleResolutionDivisor{1};
+        RibbonTrails::Frame ribbons;
+
+        std::chrono::steady_clock::time_point inputTime{};  // Events polled before this update
+        double simulateMs{0.0};
+    };
+} // namespace cg
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "core/FramePacket.h"
+#include "core/Window.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cg
+{
+    // Owns the GL context once the scene is loaded and draws the FramePackets the main thread
+    // submits, in order, presenting each one. The main thread keeps GLFW events and the
+    // simulation, so slow event handling and vsync waits each stall only their own side.
+    //
+    // Packets come from a fixed pool: queueLength may wait to be drawn, plus the one being
+    // filled and the one being drawn. acquire() blocks while all of them are in use.
+    class RenderThread
+    {
+    public:
+        // Called on the render thread: render draws a packet, presented runs after the swap
+        using RenderFn = std::function<void(FramePacket&)>;
+        using PresentedFn = std::function<void(const FramePacket&, double renderMs)>;
+
+        struct Stats
+        {
+            size_t submitted{0};
+            size_t queueDepthSum{0};  // Packets already waiting at each submit
+            size_t maxQueueDepth{0};
+            double acquireWaitMs{0.0};  // Main thread blocked on a full queue
+            double renderWaitMs{0.0};  // Render thread idle, waiting for a packet
+        };
+
+        RenderThread(Window& window, size_t queueLength, RenderFn render, PresentedFn presented);
+        ~RenderThread();
+
+        RenderThread(const RenderThread&) = delete;
+        RenderThread& operator=(const RenderThread&) = delete;
+
+        // Joins the thread, dropping undrawn packets, and makes the context current on the
+        // calling thread again. Called by the destructor if needed.
+        void stop();
+
+        std::unique_ptr<FramePacket> acquire();
+        void submit(std::unique_ptr<FramePacket> packet);
+
+        size_t queueDepth() const;
+        // Totals since the previous call
+        Stats takeStats();
+
+    private:
+        void run();
+
+        Window& m_window;
+        RenderFn m_render;
+        PresentedFn m_presented;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_packetQueued;
+        std::condition_variable m_packetFreed;
+        std::deque<std::unique_ptr<FramePacket>> m_queue;
+        std::vector<std::unique_ptr<FramePacket>> m_free;
+        bool m_stopping{false};
+        Stats m_stats;
+        std::thread m_thread;
+    };
+} // namespace cg
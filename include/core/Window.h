@@ -6,6 +6,7 @@
 #define GLFW_INCLUDE_NONE
 #endif
 #include <GLFW/glfw3.h>
+#include <functional>
 #include <string_view>
 
 namespace cg
@@ -21,18 +22,31 @@ namespace cg
 
         bool shouldClose() const;
         void swapBuffers();
-        void pollEvents();
+        // Returns true if the refresh handler ran, i.e. a modal loop held the poll
+        bool pollEvents();
         void setInputState(InputState* inputState);
+        // Called on refresh, framebuffer resize and move notifications that arrive while
+        // pollEvents() has been stuck for a while. Win32 runs its modal move/size loop inside
+        // the poll, which does not return until the drag ends, so this is the only place the
+        // main thread gets to run meanwhile. Ordinary polls never call it.
+        void setRefreshHandler(std::function<void()> handler) { m_refreshHandler = std::move(handler); }
         GLFWwindow* rawHandle() const { return m_window; }
 
     private:
-        static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
         static void cursorPosCallback(GLFWwindow* window, double xpos, double ypos);
         static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
         static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
         static void scrollCallback(GLFWwindow* window, double xoffset, double yoffset);
+        static void refreshCallback(GLFWwindow* window);
+        static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+        static void positionCallback(GLFWwindow* window, int x, int y);
+        static InputState* inputState(GLFWwindow* window);
 
         GLFWwindow* m_window{nullptr};
+        InputState* m_input{nullptr};
+        std::function<void()> m_refreshHandler;
+        double m_pollStart{-1.0};  // glfwGetTime() when the current poll began; negative outside one
+        bool m_refreshedDuringPoll{false};
     };
 } // namespace cg
 
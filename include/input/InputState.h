@@ -18,6 +18,7 @@ namespace cg
         glm::vec2 lastCursor{};
         glm::vec2 cursorDelta{};
         float scrollDelta{0.0f};
+        int particleResolutionPresses{0};  // P presses not handled yet
     };
 } // namespace cg
 
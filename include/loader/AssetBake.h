@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cg
+{
+    // Content-addressed store of runtime-ready assets produced offline by cg_bake. Artifacts
+    // are named by a hash of their source bytes (plus dependencies) and bake options, so an
+    // unchanged asset is never baked twice. An index file maps each source path and variant
+    // to its artifact together with the size and mtime of the source and of every dependency,
+    // which lets the app find artifacts without hashing anything at startup.
+    namespace AssetBake
+    {
+        // 64-bit streaming hash (MurmurHash64A mixing); not cryptographic
+        class Hasher
+        {
+        public:
+            void update(const void* data, size_t size);
+            void update(const std::string& text);
+            // Hashes the file's bytes; returns false if it cannot be read
+            bool updateFile(const std::string& path);
+            uint64_t digest() const;
+
+        private:
+            void mix(uint64_t word);
+
+            uint64_t m_state{0x9e3779b97f4a7c15ull};
+            uint64_t m_length{0};
+            uint64_t m_pending{0};
+            int m_pendingBytes{0};
+        };
+
+        std::string keyString(uint64_t key);
+
+        // Index key for a source path; the same file reached by different spellings matches
+        std::string normalizePath(const std::string& path);
+
+        bool sourceStamp(const std::string& path, uint64_t& size, int64_t& time);
+
+        // Size stamped for a dependency that does not exist, so its later appearance is noticed
+        constexpr uint64_t kMissingSize = ~0ull;
+
+        struct Dependency
+        {
+            std::string path;
+            uint64_t size{kMissingSize};
+            int64_t time{0};
+        };
+
+        // Stamps path; a missing file gets kMissingSize
+        Dependency dependencyStamp(const std::string& path);
+
+        struct Entry
+        {
+            std::string source;
+            std::string variant;   // What was baked, e.g. "mesh.materials" or "texture"
+            uint64_t sourceSize{0};
+            int64_t sourceTime{0};
+            std::string artifact;  // File name inside the bake directory
+            std::vector<Dependency> dependencies;  // Other files hashed into the artifact
+        };
+
+        // The bake directory's index file. set() may be called from several threads.
+        class Index
+        {
+        public:
+            explicit Index(std::string directory);
+
+            bool load();
+            bool save() const;
+
+            void set(Entry entry);
+            std::optional<Entry> find(const std::string& source, const std::string& variant) const;
+            // Artifact names of every variant baked from source, ordered by variant
+            std::vector<std::string> artifacts(const std::string& source) const;
+            std::string artifactPath(const std::string& artifact) const;
+            const std::string& directory() const { return m_directory; }
+
+        private:
+            std::string m_directory;
+            std::unordered_map<std::string, Entry> m_entries;
+            mutable std::mutex m_mutex;
+        };
+
+        // Runtime lookups. An empty directory (the default) disables them. bakedOnly is for
+        // installs that ship artifacts without their sources: an artifact whose source is
+        // missing is then used as-is, where it is otherwise ignored.
+        void setDirectory(const std::string& directory, bool bakedOnly = false);
+
+        // Path of the baked artifact for sourcePath, or std::nullopt if there is none, the
+        // source or one of its dependencies has changed since it was baked, or the source is
+        // missing outside baked-only mode
+        std::optional<std::string> find(const std::string& sourcePath, const std::string& variant);
+
+        // Artifact names the runtime index lists for sourcePath, whether or not find would
+        // accept them; empty without a bake directory. They change whenever cg_bake rebakes
+        // the source, so callers can key their own caches on them.
+        std::vector<std::string> artifacts(const std::string& sourcePath);
+    }
+} // namespace cg
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "util/FileSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cg
+{
+    // Runtime-ready diffuse texture (.cgtex) written by cg_bake: the full mip chain, built
+    // with an sRGB-correct box filter, stored as RGBA8 or block compressed. The app uploads
+    // it level by level instead of decoding the image and calling glGenerateMipmap.
+    namespace BakedTexture
+    {
+        // AssetBake variant of baked textures
+        inline constexpr char kBakeVariant[] = "texture";
+
+        enum class Format : uint32_t
+        {
+            Rgba8 = 0,
+            Bc1 = 1,  // Opaque images, 0.5 bytes per texel
+            Bc3 = 2   // Images with alpha, 1 byte per texel
+        };
+
+        struct Level
+        {
+            int width{0};
+            int height{0};
+            const uint8_t* data{nullptr};
+            size_t size{0};
+        };
+
+        // A mapped .cgtex file; level data points into the mapping
+        struct Texture
+        {
+            Format format{Format::Rgba8};
+            std::vector<Level> levels;
+            MappedFile file;
+        };
+
+        const char* formatName(Format format);
+
+        bool open(const std::string& path, Texture& texture);
+
+        // Decodes sourcePath and writes its mip chain to outputPath atomically. compress
+        // picks BC1 or BC3 depending on whether the image has any transparency.
+        bool bake(const std::string& sourcePath, bool compress, const std::string& outputPath);
+    }
+} // namespace cg
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "scene/Scene.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace cg
+{
+    // Draco (edgebreaker + quantization) encoding of a single Mesh's vertex and index arrays.
+    // Lossy: attributes are quantized to the configured bit depths, identical vertices are
+    // welded and the vertex order changes. Only available when built with CG_ENABLE_DRACO.
+    namespace DracoMeshCodec
+    {
+        struct Options
+        {
+            int positionBits{16};
+            int normalBits{10};
+            int uvBits{12};
+            int colorBits{8};
+            int speed{5};  // 0 = smallest output / slowest decode, 10 = largest / fastest
+        };
+
+        bool available();
+
+        // Appends the encoded mesh to output; returns false if the mesh cannot be encoded
+        bool encode(const Mesh& mesh, const Options& options, std::vector<char>& output);
+
+        // Fills mesh.vertices and mesh.indices; other Mesh fields are left untouched
+        bool decode(const char* data, size_t size, Mesh& mesh);
+    }
+} // namespace cg
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "util/FileSystem.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cg
+{
+    // Decodes an OpenEXR file one compressed chunk (scanline block or tile) at a time.
+    // Chunks are decoded straight from a memory mapping of the file and only one block of
+    // floats exists at a time, so an 8K sky never needs a full-resolution copy on the heap.
+    class ExrStreamReader
+    {
+    public:
+        // A decoded RGBA float block covering [x, x + width) x [y, y + height).
+        struct Block
+        {
+            int x{0};
+            int y{0};
+            int width{0};
+            int height{0};
+            const float* rgba{nullptr};  // width * height * 4 floats, top row first
+        };
+
+        // Return false from the sink to abort decoding.
+        using BlockSink = std::function<bool(const Block&)>;
+
+        ExrStreamReader();
+        ~ExrStreamReader();
+
+        ExrStreamReader(const ExrStreamReader&) = delete;
+        ExrStreamReader& operator=(const ExrStreamReader&) = delete;
+
+        // Parses the header and chunk offset table; no pixel data is read yet.
+        bool open(const std::string& path);
+        bool readBlocks(const BlockSink& sink);
+        void close();
+
+        int width() const { return m_width; }
+        int height() const { return m_height; }
+        size_t chunkCount() const { return m_offsets.size(); }
+        // Rows per scanline block or tile; blocks always start at multiples of this
+        int blockHeight() const { return m_blockHeight; }
+        // Largest number of pixels a single Block can contain
+        size_t maxBlockPixels() const { return static_cast<size_t>(m_blockWidth) * static_cast<size_t>(m_blockHeight); }
+
+    private:
+        struct HeaderStorage;
+
+        std::string m_path;
+        MappedFile m_file;
+        std::unique_ptr<HeaderStorage> m_header;
+        std::vector<uint64_t> m_offsets;
+        int m_width{0};
+        int m_height{0};
+        int m_minY{0};
+        int m_blockWidth{0};
+        int m_blockHeight{0};
+        int m_tilesX{0};
+        bool m_tiled{false};
+        int m_channelIndex[4]{-1, -1, -1, -1};  // R, G, B, A (-1 when absent)
+    };
+} // namespace cg
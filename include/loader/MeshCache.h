@@ -0,0 +1,70 @@
+#pragma once
+
+#include "loader/DracoMeshCodec.h"
+#include "scene/Scene.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace cg
+{
+    // Versioned binary cache (.cgmesh) of fully processed meshes, written next to the source
+    // model after its first load. It holds final vertex/index arrays (normals generated, Z-up
+    // fixed), names and texture paths in 16-byte aligned sections, and is validated against
+    // the size and modification time of the source file and of every dependency it was built
+    // from (OBJ material libraries, external glTF buffers). Mesh sections are either raw
+    // arrays or Draco-encoded; Draco sections are decoded on worker threads at load time.
+    // Instances (Mesh::instanceOf) store only their transform and point at their source.
+    // A cache whose source model is missing is rejected; shipping models without their
+    // sources is what cg_bake's artifacts are for. Those use the same format and take precedence.
+    namespace MeshCache
+    {
+        // Which loader produced the meshes; a cache written by one is never served to the other
+        enum class Layout : uint32_t
+        {
+            SingleMesh = 1,
+            PerMaterial = 2,
+            ImportedScene = 3  // ModelImporter: one mesh per node and material, with instances
+        };
+
+        enum class Compression : uint32_t
+        {
+            None = 0,
+            Draco = 1
+        };
+
+        struct Options
+        {
+            Compression compression{Compression::None};
+            DracoMeshCodec::Options draco{};
+        };
+
+        // Process-wide; set once before any model is loaded. A cache written with a different
+        // compression or different Draco options is rebuilt. Draco falls back to None when the build has no Draco support.
+        void configure(const Options& options);
+
+        std::string cachePath(const std::string& sourcePath);
+
+        // AssetBake variant under which cg_bake stores meshes produced by each layout
+        std::string bakeVariant(Layout layout);
+
+        // Returns the baked meshes for the source if there are any, otherwise maps the cache
+        // next to it; std::nullopt if both are missing or stale
+        std::optional<std::vector<Mesh>> load(const std::string& sourcePath, Layout layout);
+
+        // Reads a cache file without checking it against its source (baked artifacts)
+        std::optional<std::vector<Mesh>> loadFile(const std::string& path, Layout layout);
+
+        // Writes the cache atomically (temp file + rename); failures are logged and ignored.
+        // dependencies are the other files the meshes were built from; their stamps are recorded.
+        void store(const std::string& sourcePath, const std::vector<std::string>& dependencies, Layout layout,
+                   const Mesh* meshes, size_t count);
+
+        // Writes meshes loaded from sourcePath to an arbitrary path; false on failure
+        bool storeFile(const std::string& path, const std::string& sourcePath, const std::vector<std::string>& dependencies,
+                       Layout layout, const Mesh* meshes, size_t count);
+    }
+} // namespace cg
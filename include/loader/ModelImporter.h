@@ -0,0 +1,33 @@
+#pragma once
+
+#include "scene/Scene.h"
+
+#include <string>
+#include <vector>
+
+namespace cg
+{
+    // FBX and glTF 2.0 (.gltf/.glb) scenes through the vendored assimp importers, e.g. the
+    // merged level FBX files written by the MapFbxExporter Unreal plugin. Node instancing is
+    // kept: the first node that references a mesh owns its geometry and every further node
+    // becomes an instance (Mesh::instanceOf) with its own world transform. Results go
+    // through MeshCache (Layout::ImportedScene). Importing needs CG_ENABLE_ASSIMP; caches and
+    // baked scenes load in any build.
+    namespace ModelImporter
+    {
+        // True for the file extensions this loader handles
+        bool supports(const std::string& path);
+
+        bool available();
+
+        // One mesh per node and material, in node order with every instance after its source.
+        // Transforms are Y-up; assimp applies the FBX axis and unit settings to the root.
+        // Returns empty on failure.
+        std::vector<Mesh> loadScene(const std::string& path);
+
+        // Files besides path that loading it reads: external glTF buffers, or the material
+        // libraries of an OBJ (which ObjLoader handles). For cg_bake's hashes and for the
+        // scene snapshot and hot-reload stamps.
+        std::vector<std::string> dependencies(const std::string& path);
+    }
+} // namespace cg
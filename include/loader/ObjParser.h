@@ -0,0 +1,26 @@
+#pragma once
+
+#include <tiny_obj_loader.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace cg
+{
+    namespace ObjParser
+    {
+        // Parses OBJ text that is already in memory into tinyobj's structures, producing the same
+        // output as tinyobj::LoadObj(..., triangulate = true, default_vcols_fallback = true).
+        // The buffer is split on line boundaries and chunks are parsed on worker threads;
+        // 'l'/'p' primitives, tags and skin weights are skipped since nothing consumes them.
+        // Materials are read through tinyobj::MaterialFileReader relative to materialBaseDir.
+        bool parse(const char* data, size_t size, const std::string& materialBaseDir,
+                   tinyobj::attrib_t& attrib, std::vector<tinyobj::shape_t>& shapes,
+                   std::vector<tinyobj::material_t>& materials, std::string& warn, std::string& err);
+
+        // Paths of the material libraries the OBJ text names in mtllib lines, joined to
+        // materialBaseDir the way parse() opens them; used to invalidate caches on .mtl edits
+        std::vector<std::string> materialLibraries(const char* data, size_t size, const std::string& materialBaseDir);
+    }
+} // namespace cg
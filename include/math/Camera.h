@@ -26,12 +26,17 @@ namespace cg
         float pitch() const;
         void setFOV(float fov);
         float fov() const;
+        // Clip plane distances projectionMatrix uses
+        float nearPlane() const;
+        float farPlane() const;
 
     private:
         glm::vec3 m_position{0.0f, 500.0f, 500.0f};
         float m_yaw{-135.0f};
         float m_pitch{-20.0f};
         float m_fov{45.0f};  // Field of view in degrees
+        float m_nearPlane{0.1f};
+        float m_farPlane{30000.0f};
     };
 } // namespace cg
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+namespace cg
+{
+    namespace EnvironmentBaker
+    {
+        // Equirectangular RGB float image; row 0 is straight up (+Y), matching the shaders' lat-long mapping
+        struct LatLongImage
+        {
+            int width{0};
+            int height{0};
+            std::vector<float> rgb;
+        };
+
+        // Small prefiltered cubemap plus diffuse irradiance, ready for upload (no GL calls here)
+        struct Environment
+        {
+            int faceSize{0};
+            int mipCount{0};
+            std::vector<std::vector<float>> faces;  // [mip * 6 + face], RGB float, GL face order
+            std::array<glm::vec3, 9> irradianceSH{};  // Cosine-convolved and divided by pi
+        };
+
+        // Box-filters streamed rows of a full-resolution image into a small LatLongImage
+        class LatLongDownsampler
+        {
+        public:
+            LatLongDownsampler(int sourceWidth, int sourceHeight, int targetWidth, int targetHeight);
+
+            // Adds count pixels of row y starting at column x; channels is 3 or 4
+            void addPixels(int x, int y, const float* pixels, int count, int channels);
+            LatLongImage finish();
+
+        private:
+            int m_sourceWidth{0};
+            int m_sourceHeight{0};
+            LatLongImage m_image;
+            std::vector<float> m_weights;
+        };
+
+        // Bilinear resample of one cube face (GL face order, row 0 first) into size * size RGB floats
+        void resampleFace(const LatLongImage& source, int face, int size, float* rgb);
+
+        // Each mip level stores the environment convolved with a lobe of increasing roughness
+        // (mip 0 = mirror, last mip = cosine). Faces are computed on worker threads.
+        Environment bake(const LatLongImage& source, int faceSize);
+    }
+} // namespace cg
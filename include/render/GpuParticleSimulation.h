@@ -0,0 +1,58 @@
+#pragma once
+
+#include "render/Shader.h"
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace cg
+{
+    // Particle simulation in a compute shader over persistent buffers: particles never
+    // come back to the CPU, so the CPU cost per frame is one spawn upload and two dispatches
+    // whatever the particle count. Each frame integrates the previous frame's particles into
+    // the other buffer of a ping-pong pair, keeping only the living ones, then appends the
+    // new spawns. An atomic counter in the draw command does the compaction, and
+    // glDrawArraysIndirect draws that count without a readback.
+    //
+    // Needs GL 4.3; all calls must come from the thread that owns the context.
+    class GpuParticleSimulation
+    {
+    public:
+        // Matches the shader's std430 Particle
+        struct Spawn
+        {
+            glm::vec4 positionAge;
+            glm::vec4 velocityInverseLifetime;
+            glm::vec4 accelerationStartSize;
+            glm::vec4 color;
+            glm::vec4 endSize;
+        };
+
+        static bool isSupported();
+
+        // vertexBuffer receives one ParticleSystem::GpuParticle per live particle
+        GpuParticleSimulation(size_t capacity, unsigned vertexBuffer);
+        ~GpuParticleSimulation();
+
+        GpuParticleSimulation(const GpuParticleSimulation&) = delete;
+        GpuParticleSimulation& operator=(const GpuParticleSimulation&) = delete;
+
+        void update(const std::vector<Spawn>& spawns, float deltaSeconds);
+        // Draws the live particles as points with the vertex array currently bound
+        void draw() const;
+        // Copies back the live particles the last update wrote. Waits for the GPU, so it
+        // is for checking against the CPU simulation, not for use every frame.
+        std::vector<Spawn> readBack() const;
+
+    private:
+        size_t m_capacity;
+        unsigned m_vertexBuffer;
+        unsigned m_particleBuffers[2]{};
+        unsigned m_spawnBuffer{0};
+        unsigned m_commandBuffer{0};  // Two DrawArraysIndirectCommand, one per particle buffer
+        int m_current{0};  // Particle buffer and command the last update wrote
+        std::unique_ptr<Shader> m_shader;
+    };
+} // namespace cg
@@ -0,0 +1,30 @@
+#pragma once
+
+namespace cg
+{
+    // Measures GPU time between begin() and end() with GL_TIME_ELAPSED queries. Results are
+    // read a few frames late from a small ring of queries, so the CPU never waits for them.
+    class GpuTimer
+    {
+    public:
+        GpuTimer();
+        ~GpuTimer();
+
+        GpuTimer(const GpuTimer&) = delete;
+        GpuTimer& operator=(const GpuTimer&) = delete;
+
+        void begin();
+        void end();
+        // The newest finished measurement in milliseconds, negative before the first one
+        double latestMs() const { return m_latestMs; }
+
+    private:
+        void collect(bool wait);
+
+        static constexpr int kQueries = 4;
+        unsigned m_queries[kQueries]{};
+        int m_next{0};
+        int m_pending{0};
+        double m_latestMs{-1.0};
+    };
+} // namespace cg
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "render/Shader.h"
+
+#include <glm/glm.hpp>
+#include <memory>
+
+namespace cg
+{
+    // Draws particles at a fraction of the framebuffer resolution and blends them back in.
+    // Large additive sprites are fill-rate bound, and at full resolution every one of their
+    // pixels is shaded at the MSAA sample rate; at half resolution they cost a quarter.
+    //
+    // begin() resolves the scene depth, downsamples it into the target's depth buffer and
+    // binds the target; particles then draw as usual (point sizes scaled by pointScale()).
+    // composite() adds the target onto the default framebuffer with a depth-aware upsample.
+    // Particle blending must be additive, which makes the composite an exact sum.
+    class OffscreenParticleTarget
+    {
+    public:
+        OffscreenParticleTarget();
+        ~OffscreenParticleTarget();
+
+        OffscreenParticleTarget(const OffscreenParticleTarget&) = delete;
+        OffscreenParticleTarget& operator=(const OffscreenParticleTarget&) = delete;
+
+        // width and height are the default framebuffer's; divisor is 2 or 4
+        void begin(int width, int height, int divisor);
+        void composite(const glm::mat4& projection);
+        float pointScale() const { return 1.0f / static_cast<float>(m_divisor); }
+
+    private:
+        void resize(int width, int height, int divisor);
+        void release();
+
+        std::unique_ptr<Shader> m_downsampleShader;
+        std::unique_ptr<Shader> m_compositeShader;
+        unsigned m_emptyVao{0};
+        unsigned m_sceneDepthFbo{0};
+        unsigned m_sceneDepth{0};  // Single-sample copy of the default framebuffer's depth
+        unsigned m_particleFbo{0};
+        unsigned m_particleColor{0};
+        unsigned m_particleDepth{0};
+        int m_width{0};
+        int m_height{0};
+        int m_divisor{1};
+    };
+} // namespace cg
@@ -1,10 +1,15 @@
 #pragma once
 
 #include "math/Camera.h"
+#include "render/GpuParticleSimulation.h"
 #include "render/Shader.h"
+#include "util/AlignedAllocator.h"
+#include "util/Random.h"
 
 #include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace cg
@@ -23,45 +28,122 @@ namespace cg
             float lifetime{1.0f};
         };
 
-        explicit ParticleSystem(size_t maxParticles = 2000);
+        // A whole group of particles drawn from one distribution. Every value is uniform
+        // over its [min, max] range; jitter vectors are scaled by a uniform [-1, 1] each.
+        struct BurstParams
+        {
+            size_t count{0};
+            glm::vec3 origin{0.0f};
+            glm::vec3 direction{0.0f, 1.0f, 0.0f};
+            float coneAngle{glm::pi<float>()};  // Half angle in radians; pi covers the sphere
+            float minSpeed{0.0f};
+            float maxSpeed{0.0f};
+            float minOffset{0.0f};  // Start distance from origin along the particle's direction
+            float maxOffset{0.0f};
+            glm::vec3 positionJitter[2]{glm::vec3(0.0f), glm::vec3(0.0f)};
+            glm::vec3 velocityJitter[2]{glm::vec3(0.0f), glm::vec3(0.0f)};
+            glm::vec3 acceleration{0.0f};
+            float minLifetime{1.0f};
+            float maxLifetime{1.0f};
+            float minStartSize{40.0f};
+            float maxStartSize{40.0f};
+            float minEndSize{5.0f};
+            float maxEndSize{5.0f};
+            std::span<const glm::vec4> palette;  // Cycled through in order; white when empty
+            float maxBrighten{0.0f};  // Each color is mixed toward white by up to this
+        };
+
+        struct GpuParticle
+        {
+            glm::vec3 position;
+            glm::vec4 color;
+            float size;
+        };
+
+        // Live particles left out of a frame by buildFrame (CPU simulation only)
+        struct CullStats
+        {
+            size_t visible{0};
+            size_t outsideFrustum{0};  // Including behind the camera
+            size_t belowMinSize{0};  // Projected smaller than the minimum, or fully faded
+        };
+
+        // One frame of particle output, built on the simulation side and drawn later, so
+        // draw() never reads particle state while the next update runs
+        struct Frame
+        {
+            std::vector<GpuParticle> particles;  // CPU simulation: what to draw
+            CullStats cullStats;
+            std::vector<GpuParticleSimulation::Spawn> spawns;  // GPU simulation: emitted since the last frame
+            float deltaSeconds{0.0f};  // GPU simulation: time to advance before drawing
+        };
+
+        // gpuSimulation moves update() into a compute shader when GL 4.3 is available. The
+        // CPU simulation stays the reference: both produce the same particles.
+        explicit ParticleSystem(size_t maxParticles = 2000, bool gpuSimulation = false);
         ~ParticleSystem();
 
         ParticleSystem(const ParticleSystem&) = delete;
         ParticleSystem& operator=(const ParticleSystem&) = delete;
 
         void emit(const SpawnParams& params);
+        // Writes the burst straight into particle storage, one field at a time with bulk
+        // random fills; particles beyond the free capacity are dropped. Returns how many
+        // were emitted.
+        size_t emitBurst(const BurstParams& burst);
+        void seedRandom(uint64_t seed);
         void update(float deltaSeconds);
-        void draw(const Camera& camera, float aspectRatio);
+        // Copies the particles to draw into the frame, dropping those outside the view or
+        // projected below the minimum size. The viewport is the default framebuffer's.
+        void buildFrame(Frame& frame, const Camera& camera, int viewportWidth, int viewportHeight);
+        // Sprite diameter in pixels under which particles are not drawn; 0 keeps them all
+        void setMinPixelSize(float pixels) { m_minPixelSize = pixels; }
+        // Runs the GPU simulation step, if any, then draws; consumes the frame's spawns.
+        // pointScale shrinks the sprites when drawing into a lower resolution target.
+        void draw(Frame& frame, const Camera& camera, float aspectRatio, float pointScale = 1.0f);
 
-        size_t activeParticleCount() const { return m_particles.size(); }
+        bool gpuSimulation() const { return m_gpuSimulation != nullptr; }
+        // CPU simulation only; the GPU keeps its count to itself
+        size_t activeParticleCount() const { return m_count; }
 
-    private:
-        struct Particle
-        {
-            glm::vec3 position;
-            glm::vec3 velocity;
-            glm::vec3 acceleration;
-            glm::vec4 baseColor;
-            float startSize;
-            float endSize;
-            float lifetime;
-            float age;
-            glm::vec4 renderColor;
-            float renderSize;
-        };
+        // Steps the same fixed-seed particles through the CPU simulation and
+        // particle_simulate.comp, reads the GPU side back and compares the survivors within
+        // a small tolerance. Needs the GL context; logs the outcome and returns false on a
+        // mismatch. Without compute shaders there is nothing to compare and it returns true.
+        static bool verifyGpuSimulation(size_t particleCount = 4096, int steps = 8);
 
-        struct GpuParticle
+    private:
+        // Structure of arrays, allocated once for maxParticles: the update kernel streams
+        // only the fields it integrates, four particles per SSE register. Dead particles are
+        // replaced by the last live one, so [0, m_count) is always dense.
+        struct Particles
         {
-            glm::vec3 position;
-            glm::vec4 color;
-            float size;
+            AlignedVector<float> positionX, positionY, positionZ;
+            AlignedVector<float> velocityX, velocityY, velocityZ;
+            AlignedVector<float> accelerationX, accelerationY, accelerationZ;
+            AlignedVector<float> age;
+            AlignedVector<float> inverseLifetime;
+            AlignedVector<float> startSize;
+            AlignedVector<float> endSize;
+            std::vector<glm::vec4> baseColor;  // Only read when writing the draw list
         };
 
-        void uploadParticlesToGpu();
+        void updateRange(size_t begin, size_t end, float dt);
+        void moveParticle(size_t from, size_t to);
+        void uploadParticlesToGpu(const std::vector<GpuParticle>& particles);
 
-        std::vector<Particle> m_particles;
-        std::vector<GpuParticle> m_gpuBuffer;
+        Particles m_particles;
+        std::vector<GpuParticle> m_drawList;  // Written by the update kernel, one per live particle
+        std::vector<size_t> m_deadPerBatch;
+        std::vector<CullStats> m_batchCullStats;
+        std::unique_ptr<GpuParticleSimulation> m_gpuSimulation;
+        std::vector<GpuParticleSimulation::Spawn> m_pendingSpawns;
+        float m_pendingDeltaSeconds{0.0f};
+        float m_minPixelSize{0.0f};
+        size_t m_count{0};
         size_t m_maxParticles;
+        Random m_random{Random::entropySeed()};
+        AlignedVector<float> m_burstScratch;  // Random columns emitBurst does not write in place
 
         GLuint m_vao{0};
         GLuint m_vbo{0};
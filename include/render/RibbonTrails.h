@@ -0,0 +1,97 @@
+#pragma once
+
+#include "math/Camera.h"
+#include "render/Shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace cg
+{
+    // Continuous trails drawn as camera-facing triangle strips. Each trail keeps the points
+    // its emitter left behind in a ring buffer; the points drift and age, and the ribbon
+    // widens and fades along them. One strip replaces the hundreds of overlapping additive
+    // sprites a particle trail needs, so both the primitive count and the overdraw drop.
+    //
+    // update(), record() and buildFrame() belong to the simulation; draw() needs the GL
+    // context.
+    class RibbonTrails
+    {
+    public:
+        struct Settings
+        {
+            float sampleInterval{0.1f};  // Seconds between recorded points
+            float lifetime{3.2f};
+            float startWidth{120.0f};  // World units across, at the emitter
+            float endWidth{260.0f};
+            glm::vec3 acceleration{0.0f};
+        };
+
+        struct Vertex
+        {
+            glm::vec3 position;
+            glm::vec4 color;
+            float across;  // -1 to 1 from one edge of the ribbon to the other
+        };
+
+        // The strips to draw for one frame, built on the simulation side like
+        // ParticleSystem::Frame
+        struct Frame
+        {
+            std::vector<Vertex> vertices;
+            std::vector<GLint> stripFirsts;
+            std::vector<GLsizei> stripCounts;
+        };
+
+        // One trail per color
+        RibbonTrails(const Settings& settings, std::span<const glm::vec4> colors);
+        ~RibbonTrails();
+
+        RibbonTrails(const RibbonTrails&) = delete;
+        RibbonTrails& operator=(const RibbonTrails&) = delete;
+
+        // Ages and moves the recorded points; trails not recorded again this frame stop
+        // following their emitter and fade out
+        void update(float deltaSeconds);
+        // The emitter of a trail is at position this frame; new points start with velocity
+        void record(size_t trail, const glm::vec3& position, const glm::vec3& velocity);
+        void buildFrame(Frame& frame, const glm::vec3& cameraPosition) const;
+        void draw(const Frame& frame, const Camera& camera, float aspectRatio);
+
+    private:
+        struct Point
+        {
+            glm::vec3 position;
+            glm::vec3 velocity;
+            float age;
+            bool joinsOlder;  // False for the first point after a gap in recording
+        };
+
+        struct Trail
+        {
+            glm::vec4 color;
+            std::vector<Point> ring;  // Fixed capacity; newest at head
+            size_t head{0};
+            size_t count{0};
+            float sinceSample{0.0f};
+            glm::vec3 emitter{0.0f};
+            bool emitting{false};  // Recorded this frame
+            bool wasEmitting{false};  // Recorded the frame before
+
+            const Point& fromNewest(size_t index) const { return ring[(head + ring.size() - index) % ring.size()]; }
+        };
+
+        void appendStrip(Frame& frame, const Trail& trail, std::span<const Point> points, const glm::vec3& cameraPosition) const;
+
+        Settings m_settings;
+        std::vector<Trail> m_trails;
+
+        GLuint m_vao{0};
+        GLuint m_vbo{0};
+        std::unique_ptr<Shader> m_shader;
+    };
+} // namespace cg
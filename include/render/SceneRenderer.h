@@ -5,6 +5,7 @@
 #include "scene/Scene.h"
 
 #include <glm/glm.hpp>
+#include <array>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -21,6 +22,7 @@ namespace cg
         glm::mat4 transform{1.0f};
         unsigned texture{0};
         bool textured{false};
+        bool sharedGeometry{false};  // vao/vbo/ebo belong to the mesh this one instances
         std::string name;
     };
 
@@ -66,7 +68,11 @@ namespace cg
         void setTextureAnisotropyLevel(float level);  // Set anisotropic filtering level for new textures
         void setTextureQualityDistances(float nearDist, float farDist, float minFactor);  // Set distance-based quality parameters
         void setAdvancedMaterialToggles(const MaterialFeatureToggles& toggles);
-        void setEnvironmentMaps(unsigned dayTexture, unsigned nightTexture);
+        // Prefiltered environment cubemaps; mip level i holds roughness i / (mipCount - 1)
+        void setEnvironmentMaps(unsigned dayCubemap, unsigned nightCubemap, int mipCount);
+        // SH9 irradiance per sky, blended on the CPU with the day/night factor
+        void setEnvironmentIrradiance(const std::array<glm::vec3, 9>& day, const std::array<glm::vec3, 9>& night);
+        void setEnvironmentAmbientWeight(float weight) { m_environmentAmbientWeight = weight; }
         void setLanternLights(const std::vector<LanternLight>& lights);
 
     private:
@@ -86,6 +92,10 @@ namespace cg
         MaterialFeatureToggles m_materialToggles{};
         unsigned m_environmentMapDay{0};
         unsigned m_environmentMapNight{0};
+        int m_environmentMipCount{1};
+        std::array<glm::vec3, 9> m_dayIrradianceSH{};
+        std::array<glm::vec3, 9> m_nightIrradianceSH{};
+        float m_environmentAmbientWeight{0.0f};
         std::vector<LanternLight> m_lanternLights;
 
         void buildFromScene(const Scene& scene);
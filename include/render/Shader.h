@@ -3,6 +3,7 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <initializer_list>
 #include <string>
 #include <string_view>
 
@@ -12,6 +13,8 @@ namespace cg
     {
     public:
         Shader(std::string_view vertexPath, std::string_view fragmentPath);
+        // Compute program (GL 4.3)
+        explicit Shader(std::string_view computePath);
         ~Shader();
 
         Shader(const Shader&) = delete;
@@ -19,11 +22,15 @@ namespace cg
 
         void bind() const;
         void setMat4(std::string_view name, const glm::mat4& value) const;
+        void setVec2(std::string_view name, const glm::vec2& value) const;
         void setVec3(std::string_view name, const glm::vec3& value) const;
         void setFloat(std::string_view name, float value) const;
         void setInt(std::string_view name, int value) const;
+        void setUInt(std::string_view name, unsigned value) const;
 
     private:
+        void link(std::initializer_list<GLuint> shaders);
+
         GLuint m_program{0};
     };
 } // namespace cg
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "loader/ExrStreamReader.h"
+#include "render/EnvironmentBaker.h"
+#include "render/SkyboxFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cg
+{
+    // GL-free half of the skybox loader: decodes an equirectangular EXR/HDR sky straight into
+    // its GPU layout (optionally as a cubemap) plus the baked environment, and reads/writes
+    // the on-disk form of that result. Shared by SkyboxRenderer and the cg_bake tool.
+    namespace SkyboxDecoder
+    {
+        const char* formatName(SkyboxFormat format);
+        size_t textureByteSize(SkyboxFormat format, int width, int height);
+
+        struct Job
+        {
+            SkyboxFormat format{SkyboxFormat::Rgba16F};
+            int sourceWidth{0};
+            int sourceHeight{0};
+            int sourceBlockHeight{1};
+            int cubemapFaceSize{0};  // 0 keeps the equirectangular layout
+            int environmentFaceSize{0};
+            uint8_t* target{nullptr};  // Final GPU layout; cubemap faces back to back
+            // Used instead of target when that is null: receives every finished band of rows in
+            // the GPU layout (face 0 without a cubemap). bytes is only valid during the call.
+            std::function<void(int face, int firstRow, int rows, const uint8_t* bytes)> writeBand;
+        };
+
+        // Bytes job.target must hold
+        size_t outputSize(const Job& job);
+
+        // Reads only the image header and fills the job's source fields. EXR files keep their
+        // reader open for decode(). Must run before any worker decodes (stb flip flag).
+        bool openSource(const std::string& path, Job& job, std::unique_ptr<ExrStreamReader>& reader);
+
+        // Decodes the whole image into job.target or job.writeBand; errors are logged
+        bool decode(const std::string& path, std::unique_ptr<ExrStreamReader> reader, const Job& job,
+                    EnvironmentBaker::Environment& environment);
+
+        // Decoded sky on disk: the skybox cache and baked artifacts
+        struct CacheHeader
+        {
+            char magic[4]{};
+            uint32_t version{0};
+            uint64_t sourceSize{0};
+            int64_t sourceTime{0};
+            int32_t width{0};
+            int32_t height{0};
+            int32_t cubemapFaceSize{0};
+            int32_t environmentFaceSize{0};  // Requested size; part of the settings
+            int32_t environmentMipCount{0};
+            int32_t environmentBakedFaceSize{0};  // Power of two the bake rounded it to
+            uint32_t format{0};
+            uint64_t dataSize{0};
+        };
+
+        // Fills in the source size and time; false if the source cannot be stat'ed
+        bool makeCacheHeader(const std::string& sourcePath, SkyboxFormat format, const Job& job, CacheHeader& header);
+        // Reads the header of a cache file and checks its magic and version
+        bool readCacheHeader(const std::string& cachePath, CacheHeader& header);
+        // Same output settings (format, sizes); sameSource additionally compares the source stamp
+        bool sameSettings(const CacheHeader& a, const CacheHeader& b);
+        bool sameSource(const CacheHeader& a, const CacheHeader& b);
+        // Rejects files whose size does not match the header
+        bool readCache(const std::string& cachePath, const CacheHeader& header, std::vector<uint8_t>& data,
+                       EnvironmentBaker::Environment& environment);
+        // Writes atomically (temp file + rename); failures are logged
+        bool writeCache(const std::string& cachePath, CacheHeader header, const std::vector<uint8_t>& data,
+                        const EnvironmentBaker::Environment& environment);
+
+        // AssetBake variant for one output configuration
+        std::string bakeVariant(SkyboxFormat format, int cubemapFaceSize, int environmentFaceSize);
+    }
+} // namespace cg
@@ -0,0 +1,12 @@
+#pragma once
+
+namespace cg
+{
+    // GPU storage for skybox images, largest to smallest
+    enum class SkyboxFormat
+    {
+        Rgba16F,  // 8 bytes per texel
+        Rgb9E5,   // 4 bytes per texel, shared exponent
+        Bc6h      // 1 byte per texel, CPU encoded and cached on disk
+    };
+} // namespace cg
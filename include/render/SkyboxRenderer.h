@@ -1,17 +1,31 @@
 #pragma once
 
 #include "math/Camera.h"
+#include "render/EnvironmentBaker.h"
 #include "render/Shader.h"
+#include "render/SkyboxFormat.h"
 
 #include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace cg
 {
     class SkyboxRenderer
     {
     public:
+        // Prefiltered cubemap (mip = roughness) and SH9 irradiance baked from one sky image
+        struct EnvironmentLighting
+        {
+            unsigned cubemap{0};
+            int mipCount{0};
+            std::array<glm::vec3, 9> irradianceSH{};
+        };
+
         SkyboxRenderer();
         ~SkyboxRenderer();
 
@@ -19,20 +33,66 @@ namespace cg
         SkyboxRenderer& operator=(const SkyboxRenderer&) = delete;
 
         bool loadEquirectangularTextures(const std::string& dayPath, const std::string& nightPath);
+        // Starts decoding both images on worker threads. Must be called on the GL thread,
+        // which only allocates the textures; pair with finishLoadEquirectangularTextures().
+        void beginLoadEquirectangularTextures(const std::string& dayPath, const std::string& nightPath);
+        // Waits for the decode jobs and finishes the uploads (GL thread).
+        bool finishLoadEquirectangularTextures();
         void draw(const Camera& camera, float aspectRatio, float blend, float dayYOffset, float nightYOffset);
         void setNightBrightness(float brightness) { m_nightBrightness = brightness; }
         unsigned dayTextureHandle() const { return m_dayTexture; }
         unsigned nightTextureHandle() const { return m_nightTexture; }
+        // Face size of the baked environment cubemaps; 0 disables the bake. Set before loading.
+        void setEnvironmentFaceSize(int faceSize) { m_environmentFaceSize = faceSize; }
+        // GPU storage for the sky itself. A cubemap face size > 0 converts the equirectangular
+        // images to cubemaps of that size; BC6H results are cached in cacheDirectory.
+        void setStorage(SkyboxFormat format, int cubemapFaceSize, const std::string& cacheDirectory)
+        {
+            m_format = format;
+            m_cubemapFaceSize = cubemapFaceSize;
+            m_cacheDirectory = cacheDirectory;
+        }
+        const EnvironmentLighting& dayEnvironment() const { return m_dayEnvironment; }
+        const EnvironmentLighting& nightEnvironment() const { return m_nightEnvironment; }
 
     private:
+        class BandUploads;
+
+        // One in-flight texture load. Uncompressed formats stream bands of finished rows
+        // through a few staging slots into texture as main-thread jobs; BC6H and baked or
+        // cached skies are read into data and uploaded at the end.
+        struct PendingTexture
+        {
+            std::string path;
+            SkyboxFormat format{SkyboxFormat::Rgba16F};
+            bool cubemap{false};
+            int width{0};   // Face size for cubemaps
+            int height{0};
+            unsigned texture{0};
+            std::shared_ptr<BandUploads> uploads;
+            std::vector<uint8_t> data;
+            EnvironmentBaker::Environment environment;
+            std::future<bool> decoded;
+        };
+
         std::unique_ptr<Shader> m_shader;
         unsigned m_vao{0};
         unsigned m_vbo{0};
         unsigned m_dayTexture{0};
         unsigned m_nightTexture{0};
         float m_nightBrightness{1.0f};
+        int m_environmentFaceSize{128};
+        SkyboxFormat m_format{SkyboxFormat::Rgba16F};
+        int m_cubemapFaceSize{0};
+        std::string m_cacheDirectory{"cache"};
+        bool m_cubemap{false};
+        EnvironmentLighting m_dayEnvironment;
+        EnvironmentLighting m_nightEnvironment;
+        PendingTexture m_pendingDay;
+        PendingTexture m_pendingNight;
 
-        unsigned loadTexture(const std::string& path) const;
+        void beginTextureLoad(const std::string& path, PendingTexture& pending);
+        unsigned finishTextureLoad(PendingTexture& pending, EnvironmentLighting& environment);
         void createCubeGeometry();
     };
 } // namespace cg
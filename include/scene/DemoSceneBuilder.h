@@ -3,6 +3,7 @@
 #include "scene/Scene.h"
 #include "scene/FlagGenerator.h"
 #include "scene/GroundBuilder.h"
+#include "loader/ModelImporter.h"
 #include "loader/ObjLoader.h"
 
 #include <vector>
@@ -32,6 +33,13 @@ namespace cg
     {
         return ObjLoader::loadObjAsMeshes(path);
     }
+
+    // OBJ split by materials, or an FBX/glTF scene with its node instancing kept
+    // (Mesh::instanceOf indices are relative to the returned vector).
+    inline std::vector<Mesh> loadModelAsMeshes(const std::string& path)
+    {
+        return ModelImporter::supports(path) ? ModelImporter::loadScene(path) : ObjLoader::loadObjAsMeshes(path);
+    }
     
     // Generate a Bezier surface flag mesh for waving animation (with configurable control points)
     inline Mesh generateBezierFlag(float width, float height, int controlPointsU, int controlPointsV,
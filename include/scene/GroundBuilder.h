@@ -11,6 +11,14 @@ namespace cg
     {
         // Build a demo scene with tiled ground meshes
         std::vector<Mesh> buildDemoScene(const std::string& groundMeshPath, int tilesPerSide);
+
+        // Files buildDemoScene reads: candidate tile OBJs and the ground textures (for cg_bake)
+        struct GroundAssets
+        {
+            std::vector<std::string> tileFiles;
+            std::vector<std::string> textures;
+        };
+        GroundAssets listGroundAssets(const std::string& groundMeshPath);
     }
 } // namespace cg
 
@@ -22,6 +22,10 @@ namespace cg
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
         std::string diffuseTexture;
+        // Index of an earlier mesh in the same list whose vertices and indices this mesh
+        // draws with its own transform; -1 if the mesh owns its geometry. Instances keep
+        // their vertex and index arrays empty.
+        int instanceOf{-1};
     };
 
     struct SceneBounds
@@ -36,6 +40,8 @@ namespace cg
     {
     public:
         explicit Scene(std::vector<Mesh> meshes);
+        // Bounds already known (SceneSnapshot); skips transforming every vertex
+        Scene(std::vector<Mesh> meshes, const SceneBounds& bounds);
         const std::vector<Mesh>& meshes() const { return m_meshes; }
         bool empty() const { return m_meshes.empty(); }
         const SceneBounds& bounds() const { return m_bounds; }
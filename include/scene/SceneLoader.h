@@ -0,0 +1,24 @@
+#pragma once
+
+#include "scene/Scene.h"
+#include "scene/SceneManifest.h"
+
+#include <string>
+#include <vector>
+
+namespace cg
+{
+    // Builds the mesh list a SceneManifest describes. Every asset load and every node
+    // (copy, tint, place) is a TaskGraph task: independent assets decode concurrently and a
+    // node starts as soon as its asset is ready. Output follows manifest node order.
+    namespace SceneLoader
+    {
+        // Returns false when a required asset fails or the "after" lists form a cycle.
+        // breakdown receives one timing line per task, for the startup log.
+        bool load(const SceneManifest::Manifest& manifest, std::vector<Mesh>& meshes, std::string& breakdown);
+
+        // Files load() reads, including the material libraries of OBJ models and ground
+        // tiles, for cache keys (generated assets read none)
+        std::vector<std::string> inputFiles(const SceneManifest::Manifest& manifest);
+    }
+} // namespace cg
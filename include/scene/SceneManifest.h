@@ -0,0 +1,128 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace cg
+{
+    struct AppConfig;
+
+    // Declarative scene description: the assets a scene is built from and the nodes placing
+    // them. SceneLoader turns it into the startup mesh list. JSON form:
+    //
+    //   {
+    //     "assets": [
+    //       {"id": "jet", "type": "mesh", "path": "models/plane/SR71.obj", "required": true},
+    //       {"id": "city", "type": "meshes", "path": "models/gugong/ancientCity.obj", "searchDirectory": true},
+    //       {"id": "ground", "type": "ground", "path": "models/ground/groundtail", "tilesPerSide": 150},
+    //       {"id": "pole", "type": "flagpole", "height": 400, "radius": 3, "ballRadius": 6, "segments": 16},
+    //       {"id": "flag", "type": "flag", "width": 120, "height": 80, "after": ["pole"]}
+    //     ],
+    //     "nodes": [
+    //       {"asset": "ground"},
+    //       {"name": "ancientCity", "asset": "city", "transform": {"translate": [0, 30, 0], "rotateY": -90, "scale": 100}},
+    //       {"name": "wingman_left{n}", "asset": "jet", "count": 2, "transform": {"hidden": true}},
+    //       {"name": "drone_{i}", "asset": "jet", "count": 8, "tint": [1, 0.7, 0.4], "tintAmount": 0.3},
+    //       {"asset": "pole"}, {"name": "flag", "asset": "flag", "texture": "models/FlagPole/image.png"}
+    //     ]
+    //   }
+    //
+    // Asset types: "mesh" (one OBJ mesh), "meshes" (OBJ split by material, or an FBX/glTF
+    // scene), "ground", and the procedural "flagpole", "flag" and "flagControlPoints". An
+    // asset starts loading once everything in its "after" list has. A node places count
+    // copies of an asset; in its name {i} expands to the copy index and {n} to index + 1.
+    // Multi-mesh assets name their meshes "<node name>_<mesh name>" (the mesh names alone
+    // when the node has none). Untinted copies of an asset share its geometry.
+    namespace SceneManifest
+    {
+        struct Transform
+        {
+            glm::vec3 translate{0.0f};
+            float rotateY{0.0f};  // Degrees
+            glm::vec3 scale{1.0f};
+            bool hidden{false};  // Zero scale: placed in the scene but not drawn until moved
+
+            // translate * rotateY * scale
+            glm::mat4 matrix() const;
+        };
+
+        enum class AssetType
+        {
+            Mesh,
+            Meshes,
+            Ground,
+            Flagpole,
+            Flag,
+            FlagControlPoints
+        };
+
+        struct FlagpoleParams
+        {
+            float height{400.0f};
+            float radius{3.0f};
+            float ballRadius{6.0f};
+            int segments{16};
+            glm::vec3 color{0.7f};
+            glm::vec3 ballColor{1.0f, 0.9f, 0.8f};
+        };
+
+        // Also used by "flagControlPoints", which draws the control points of the same surface
+        struct FlagParams
+        {
+            float width{120.0f};
+            float height{80.0f};
+            int controlPointsU{8};
+            int controlPointsV{6};
+            int segmentsU{20};
+            int segmentsV{15};
+            float markerSize{8.0f};
+            glm::vec3 markerColor{1.0f, 0.9f, 0.2f};
+        };
+
+        struct Asset
+        {
+            std::string id;
+            AssetType type{AssetType::Mesh};
+            std::string path;  // mesh, meshes, ground
+            bool required{false};  // Loading fails when a required asset yields no meshes
+            bool searchDirectory{false};  // meshes: fall back to any model next to path
+            int tilesPerSide{1};  // ground
+            FlagpoleParams flagpole;
+            FlagParams flag;
+            std::vector<std::string> after;
+        };
+
+        struct Node
+        {
+            std::string name;
+            std::string asset;
+            int count{1};
+            Transform transform;
+            std::string texture;  // Replaces the asset's diffuse texture when set
+            glm::vec3 tint{1.0f};
+            float tintAmount{0.0f};  // Vertex colors are mixed towards tint by this much
+        };
+
+        struct Manifest
+        {
+            std::vector<Asset> assets;
+            std::vector<Node> nodes;
+
+            const Asset* findAsset(const std::string& id) const;
+        };
+
+        // Parses and validates (unique asset ids, known references); errors are logged
+        bool load(const std::string& path, Manifest& manifest);
+        bool parse(const char* json, size_t size, const std::string& source, Manifest& manifest);
+        // Canonical JSON with every field written out; equal manifests give equal strings
+        std::string toJson(const Manifest& manifest);
+
+        // The scene the settings in AppConfig describe
+        Manifest fromConfig(const AppConfig& config);
+        // config.sceneManifestPath when set, fromConfig otherwise
+        bool resolve(const AppConfig& config, Manifest& manifest);
+
+        const char* typeName(AssetType type);
+    }
+} // namespace cg
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "scene/Scene.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cg
+{
+    // Whole-scene snapshot (.cgscene): the final mesh list App::preloadResources assembles,
+    // with transforms, texture references and the scene bounds, so a warm start maps one
+    // file and goes straight to GPU upload. The caller supplies a key covering everything
+    // the scene was built from (config values, input file stamps); a snapshot written with
+    // another key is ignored. Meshes whose geometry is identical to an earlier one's are
+    // stored once and come back as instances (Mesh::instanceOf).
+    namespace SceneSnapshot
+    {
+        std::unique_ptr<Scene> load(const std::string& path, uint64_t key);
+
+        // Writes atomically (temp file + rename); failures are logged. Meshes named in
+        // keepUnique (vertices updated at runtime) never share geometry.
+        bool store(const std::string& path, uint64_t key, const Scene& scene, const std::vector<std::string>& keepUnique);
+    }
+} // namespace cg
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace cg
+{
+    // std::allocator with a minimum alignment, so SIMD kernels can use aligned loads on
+    // std::vector storage
+    template <typename T, size_t Alignment>
+    struct AlignedAllocator
+    {
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() = default;
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+        T* allocate(size_t count)
+        {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T* pointer, size_t) noexcept
+        {
+            ::operator delete(pointer, std::align_val_t(Alignment));
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+    };
+
+    template <typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T, 32>>;
+} // namespace cg
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+namespace cg
+{
+    // Session-wide, case-insensitive, recursive filename index used to resolve texture
+    // references. Each base directory is scanned once, on first use; lookups afterwards
+    // are hash lookups. Safe to call from loader threads.
+    namespace DirectoryIndex
+    {
+        // Finds fileName (its filename component, compared case-insensitively) anywhere under
+        // baseDir, preferring the shallowest match. With allowPartialMatch, falls back to the
+        // first indexed filename containing it. Returns a generic-format path.
+        std::optional<std::string> findFile(const std::string& baseDir, const std::string& fileName, bool allowPartialMatch = true);
+
+        // Logs directories indexed and lookup hit/miss counts so far
+        void logStatistics();
+    }
+} // namespace cg
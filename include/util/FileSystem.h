@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -7,5 +8,47 @@ namespace cg
 {
     std::string readTextFile(const std::string& path);
     std::vector<char> readBinaryFile(const std::string& path);
-} // namespace cg
 
+    // Read-only memory mapping of a whole file. Loaders parse straight out of the page
+    // cache instead of copying the file into a heap buffer first.
+    class MappedFile
+    {
+    public:
+        enum class Access
+        {
+            Sequential,  // Read front to back once; the OS reads ahead aggressively
+            Random
+        };
+
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        // Returns false if the file cannot be opened or mapped; callers report the error.
+        // Empty files map successfully with data() == nullptr.
+        bool open(const std::string& path, Access access = Access::Sequential);
+        void close();
+
+        // Tells the OS a range has been consumed and its pages can be dropped early.
+        // Keeps resident memory flat while streaming through a large file; no-op on Windows.
+        void release(size_t offset, size_t size) const;
+
+        bool isOpen() const { return m_open; }
+        const char* data() const { return m_data; }
+        const unsigned char* bytes() const { return reinterpret_cast<const unsigned char*>(m_data); }
+        size_t size() const { return m_size; }
+
+    private:
+        const char* m_data{nullptr};
+        size_t m_size{0};
+        bool m_open{false};
+#ifdef _WIN32
+        void* m_file{nullptr};
+        void* m_mapping{nullptr};
+#endif
+    };
+} // namespace cg
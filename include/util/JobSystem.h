@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cg
+{
+    // Persistent work-stealing thread pool shared by every parallel loop and background job.
+    // Each worker owns a deque: it pushes and pops jobs at the back, idle workers steal from
+    // the front. Jobs submitted from other threads go through a shared injection queue.
+    //
+    // A job may depend on earlier jobs; it is queued the moment the last of them finishes.
+    // Jobs submitted with submitMain run on the main thread (the one that first used the
+    // pool) inside runMainThreadJobs() or a main-thread wait(); that is where loading-time GL
+    // work goes.
+    //
+    // wait() never just blocks: the waiting thread runs queued jobs until its job is done,
+    // so jobs can wait on nested parallel loops without starving the pool.
+    class JobSystem
+    {
+    public:
+        struct Job;
+        using JobHandle = std::shared_ptr<Job>;
+
+        static JobSystem& instance();
+
+        explicit JobSystem(size_t workerCount);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // Exceptions escaping fn are logged; the job still counts as finished
+        JobHandle submit(std::function<void()> fn, const std::vector<JobHandle>& dependencies = {});
+        JobHandle submitMain(std::function<void()> fn, const std::vector<JobHandle>& dependencies = {});
+
+        // The result (or exception) of fn through a std::future
+        template <typename Fn>
+        auto async(Fn fn) -> std::future<std::invoke_result_t<Fn&>>;
+
+        // fn(i) for every i in [0, count) on the workers and the calling thread. Items are
+        // handed out one at a time, so uneven item costs balance out. The first exception
+        // thrown by fn is rethrown here once every item has stopped.
+        template <typename Fn>
+        void parallelFor(size_t count, const Fn& fn);
+
+        void wait(const JobHandle& job);
+        void wait(const std::vector<JobHandle>& jobs);
+        static bool finished(const JobHandle& job);
+
+        // Runs the main-thread jobs queued so far; returns how many ran
+        size_t runMainThreadJobs();
+
+        size_t workerCount() const { return m_workers.size(); }
+        bool isMainThread() const { return std::this_thread::get_id() == m_mainThread; }
+
+    private:
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<JobHandle> jobs;
+        };
+
+        JobHandle create(std::function<void()> fn, bool mainThread, const std::vector<JobHandle>& dependencies);
+        void schedule(JobHandle job);
+        JobHandle findWork();
+        bool runOneMainThreadJob();
+        void execute(const JobHandle& job);
+        void workerLoop(size_t index);
+
+        std::thread::id m_mainThread;
+        std::vector<std::unique_ptr<WorkQueue>> m_queues;  // One per worker
+        WorkQueue m_injection;
+        WorkQueue m_mainQueue;
+        std::atomic<size_t> m_queued{0};  // Jobs in m_queues and m_injection
+        std::atomic<size_t> m_waiters{0};
+
+        std::mutex m_sleepMutex;
+        std::condition_variable m_workAvailable;  // Idle workers
+        std::condition_variable m_progress;  // Threads inside wait()
+        bool m_stopping{false};
+        std::vector<std::thread> m_workers;
+    };
+
+    template <typename Fn>
+    auto JobSystem::async(Fn fn) -> std::future<std::invoke_result_t<Fn&>>
+    {
+        using Result = std::invoke_result_t<Fn&>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+        std::future<Result> future = task->get_future();
+        submit([task]() { (*task)(); });
+        return future;
+    }
+
+    template <typename Fn>
+    void JobSystem::parallelFor(size_t count, const Fn& fn)
+    {
+        const size_t helpers = std::min(count, workerCount() + 1) - (count > 0 ? 1 : 0);
+        if (helpers == 0)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                fn(i);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        auto work = [&]() {
+            try
+            {
+                for (size_t i = next++; i < count; i = next++)
+                {
+                    fn(i);
+                }
+            }
+            catch (...)
+            {
+                next = count;
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        };
+        std::vector<JobHandle> jobs;
+        jobs.reserve(helpers);
+        for (size_t h = 0; h < helpers; ++h)
+        {
+            jobs.push_back(submit(work));
+        }
+        work();
+        wait(jobs);
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+} // namespace cg
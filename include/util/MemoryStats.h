@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cg
+{
+    namespace MemoryStats
+    {
+        // Resident set size of this process, in bytes (0 if the platform cannot report it)
+        size_t currentResidentBytes();
+        // High-water mark of the resident set since process start
+        size_t peakResidentBytes();
+    }
+} // namespace cg
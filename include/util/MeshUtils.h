@@ -25,6 +25,9 @@ namespace cg
         
         // Transform mesh from Z-up to Y-up coordinate system
         void transformZUpToYUp(Mesh& mesh);
+
+        // Merge bit-identical vertices and remap the indices; keeps first-use vertex order
+        void weldVertices(Mesh& mesh);
     }
 } // namespace cg
 
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "util/JobSystem.h"
+
+#include <cstddef>
+
+namespace cg
+{
+    // Runs fn(i) for every i in [0, count) on the shared JobSystem workers, the calling
+    // thread included. Items are handed out one at a time, so uneven item costs balance out.
+    template <typename Fn>
+    void parallelFor(size_t count, const Fn& fn)
+    {
+        JobSystem::instance().parallelFor(count, fn);
+    }
+} // namespace cg
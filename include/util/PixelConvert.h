@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cg
+{
+    namespace PixelConvert
+    {
+        // Convert IEEE floats to half floats (round to nearest, overflow saturates to Inf).
+        // Uses SSE2 when available, four values per iteration.
+        void floatToHalf(const float* src, uint16_t* dst, size_t count);
+
+        uint16_t floatToHalf(float value);
+
+        // Pack RGB (alpha ignored when channels == 4) into GL_RGB9_E5 / GL_UNSIGNED_INT_5_9_9_9_REV
+        void floatToRgb9e5(const float* src, int channels, uint32_t* dst, size_t count);
+
+        // BC6H unsigned (GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT) encoder using the single-region
+        // 10-bit mode. Encodes rows [0, height) of a width-wide image; partial edge blocks
+        // repeat the last row/column. dst receives ((width + 3) / 4) * ((height + 3) / 4) * 16 bytes.
+        void encodeBc6h(const float* src, int channels, int width, int height, uint8_t* dst);
+        size_t bc6hSize(int width, int height);
+
+        // BC1 (opaque) and BC3 (with alpha) encoders for RGBA8 images, same block layout and
+        // edge handling as encodeBc6h. Values are encoded as given, so sRGB data stays sRGB.
+        void encodeBc1(const uint8_t* src, int width, int height, uint8_t* dst);
+        void encodeBc3(const uint8_t* src, int width, int height, uint8_t* dst);
+        size_t bc1Size(int width, int height);
+        size_t bc3Size(int width, int height);
+    }
+} // namespace cg
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace cg
+{
+    // xoshiro128+ run as four interleaved streams, so every step yields four numbers from
+    // one SSE2 register. The bulk fills write whole columns at a time, which suits the
+    // structure-of-arrays particle storage; the single-value calls draw from the same
+    // sequence. Everything is reproducible from the seed. Not thread-safe: give each
+    // thread its own generator.
+    class Random
+    {
+    public:
+        explicit Random(uint64_t seed);
+
+        void seed(uint64_t seed);
+
+        uint32_t nextUInt();
+        // Uniform in [0, 1)
+        float nextFloat();
+        float uniform(float minValue, float maxValue);
+        // Uniform in [minValue, maxValue], bounds included
+        int uniformInt(int minValue, int maxValue);
+        glm::vec3 unitVector();
+
+        void fillUniform(float* out, size_t count, float minValue, float maxValue);
+        // Directions uniform over the cap {z >= minCosine} of the unit sphere; -1 covers
+        // the whole sphere
+        void fillUnitVectors(float* x, float* y, float* z, size_t count, float minCosine = -1.0f);
+        // Points uniform over a disk of the given radius around the origin
+        void fillDisk(float* x, float* y, size_t count, float radius);
+        // Points uniform inside a ball of the given radius around the origin
+        void fillBall(float* x, float* y, float* z, size_t count, float radius);
+
+        // A seed from std::random_device, for callers that were not given one
+        static uint64_t entropySeed();
+
+    private:
+        static constexpr size_t kLanes = 4;
+
+        // Advances every stream once and writes one value per stream
+        void step(uint32_t* out);
+
+        alignas(16) uint32_t m_state[4][kLanes];
+        alignas(16) uint32_t m_buffer[kLanes];
+        size_t m_buffered{0};  // Values of m_buffer not handed out yet, taken from the back
+    };
+} // namespace cg
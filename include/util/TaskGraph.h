@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cg
+{
+    // A one-shot DAG of named, timed tasks on the JobSystem. run() starts every task as soon
+    // as all of its dependencies have finished; the calling thread helps until all are done.
+    // Dependencies must be added before their dependents, so the graph cannot have cycles.
+    class TaskGraph
+    {
+    public:
+        using TaskId = size_t;
+
+        TaskId add(std::string name, std::function<void()> fn, std::vector<TaskId> dependencies = {});
+
+        // Blocks until every task has run. An exception escaping a task is logged and counts
+        // as the task finishing; dependents still run and see whatever state it left.
+        void run();
+
+        size_t size() const { return m_tasks.size(); }
+        const std::string& name(TaskId id) const { return m_tasks[id].name; }
+        // Wall time of a finished task
+        long long milliseconds(TaskId id) const { return m_tasks[id].milliseconds; }
+
+    private:
+        struct Task
+        {
+            std::string name;
+            std::function<void()> fn;
+            std::vector<TaskId> dependencies;
+            long long milliseconds{0};
+        };
+
+        std::vector<Task> m_tasks;
+    };
+} // namespace cg
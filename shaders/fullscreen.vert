@@ -0,0 +1,10 @@
+#version 450 core
+
+// One triangle covering the viewport, from gl_VertexID alone (draw 3 vertices with an
+// empty vertex array)
+
+void main()
+{
+    vec2 position = vec2(float((gl_VertexID & 1) << 2), float((gl_VertexID & 2) << 1)) - 1.0;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
@@ -8,13 +8,14 @@ out vec4 vColor;
 
 uniform mat4 uView;
 uniform mat4 uProj;
+uniform float uPointScale;  // Target resolution over framebuffer resolution
 
 void main()
 {
     vec4 viewPos = uView * vec4(aPosition, 1.0);
     float dist = max(0.1, -viewPos.z);
-    float sizeScale = clamp(800.0 / dist, 0.5, 8.0);
-    gl_PointSize = aSize * sizeScale;
+    float sizeScale = clamp(800.0 / dist, 0.5, 8.0);  // Mirrored by ParticleSystem's culling
+    gl_PointSize = aSize * sizeScale * uPointScale;
     gl_Position = uProj * viewPos;
     vColor = aColor;
 }
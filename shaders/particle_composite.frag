@@ -0,0 +1,42 @@
+#version 450 core
+
+// Depth-aware (bilateral) upsample of the low resolution particle target. Each pixel blends
+// the four nearest low resolution texels with bilinear weights scaled down by how far each
+// texel's depth is from the pixel's own, so particles do not bleed across silhouettes.
+
+uniform sampler2D uParticles;
+uniform sampler2D uParticleDepth;
+uniform sampler2D uSceneDepth;
+uniform vec2 uDepthParams;  // proj[2][2], proj[3][2]
+
+out vec4 FragColor;
+
+float viewDistance(float depth)
+{
+    return uDepthParams.y / (depth * 2.0 - 1.0 + uDepthParams.x);
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float sceneDistance = viewDistance(texelFetch(uSceneDepth, pixel, 0).r);
+
+    ivec2 lowSize = textureSize(uParticles, 0);
+    vec2 lowPosition = gl_FragCoord.xy * vec2(lowSize) / vec2(textureSize(uSceneDepth, 0)) - 0.5;
+    ivec2 base = ivec2(floor(lowPosition));
+    vec2 f = lowPosition - vec2(base);
+
+    vec4 sum = vec4(0.0);
+    float weightSum = 0.0;
+    for (int i = 0; i < 4; ++i)
+    {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 texel = clamp(base + offset, ivec2(0), lowSize - 1);
+        vec2 bilinear = mix(1.0 - f, f, vec2(offset));
+        float lowDistance = viewDistance(texelFetch(uParticleDepth, texel, 0).r);
+        float weight = bilinear.x * bilinear.y / (0.01 + abs(sceneDistance - lowDistance) / sceneDistance);
+        sum += texelFetch(uParticles, texel, 0) * weight;
+        weightSum += weight;
+    }
+    FragColor = sum / max(weightSum, 1e-6);
+}
@@ -0,0 +1,24 @@
+#version 450 core
+
+// Writes the farthest scene depth of each uDivisor x uDivisor block, so the low resolution
+// particle pass never hides a particle that is visible in any of the block's pixels. The
+// composite sorts out the edges.
+
+uniform sampler2D uSceneDepth;
+uniform int uDivisor;
+
+void main()
+{
+    ivec2 size = textureSize(uSceneDepth, 0);
+    ivec2 origin = ivec2(gl_FragCoord.xy) * uDivisor;
+    float depth = 0.0;
+    for (int y = 0; y < uDivisor; ++y)
+    {
+        for (int x = 0; x < uDivisor; ++x)
+        {
+            ivec2 texel = min(origin + ivec2(x, y), size - 1);
+            depth = max(depth, texelFetch(uSceneDepth, texel, 0).r);
+        }
+    }
+    gl_FragDepth = depth;
+}
@@ -0,0 +1,12 @@
+#version 450 core
+
+in vec4 vColor;
+in float vAcross;
+out vec4 FragColor;
+
+void main()
+{
+    // Soft edges, like the particle sprites' radial falloff
+    float falloff = smoothstep(1.0, 0.0, abs(vAcross));
+    FragColor = vec4(vColor.rgb * falloff, vColor.a * falloff);
+}
@@ -0,0 +1,18 @@
+#version 450 core
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec4 aColor;
+layout(location = 2) in float aAcross;
+
+out vec4 vColor;
+out float vAcross;
+
+uniform mat4 uView;
+uniform mat4 uProj;
+
+void main()
+{
+    gl_Position = uProj * uView * vec4(aPosition, 1.0);
+    vColor = aColor;
+    vAcross = aAcross;
+}
@@ -9,6 +9,9 @@ in VS_OUT
 
 uniform sampler2D uDaySampler;
 uniform sampler2D uNightSampler;
+uniform samplerCube uDayCube;
+uniform samplerCube uNightCube;
+uniform int uUseCubemap;
 uniform float uBlend;
 uniform float uNightBrightness;
 
@@ -34,9 +37,21 @@ vec3 sampleSky(sampler2D tex, vec3 dir)
 void main()
 {
     vec3 dir = normalize(fs_in.viewDir);
-    vec3 dayColor = sampleSky(uDaySampler, dir);
     vec3 rotatedDir = vec3(-dir.x, dir.y, -dir.z);
-    vec3 nightColor = sampleSky(uNightSampler, rotatedDir) * max(uNightBrightness, 0.0);
+    vec3 dayColor;
+    vec3 nightColor;
+    if (uUseCubemap == 1)
+    {
+        // Cubemap faces were resampled with the same lat-long mapping as directionToUv
+        dayColor = texture(uDayCube, dir).rgb;
+        nightColor = texture(uNightCube, rotatedDir).rgb;
+    }
+    else
+    {
+        dayColor = sampleSky(uDaySampler, dir);
+        nightColor = sampleSky(uNightSampler, rotatedDir);
+    }
+    nightColor *= max(uNightBrightness, 0.0);
     vec3 color = mix(dayColor, nightColor, clamp(uBlend, 0.0, 1.0));
     FragColor = vec4(color, 1.0);
 }
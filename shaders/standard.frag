@@ -24,9 +24,12 @@ uniform sampler2D uDiffuse;
 uniform float uTextureQualityNearDistance;
 uniform float uTextureQualityFarDistance;
 uniform float uTextureQualityMinFactor;
-uniform sampler2D uEnvironmentDay;
-uniform sampler2D uEnvironmentNight;
+uniform samplerCube uEnvironmentDay;
+uniform samplerCube uEnvironmentNight;
 uniform float uEnvironmentBlend;
+uniform float uEnvironmentMaxLod;
+uniform vec3 uEnvironmentSH[9];
+uniform float uEnvironmentAmbientWeight;
 uniform int uHasEnvironmentMap;
 uniform int uMaterialMode;
 uniform int uLanternLightCount;
@@ -49,26 +52,34 @@ float proceduralHeight(vec3 worldPos)
     return h;
 }
 
-vec2 directionToLatLong(vec3 dir)
+// Prefiltered cubemaps: mip level = roughness * uEnvironmentMaxLod
+vec3 sampleEnvironment(vec3 dir, float roughness)
 {
-    float phi = atan(dir.z, dir.x);
-    float theta = acos(clamp(dir.y, -1.0, 1.0));
-    return vec2(phi / (2.0 * 3.14159265) + 0.5, theta / 3.14159265);
-}
-
-vec3 sampleEnvironment(vec3 dir)
-{
-    vec2 uv = directionToLatLong(normalize(dir));
     if (uHasEnvironmentMap == 0)
     {
         float horizon = clamp(dir.y * 0.5 + 0.5, 0.0, 1.0);
         return mix(vec3(0.25, 0.3, 0.35), vec3(0.85, 0.9, 1.0), horizon);
     }
-    vec3 day = texture(uEnvironmentDay, uv).rgb;
-    vec3 night = texture(uEnvironmentNight, uv).rgb;
+    float lod = clamp(roughness, 0.0, 1.0) * uEnvironmentMaxLod;
+    vec3 day = textureLod(uEnvironmentDay, dir, lod).rgb;
+    vec3 night = textureLod(uEnvironmentNight, dir, lod).rgb;
     return mix(day, night, clamp(uEnvironmentBlend, 0.0, 1.0));
 }
 
+// Diffuse irradiance / pi from the day/night-blended SH9 coefficients
+vec3 environmentIrradiance(vec3 n)
+{
+    return uEnvironmentSH[0] * 0.282095
+         + uEnvironmentSH[1] * (0.488603 * n.y)
+         + uEnvironmentSH[2] * (0.488603 * n.z)
+         + uEnvironmentSH[3] * (0.488603 * n.x)
+         + uEnvironmentSH[4] * (1.092548 * n.x * n.y)
+         + uEnvironmentSH[5] * (1.092548 * n.y * n.z)
+         + uEnvironmentSH[6] * (0.315392 * (3.0 * n.z * n.z - 1.0))
+         + uEnvironmentSH[7] * (1.092548 * n.x * n.z)
+         + uEnvironmentSH[8] * (0.546274 * (n.x * n.x - n.y * n.y));
+}
+
 vec3 brushedMetalNormal(vec3 normal, vec3 worldPos)
 {
     vec2 cyl = vec2(worldPos.x, worldPos.z);
@@ -171,6 +182,10 @@ void main()
     // 增强半球环境光
     float hemi = normal.y * 0.5 + 0.5;
     vec3 ambient = mix(uAmbientGround, uAmbientSky, clamp(hemi, 0.0, 1.0));
+    if (uHasEnvironmentMap == 1)
+    {
+        ambient = mix(ambient, max(environmentIrradiance(normal), vec3(0.0)), uEnvironmentAmbientWeight);
+    }
     // 增强环境光强度，确保即使在没有直射光的地方也能看到颜色
     ambient *= 1.5;
 
@@ -328,7 +343,7 @@ void main()
 
     if (uMaterialMode == 1)
     {
-        vec3 envColor = sampleEnvironment(reflect(-viewDir, normal));
+        vec3 envColor = sampleEnvironment(reflect(-viewDir, normal), 0.15);
         float fresnel = pow(1.0 - max(dot(normal, viewDir), 0.0), 5.0);
         float upFactor = clamp(normal.y * 0.5 + 0.5, 0.0, 1.0);
         float envWeight = mix(0.55, 0.92, upFactor);
@@ -342,7 +357,7 @@ void main()
     }
     else if (uMaterialMode == 3 && uHasEnvironmentMap == 1)
     {
-        vec3 envColor = sampleEnvironment(reflect(-viewDir, normal));
+        vec3 envColor = sampleEnvironment(reflect(-viewDir, normal), 0.8);
         // Reduce environment reflection for cloth (less mirror-like)
         baseColor = mix(baseColor, envColor, 0.03);  // Reduced from 0.12 to 0.03 for cloth
     }
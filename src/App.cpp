@@ -1,7 +1,14 @@
 #include "core/App.h"
 #include "core/AppConfig.h"
 
+#include "loader/AssetBake.h"
+#include "loader/MeshCache.h"
+#include "scene/SceneLoader.h"
+#include "scene/SceneManifest.h"
+#include "scene/SceneSnapshot.h"
+#include "util/JobSystem.h"
 #include "util/Log.h"
+#include "util/MemoryStats.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
@@ -13,49 +20,19 @@
 #include <sstream>
 #include <iomanip>
 #include <thread>
-#include <future>
 #include <mutex>
 #include <vector>
 #include <chrono>
 #include <optional>
-#include <random>
 
 namespace
 {
-    using RandomEngine = std::mt19937;
-
-    RandomEngine& globalRandomEngine()
-    {
-        thread_local RandomEngine engine(std::random_device{}());
-        return engine;
-    }
-
-    float randomFloat(float minValue, float maxValue)
-    {
-        if (minValue > maxValue)
-        {
-            std::swap(minValue, maxValue);
-        }
-        std::uniform_real_distribution<float> dist(minValue, maxValue);
-        return dist(globalRandomEngine());
-    }
-
-    int randomInt(int minValue, int maxValue)
-    {
-        if (minValue > maxValue)
-        {
-            std::swap(minValue, maxValue);
-        }
-        std::uniform_int_distribution<int> dist(minValue, maxValue);
-        return dist(globalRandomEngine());
-    }
-
-    glm::vec3 randomUnitVector()
+    template <typename Fn>
+    double measureMs(Fn&& fn)
     {
-        const float z = randomFloat(-1.0f, 1.0f);
-        const float theta = randomFloat(0.0f, glm::two_pi<float>());
-        const float radius = std::sqrt(std::max(0.0f, 1.0f - z * z));
-        return glm::vec3(radius * std::cos(theta), z, radius * std::sin(theta));
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
     }
 
     glm::mat4 applyScale(const glm::mat4& matrix, const glm::vec3& scale)
@@ -66,6 +43,38 @@ namespace
         result[2] *= scale.z;
         return result;
     }
+
+    // Everything App::buildSceneMeshes reads: the manifest, the size/mtime of each file it
+    // loads, the baked artifacts it may load instead and the settings that change how meshes
+    // are conditioned on the way in
+    uint64_t sceneSnapshotKey(const cg::AppConfig& config, const cg::SceneManifest::Manifest& manifest)
+    {
+        cg::AssetBake::Hasher hasher;
+        hasher.update(std::string("scene-2"));
+        hasher.update(cg::SceneManifest::toJson(manifest));
+        for (const std::string& path : cg::SceneLoader::inputFiles(manifest))
+        {
+            uint64_t size = ~0ull;
+            int64_t time = 0;
+            cg::AssetBake::sourceStamp(path, size, time);
+            hasher.update(path);
+            hasher.update(&size, sizeof(size));
+            hasher.update(&time, sizeof(time));
+            // Rebaking with other options rewrites what the scene was built from
+            for (const std::string& artifact : cg::AssetBake::artifacts(path))
+            {
+                hasher.update(artifact);
+            }
+        }
+
+        // Draco caches are lossy and baked meshes are welded, so both change the vertices
+        auto add = [&hasher](const auto& value) { hasher.update(&value, sizeof(value)); };
+        add(config.meshCacheDraco);
+        add(config.meshCacheDracoPositionBits);
+        hasher.update(config.bakedAssetDirectory);
+        add(config.bakedAssetsOnly);
+        return hasher.digest();
+    }
 }
 
 namespace cg
@@ -73,10 +82,20 @@ namespace cg
     App::App(AppConfig config)
         : m_config(std::move(config))
     {
+        // Snapped to the divisors P cycles through
+        const int divisor = m_config.particleResolutionDivisor;
+        m_particleResolutionDivisor = divisor >= 4 ? 4 : (divisor >= 2 ? 2 : 1);
     }
 
     int App::run()
     {
+        // Created here so this thread is the job system's main thread (GL uploads run on it)
+        JobSystem::instance();
+
+        const uint64_t seed = m_config.randomSeed != 0 ? m_config.randomSeed : Random::entropySeed();
+        m_random.seed(seed);
+        log(LogLevel::Info, "Random seed " + std::to_string(seed));
+
         if (!m_glfwContext.isInitialized())
         {
             log(LogLevel::Error, "Failed to initialize GLFW");
@@ -112,475 +131,334 @@ namespace cg
         log(LogLevel::Info, "Resource preloading completed. Starting animation...");
 
         // Initialize viewport
-        int framebufferWidth = m_config.windowWidth;
-        int framebufferHeight = m_config.windowHeight;
-        glViewport(0, 0, framebufferWidth, framebufferHeight);
+        glViewport(0, 0, m_config.windowWidth, m_config.windowHeight);
 
         // Reset timer and total time - animation starts now
         m_timer.reset();
         m_totalTime = 0.0;
         m_lastCameraLogTime = 0.0;
-        
-        double deltaSeconds = 0.0;
-        
-        while (!m_window->shouldClose())
-        {
-            deltaSeconds = m_timer.tick();
-            m_totalTime += deltaSeconds;
-            processInput(deltaSeconds);
-            updateSkyBlend(deltaSeconds);
-            updateCameraMotion(deltaSeconds);  // Update camera motion before other animations
-            updateAirplaneAnimation(deltaSeconds);
-            updateMissileAnimation(deltaSeconds);
-            updateFlagAnimation(deltaSeconds);
-            updateLanterns(deltaSeconds);
-            updateParticleEffects(deltaSeconds);
-            
-            // Log camera info periodically
-            if (m_totalTime - m_lastCameraLogTime >= CAMERA_LOG_INTERVAL)
+        m_frameStats = FrameStats{};
+        m_frameStats.windowStart = std::chrono::steady_clock::now();
+
+        if (m_config.enableRenderThread)
+        {
+            // The GL context moves to the render thread; this thread pumps events and simulates
+            // the next frame while the previous ones are drawn
+            m_renderThread = std::make_unique<RenderThread>(*m_window, static_cast<size_t>(std::max(1, m_config.renderQueueLength)),
+                [this](FramePacket& packet) { renderFrame(packet); },
+                [this](const FramePacket& packet, double renderMs) { recordFrameStats(packet, renderMs); });
+            // A modal move/resize keeps pollEvents() from returning; the window's notifications
+            // keep frames coming meanwhile, and the loop skips its own frame after one
+            m_window->setRefreshHandler([this]() { submitFrame(); });
+            while (!m_window->shouldClose())
             {
-                const glm::vec3 camPos = m_camera.position();
-                const float yaw = m_camera.yaw();
-                const float pitch = m_camera.pitch();
-                
-                std::ostringstream logMsg;
-                logMsg << std::fixed << std::setprecision(2) 
-                       << "Time: " << m_totalTime << "s | "
-                       << "Position: (" << std::setprecision(1) << camPos.x << ", " << camPos.y << ", " << camPos.z << ") | "
-                       << "Rotation: Yaw=" << yaw << " Pitch=" << pitch;
-                
-                log(LogLevel::Info, logMsg.str());
-                m_lastCameraLogTime = m_totalTime;
-            }
-            m_window->pollEvents();
-            glfwGetFramebufferSize(m_window->rawHandle(), &framebufferWidth, &framebufferHeight);
-
-            // Ensure viewport matches framebuffer size (handle 0 or negative sizes)
-            if (framebufferWidth > 0 && framebufferHeight > 0)
-            {
-                glViewport(0, 0, framebufferWidth, framebufferHeight);
-            }
-
-            glEnable(GL_DEPTH_TEST);
-            glDepthFunc(GL_LESS);  // Ensure depth test is using LESS (standard)
-            
-            // Disable face culling to render all faces (some models may have incorrect winding order)
-            glDisable(GL_CULL_FACE);
-            
-            // Ensure proper depth buffer precision
-            glDepthRange(0.0, 1.0);
-            
-            glClearColor(0.05f, 0.08f, 0.12f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            const float aspect = framebufferHeight > 0 ? static_cast<float>(framebufferWidth) / static_cast<float>(framebufferHeight) : 1.0f;
-            m_skybox->draw(m_camera, aspect, m_skyBlend, m_config.daySkyboxYOffset, m_config.nightSkyboxYOffset);
-            m_renderer->setEnvironmentBlend(m_skyBlend);
-            m_renderer->draw(m_camera, aspect);
-            if (m_particleSystem)
-            {
-                m_particleSystem->draw(m_camera, aspect);
+                if (!m_window->pollEvents())
+                {
+                    submitFrame();
+                }
             }
-
-            // Draw time and camera info on screen (top right corner) if enabled
-            if (m_config.showTimeDisplay)
+            m_window->setRefreshHandler(nullptr);
+            m_renderThread->stop();
+            m_renderThread.reset();
+        }
+        else
+        {
+            FramePacket packet;
+            while (!m_window->shouldClose())
             {
-                // Position text from right edge, but ensure it's visible
-                // Use a smaller offset to keep text more to the left
-                // Ensure text is always visible by using a reasonable offset
-                // Use smaller offset (150px) and ensure minimum left margin of 20px
-                const float textX = std::max(20.0f, static_cast<float>(framebufferWidth) - 150.0f); // Right side, but ensure minimum left margin
-                float textY = 30.0f; // Top margin
-                
-                // Display time
-                std::ostringstream timeStr;
-                timeStr << std::fixed << std::setprecision(2) << "Time: " << m_totalTime << "s";
-                m_textRenderer->drawText(timeStr.str(), textX, textY, m_config.timeDisplayScale, glm::vec3(1.0f, 1.0f, 0.0f)); // Yellow color
-                textY += 35.0f; // Move down for next line
-                
-                // Display camera position
-                const glm::vec3 camPos = m_camera.position();
-                std::ostringstream posStr;
-                posStr << std::fixed << std::setprecision(1) 
-                       << "Pos: (" << camPos.x << ", " << camPos.y << ", " << camPos.z << ")";
-                m_textRenderer->drawText(posStr.str(), textX, textY, m_config.timeDisplayScale, glm::vec3(0.8f, 0.8f, 1.0f)); // Light blue color
-                textY += 35.0f; // Move down for next line
-                
-                // Display camera rotation (yaw and pitch)
-                std::ostringstream rotStr;
-                rotStr << std::fixed << std::setprecision(1) 
-                       << "Rot: Yaw=" << m_camera.yaw() << " Pitch=" << m_camera.pitch();
-                m_textRenderer->drawText(rotStr.str(), textX, textY, m_config.timeDisplayScale, glm::vec3(0.8f, 1.0f, 0.8f)); // Light green color
+                m_window->pollEvents();
+                JobSystem::instance().runMainThreadJobs();
+                const double deltaSeconds = m_timer.tick();
+                glfwGetFramebufferSize(m_window->rawHandle(), &packet.framebufferWidth, &packet.framebufferHeight);
+                simulate(deltaSeconds, packet);
+                const double renderMs = measureMs([&]() { renderFrame(packet); });
+                m_window->swapBuffers();
+                recordFrameStats(packet, renderMs);
             }
-
-            m_window->swapBuffers();
         }
 
         return EXIT_SUCCESS;
     }
 
-    bool App::preloadResources()
+    void App::simulate(double deltaSeconds, FramePacket& packet)
     {
-        // Build base scene meshes (ground tiles, etc.)
-        log(LogLevel::Info, "Loading ground meshes...");
-        auto meshes = buildDemoScene(m_config.groundMeshPath, m_config.groundTilesPerSide);
+        const auto start = std::chrono::steady_clock::now();
+        m_simulationPacket = &packet;
+
+        m_totalTime += deltaSeconds;
+        processInput(deltaSeconds);
+        updateSkyBlend(deltaSeconds);
+        updateCameraMotion(deltaSeconds);  // Update camera motion before other animations
+        updateAirplaneAnimation(deltaSeconds);
+        updateMissileAnimation(deltaSeconds);
+        updateFlagAnimation(deltaSeconds);
+        updateLanterns(deltaSeconds);
+        updateParticleEffects(deltaSeconds);
 
-        // Collect all model paths that need to be loaded
-        struct ModelLoadTask
+        // Log camera info periodically
+        if (m_totalTime - m_lastCameraLogTime >= CAMERA_LOG_INTERVAL)
         {
-            std::string path;
-            std::string name;
-            bool isMeshes;  // true for loadObjAsMeshes, false for loadObjAsMesh
-        };
-        
-        std::vector<ModelLoadTask> loadTasks;
-        
-        if (!m_config.airplaneModelPath.empty())
+            const glm::vec3 camPos = m_camera.position();
+            const float yaw = m_camera.yaw();
+            const float pitch = m_camera.pitch();
+
+            std::ostringstream logMsg;
+            logMsg << std::fixed << std::setprecision(2)
+                   << "Time: " << m_totalTime << "s | "
+                   << "Position: (" << std::setprecision(1) << camPos.x << ", " << camPos.y << ", " << camPos.z << ") | "
+                   << "Rotation: Yaw=" << yaw << " Pitch=" << pitch;
+
+            log(LogLevel::Info, logMsg.str());
+            m_lastCameraLogTime = m_totalTime;
+        }
+
+        packet.camera = m_camera;
+        packet.time = m_totalTime;
+        packet.skyBlend = m_skyBlend;
+        if (m_particleSystem)
         {
-            loadTasks.push_back({m_config.airplaneModelPath, "airplane", false});
+            m_particleSystem->buildFrame(packet.particles, m_camera, packet.framebufferWidth, packet.framebufferHeight);
         }
-        
-        if (!m_config.wingmanModelPath.empty())
+        packet.particleResolutionDivisor = m_particleResolutionDivisor;
+        if (m_ribbonTrails)
         {
-            // Only load wingman once, we'll duplicate it later
-            loadTasks.push_back({m_config.wingmanModelPath, "wingman", false});
+            m_ribbonTrails->buildFrame(packet.ribbons, m_camera.position());
         }
-        
-        if (!m_config.missileModelPath.empty())
+        packet.inputTime = start;
+        packet.simulateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        m_simulationPacket = nullptr;
+    }
+
+    void App::submitFrame()
+    {
+        const double deltaSeconds = m_timer.tick();
+        std::unique_ptr<FramePacket> packet = m_renderThread->acquire();
+        glfwGetFramebufferSize(m_window->rawHandle(), &packet->framebufferWidth, &packet->framebufferHeight);
+        simulate(deltaSeconds, *packet);
+        m_renderThread->submit(std::move(packet));
+    }
+
+    void App::renderFrame(FramePacket& packet)
+    {
+        for (const auto& [name, transform] : packet.meshTransforms)
         {
-            loadTasks.push_back({m_config.missileModelPath, "missile", false});
+            m_renderer->setMeshTransformByName(name, transform);
         }
-        
-        if (m_config.enableAncientCity && !m_config.ancientCityModelPath.empty())
+        packet.meshTransforms.clear();
+        if (!packet.flagVertices.empty())
         {
-            loadTasks.push_back({m_config.ancientCityModelPath, "ancientCity", true});
+            m_renderer->updateMeshVerticesByName("flag", packet.flagVertices);
+            packet.flagVertices.clear();
         }
-        
-        if (m_config.enableLanterns && !m_config.lanternModelPath.empty())
+        if (!packet.flagControlPointVertices.empty())
         {
-            loadTasks.push_back({m_config.lanternModelPath, "kongming", false});
+            m_renderer->updateMeshVerticesByName("flag_control_points", packet.flagControlPointVertices);
+            packet.flagControlPointVertices.clear();
         }
+        m_renderer->setLanternLights(packet.lanternLights);
+
+        const int framebufferWidth = packet.framebufferWidth;
+        const int framebufferHeight = packet.framebufferHeight;
+
+        // Ensure viewport matches framebuffer size (handle 0 or negative sizes)
+        if (framebufferWidth > 0 && framebufferHeight > 0)
+        {
+            glViewport(0, 0, framebufferWidth, framebufferHeight);
+        }
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);  // Ensure depth test is using LESS (standard)
         
-        // Flagpole is now procedurally generated, no need to load model
+        // Disable face culling to render all faces (some models may have incorrect winding order)
+        glDisable(GL_CULL_FACE);
         
-        // Load all models in parallel
-        if (!loadTasks.empty())
+        // Ensure proper depth buffer precision
+        glDepthRange(0.0, 1.0);
+        
+        glClearColor(0.05f, 0.08f, 0.12f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        const Camera& camera = packet.camera;
+        const float aspect = framebufferHeight > 0 ? static_cast<float>(framebufferWidth) / static_cast<float>(framebufferHeight) : 1.0f;
+        m_skybox->draw(camera, aspect, packet.skyBlend, m_config.daySkyboxYOffset, m_config.nightSkyboxYOffset);
+        m_renderer->setEnvironmentBlend(packet.skyBlend);
+        m_renderer->draw(camera, aspect);
+        if (m_ribbonTrails)
         {
-            log(LogLevel::Info, "Starting parallel loading of " + std::to_string(loadTasks.size()) + " model files...");
-            std::chrono::high_resolution_clock::time_point loadStart = std::chrono::high_resolution_clock::now();
-            
-            // Structure to hold loaded model data
-            struct LoadedModel
-            {
-                std::string name;
-                std::optional<Mesh> singleMesh;
-                std::vector<Mesh> multipleMeshes;
-                bool isMeshes;
-                bool success;
-            };
-            
-            // Launch async tasks for each model
-            std::vector<std::future<LoadedModel>> futures;
-            for (const auto& task : loadTasks)
-            {
-                futures.push_back(std::async(std::launch::async, [task]() -> LoadedModel {
-                    LoadedModel result;
-                    result.name = task.name;
-                    result.isMeshes = task.isMeshes;
-                    result.success = false;
-                    
-                    try
-                    {
-                        if (task.isMeshes)
-                        {
-                            // Try to load from explicit path first
-                            namespace fs = std::filesystem;
-                            if (fs::exists(task.path))
-                            {
-                                result.multipleMeshes = cg::loadObjAsMeshes(task.path);
-                                result.success = !result.multipleMeshes.empty();
-                            }
-                            
-                            // If that failed, try to find any .obj file in the directory
-                            if (!result.success)
-                            {
-                                fs::path modelDir = fs::path(task.path).parent_path();
-                                if (fs::is_directory(modelDir))
-                                {
-                                    cg::log(cg::LogLevel::Warn, "Failed to load " + task.name + " from explicit path: " + task.path + ", searching directory...");
-                                    for (const auto& entry : fs::directory_iterator(modelDir))
-                                    {
-                                        if (entry.is_regular_file() && entry.path().extension() == ".obj")
-                                        {
-                                            cg::log(cg::LogLevel::Info, "Trying to load " + task.name + " from: " + entry.path().string());
-                                            result.multipleMeshes = cg::loadObjAsMeshes(entry.path().string());
-                                            if (!result.multipleMeshes.empty())
-                                            {
-                                                result.success = true;
-                                                cg::log(cg::LogLevel::Info, "Successfully loaded " + task.name + " from: " + entry.path().string());
-                                                break;
-                                            }
-                                        }
-                                    }
-                                }
-                                else
-                                {
-                                    cg::log(cg::LogLevel::Error, "Model directory does not exist: " + modelDir.string());
-                                }
-                            }
-                        }
-                        else
-                        {
-                            result.singleMesh = cg::loadObjAsMesh(task.path);
-                            result.success = result.singleMesh.has_value();
-                        }
-                    }
-                    catch (const std::exception& e)
-                    {
-                        cg::log(cg::LogLevel::Error, "Exception while loading " + task.name + ": " + e.what());
-                        result.success = false;
-                    }
-                    
-                    return result;
-                }));
-            }
-            
-            // Wait for all models to load and collect results
-            std::vector<LoadedModel> loadedModels;
-            for (auto& future : futures)
-            {
-                loadedModels.push_back(future.get());
-            }
-            
-            std::chrono::high_resolution_clock::time_point loadEnd = std::chrono::high_resolution_clock::now();
-            long long loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(loadEnd - loadStart).count();
-            log(LogLevel::Info, "Model loading completed in " + std::to_string(loadTime) + "ms");
-            
-            // Process loaded models and add to scene
-            for (auto& loaded : loadedModels)
+            m_ribbonTrails->draw(packet.ribbons, camera, aspect);
+        }
+        if (m_particleSystem)
+        {
+            m_particleTimer->begin();
+            const int divisor = packet.particleResolutionDivisor;
+            if (divisor > 1 && framebufferWidth > 0 && framebufferHeight > 0)
             {
-                if (!loaded.success)
-                {
-                    log(LogLevel::Error, "Failed to load " + loaded.name + " model");
-                    if (loaded.name == "airplane" || loaded.name == "missile")
-                    {
-                        return false;  // Critical models
-                    }
-                    continue;
-                }
-                
-                if (loaded.name == "airplane")
-                {
-                    auto airplane = *loaded.singleMesh;
-                    airplane.name = "airplane";
-                    const glm::vec3 startPos = m_config.airplaneStartPosition + glm::vec3(0.0f, m_config.airplaneHeight, 0.0f);
-                    glm::mat4 transform(1.0f);
-                    transform = glm::translate(transform, startPos);
-                    const glm::vec3 forward = glm::normalize(m_config.airplaneDirection);
-                    const float yaw = glm::degrees(atan2f(forward.z, forward.x));
-                    transform = glm::rotate(transform, glm::radians(yaw + 90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                    transform = applyScale(transform, m_config.airplaneScale);
-                    if (m_config.airplaneSpawnTime > 0.0f)
-                    {
-                        transform = applyScale(transform, glm::vec3(0.0f, 0.0f, 0.0f));
-                    }
-                    airplane.transform = transform;
-                    meshes.push_back(std::move(airplane));
-                    log(LogLevel::Info, "Airplane model processed (will spawn at " + std::to_string(m_config.airplaneSpawnTime) + "s)");
-                }
-                else if (loaded.name == "wingman")
-                {
-                    // Load once, duplicate 4 times
-                    auto baseWingman = *loaded.singleMesh;
-                    glm::mat4 baseTransform(1.0f);
-                    if (m_config.airplaneSpawnTime > 0.0f)
-                    {
-                        baseTransform = applyScale(baseTransform, glm::vec3(0.0f, 0.0f, 0.0f));
-                    }
-                    
-                    // Left side wingmen
-                    for (int i = 0; i < 2; ++i)
-                    {
-                        auto wingman = baseWingman;  // Copy mesh
-                        wingman.name = "wingman_left" + std::to_string(i + 1);
-                        wingman.transform = baseTransform;
-                        meshes.push_back(std::move(wingman));
-                    }
-                    
-                    // Right side wingmen
-                    for (int i = 0; i < 2; ++i)
-                    {
-                        auto wingman = baseWingman;  // Copy mesh
-                        wingman.name = "wingman_right" + std::to_string(i + 1);
-                        wingman.transform = baseTransform;
-                        meshes.push_back(std::move(wingman));
-                    }
-                    
-                    log(LogLevel::Info, "Wingman models processed (4 wingmen)");
-                }
-                else if (loaded.name == "missile")
-                {
-                    auto missile = *loaded.singleMesh;
-                    missile.name = "missile";
-                namespace fs = std::filesystem;
-                fs::path objDir = fs::path(m_config.missileModelPath).parent_path();
-                fs::path bodyTex = objDir / "body.bmp";
-                if (fs::exists(bodyTex))
-                {
-                        missile.diffuseTexture = bodyTex.generic_string();
-                }
-                glm::mat4 transform(1.0f);
-                transform = applyScale(transform, glm::vec3(0.0f, 0.0f, 0.0f));
-                    missile.transform = transform;
-                    meshes.push_back(std::move(missile));
-                    log(LogLevel::Info, "Missile model processed");
-                }
-                else if (loaded.name == "ancientCity")
-                {
-                    glm::mat4 transform(1.0f);
-                    transform = glm::translate(transform, m_config.ancientCityPosition);
-                    if (m_config.ancientCityRotationY != 0.0f)
-                    {
-                        transform = glm::rotate(transform, glm::radians(m_config.ancientCityRotationY), glm::vec3(0.0f, 1.0f, 0.0f));
-                    }
-                    transform = applyScale(transform, m_config.ancientCityScale);
-                    
-                    for (auto& mesh : loaded.multipleMeshes)
-                    {
-                        mesh.name = "ancientCity_" + mesh.name;
-                        mesh.transform = transform;
-                        meshes.push_back(std::move(mesh));
-                    }
-                    
-                    log(LogLevel::Info, "Ancient city model processed as " + std::to_string(loaded.multipleMeshes.size()) + 
-                        " meshes at position (" + 
-                        std::to_string(m_config.ancientCityPosition.x) + ", " + 
-                        std::to_string(m_config.ancientCityPosition.y) + ", " + 
-                        std::to_string(m_config.ancientCityPosition.z) + ")");
-                }
-                else if (loaded.name == "kongming")
-                {
-                    if (loaded.singleMesh)
-                    {
-                        m_lanternPrototype = *loaded.singleMesh;
-                        m_lanternPrototypeLoaded = true;
-                        log(LogLevel::Info, "Loaded kongming lantern prototype.");
-                    }
-                }
-                // Flagpole is now procedurally generated, no model loading needed
+                m_particleTarget->begin(framebufferWidth, framebufferHeight, divisor);
+                m_particleSystem->draw(packet.particles, camera, aspect, m_particleTarget->pointScale());
+                m_particleTarget->composite(camera.projectionMatrix(aspect));
             }
-        }
-        
-        // Generate procedural flagpole (cylinder + sphere)
-        if (m_config.enableFlagpole)
-        {
-            log(LogLevel::Info, "Generating procedural flagpole...");
-            auto flagpoleMeshes = FlagGenerator::generateFlagpole(
-                m_config.flagpoleHeight,
-                m_config.flagpoleRadius,
-                m_config.flagpoleBallRadius,
-                m_config.flagpoleSegments,
-                m_config.flagpoleColor,
-                m_config.flagpoleBallColor
-            );
-            
-            // Apply position transform to all flagpole meshes
-            glm::mat4 flagpoleTransform = glm::translate(glm::mat4(1.0f), m_config.flagpolePosition);
-            for (auto& mesh : flagpoleMeshes)
+            else
             {
-                mesh.transform = flagpoleTransform;
-                meshes.push_back(std::move(mesh));
+                m_particleSystem->draw(packet.particles, camera, aspect);
             }
-            
-            log(LogLevel::Info, "Flagpole generated: " + std::to_string(flagpoleMeshes.size()) + 
-                " meshes (pole + ball), height=" + std::to_string(m_config.flagpoleHeight) +
-                ", position (" + 
-                std::to_string(m_config.flagpolePosition.x) + ", " + 
-                std::to_string(m_config.flagpolePosition.y) + ", " + 
-                std::to_string(m_config.flagpolePosition.z) + ")");
+            m_particleTimer->end();
         }
-        
-        // Create flag mesh if enabled
-        if (m_config.enableFlag && m_config.enableFlagpole)
-        {
-            log(LogLevel::Info, "Generating Bezier flag mesh...");
-            Mesh flag = generateBezierFlag(
-                m_config.flagWidth,
-                m_config.flagHeight,
-                m_config.flagControlPointsU,
-                m_config.flagControlPointsV,
-                m_config.flagSegmentsU,
-                m_config.flagSegmentsV
-            );
+
+        // Draw time and camera info on screen (top right corner) if enabled
+        if (m_config.showTimeDisplay)
+        {
+            // Position text from right edge, but ensure it's visible
+            // Use a smaller offset to keep text more to the left
+            // Ensure text is always visible by using a reasonable offset
+            // Use smaller offset (150px) and ensure minimum left margin of 20px
+            const float textX = std::max(20.0f, static_cast<float>(framebufferWidth) - 150.0f); // Right side, but ensure minimum left margin
+            float textY = 30.0f; // Top margin
             
-            // Position flag so its top-left corner aligns with the bottom center of the ball
-            // Flag's local coordinate: top-left is (-halfWidth, halfHeight, 0)
-            // Ball's bottom center in world: (0, flagpoleHeight, 0) relative to flagpolePosition
-            float halfWidth = m_config.flagWidth * 0.5f;
-            float halfHeight = m_config.flagHeight * 0.5f;
-            glm::mat4 flagTransform(1.0f);
-            flagTransform = glm::translate(flagTransform, 
-                m_config.flagpolePosition + glm::vec3(halfWidth, m_config.flagpoleHeight - halfHeight, 0.0f));
-            flag.transform = flagTransform;
-            flag.name = "flag";
-            flag.diffuseTexture = m_config.flagTexturePath;
+            // Display time
+            std::ostringstream timeStr;
+            timeStr << std::fixed << std::setprecision(2) << "Time: " << packet.time << "s";
+            m_textRenderer->drawText(timeStr.str(), textX, textY, m_config.timeDisplayScale, glm::vec3(1.0f, 1.0f, 0.0f)); // Yellow color
+            textY += 35.0f; // Move down for next line
             
-            meshes.push_back(std::move(flag));
-            m_flagExists = true;
-            log(LogLevel::Info, "Flag mesh created and positioned at flagpole top");
+            // Display camera position
+            const glm::vec3 camPos = camera.position();
+            std::ostringstream posStr;
+            posStr << std::fixed << std::setprecision(1) 
+                   << "Pos: (" << camPos.x << ", " << camPos.y << ", " << camPos.z << ")";
+            m_textRenderer->drawText(posStr.str(), textX, textY, m_config.timeDisplayScale, glm::vec3(0.8f, 0.8f, 1.0f)); // Light blue color
+            textY += 35.0f; // Move down for next line
             
-            if (m_config.debugShowFlagControlPoints)
-            {
-                Mesh controlPointMesh = FlagGenerator::generateFlagControlPointDebugMesh(
-                    m_config.flagWidth,
-                    m_config.flagHeight,
-                    m_config.flagControlPointsU,
-                    m_config.flagControlPointsV,
-                    m_flagControlPointMarkerSize,
-                    m_flagControlPointColor
-                );
-                controlPointMesh.transform = flagTransform;
-                controlPointMesh.name = "flag_control_points";
-                meshes.push_back(std::move(controlPointMesh));
-                m_flagControlPointMeshExists = true;
-                log(LogLevel::Info, "Flag control point debug mesh enabled");
-            }
+            // Display camera rotation (yaw and pitch)
+            std::ostringstream rotStr;
+            rotStr << std::fixed << std::setprecision(1) 
+                   << "Rot: Yaw=" << camera.yaw() << " Pitch=" << camera.pitch();
+            m_textRenderer->drawText(rotStr.str(), textX, textY, m_config.timeDisplayScale, glm::vec3(0.8f, 1.0f, 0.8f)); // Light green color
+        }
+    }
+
+    void App::recordFrameStats(const FramePacket& packet, double renderMs)
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point now = Clock::now();
+        FrameStats& stats = m_frameStats;
+        ++stats.frames;
+        stats.simulateMs += packet.simulateMs;
+        stats.renderMs += renderMs;
+        stats.latencyMs += std::chrono::duration<double, std::milli>(now - packet.inputTime).count();
+        if (m_particleTimer && m_particleTimer->latestMs() >= 0.0)
+        {
+            stats.particleGpuMs += m_particleTimer->latestMs();
+            ++stats.particleGpuSamples;
+        }
+        stats.particlesVisible += packet.particles.cullStats.visible;
+        stats.particlesOutsideFrustum += packet.particles.cullStats.outsideFrustum;
+        stats.particlesBelowMinSize += packet.particles.cullStats.belowMinSize;
+
+        const double windowSeconds = std::chrono::duration<double>(now - stats.windowStart).count();
+        if (m_config.frameStatsInterval <= 0.0f || windowSeconds < m_config.frameStatsInterval)
+        {
+            return;
         }
 
-        if (m_config.enableLanterns && m_lanternPrototypeLoaded)
+        // With the render thread, frame time approaches max(simulate, render + swap) instead
+        // of their sum, and latency grows by the frames waiting in the queue
+        const double frames = static_cast<double>(stats.frames);
+        std::ostringstream message;
+        message << std::fixed << std::setprecision(2)
+                << "Frames (" << (m_renderThread ? "render thread" : "sequential") << "): "
+                << frames / windowSeconds << " fps, frame " << windowSeconds * 1000.0 / frames << "ms"
+                << " | simulate " << stats.simulateMs / frames << "ms"
+                << ", render " << stats.renderMs / frames << "ms"
+                << " | input-to-present latency " << stats.latencyMs / frames << "ms";
+        if (stats.particleGpuSamples > 0)
         {
-            const int poolSize = std::max(0, m_config.lanternPoolSize);
-            m_lanternMeshNames.reserve(poolSize);
-            // Use OBJ model as-is, no texture override
-            glm::vec3 lanternBaseColor = m_config.lanternLightColor;
-            for (int i = 0; i < poolSize; ++i)
+            // Timer results trail by a few frames, so right after a resolution change this
+            // still partly reflects the previous one
+            message << " | particles " << stats.particleGpuMs / static_cast<double>(stats.particleGpuSamples)
+                    << "ms GPU at 1/" << packet.particleResolutionDivisor << " resolution";
+        }
+        if (m_particleSystem && !m_particleSystem->gpuSimulation())
+        {
+            message << " | particles drawn " << static_cast<double>(stats.particlesVisible) / frames
+                    << ", culled " << static_cast<double>(stats.particlesOutsideFrustum) / frames << " off-screen"
+                    << " + " << static_cast<double>(stats.particlesBelowMinSize) / frames << " below min size";
+        }
+        if (m_renderThread)
+        {
+            const RenderThread::Stats queue = m_renderThread->takeStats();
+            const double submitted = static_cast<double>(std::max<size_t>(1, queue.submitted));
+            message << " | queue depth " << static_cast<double>(queue.queueDepthSum) / submitted
+                    << " (max " << queue.maxQueueDepth << ")"
+                    << ", render thread idle " << queue.renderWaitMs / frames << "ms"
+                    << ", simulation blocked " << queue.acquireWaitMs / submitted << "ms";
+        }
+        log(LogLevel::Info, message.str());
+
+        stats = FrameStats{};
+        stats.windowStart = now;
+    }
+
+    bool App::preloadResources()
+    {
+        using Clock = std::chrono::high_resolution_clock;
+        auto elapsedMs = [](Clock::time_point since) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count();
+        };
+        const Clock::time_point preloadStart = Clock::now();
+        std::string startupBreakdown;
+
+        AssetBake::setDirectory(m_config.bakedAssetDirectory, m_config.bakedAssetsOnly);
+
+        // Skybox images do not depend on any mesh work; decode them in the background
+        // while everything else loads and upload them once the renderer exists.
+        log(LogLevel::Info, "Loading skybox textures in background...");
+        m_skybox = std::make_unique<SkyboxRenderer>();
+        m_skybox->setEnvironmentFaceSize(m_config.environmentMapFaceSize);
+        m_skybox->setStorage(m_config.skyboxFormat, m_config.skyboxCubemapFaceSize, m_config.skyboxCacheDirectory);
+        m_skybox->beginLoadEquirectangularTextures(m_config.daySkyboxPath, m_config.nightSkyboxPath);
+
+        SceneManifest::Manifest manifest;
+        if (!SceneManifest::resolve(m_config, manifest))
+        {
+            return false;
+        }
+
+        // Warm start: the whole scene from the snapshot written by the last cold start
+        const uint64_t snapshotKey = m_config.sceneSnapshotPath.empty() ? 0 : sceneSnapshotKey(m_config, manifest);
+        const Clock::time_point sceneStart = Clock::now();
+        if (!m_config.sceneSnapshotPath.empty())
+        {
+            m_scene = SceneSnapshot::load(m_config.sceneSnapshotPath, snapshotKey);
+        }
+        const bool warmStart = m_scene != nullptr;
+        if (warmStart)
+        {
+            startupBreakdown += "\n  scene snapshot: " + std::to_string(elapsedMs(sceneStart)) + "ms";
+        }
+        else
+        {
+            std::vector<Mesh> meshes;
+            if (!buildSceneMeshes(manifest, meshes, startupBreakdown))
             {
-                Mesh lanternInstance = *m_lanternPrototype;
-                lanternInstance.name = "lantern_" + std::to_string(i);
-                lanternInstance.transform = applyScale(glm::mat4(1.0f), glm::vec3(0.0f));
-                // Keep original texture from OBJ if it has one, otherwise use vertex colors
-                // Set warm orange/yellow vertex colors as base for internal light effect
-                if (lanternInstance.vertices.size() > 0)
-                {
-                    for (auto& vertex : lanternInstance.vertices)
-                    {
-                        // Preserve original color but add warm tint
-                        vertex.color = glm::vec4(
-                            glm::mix(glm::vec3(vertex.color), lanternBaseColor, 0.3f),
-                            1.0f
-                        );
-                    }
-                }
-                meshes.push_back(lanternInstance);
-                m_lanternMeshNames.push_back(lanternInstance.name);
+                return false;
+            }
+            const Clock::time_point boundsStart = Clock::now();
+            m_scene = std::make_unique<Scene>(std::move(meshes));
+            startupBreakdown += "\n  scene bounds: " + std::to_string(elapsedMs(boundsStart)) + "ms";
+            if (!m_config.sceneSnapshotPath.empty())
+            {
+                const Clock::time_point snapshotStart = Clock::now();
+                SceneSnapshot::store(m_config.sceneSnapshotPath, snapshotKey, *m_scene, {"flag", "flag_control_points"});
+                startupBreakdown += "\n  scene snapshot write: " + std::to_string(elapsedMs(snapshotStart)) + "ms";
             }
-            log(LogLevel::Info, "Lantern pool created with " + std::to_string(poolSize) + " instances.");
         }
+        indexSceneMeshes();
 
-        // Create scene and renderer
-        log(LogLevel::Info, "Creating scene and renderer...");
-        m_scene = std::make_unique<Scene>(std::move(meshes));
+        // Create renderer
+        log(LogLevel::Info, "Creating renderer...");
+        const Clock::time_point rendererStart = Clock::now();
         m_renderer = std::make_unique<SceneRenderer>(*m_scene);
+        startupBreakdown += "\n  renderer (GPU upload, textures): " + std::to_string(elapsedMs(rendererStart)) + "ms";
         MaterialFeatureToggles materialToggles{};
         materialToggles.flagpoleMetal = m_config.enableFlagpoleMetalMaterial;
         materialToggles.missileMetal = m_config.enableMissileMetalMaterial;
@@ -600,18 +478,22 @@ namespace cg
             ", far=" + std::to_string(m_config.textureQualityFarDistance) + 
             ", minFactor=" + std::to_string(m_config.textureQualityMinFactor));
 
-        // Load skybox textures
-        log(LogLevel::Info, "Loading skybox textures...");
-        m_skybox = std::make_unique<SkyboxRenderer>();
-        if (!m_skybox->loadEquirectangularTextures(m_config.daySkyboxPath, m_config.nightSkyboxPath))
+        // Collect skybox textures started at the top of preload
+        const Clock::time_point skyboxStart = Clock::now();
+        if (!m_skybox->finishLoadEquirectangularTextures())
         {
             log(LogLevel::Error, "Failed to load skybox textures.");
             return false;
         }
+        startupBreakdown += "\n  skybox wait and upload: " + std::to_string(elapsedMs(skyboxStart)) + "ms";
         m_skybox->setNightBrightness(m_config.nightSkyboxBrightness);
         if (m_renderer)
         {
-            m_renderer->setEnvironmentMaps(m_skybox->dayTextureHandle(), m_skybox->nightTextureHandle());
+            const auto& dayEnvironment = m_skybox->dayEnvironment();
+            const auto& nightEnvironment = m_skybox->nightEnvironment();
+            m_renderer->setEnvironmentMaps(dayEnvironment.cubemap, nightEnvironment.cubemap, dayEnvironment.mipCount);
+            m_renderer->setEnvironmentIrradiance(dayEnvironment.irradianceSH, nightEnvironment.irradianceSH);
+            m_renderer->setEnvironmentAmbientWeight(m_config.environmentAmbientWeight);
         }
         log(LogLevel::Info, "Skybox textures loaded successfully");
 
@@ -620,16 +502,35 @@ namespace cg
         m_textRenderer = std::make_unique<TextRenderer>();
 
         // Initialize particle system
-        const bool needsParticleSystem = (m_config.enableAirplaneTrails && m_config.airplaneTrailMaxParticles > 0) ||
+        const bool particleTrails = m_config.enableAirplaneTrails && !m_config.airplaneTrailRibbons && m_config.airplaneTrailMaxParticles > 0;
+        const bool needsParticleSystem = particleTrails ||
                                          (m_config.enableMissileExplosion && m_config.missileExplosionParticleCount > 0);
         if (needsParticleSystem)
         {
-            int desiredMax = std::max(m_config.airplaneTrailMaxParticles, m_config.missileExplosionParticleCount);
+            int desiredMax = std::max(particleTrails ? m_config.airplaneTrailMaxParticles : 0, m_config.missileExplosionParticleCount);
             desiredMax = std::max(desiredMax, 200);
             const size_t maxParticles = static_cast<size_t>(desiredMax);
-            m_particleSystem = std::make_unique<ParticleSystem>(maxParticles);
+            m_particleSystem = std::make_unique<ParticleSystem>(maxParticles, m_config.gpuParticleSimulation);
+            m_particleSystem->seedRandom(m_random.nextUInt());
+            m_particleSystem->setMinPixelSize(m_config.particleMinPixelSize);
+            if (m_particleSystem->gpuSimulation() && m_config.verifyGpuParticleSimulation)
+            {
+                ParticleSystem::verifyGpuSimulation();
+            }
+            m_particleTarget = std::make_unique<OffscreenParticleTarget>();
+            m_particleTimer = std::make_unique<GpuTimer>();
             log(LogLevel::Info, "Particle system initialized with max " + std::to_string(maxParticles) + " particles");
         }
+        if (m_config.enableAirplaneTrails && m_config.airplaneTrailRibbons)
+        {
+            RibbonTrails::Settings settings;
+            settings.sampleInterval = m_config.airplaneTrailRibbonSampleInterval;
+            settings.lifetime = m_config.airplaneTrailParticleLifetime;
+            settings.startWidth = m_config.airplaneTrailRibbonStartWidth;
+            settings.endWidth = m_config.airplaneTrailRibbonEndWidth;
+            settings.acceleration = glm::vec3(0.0f, -std::abs(m_config.airplaneTrailGravity), 0.0f);
+            m_ribbonTrails = std::make_unique<RibbonTrails>(settings, m_config.airplaneTrailRainbowColors);
+        }
 
         // Normalize airplane direction
         m_normalizedAirplaneDirection = glm::normalize(m_config.airplaneDirection);
@@ -687,6 +588,48 @@ namespace cg
             }
         }
 
+        log(LogLevel::Info, std::string(warmStart ? "Warm" : "Cold") + " startup breakdown:" + startupBreakdown +
+            "\n  total preload: " + std::to_string(elapsedMs(preloadStart)) + "ms");
+        log(LogLevel::Info, "Preload memory: resident " + std::to_string(MemoryStats::currentResidentBytes() / (1024 * 1024)) +
+            "MB, peak " + std::to_string(MemoryStats::peakResidentBytes() / (1024 * 1024)) + "MB");
+        return true;
+    }
+
+    bool App::buildSceneMeshes(const SceneManifest::Manifest& manifest, std::vector<Mesh>& meshes, std::string& startupBreakdown)
+    {
+        MeshCache::Options meshCacheOptions;
+        meshCacheOptions.compression = m_config.meshCacheDraco ? MeshCache::Compression::Draco : MeshCache::Compression::None;
+        meshCacheOptions.draco.positionBits = m_config.meshCacheDracoPositionBits;
+        meshCacheOptions.draco.speed = m_config.meshCacheDracoSpeed;
+        MeshCache::configure(meshCacheOptions);
+
+        log(LogLevel::Info, "Loading " + std::to_string(manifest.assets.size()) + " scene assets for " +
+            std::to_string(manifest.nodes.size()) + " nodes...");
+        return SceneLoader::load(manifest, meshes, startupBreakdown);
+    }
+
+    void App::indexSceneMeshes()
+    {
+        // Meshes the per-frame updates address by name
+        for (const auto& mesh : m_scene->meshes())
+        {
+            m_flagExists = m_flagExists || mesh.name == "flag";
+            m_flagControlPointMeshExists = m_flagControlPointMeshExists || mesh.name == "flag_control_points";
+            if (mesh.name.rfind("lantern_", 0) == 0)
+            {
+                m_lanternMeshNames.push_back(mesh.name);
+            }
+            m_meshNames.insert(mesh.name);
+        }
+    }
+
+    bool App::setMeshTransform(const std::string& name, const glm::mat4& transform)
+    {
+        if (m_meshNames.count(name) == 0)
+        {
+            return false;
+        }
+        m_simulationPacket->meshTransforms.emplace_back(name, transform);
         return true;
     }
 
@@ -694,6 +637,12 @@ namespace cg
     {
         constexpr float rotationSensitivity = 0.08f;
 
+        for (; m_input.particleResolutionPresses > 0; --m_input.particleResolutionPresses)
+        {
+            m_particleResolutionDivisor = m_particleResolutionDivisor >= 4 ? 1 : m_particleResolutionDivisor * 2;
+            log(LogLevel::Info, "Particle resolution 1/" + std::to_string(m_particleResolutionDivisor));
+        }
+
         // Disable manual camera control when camera motion system is enabled
         if (m_config.enableCameraMotion)
         {
@@ -846,11 +795,11 @@ namespace cg
                 // Hide airplane and wingmen by scaling to zero (destroy them visually)
                 glm::mat4 destroyTransform(1.0f);
                 destroyTransform = applyScale(destroyTransform, glm::vec3(0.0f, 0.0f, 0.0f));
-                m_renderer->setMeshTransformByName("airplane", destroyTransform);
-                m_renderer->setMeshTransformByName("wingman_left1", destroyTransform);
-                m_renderer->setMeshTransformByName("wingman_left2", destroyTransform);
-                m_renderer->setMeshTransformByName("wingman_right1", destroyTransform);
-                m_renderer->setMeshTransformByName("wingman_right2", destroyTransform);
+                setMeshTransform("airplane", destroyTransform);
+                setMeshTransform("wingman_left1", destroyTransform);
+                setMeshTransform("wingman_left2", destroyTransform);
+                setMeshTransform("wingman_right1", destroyTransform);
+                setMeshTransform("wingman_right2", destroyTransform);
                 
                 // Don't restore camera to default position if camera motion is enabled
                 // Let camera motion system handle camera position
@@ -909,7 +858,7 @@ namespace cg
         transform = applyScale(transform, m_config.airplaneScale);
         
         // Update airplane transform
-        bool transformSet = m_renderer->setMeshTransformByName("airplane", transform);
+        bool transformSet = setMeshTransform("airplane", transform);
         if (!transformSet)
         {
             static bool warned = false;
@@ -933,7 +882,7 @@ namespace cg
             wingmanTransform = glm::rotate(wingmanTransform, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
             wingmanTransform = applyScale(wingmanTransform, m_config.wingmanScale);
             
-            if (!m_renderer->setMeshTransformByName(name, wingmanTransform))
+            if (!setMeshTransform(name, wingmanTransform))
             {
                 static std::unordered_map<std::string, bool> warned;
                 if (!warned[name])
@@ -1036,7 +985,7 @@ namespace cg
             // Hide missile by scaling to zero
             glm::mat4 destroyTransform(1.0f);
             destroyTransform = applyScale(destroyTransform, glm::vec3(0.0f, 0.0f, 0.0f));
-            m_renderer->setMeshTransformByName("missile", destroyTransform);
+            setMeshTransform("missile", destroyTransform);
             
             // Immediately return to keyframe 4 (original keyframe 3) and look at explosion position
             const auto& keyframe4 = m_config.cameraKeyframes[4];
@@ -1067,7 +1016,7 @@ namespace cg
         transform = applyScale(transform, m_config.missileScale);
         
         // Update missile transform
-        bool transformSet = m_renderer->setMeshTransformByName("missile", transform);
+        bool transformSet = setMeshTransform("missile", transform);
         if (!transformSet)
         {
             static bool warned = false;
@@ -1102,83 +1051,76 @@ namespace cg
 
         m_flagAnimationTime += static_cast<float>(deltaSeconds);
 
-        if (m_flagUpdatePending)
+        if (m_flagUpdateJob)
         {
-            if (m_flagUpdateFuture.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
+            // Keep showing the previous shape until the worker is done
+            if (!JobSystem::finished(m_flagUpdateJob))
             {
-                FlagUpdateResult result = m_flagUpdateFuture.get();
-                m_renderer->updateMeshVerticesByName("flag", result.vertices);
-
-                if (m_config.debugShowFlagControlPoints && m_flagControlPointMeshExists && !result.controlPoints.empty())
-                {
-                    m_flagControlPoints = result.controlPoints;
-                    FlagGenerator::updateFlagControlPointDebugVertices(
-                        m_flagControlPoints,
-                        m_flagControlPointMarkerSize,
-                        m_flagControlPointColor,
-                        m_flagControlPointDebugVertices
-                    );
-                    m_renderer->updateMeshVerticesByName("flag_control_points", m_flagControlPointDebugVertices);
-                }
-                m_flagUpdatePending = false;
+                return;
             }
-        }
+            m_simulationPacket->flagVertices = std::move(m_flagUpdateResult->vertices);
 
-        if (!m_flagUpdatePending)
-        {
-            const float targetTime = m_flagAnimationTime;
-            const bool captureControlPoints = m_config.debugShowFlagControlPoints && m_flagControlPointMeshExists;
-            const float width = m_config.flagWidth;
-            const float height = m_config.flagHeight;
-            const int controlPointsU = m_config.flagControlPointsU;
-            const int controlPointsV = m_config.flagControlPointsV;
-            const int segmentsU = m_config.flagSegmentsU;
-            const int segmentsV = m_config.flagSegmentsV;
-            const float waveAmplitude = m_config.flagWaveAmplitude;
-            const float waveFrequency = m_config.flagWaveFrequency;
-
-            m_flagUpdateFuture = std::async(std::launch::async, [=]() -> FlagUpdateResult {
-                FlagUpdateResult output;
-                std::vector<glm::vec3> tempControlPoints;
-                std::vector<Vertex> vertices = FlagGenerator::updateFlagVertices(
-                    width,
-                    height,
-                    controlPointsU,
-                    controlPointsV,
-                    segmentsU,
-                    segmentsV,
-                    targetTime,
-                    waveAmplitude,
-                    waveFrequency,
-                    captureControlPoints ? &tempControlPoints : nullptr
+            if (m_config.debugShowFlagControlPoints && m_flagControlPointMeshExists && !m_flagUpdateResult->controlPoints.empty())
+            {
+                m_flagControlPoints = std::move(m_flagUpdateResult->controlPoints);
+                FlagGenerator::updateFlagControlPointDebugVertices(
+                    m_flagControlPoints,
+                    m_flagControlPointMarkerSize,
+                    m_flagControlPointColor,
+                    m_flagControlPointDebugVertices
                 );
-                output.vertices = std::move(vertices);
-                if (captureControlPoints)
-                {
-                    output.controlPoints = std::move(tempControlPoints);
-                }
-                return output;
-            });
-
-            m_flagUpdatePending = true;
-        }
+                m_simulationPacket->flagControlPointVertices = m_flagControlPointDebugVertices;
+            }
+            m_flagUpdateJob = nullptr;
+            m_flagUpdateResult = nullptr;
+        }
+
+        const float targetTime = m_flagAnimationTime;
+        const bool captureControlPoints = m_config.debugShowFlagControlPoints && m_flagControlPointMeshExists;
+        const float width = m_config.flagWidth;
+        const float height = m_config.flagHeight;
+        const int controlPointsU = m_config.flagControlPointsU;
+        const int controlPointsV = m_config.flagControlPointsV;
+        const int segmentsU = m_config.flagSegmentsU;
+        const int segmentsV = m_config.flagSegmentsV;
+        const float waveAmplitude = m_config.flagWaveAmplitude;
+        const float waveFrequency = m_config.flagWaveFrequency;
+
+        auto result = std::make_shared<FlagUpdateResult>();
+        m_flagUpdateResult = result;
+        m_flagUpdateJob = JobSystem::instance().submit([=]() {
+            std::vector<glm::vec3> tempControlPoints;
+            result->vertices = FlagGenerator::updateFlagVertices(
+                width,
+                height,
+                controlPointsU,
+                controlPointsV,
+                segmentsU,
+                segmentsV,
+                targetTime,
+                waveAmplitude,
+                waveFrequency,
+                captureControlPoints ? &tempControlPoints : nullptr
+            );
+            if (captureControlPoints)
+            {
+                result->controlPoints = std::move(tempControlPoints);
+            }
+        });
     }
 
     void App::updateLanterns(double deltaSeconds)
     {
-        if (!m_config.enableLanterns || m_lanternInstances.empty() || !m_renderer)
+        if (!m_config.enableLanterns || m_lanternInstances.empty())
         {
-            if (m_renderer)
-            {
-                m_renderer->setLanternLights({});
-            }
+            m_simulationPacket->lanternLights.clear();
             return;
         }
 
         const float spawnStartTime = m_config.lanternSpawnStartTime;
         if (m_totalTime < static_cast<double>(spawnStartTime))
         {
-            m_renderer->setLanternLights({});
+            m_simulationPacket->lanternLights.clear();
             return;
         }
 
@@ -1192,7 +1134,7 @@ namespace cg
             int spawnCount = minCount;
             if (maxCount > minCount)
             {
-                spawnCount = randomInt(minCount, maxCount);
+                spawnCount = m_random.uniformInt(minCount, maxCount);
             }
             spawnCount = std::max(spawnCount, 0);
             int available = static_cast<int>(std::count_if(m_lanternInstances.begin(), m_lanternInstances.end(),
@@ -1204,8 +1146,8 @@ namespace cg
             }
         }
 
-        std::vector<SceneRenderer::LanternLight> lights;
-        lights.reserve(m_lanternInstances.size());
+        std::vector<SceneRenderer::LanternLight>& lights = m_simulationPacket->lanternLights;
+        lights.clear();
 
         for (auto& lantern : m_lanternInstances)
         {
@@ -1258,7 +1200,7 @@ namespace cg
             const glm::vec3 lanternScale = m_config.lanternScale;
             transform = applyScale(transform, lanternScale);
 
-            m_renderer->setMeshTransformByName(lantern.meshName, transform);
+            setMeshTransform(lantern.meshName, transform);
             lantern.position = position;
 
             SceneRenderer::LanternLight light;
@@ -1269,8 +1211,6 @@ namespace cg
             light.radius = m_config.lanternLightRadius;
             lights.push_back(light);
         }
-
-        m_renderer->setLanternLights(lights);
     }
 
     glm::vec3 App::evaluateLanternPosition(const LanternInstance& lantern, float t) const
@@ -1304,16 +1244,16 @@ namespace cg
         lantern.age = 0.0f;
         
         // Random speed for this lantern
-        lantern.speed = randomFloat(m_config.lanternMinSpeed, m_config.lanternMaxSpeed);
+        lantern.speed = m_random.uniform(m_config.lanternMinSpeed, m_config.lanternMaxSpeed);
         
         // Random lifetime
-        lantern.duration = randomFloat(m_config.lanternMinLifetime, m_config.lanternMaxLifetime);
+        lantern.duration = m_random.uniform(m_config.lanternMinLifetime, m_config.lanternMaxLifetime);
 
         // Spawn position: random horizontal position on the ground
         glm::vec3 spawnOffset(
-            randomFloat(-m_config.lanternSpawnHalfExtents.x, m_config.lanternSpawnHalfExtents.x),
+            m_random.uniform(-m_config.lanternSpawnHalfExtents.x, m_config.lanternSpawnHalfExtents.x),
             0.0f,  // No vertical offset - spawn on ground
-            randomFloat(-m_config.lanternSpawnHalfExtents.z, m_config.lanternSpawnHalfExtents.z));
+            m_random.uniform(-m_config.lanternSpawnHalfExtents.z, m_config.lanternSpawnHalfExtents.z));
         lantern.p0 = m_config.lanternSpawnCenter + spawnOffset;
         // Set initial point on the ground
         lantern.p0.y = 0.0f;
@@ -1323,7 +1263,7 @@ namespace cg
         // Height = speed * lifetime (with some variation)
         float baseHeightDiff = lantern.speed * lantern.duration;
         float heightVariation = baseHeightDiff * 0.3f;  // 30% variation
-        float heightDiff = baseHeightDiff + randomFloat(-heightVariation, heightVariation);
+        float heightDiff = baseHeightDiff + m_random.uniform(-heightVariation, heightVariation);
         
         // Clamp to target height range
         const float targetHeightMin = m_config.lanternTargetHeightMin;
@@ -1334,25 +1274,25 @@ namespace cg
         
         // End point: random horizontal offset, height based on speed
         lantern.p3 = lantern.p0 + glm::vec3(
-            randomFloat(-800.0f, 800.0f),
+            m_random.uniform(-800.0f, 800.0f),
             heightDiff,  // Height difference based on speed
-            randomFloat(-800.0f, 800.0f));
+            m_random.uniform(-800.0f, 800.0f));
 
         // First control point: ensure it's above p0 and below p3
         // Use a fraction of the height difference to ensure upward motion
-        float p1Height = lantern.p0.y + randomFloat(heightDiff * 0.3f, heightDiff * 0.7f);
+        float p1Height = lantern.p0.y + m_random.uniform(heightDiff * 0.3f, heightDiff * 0.7f);
         lantern.p1 = lantern.p0 + glm::vec3(
-            randomFloat(-600.0f, 600.0f),
+            m_random.uniform(-600.0f, 600.0f),
             p1Height - lantern.p0.y,  // Ensure p1.y is between p0.y and p3.y
-            randomFloat(-600.0f, 600.0f));
+            m_random.uniform(-600.0f, 600.0f));
 
         // Second control point: ensure it's above p0 and below p3
         // Use a fraction of the height difference to ensure upward motion
-        float p2Height = lantern.p0.y + randomFloat(heightDiff * 0.5f, heightDiff * 0.9f);
+        float p2Height = lantern.p0.y + m_random.uniform(heightDiff * 0.5f, heightDiff * 0.9f);
         lantern.p2 = lantern.p0 + glm::vec3(
-            randomFloat(-700.0f, 700.0f),
+            m_random.uniform(-700.0f, 700.0f),
             p2Height - lantern.p0.y,  // Ensure p2.y is between p0.y and p3.y
-            randomFloat(-700.0f, 700.0f));
+            m_random.uniform(-700.0f, 700.0f));
         
         // Final verification: ensure p0.y < p1.y < p2.y < p3.y (strictly upward)
         // Sort control points by height to ensure monotonic upward motion
@@ -1365,7 +1305,7 @@ namespace cg
         transform = glm::translate(transform, lantern.position);
         const glm::vec3 lanternScale2 = m_config.lanternScale;
         transform = applyScale(transform, lanternScale2);
-        m_renderer->setMeshTransformByName(lantern.meshName, transform);
+        setMeshTransform(lantern.meshName, transform);
     }
 
     void App::deactivateLantern(LanternInstance& lantern)
@@ -1379,7 +1319,7 @@ namespace cg
         lantern.duration = 0.0f;
         glm::mat4 transform(1.0f);
         transform = applyScale(transform, glm::vec3(0.0f));
-        m_renderer->setMeshTransformByName(lantern.meshName, transform);
+        setMeshTransform(lantern.meshName, transform);
     }
 
     void App::updateCameraMotion(double deltaSeconds)
@@ -1626,12 +1566,14 @@ namespace cg
 
     void App::updateParticleEffects(double deltaSeconds)
     {
-        if (!m_particleSystem)
+        if (m_particleSystem)
         {
-            return;
+            m_particleSystem->update(static_cast<float>(deltaSeconds));
+        }
+        if (m_ribbonTrails)
+        {
+            m_ribbonTrails->update(static_cast<float>(deltaSeconds));
         }
-
-        m_particleSystem->update(static_cast<float>(deltaSeconds));
 
         if (!m_config.enableAirplaneTrails || !m_airplaneActive)
         {
@@ -1651,11 +1593,20 @@ namespace cg
             right = glm::vec3(1.0f, 0.0f, 0.0f);
         }
 
-        emitTrailParticles(m_airplanePosition, forward, right, m_config.airplaneTrailRainbowColors[0], 0, deltaSeconds);
-        emitTrailParticles(m_wingmanLeft1Position, forward, right, m_config.airplaneTrailRainbowColors[1], 1, deltaSeconds);
-        emitTrailParticles(m_wingmanLeft2Position, forward, right, m_config.airplaneTrailRainbowColors[2], 2, deltaSeconds);
-        emitTrailParticles(m_wingmanRight1Position, forward, right, m_config.airplaneTrailRainbowColors[3], 3, deltaSeconds);
-        emitTrailParticles(m_wingmanRight2Position, forward, right, m_config.airplaneTrailRainbowColors[4], 4, deltaSeconds);
+        const std::array<glm::vec3, 5> emitters{
+            m_airplanePosition, m_wingmanLeft1Position, m_wingmanLeft2Position, m_wingmanRight1Position, m_wingmanRight2Position};
+        for (size_t i = 0; i < emitters.size(); ++i)
+        {
+            if (m_ribbonTrails)
+            {
+                m_ribbonTrails->record(i, emitters[i] - forward * m_config.airplaneTrailEmissionOffset,
+                                       -forward * m_config.airplaneTrailInitialSpeed);
+            }
+            else
+            {
+                emitTrailParticles(emitters[i], forward, right, m_config.airplaneTrailRainbowColors[i], i, deltaSeconds);
+            }
+        }
     }
 
     void App::emitTrailParticles(const glm::vec3& emitterPos, const glm::vec3& forward,
@@ -1674,31 +1625,31 @@ namespace cg
 
         float& accumulator = m_trailSpawnAccumulators[accumulatorIndex];
         accumulator += m_config.airplaneTrailSpawnRate * static_cast<float>(deltaSeconds);
-
-        while (accumulator >= 1.0f)
+        const float whole = std::floor(accumulator);
+        if (whole < 1.0f)
         {
-            accumulator -= 1.0f;
-
-            ParticleSystem::SpawnParams params;
-            glm::vec3 basePosition = emitterPos - forward * m_config.airplaneTrailEmissionOffset;
-            basePosition += right * randomFloat(-m_config.airplaneTrailHorizontalJitter, m_config.airplaneTrailHorizontalJitter);
-            basePosition += glm::vec3(0.0f, randomFloat(-m_config.airplaneTrailVerticalJitter, m_config.airplaneTrailVerticalJitter), 0.0f);
-            params.position = basePosition;
-
-            float speedVariation = randomFloat(-m_config.airplaneTrailSpeedVariance, m_config.airplaneTrailSpeedVariance);
-            float baseSpeed = std::max(0.0f, m_config.airplaneTrailInitialSpeed + speedVariation);
-            params.velocity = -forward * baseSpeed;
-            params.velocity += right * randomFloat(-m_config.airplaneTrailLateralDrift, m_config.airplaneTrailLateralDrift);
-            params.velocity += glm::vec3(0.0f, randomFloat(-m_config.airplaneTrailVerticalDrift, m_config.airplaneTrailVerticalDrift), 0.0f);
-
-            params.color = color;
-            params.startSize = m_config.airplaneTrailStartSize;
-            params.endSize = m_config.airplaneTrailEndSize;
-            params.lifetime = m_config.airplaneTrailParticleLifetime;
-            params.acceleration = glm::vec3(0.0f, -std::abs(m_config.airplaneTrailGravity), 0.0f);
-
-            m_particleSystem->emit(params);
+            return;
         }
+        accumulator -= whole;
+
+        const glm::vec3 up(0.0f, 1.0f, 0.0f);
+        ParticleSystem::BurstParams burst;
+        burst.count = static_cast<size_t>(whole);
+        burst.origin = emitterPos - forward * m_config.airplaneTrailEmissionOffset;
+        burst.direction = -forward;
+        burst.coneAngle = 0.0f;
+        burst.minSpeed = std::max(0.0f, m_config.airplaneTrailInitialSpeed - m_config.airplaneTrailSpeedVariance);
+        burst.maxSpeed = std::max(0.0f, m_config.airplaneTrailInitialSpeed + m_config.airplaneTrailSpeedVariance);
+        burst.positionJitter[0] = right * m_config.airplaneTrailHorizontalJitter;
+        burst.positionJitter[1] = up * m_config.airplaneTrailVerticalJitter;
+        burst.velocityJitter[0] = right * m_config.airplaneTrailLateralDrift;
+        burst.velocityJitter[1] = up * m_config.airplaneTrailVerticalDrift;
+        burst.acceleration = glm::vec3(0.0f, -std::abs(m_config.airplaneTrailGravity), 0.0f);
+        burst.minLifetime = burst.maxLifetime = m_config.airplaneTrailParticleLifetime;
+        burst.minStartSize = burst.maxStartSize = m_config.airplaneTrailStartSize;
+        burst.minEndSize = burst.maxEndSize = m_config.airplaneTrailEndSize;
+        burst.palette = std::span<const glm::vec4>(&color, 1);
+        m_particleSystem->emitBurst(burst);
     }
 
     void App::triggerMissileExplosion(const glm::vec3& position)
@@ -1708,32 +1659,22 @@ namespace cg
             return;
         }
 
-        const auto& palette = m_config.missileExplosionColors;
-        const int paletteSize = static_cast<int>(palette.size());
-        const float gravity = std::abs(m_config.missileExplosionGravity);
-
-        for (int i = 0; i < m_config.missileExplosionParticleCount; ++i)
-        {
-            const glm::vec3 dir = randomUnitVector();
-            const float speed = randomFloat(m_config.missileExplosionMinSpeed, m_config.missileExplosionMaxSpeed);
-            const float lifetime = randomFloat(m_config.missileExplosionMinLifetime, m_config.missileExplosionMaxLifetime);
-            const float startSize = randomFloat(m_config.missileExplosionStartSize * 0.8f, m_config.missileExplosionStartSize * 1.2f);
-            const float endSize = randomFloat(m_config.missileExplosionEndSize * 0.6f, m_config.missileExplosionEndSize * 1.2f);
-
-            ParticleSystem::SpawnParams params;
-            params.position = position + dir * randomFloat(0.0f, 120.0f);
-            params.velocity = dir * speed;
-            params.acceleration = glm::vec3(0.0f, -gravity, 0.0f);
-            params.lifetime = lifetime;
-            params.startSize = startSize;
-            params.endSize = endSize;
-
-            glm::vec4 color = palette[paletteSize > 0 ? i % paletteSize : 0];
-            glm::vec3 brightened = glm::mix(glm::vec3(color), glm::vec3(1.0f), randomFloat(0.0f, 0.25f));
-            params.color = glm::vec4(brightened, color.a);
-
-            m_particleSystem->emit(params);
-        }
+        ParticleSystem::BurstParams burst;
+        burst.count = static_cast<size_t>(m_config.missileExplosionParticleCount);
+        burst.origin = position;
+        burst.minSpeed = m_config.missileExplosionMinSpeed;
+        burst.maxSpeed = m_config.missileExplosionMaxSpeed;
+        burst.maxOffset = 120.0f;
+        burst.acceleration = glm::vec3(0.0f, -std::abs(m_config.missileExplosionGravity), 0.0f);
+        burst.minLifetime = m_config.missileExplosionMinLifetime;
+        burst.maxLifetime = m_config.missileExplosionMaxLifetime;
+        burst.minStartSize = m_config.missileExplosionStartSize * 0.8f;
+        burst.maxStartSize = m_config.missileExplosionStartSize * 1.2f;
+        burst.minEndSize = m_config.missileExplosionEndSize * 0.6f;
+        burst.maxEndSize = m_config.missileExplosionEndSize * 1.2f;
+        burst.palette = m_config.missileExplosionColors;
+        burst.maxBrighten = 0.25f;
+        m_particleSystem->emitBurst(burst);
     }
 } // namespace cg
 
@@ -0,0 +1,399 @@
+#include "loader/AssetBake.h"
+
+#include "util/FileSystem.h"
+#include "util/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+namespace cg
+{
+    namespace AssetBake
+    {
+        namespace
+        {
+            namespace fs = std::filesystem;
+
+            constexpr uint64_t kMurmurMultiplier = 0xc6a4a7935bd1e995ull;
+            constexpr int kMurmurShift = 47;
+            constexpr const char* kIndexFile = "index.txt";
+            constexpr const char* kIndexHeader = "cgbake 2";
+
+            std::string entryKey(const std::string& source, const std::string& variant)
+            {
+                return variant + '|' + source;
+            }
+
+            std::mutex g_runtimeMutex;
+            std::unique_ptr<Index> g_runtimeIndex;
+            bool g_bakedOnly = false;
+        } // namespace
+
+        void Hasher::mix(uint64_t word)
+        {
+            word *= kMurmurMultiplier;
+            word ^= word >> kMurmurShift;
+            word *= kMurmurMultiplier;
+            m_state ^= word;
+            m_state *= kMurmurMultiplier;
+        }
+
+        void Hasher::update(const void* data, size_t size)
+        {
+            const auto* bytes = static_cast<const unsigned char*>(data);
+            m_length += size;
+
+            // Finish a word left partial by the previous call, so the result does not depend
+            // on how the input was split up
+            while (m_pendingBytes > 0 && size > 0)
+            {
+                m_pending |= static_cast<uint64_t>(*bytes++) << (8 * m_pendingBytes++);
+                --size;
+                if (m_pendingBytes == 8)
+                {
+                    mix(m_pending);
+                    m_pending = 0;
+                    m_pendingBytes = 0;
+                }
+            }
+            for (; size >= 8; size -= 8, bytes += 8)
+            {
+                uint64_t word = 0;
+                std::memcpy(&word, bytes, sizeof(word));
+                mix(word);
+            }
+            for (; size > 0; --size)
+            {
+                m_pending |= static_cast<uint64_t>(*bytes++) << (8 * m_pendingBytes++);
+            }
+        }
+
+        void Hasher::update(const std::string& text)
+        {
+            // Length first, so ("ab", "c") and ("a", "bc") hash differently
+            const uint64_t length = text.size();
+            update(&length, sizeof(length));
+            update(text.data(), text.size());
+        }
+
+        bool Hasher::updateFile(const std::string& path)
+        {
+            MappedFile file;
+            if (!file.open(path))
+            {
+                return false;
+            }
+            const uint64_t size = file.size();
+            update(&size, sizeof(size));
+            update(file.data(), file.size());
+            return true;
+        }
+
+        uint64_t Hasher::digest() const
+        {
+            uint64_t state = m_state ^ (m_length * kMurmurMultiplier);
+            if (m_pendingBytes > 0)
+            {
+                state ^= m_pending;
+                state *= kMurmurMultiplier;
+            }
+            state ^= state >> kMurmurShift;
+            state *= kMurmurMultiplier;
+            state ^= state >> kMurmurShift;
+            return state;
+        }
+
+        std::string keyString(uint64_t key)
+        {
+            static const char digits[] = "0123456789abcdef";
+            std::string text(16, '0');
+            for (int i = 15; i >= 0; --i, key >>= 4)
+            {
+                text[static_cast<size_t>(i)] = digits[key & 0xf];
+            }
+            return text;
+        }
+
+        std::string normalizePath(const std::string& path)
+        {
+            return fs::path(path).lexically_normal().generic_string();
+        }
+
+        bool sourceStamp(const std::string& path, uint64_t& size, int64_t& time)
+        {
+            std::error_code ec;
+            const auto fileSize = fs::file_size(path, ec);
+            if (ec) return false;
+            const auto writeTime = fs::last_write_time(path, ec);
+            if (ec) return false;
+            size = static_cast<uint64_t>(fileSize);
+            time = static_cast<int64_t>(writeTime.time_since_epoch().count());
+            return true;
+        }
+
+        Dependency dependencyStamp(const std::string& path)
+        {
+            Dependency dependency;
+            dependency.path = path;
+            if (!sourceStamp(path, dependency.size, dependency.time))
+            {
+                dependency.size = kMissingSize;
+                dependency.time = 0;
+            }
+            return dependency;
+        }
+
+        Index::Index(std::string directory)
+            : m_directory(std::move(directory))
+        {
+        }
+
+        // One entry per line: variant, source size, source time, artifact and source path,
+        // tab separated with the path last. Each is followed by one line per dependency that
+        // starts with a tab: size, time and path.
+        bool Index::load()
+        {
+            std::ifstream file(fs::path(m_directory) / kIndexFile);
+            std::string line;
+            if (!file || !std::getline(file, line) || line != kIndexHeader)
+            {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Entry* last = nullptr;
+            while (std::getline(file, line))
+            {
+                std::istringstream fields(line);
+                if (!line.empty() && line[0] == '\t')
+                {
+                    Dependency dependency;
+                    std::string size;
+                    std::string time;
+                    fields.ignore(1);
+                    if (!last || !std::getline(fields, size, '\t') || !std::getline(fields, time, '\t') ||
+                        !std::getline(fields, dependency.path))
+                    {
+                        continue;
+                    }
+                    try
+                    {
+                        dependency.size = std::stoull(size);
+                        dependency.time = std::stoll(time);
+                    }
+                    catch (const std::exception&)
+                    {
+                        // Unreadable stamps never match, so the entry is treated as stale
+                        dependency.size = kMissingSize - 1;
+                    }
+                    last->dependencies.push_back(std::move(dependency));
+                    continue;
+                }
+                last = nullptr;
+                Entry entry;
+                std::string size;
+                std::string time;
+                if (!std::getline(fields, entry.variant, '\t') || !std::getline(fields, size, '\t') ||
+                    !std::getline(fields, time, '\t') || !std::getline(fields, entry.artifact, '\t') ||
+                    !std::getline(fields, entry.source))
+                {
+                    continue;
+                }
+                try
+                {
+                    entry.sourceSize = std::stoull(size);
+                    entry.sourceTime = std::stoll(time);
+                }
+                catch (const std::exception&)
+                {
+                    continue;
+                }
+                Entry& stored = m_entries[entryKey(entry.source, entry.variant)];
+                stored = std::move(entry);
+                last = &stored;
+            }
+            return true;
+        }
+
+        bool Index::save() const
+        {
+            std::vector<const Entry*> sorted;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (const auto& [key, entry] : m_entries)
+                {
+                    sorted.push_back(&entry);
+                }
+            }
+            // Stable order keeps the file diffable between bakes
+            std::sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) {
+                return a->source != b->source ? a->source < b->source : a->variant < b->variant;
+            });
+
+            std::error_code ec;
+            fs::create_directories(m_directory, ec);
+            const fs::path path = fs::path(m_directory) / kIndexFile;
+            const fs::path tempPath = fs::path(path).concat(".tmp");
+            {
+                std::ofstream file(tempPath, std::ios::trunc);
+                file << kIndexHeader << '\n';
+                for (const Entry* entry : sorted)
+                {
+                    file << entry->variant << '\t' << entry->sourceSize << '\t' << entry->sourceTime << '\t'
+                         << entry->artifact << '\t' << entry->source << '\n';
+                    for (const Dependency& dependency : entry->dependencies)
+                    {
+                        file << '\t' << dependency.size << '\t' << dependency.time << '\t' << dependency.path << '\n';
+                    }
+                }
+                if (!file)
+                {
+                    log(LogLevel::Warn, "Failed to write bake index: " + path.string());
+                    return false;
+                }
+            }
+            fs::rename(tempPath, path, ec);
+            if (ec)
+            {
+                log(LogLevel::Warn, "Failed to write bake index: " + path.string() + " (" + ec.message() + ")");
+                return false;
+            }
+            return true;
+        }
+
+        void Index::set(Entry entry)
+        {
+            entry.source = normalizePath(entry.source);
+            std::string key = entryKey(entry.source, entry.variant);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries[std::move(key)] = std::move(entry);
+        }
+
+        std::optional<Entry> Index::find(const std::string& source, const std::string& variant) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto it = m_entries.find(entryKey(normalizePath(source), variant));
+            if (it == m_entries.end())
+            {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+
+        std::vector<std::string> Index::artifacts(const std::string& source) const
+        {
+            const std::string normalized = normalizePath(source);
+            std::vector<const Entry*> entries;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& [key, entry] : m_entries)
+            {
+                if (entry.source == normalized)
+                {
+                    entries.push_back(&entry);
+                }
+            }
+            std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) { return a->variant < b->variant; });
+            std::vector<std::string> names;
+            names.reserve(entries.size());
+            for (const Entry* entry : entries)
+            {
+                names.push_back(entry->artifact);
+            }
+            return names;
+        }
+
+        std::string Index::artifactPath(const std::string& artifact) const
+        {
+            return (fs::path(m_directory) / artifact).string();
+        }
+
+        void setDirectory(const std::string& directory, bool bakedOnly)
+        {
+            std::lock_guard<std::mutex> lock(g_runtimeMutex);
+            g_runtimeIndex.reset();
+            g_bakedOnly = bakedOnly;
+            if (directory.empty())
+            {
+                return;
+            }
+            g_runtimeIndex = std::make_unique<Index>(directory);
+            if (!g_runtimeIndex->load())
+            {
+                // No bake yet; every lookup falls back to runtime conditioning
+                g_runtimeIndex.reset();
+                return;
+            }
+            log(LogLevel::Info, "Using baked assets from " + directory + (bakedOnly ? " (baked-only)" : ""));
+        }
+
+        std::optional<std::string> find(const std::string& sourcePath, const std::string& variant)
+        {
+            std::optional<Entry> entry;
+            std::string path;
+            bool bakedOnly = false;
+            {
+                std::lock_guard<std::mutex> lock(g_runtimeMutex);
+                if (!g_runtimeIndex)
+                {
+                    return std::nullopt;
+                }
+                entry = g_runtimeIndex->find(sourcePath, variant);
+                if (!entry)
+                {
+                    return std::nullopt;
+                }
+                path = g_runtimeIndex->artifactPath(entry->artifact);
+                bakedOnly = g_bakedOnly;
+            }
+
+            uint64_t size = 0;
+            int64_t time = 0;
+            if (!sourceStamp(sourcePath, size, time))
+            {
+                // Nothing to check the artifact against; only a baked-only install may use it
+                if (!bakedOnly)
+                {
+                    return std::nullopt;
+                }
+            }
+            else
+            {
+                if (size != entry->sourceSize || time != entry->sourceTime)
+                {
+                    log(LogLevel::Info, "Baked asset is out of date, ignoring: " + sourcePath + " (" + variant + ")");
+                    return std::nullopt;
+                }
+                for (const Dependency& recorded : entry->dependencies)
+                {
+                    const Dependency current = dependencyStamp(recorded.path);
+                    if (current.size != recorded.size || current.time != recorded.time)
+                    {
+                        log(LogLevel::Info, "Baked asset is out of date (" + recorded.path + " changed), ignoring: " +
+                            sourcePath + " (" + variant + ")");
+                        return std::nullopt;
+                    }
+                }
+            }
+            std::error_code ec;
+            if (!fs::exists(path, ec))
+            {
+                return std::nullopt;
+            }
+            return path;
+        }
+
+        std::vector<std::string> artifacts(const std::string& sourcePath)
+        {
+            std::lock_guard<std::mutex> lock(g_runtimeMutex);
+            if (!g_runtimeIndex)
+            {
+                return {};
+            }
+            return g_runtimeIndex->artifacts(sourcePath);
+        }
+    }
+} // namespace cg
@@ -0,0 +1,267 @@
+#include "loader/BakedTexture.h"
+
+#include "util/Log.h"
+#include "util/PixelConvert.h"
+
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace cg
+{
+    namespace BakedTexture
+    {
+        namespace
+        {
+            namespace fs = std::filesystem;
+
+            constexpr char kMagic[4] = {'C', 'G', 'T', 'X'};
+            constexpr uint32_t kVersion = 1;
+            constexpr uint64_t kAlignment = 16;
+
+            // Layout: header, level records, then every level's data on a kAlignment boundary
+            struct FileHeader
+            {
+                char magic[4]{};
+                uint32_t version{0};
+                uint32_t format{0};
+                uint32_t levelCount{0};
+                uint64_t fileSize{0};
+            };
+
+            struct LevelRecord
+            {
+                int32_t width{0};
+                int32_t height{0};
+                uint64_t offset{0};
+                uint64_t size{0};
+            };
+
+            uint64_t alignUp(uint64_t value)
+            {
+                return (value + kAlignment - 1) / kAlignment * kAlignment;
+            }
+
+            const std::array<float, 256>& srgbToLinearTable()
+            {
+                static const std::array<float, 256> table = [] {
+                    std::array<float, 256> values{};
+                    for (int i = 0; i < 256; ++i)
+                    {
+                        const float c = static_cast<float>(i) / 255.0f;
+                        values[static_cast<size_t>(i)] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                    }
+                    return values;
+                }();
+                return table;
+            }
+
+            uint8_t linearToSrgb(float value)
+            {
+                const float c = std::clamp(value, 0.0f, 1.0f);
+                const float encoded = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+                return static_cast<uint8_t>(std::lround(encoded * 255.0f));
+            }
+
+            // 2x2 box filter in linear space (alpha as is); odd edges reuse the last row/column
+            std::vector<uint8_t> downsample(const std::vector<uint8_t>& src, int width, int height, int nextWidth, int nextHeight)
+            {
+                const auto& toLinear = srgbToLinearTable();
+                std::vector<uint8_t> dst(static_cast<size_t>(nextWidth) * nextHeight * 4);
+                for (int y = 0; y < nextHeight; ++y)
+                {
+                    const int y0 = std::min(y * 2, height - 1);
+                    const int y1 = std::min(y * 2 + 1, height - 1);
+                    for (int x = 0; x < nextWidth; ++x)
+                    {
+                        const int x0 = std::min(x * 2, width - 1);
+                        const int x1 = std::min(x * 2 + 1, width - 1);
+                        const uint8_t* texels[4] = {
+                            &src[(static_cast<size_t>(y0) * width + x0) * 4],
+                            &src[(static_cast<size_t>(y0) * width + x1) * 4],
+                            &src[(static_cast<size_t>(y1) * width + x0) * 4],
+                            &src[(static_cast<size_t>(y1) * width + x1) * 4]
+                        };
+                        uint8_t* out = &dst[(static_cast<size_t>(y) * nextWidth + x) * 4];
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            float sum = 0.0f;
+                            for (const uint8_t* texel : texels) sum += toLinear[texel[c]];
+                            out[c] = linearToSrgb(sum * 0.25f);
+                        }
+                        int alpha = 0;
+                        for (const uint8_t* texel : texels) alpha += texel[3];
+                        out[3] = static_cast<uint8_t>((alpha + 2) / 4);
+                    }
+                }
+                return dst;
+            }
+
+            std::vector<uint8_t> encodeLevel(Format format, const std::vector<uint8_t>& rgba, int width, int height)
+            {
+                switch (format)
+                {
+                case Format::Bc1:
+                {
+                    std::vector<uint8_t> blocks(PixelConvert::bc1Size(width, height));
+                    PixelConvert::encodeBc1(rgba.data(), width, height, blocks.data());
+                    return blocks;
+                }
+                case Format::Bc3:
+                {
+                    std::vector<uint8_t> blocks(PixelConvert::bc3Size(width, height));
+                    PixelConvert::encodeBc3(rgba.data(), width, height, blocks.data());
+                    return blocks;
+                }
+                default:
+                    return rgba;
+                }
+            }
+        } // namespace
+
+        const char* formatName(Format format)
+        {
+            switch (format)
+            {
+            case Format::Bc1: return "BC1";
+            case Format::Bc3: return "BC3";
+            default: return "RGBA8";
+            }
+        }
+
+        bool open(const std::string& path, Texture& texture)
+        {
+            texture = Texture{};
+            if (!texture.file.open(path) || texture.file.size() < sizeof(FileHeader))
+            {
+                return false;
+            }
+
+            FileHeader header;
+            std::memcpy(&header, texture.file.data(), sizeof(header));
+            const uint64_t recordsEnd = sizeof(FileHeader) + static_cast<uint64_t>(header.levelCount) * sizeof(LevelRecord);
+            if (std::memcmp(header.magic, kMagic, sizeof(header.magic)) != 0 || header.version != kVersion ||
+                header.format > static_cast<uint32_t>(Format::Bc3) || header.fileSize != texture.file.size() ||
+                header.levelCount == 0 || recordsEnd > texture.file.size())
+            {
+                log(LogLevel::Warn, "Baked texture is corrupt: " + path);
+                return false;
+            }
+
+            texture.format = static_cast<Format>(header.format);
+            texture.levels.resize(header.levelCount);
+            for (uint32_t i = 0; i < header.levelCount; ++i)
+            {
+                LevelRecord record;
+                std::memcpy(&record, texture.file.data() + sizeof(FileHeader) + i * sizeof(LevelRecord), sizeof(record));
+                if (record.width <= 0 || record.height <= 0 || record.offset + record.size > texture.file.size())
+                {
+                    log(LogLevel::Warn, "Baked texture is corrupt: " + path);
+                    return false;
+                }
+                texture.levels[i] = {record.width, record.height, texture.file.bytes() + record.offset, static_cast<size_t>(record.size)};
+            }
+            return true;
+        }
+
+        bool bake(const std::string& sourcePath, bool compress, const std::string& outputPath)
+        {
+            int width = 0;
+            int height = 0;
+            int channels = 0;
+            MappedFile source;
+            stbi_uc* pixels = source.open(sourcePath) ? stbi_load_from_memory(source.bytes(), static_cast<int>(source.size()), &width, &height, &channels, 4) : nullptr;
+            source.close();
+            if (!pixels)
+            {
+                log(LogLevel::Warn, "Failed to load texture: " + sourcePath);
+                return false;
+            }
+            std::vector<uint8_t> level(pixels, pixels + static_cast<size_t>(width) * height * 4);
+            stbi_image_free(pixels);
+
+            Format format = Format::Rgba8;
+            if (compress)
+            {
+                bool opaque = true;
+                for (size_t i = 3; i < level.size() && opaque; i += 4)
+                {
+                    opaque = level[i] == 255;
+                }
+                format = opaque ? Format::Bc1 : Format::Bc3;
+            }
+
+            // Same chain glGenerateMipmap would build: halve (rounding down) until 1x1
+            std::vector<LevelRecord> records;
+            std::vector<std::vector<uint8_t>> levelData;
+            for (;;)
+            {
+                LevelRecord record;
+                record.width = width;
+                record.height = height;
+                levelData.push_back(encodeLevel(format, level, width, height));
+                record.size = levelData.back().size();
+                records.push_back(record);
+                if (width == 1 && height == 1)
+                {
+                    break;
+                }
+                const int nextWidth = std::max(1, width / 2);
+                const int nextHeight = std::max(1, height / 2);
+                level = downsample(level, width, height, nextWidth, nextHeight);
+                width = nextWidth;
+                height = nextHeight;
+            }
+
+            FileHeader header;
+            std::memcpy(header.magic, kMagic, sizeof(header.magic));
+            header.version = kVersion;
+            header.format = static_cast<uint32_t>(format);
+            header.levelCount = static_cast<uint32_t>(records.size());
+            uint64_t offset = sizeof(FileHeader) + records.size() * sizeof(LevelRecord);
+            for (auto& record : records)
+            {
+                record.offset = alignUp(offset);
+                offset = record.offset + record.size;
+            }
+            header.fileSize = offset;
+
+            const std::string tempPath = outputPath + ".tmp";
+            std::error_code ec;
+            bool written = false;
+            {
+                static const char zeros[kAlignment]{};
+                std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(LevelRecord)));
+                offset = sizeof(FileHeader) + records.size() * sizeof(LevelRecord);
+                for (size_t i = 0; i < records.size(); ++i)
+                {
+                    file.write(zeros, static_cast<std::streamsize>(records[i].offset - offset));
+                    file.write(reinterpret_cast<const char*>(levelData[i].data()), static_cast<std::streamsize>(levelData[i].size()));
+                    offset = records[i].offset + records[i].size;
+                }
+                written = file.good();
+            }
+            if (!written)
+            {
+                log(LogLevel::Warn, "Failed to write baked texture: " + outputPath);
+                fs::remove(tempPath, ec);
+                return false;
+            }
+            fs::rename(tempPath, outputPath, ec);
+            if (ec)
+            {
+                log(LogLevel::Warn, "Failed to write baked texture: " + outputPath + " (" + ec.message() + ")");
+                fs::remove(tempPath, ec);
+                return false;
+            }
+            return true;
+        }
+    }
+} // namespace cg
@@ -45,7 +45,7 @@ namespace cg
 
     glm::mat4 Camera::projectionMatrix(float aspect) const
     {
-        return glm::perspective(glm::radians(m_fov), aspect, 0.1f, 30000.0f);
+        return glm::perspective(glm::radians(m_fov), aspect, m_nearPlane, m_farPlane);
     }
 
     void Camera::setFOV(float fov)
@@ -58,6 +58,16 @@ namespace cg
         return m_fov;
     }
 
+    float Camera::nearPlane() const
+    {
+        return m_nearPlane;
+    }
+
+    float Camera::farPlane() const
+    {
+        return m_farPlane;
+    }
+
     glm::vec3 Camera::position() const
     {
         return m_position;
@@ -0,0 +1,184 @@
+#include "util/DirectoryIndex.h"
+
+#include "util/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace cg
+{
+    namespace DirectoryIndex
+    {
+        namespace
+        {
+            namespace fs = std::filesystem;
+
+            // Bounds for a base directory that turns out to be a huge tree (e.g. a drive root)
+            constexpr int kMaxDepth = 16;
+            constexpr size_t kMaxVisited = 200000;
+
+            struct Entry
+            {
+                std::string lowerName;
+                std::string path;
+                int depth{0};
+            };
+
+            struct Index
+            {
+                std::once_flag built;
+                std::vector<Entry> entries;  // Sorted shallowest first
+                std::unordered_map<std::string, size_t> byName;  // Lowercase filename -> first (shallowest) entry
+                std::mutex partialMutex;
+                std::unordered_map<std::string, std::optional<std::string>> partialMatches;
+            };
+
+            std::mutex g_indicesMutex;
+            std::unordered_map<std::string, std::unique_ptr<Index>> g_indices;
+
+            std::atomic<size_t> g_directoriesIndexed{0};
+            std::atomic<size_t> g_filesIndexed{0};
+            std::atomic<size_t> g_exactHits{0};
+            std::atomic<size_t> g_partialHits{0};
+            std::atomic<size_t> g_misses{0};
+
+            std::string toLower(std::string str)
+            {
+                std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                return str;
+            }
+
+            void buildIndex(Index& index, const fs::path& root)
+            {
+                const auto start = std::chrono::high_resolution_clock::now();
+                std::error_code ec;
+                // Directory symlinks are not followed (no follow_directory_symlink), so links cannot loop
+                fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
+                size_t visited = 0;
+                bool depthCapped = false;
+                for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+                {
+                    if (++visited > kMaxVisited)
+                    {
+                        log(LogLevel::Warn, "Stopped indexing " + root.generic_string() + " after " + std::to_string(kMaxVisited) +
+                            " entries; files further in will not be found");
+                        break;
+                    }
+                    // A bad entry (e.g. a dangling link) must not end the walk
+                    std::error_code entryError;
+                    if (it->is_regular_file(entryError))
+                    {
+                        index.entries.push_back({toLower(it->path().filename().string()), it->path().generic_string(), it.depth()});
+                    }
+                    else if (it.depth() >= kMaxDepth && it->is_directory(entryError))
+                    {
+                        it.disable_recursion_pending();
+                        depthCapped = true;
+                    }
+                }
+                if (depthCapped)
+                {
+                    log(LogLevel::Warn, "Skipped directories more than " + std::to_string(kMaxDepth) + " levels below " +
+                        root.generic_string());
+                }
+
+                std::stable_sort(index.entries.begin(), index.entries.end(), [](const Entry& a, const Entry& b) {
+                    return a.depth != b.depth ? a.depth < b.depth : a.path < b.path;
+                });
+                for (size_t i = 0; i < index.entries.size(); ++i)
+                {
+                    index.byName.emplace(index.entries[i].lowerName, i);
+                }
+
+                g_directoriesIndexed.fetch_add(1);
+                g_filesIndexed.fetch_add(index.entries.size());
+                const auto end = std::chrono::high_resolution_clock::now();
+                const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+                log(LogLevel::Info, "Indexed " + std::to_string(index.entries.size()) + " files under " + root.generic_string() +
+                    " time: " + std::to_string(duration.count()) + "ms");
+            }
+
+            Index& indexFor(const std::string& baseDir)
+            {
+                std::error_code ec;
+                fs::path root = fs::absolute(fs::path(baseDir), ec).lexically_normal();
+                if (ec)
+                {
+                    root = fs::path(baseDir).lexically_normal();
+                }
+
+                Index* index = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(g_indicesMutex);
+                    auto& slot = g_indices[root.generic_string()];
+                    if (!slot)
+                    {
+                        slot = std::make_unique<Index>();
+                    }
+                    index = slot.get();
+                }
+                // Other directories can be looked up while this one is being scanned
+                std::call_once(index->built, [&]() { buildIndex(*index, root); });
+                return *index;
+            }
+        } // namespace
+
+        std::optional<std::string> findFile(const std::string& baseDir, const std::string& fileName, bool allowPartialMatch)
+        {
+            if (baseDir.empty() || fileName.empty())
+            {
+                return std::nullopt;
+            }
+
+            Index& index = indexFor(baseDir);
+            const std::string key = toLower(fs::path(fileName).filename().string());
+
+            if (auto it = index.byName.find(key); it != index.byName.end())
+            {
+                g_exactHits.fetch_add(1);
+                return index.entries[it->second].path;
+            }
+
+            if (allowPartialMatch && !key.empty())
+            {
+                std::lock_guard<std::mutex> lock(index.partialMutex);
+                auto cached = index.partialMatches.find(key);
+                if (cached == index.partialMatches.end())
+                {
+                    std::optional<std::string> match;
+                    for (const auto& entry : index.entries)
+                    {
+                        if (entry.lowerName.find(key) != std::string::npos)
+                        {
+                            match = entry.path;
+                            break;
+                        }
+                    }
+                    cached = index.partialMatches.emplace(key, std::move(match)).first;
+                }
+                if (cached->second)
+                {
+                    g_partialHits.fetch_add(1);
+                    return cached->second;
+                }
+            }
+
+            g_misses.fetch_add(1);
+            return std::nullopt;
+        }
+
+        void logStatistics()
+        {
+            log(LogLevel::Info, "Texture directory index: " + std::to_string(g_directoriesIndexed.load()) + " directories, " +
+                std::to_string(g_filesIndexed.load()) + " files, " + std::to_string(g_exactHits.load()) + " exact hits, " +
+                std::to_string(g_partialHits.load()) + " partial hits, " + std::to_string(g_misses.load()) + " misses");
+        }
+    }
+} // namespace cg
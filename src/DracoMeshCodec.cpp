@@ -0,0 +1,166 @@
+#include "loader/DracoMeshCodec.h"
+
+#include "util/Log.h"
+
+#ifdef CG_HAS_DRACO
+#include <draco/compression/decode.h>
+#include <draco/compression/encode.h>
+#include <draco/mesh/mesh.h>
+#endif
+
+#include <string>
+
+namespace cg
+{
+    namespace DracoMeshCodec
+    {
+#ifdef CG_HAS_DRACO
+        namespace
+        {
+            int addAttribute(draco::Mesh& mesh, draco::GeometryAttribute::Type type, int components, size_t count)
+            {
+                draco::GeometryAttribute attribute;
+                attribute.Init(type, nullptr, static_cast<uint8_t>(components), draco::DT_FLOAT32, false,
+                               static_cast<int64_t>(sizeof(float) * components), 0);
+                return mesh.AddAttribute(attribute, true, static_cast<draco::AttributeValueIndex::ValueType>(count));
+            }
+
+            bool readAttribute(const draco::PointAttribute* attribute, const draco::PointIndex& point, int components, float* out)
+            {
+                return attribute && attribute->ConvertValue<float>(attribute->mapped_index(point), static_cast<int8_t>(components), out);
+            }
+        } // namespace
+
+        bool available()
+        {
+            return true;
+        }
+
+        bool encode(const Mesh& mesh, const Options& options, std::vector<char>& output)
+        {
+            if (mesh.vertices.empty() || mesh.indices.size() < 3 || mesh.indices.size() % 3 != 0)
+            {
+                return false;
+            }
+
+            const size_t vertexCount = mesh.vertices.size();
+            draco::Mesh dracoMesh;
+            dracoMesh.set_num_points(static_cast<uint32_t>(vertexCount));
+            dracoMesh.SetNumFaces(mesh.indices.size() / 3);
+            for (size_t i = 0; i < mesh.indices.size(); i += 3)
+            {
+                draco::Mesh::Face face;
+                for (size_t corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t index = mesh.indices[i + corner];
+                    if (index >= vertexCount)
+                    {
+                        return false;
+                    }
+                    face[corner] = draco::PointIndex(index);
+                }
+                dracoMesh.SetFace(draco::FaceIndex(static_cast<uint32_t>(i / 3)), face);
+            }
+
+            const int position = addAttribute(dracoMesh, draco::GeometryAttribute::POSITION, 3, vertexCount);
+            const int normal = addAttribute(dracoMesh, draco::GeometryAttribute::NORMAL, 3, vertexCount);
+            const int uv = addAttribute(dracoMesh, draco::GeometryAttribute::TEX_COORD, 2, vertexCount);
+            const int color = addAttribute(dracoMesh, draco::GeometryAttribute::COLOR, 3, vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                const Vertex& vertex = mesh.vertices[i];
+                const draco::AttributeValueIndex value(static_cast<uint32_t>(i));
+                dracoMesh.attribute(position)->SetAttributeValue(value, &vertex.position[0]);
+                dracoMesh.attribute(normal)->SetAttributeValue(value, &vertex.normal[0]);
+                dracoMesh.attribute(uv)->SetAttributeValue(value, &vertex.uv[0]);
+                dracoMesh.attribute(color)->SetAttributeValue(value, &vertex.color[0]);
+            }
+
+            // OBJ meshes come out unwelded (one vertex per face corner); merging identical
+            // vertices first is what lets edgebreaker see the connectivity
+            dracoMesh.DeduplicateAttributeValues();
+            dracoMesh.DeduplicatePointIds();
+
+            draco::Encoder encoder;
+            encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, options.positionBits);
+            encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, options.normalBits);
+            encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, options.uvBits);
+            encoder.SetAttributeQuantization(draco::GeometryAttribute::COLOR, options.colorBits);
+            encoder.SetSpeedOptions(options.speed, options.speed);
+
+            draco::EncoderBuffer buffer;
+            const draco::Status status = encoder.EncodeMeshToBuffer(dracoMesh, &buffer);
+            if (!status.ok())
+            {
+                log(LogLevel::Warn, "Draco encoding failed for mesh '" + mesh.name + "': " + status.error_msg_string());
+                return false;
+            }
+
+            output.insert(output.end(), buffer.data(), buffer.data() + buffer.size());
+            return true;
+        }
+
+        bool decode(const char* data, size_t size, Mesh& mesh)
+        {
+            draco::DecoderBuffer buffer;
+            buffer.Init(data, size);
+            draco::Decoder decoder;
+            auto result = decoder.DecodeMeshFromBuffer(&buffer);
+            if (!result.ok())
+            {
+                log(LogLevel::Warn, "Draco decoding failed for mesh '" + mesh.name + "': " + result.status().error_msg_string());
+                return false;
+            }
+            const std::unique_ptr<draco::Mesh> dracoMesh = std::move(result).value();
+
+            const draco::PointAttribute* position = dracoMesh->GetNamedAttribute(draco::GeometryAttribute::POSITION);
+            const draco::PointAttribute* normal = dracoMesh->GetNamedAttribute(draco::GeometryAttribute::NORMAL);
+            const draco::PointAttribute* uv = dracoMesh->GetNamedAttribute(draco::GeometryAttribute::TEX_COORD);
+            const draco::PointAttribute* color = dracoMesh->GetNamedAttribute(draco::GeometryAttribute::COLOR);
+            if (!position)
+            {
+                return false;
+            }
+
+            const uint32_t pointCount = dracoMesh->num_points();
+            mesh.vertices.resize(pointCount);
+            for (uint32_t i = 0; i < pointCount; ++i)
+            {
+                Vertex& vertex = mesh.vertices[i];
+                const draco::PointIndex point(i);
+                readAttribute(position, point, 3, &vertex.position[0]);
+                readAttribute(normal, point, 3, &vertex.normal[0]);
+                readAttribute(uv, point, 2, &vertex.uv[0]);
+                readAttribute(color, point, 3, &vertex.color[0]);
+            }
+
+            const uint32_t faceCount = dracoMesh->num_faces();
+            mesh.indices.resize(static_cast<size_t>(faceCount) * 3);
+            for (uint32_t i = 0; i < faceCount; ++i)
+            {
+                const draco::Mesh::Face& face = dracoMesh->face(draco::FaceIndex(i));
+                mesh.indices[i * 3 + 0] = face[0].value();
+                mesh.indices[i * 3 + 1] = face[1].value();
+                mesh.indices[i * 3 + 2] = face[2].value();
+            }
+            return true;
+        }
+#else
+        bool available()
+        {
+            return false;
+        }
+
+        bool encode(const Mesh&, const Options&, std::vector<char>&)
+        {
+            return false;
+        }
+
+        bool decode(const char*, size_t, Mesh& mesh)
+        {
+            log(LogLevel::Warn, "Mesh '" + mesh.name + "' is Draco-encoded but this build has no Draco support");
+            return false;
+        }
+#endif
+    }
+} // namespace cg
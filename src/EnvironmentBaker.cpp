@@ -0,0 +1,359 @@
+#include "render/EnvironmentBaker.h"
+
+#include "util/JobSystem.h"
+#include "util/Log.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace cg
+{
+    namespace EnvironmentBaker
+    {
+        namespace
+        {
+            constexpr int kMinFaceSize = 4;
+            // Lobe weights below this fraction of the peak are skipped when convolving
+            constexpr float kLobeCutoff = 0.01f;
+
+            // Source image with per-row/per-column trig tables for direction lookups
+            struct SourceLevel
+            {
+                const LatLongImage* image{nullptr};
+                std::vector<float> sinTheta;
+                std::vector<float> cosTheta;
+                std::vector<float> sinPhi;
+                std::vector<float> cosPhi;
+            };
+
+            LatLongImage halveImage(const LatLongImage& source)
+            {
+                LatLongImage result;
+                result.width = std::max(1, source.width / 2);
+                result.height = std::max(1, source.height / 2);
+                result.rgb.assign(static_cast<size_t>(result.width) * result.height * 3, 0.0f);
+                for (int y = 0; y < result.height; ++y)
+                {
+                    for (int x = 0; x < result.width; ++x)
+                    {
+                        float* dst = &result.rgb[(static_cast<size_t>(y) * result.width + x) * 3];
+                        for (int dy = 0; dy < 2; ++dy)
+                        {
+                            const int sy = std::min(y * 2 + dy, source.height - 1);
+                            for (int dx = 0; dx < 2; ++dx)
+                            {
+                                const int sx = std::min(x * 2 + dx, source.width - 1);
+                                const float* src = &source.rgb[(static_cast<size_t>(sy) * source.width + sx) * 3];
+                                dst[0] += src[0] * 0.25f;
+                                dst[1] += src[1] * 0.25f;
+                                dst[2] += src[2] * 0.25f;
+                            }
+                        }
+                    }
+                }
+                return result;
+            }
+
+            SourceLevel makeSourceLevel(const LatLongImage& image)
+            {
+                SourceLevel level;
+                level.image = &image;
+                level.sinTheta.resize(image.height);
+                level.cosTheta.resize(image.height);
+                for (int y = 0; y < image.height; ++y)
+                {
+                    const float theta = (static_cast<float>(y) + 0.5f) / static_cast<float>(image.height) * glm::pi<float>();
+                    level.sinTheta[y] = std::sin(theta);
+                    level.cosTheta[y] = std::cos(theta);
+                }
+                level.sinPhi.resize(image.width);
+                level.cosPhi.resize(image.width);
+                for (int x = 0; x < image.width; ++x)
+                {
+                    const float phi = ((static_cast<float>(x) + 0.5f) / static_cast<float>(image.width) - 0.5f) * glm::two_pi<float>();
+                    level.sinPhi[x] = std::sin(phi);
+                    level.cosPhi[x] = std::cos(phi);
+                }
+                return level;
+            }
+
+            glm::vec3 faceDirection(int face, int x, int y, int size)
+            {
+                const float s = 2.0f * (static_cast<float>(x) + 0.5f) / static_cast<float>(size) - 1.0f;
+                const float t = 2.0f * (static_cast<float>(y) + 0.5f) / static_cast<float>(size) - 1.0f;
+                glm::vec3 dir;
+                switch (face)
+                {
+                case 0: dir = glm::vec3(1.0f, -t, -s); break;
+                case 1: dir = glm::vec3(-1.0f, -t, s); break;
+                case 2: dir = glm::vec3(s, 1.0f, t); break;
+                case 3: dir = glm::vec3(s, -1.0f, -t); break;
+                case 4: dir = glm::vec3(s, -t, 1.0f); break;
+                default: dir = glm::vec3(-s, -t, -1.0f); break;
+                }
+                return glm::normalize(dir);
+            }
+
+            glm::vec3 texel(const LatLongImage& image, int x, int y)
+            {
+                const float* p = &image.rgb[(static_cast<size_t>(y) * image.width + x) * 3];
+                return glm::vec3(p[0], p[1], p[2]);
+            }
+
+            glm::vec3 sampleBilinear(const LatLongImage& image, const glm::vec3& dir)
+            {
+                const float phi = std::atan2(dir.z, dir.x);
+                const float theta = std::acos(glm::clamp(dir.y, -1.0f, 1.0f));
+                const float fx = (phi / glm::two_pi<float>() + 0.5f) * static_cast<float>(image.width) - 0.5f;
+                const float fy = theta / glm::pi<float>() * static_cast<float>(image.height) - 0.5f;
+                const int x0 = static_cast<int>(std::floor(fx));
+                const int y0 = static_cast<int>(std::floor(fy));
+                const float tx = fx - static_cast<float>(x0);
+                const float ty = fy - static_cast<float>(y0);
+                const int xa = (x0 % image.width + image.width) % image.width;
+                const int xb = (xa + 1) % image.width;
+                const int ya = glm::clamp(y0, 0, image.height - 1);
+                const int yb = glm::clamp(y0 + 1, 0, image.height - 1);
+                const glm::vec3 top = glm::mix(texel(image, xa, ya), texel(image, xb, ya), tx);
+                const glm::vec3 bottom = glm::mix(texel(image, xa, yb), texel(image, xb, yb), tx);
+                return glm::mix(top, bottom, ty);
+            }
+
+            // Phong-lobe convolution restricted to the lat-long window that can contribute
+            glm::vec3 convolve(const SourceLevel& level, const glm::vec3& n, float exponent)
+            {
+                const LatLongImage& image = *level.image;
+                const float pi = glm::pi<float>();
+                const float cutoff = std::acos(std::pow(kLobeCutoff, 1.0f / exponent));
+                const float theta = std::acos(glm::clamp(n.y, -1.0f, 1.0f));
+                const float phi = std::atan2(n.z, n.x);
+
+                const int rowBegin = std::max(0, static_cast<int>(std::floor((theta - cutoff) / pi * image.height)));
+                const int rowEnd = std::min(image.height, static_cast<int>(std::ceil((theta + cutoff) / pi * image.height)) + 1);
+
+                int columnBegin = 0;
+                int columnCount = image.width;
+                if (theta - cutoff > 0.0f && theta + cutoff < pi)
+                {
+                    // Widest longitude offset of a cap of radius cutoff, bounded by the window's smallest sin(theta)
+                    const float minSin = std::min(std::sin(theta - cutoff), std::sin(theta + cutoff));
+                    const float halfSpan = std::asin(std::min(1.0f, std::sin(cutoff) / minSin));
+                    const float center = (phi / glm::two_pi<float>() + 0.5f) * image.width - 0.5f;
+                    const float span = halfSpan / glm::two_pi<float>() * image.width + 1.0f;
+                    if (span * 2.0f + 1.0f < static_cast<float>(image.width))
+                    {
+                        columnBegin = static_cast<int>(std::floor(center - span));
+                        columnCount = static_cast<int>(std::ceil(span * 2.0f)) + 1;
+                    }
+                }
+
+                glm::vec3 sum(0.0f);
+                float weightSum = 0.0f;
+                for (int y = rowBegin; y < rowEnd; ++y)
+                {
+                    const float sinTheta = level.sinTheta[y];
+                    const float cosTheta = level.cosTheta[y];
+                    const float* row = &image.rgb[static_cast<size_t>(y) * image.width * 3];
+                    for (int i = 0; i < columnCount; ++i)
+                    {
+                        const int x = ((columnBegin + i) % image.width + image.width) % image.width;
+                        const float d = n.x * sinTheta * level.cosPhi[x] + n.y * cosTheta + n.z * sinTheta * level.sinPhi[x];
+                        if (d <= 0.0f)
+                        {
+                            continue;
+                        }
+                        const float w = std::pow(d, exponent) * sinTheta;
+                        const float* p = row + static_cast<size_t>(x) * 3;
+                        sum += glm::vec3(p[0], p[1], p[2]) * w;
+                        weightSum += w;
+                    }
+                }
+                return weightSum > 0.0f ? sum / weightSum : sampleBilinear(image, n);
+            }
+
+            std::array<glm::vec3, 9> projectIrradianceSH(const SourceLevel& level)
+            {
+                const LatLongImage& image = *level.image;
+                std::array<glm::vec3, 9> sh{};
+                const float texelArea = (glm::two_pi<float>() / image.width) * (glm::pi<float>() / image.height);
+                for (int y = 0; y < image.height; ++y)
+                {
+                    const float dOmega = texelArea * level.sinTheta[y];
+                    for (int x = 0; x < image.width; ++x)
+                    {
+                        const float dx = level.sinTheta[y] * level.cosPhi[x];
+                        const float dy = level.cosTheta[y];
+                        const float dz = level.sinTheta[y] * level.sinPhi[x];
+                        const glm::vec3 c = texel(image, x, y) * dOmega;
+                        sh[0] += c * 0.282095f;
+                        sh[1] += c * (0.488603f * dy);
+                        sh[2] += c * (0.488603f * dz);
+                        sh[3] += c * (0.488603f * dx);
+                        sh[4] += c * (1.092548f * dx * dy);
+                        sh[5] += c * (1.092548f * dy * dz);
+                        sh[6] += c * (0.315392f * (3.0f * dz * dz - 1.0f));
+                        sh[7] += c * (1.092548f * dx * dz);
+                        sh[8] += c * (0.546274f * (dx * dx - dy * dy));
+                    }
+                }
+
+                // Convolve with the clamped cosine (pi, 2pi/3, pi/4 per band) and divide by pi
+                for (int i = 1; i < 4; ++i) sh[i] *= 2.0f / 3.0f;
+                for (int i = 4; i < 9; ++i) sh[i] *= 0.25f;
+                return sh;
+            }
+        } // namespace
+
+        LatLongDownsampler::LatLongDownsampler(int sourceWidth, int sourceHeight, int targetWidth, int targetHeight)
+            : m_sourceWidth(sourceWidth), m_sourceHeight(sourceHeight)
+        {
+            m_image.width = std::max(1, std::min(sourceWidth, targetWidth));
+            m_image.height = std::max(1, std::min(sourceHeight, targetHeight));
+            m_image.rgb.assign(static_cast<size_t>(m_image.width) * m_image.height * 3, 0.0f);
+            m_weights.assign(static_cast<size_t>(m_image.width) * m_image.height, 0.0f);
+        }
+
+        void LatLongDownsampler::addPixels(int x, int y, const float* pixels, int count, int channels)
+        {
+            const int ty = static_cast<int>(static_cast<int64_t>(y) * m_image.height / m_sourceHeight);
+            float* dstRow = &m_image.rgb[static_cast<size_t>(ty) * m_image.width * 3];
+            float* weightRow = &m_weights[static_cast<size_t>(ty) * m_image.width];
+            for (int i = 0; i < count; ++i)
+            {
+                const int tx = static_cast<int>(static_cast<int64_t>(x + i) * m_image.width / m_sourceWidth);
+                const float* src = pixels + static_cast<size_t>(i) * channels;
+                float* dst = dstRow + static_cast<size_t>(tx) * 3;
+                dst[0] += src[0];
+                dst[1] += src[1];
+                dst[2] += src[2];
+                weightRow[tx] += 1.0f;
+            }
+        }
+
+        LatLongImage LatLongDownsampler::finish()
+        {
+            for (size_t i = 0; i < m_weights.size(); ++i)
+            {
+                const float inv = m_weights[i] > 0.0f ? 1.0f / m_weights[i] : 0.0f;
+                m_image.rgb[i * 3 + 0] *= inv;
+                m_image.rgb[i * 3 + 1] *= inv;
+                m_image.rgb[i * 3 + 2] *= inv;
+            }
+            m_weights.clear();
+            return std::move(m_image);
+        }
+
+        void resampleFace(const LatLongImage& source, int face, int size, float* rgb)
+        {
+            for (int y = 0; y < size; ++y)
+            {
+                for (int x = 0; x < size; ++x)
+                {
+                    const glm::vec3 color = sampleBilinear(source, faceDirection(face, x, y, size));
+                    float* dst = rgb + (static_cast<size_t>(y) * size + x) * 3;
+                    dst[0] = color.r;
+                    dst[1] = color.g;
+                    dst[2] = color.b;
+                }
+            }
+        }
+
+        Environment bake(const LatLongImage& source, int faceSize)
+        {
+            Environment env;
+            if (source.width <= 0 || source.height <= 0 || source.rgb.empty())
+            {
+                return env;
+            }
+
+            const auto start = std::chrono::high_resolution_clock::now();
+
+            // Round down to a power of two so every mip halves cleanly
+            env.faceSize = kMinFaceSize;
+            while (env.faceSize * 2 <= faceSize)
+            {
+                env.faceSize *= 2;
+            }
+            env.mipCount = 1;
+            while ((env.faceSize >> env.mipCount) >= kMinFaceSize)
+            {
+                ++env.mipCount;
+            }
+
+            // Lat-long pyramid; each mip convolves the smallest level that still has ~2 texels per output texel
+            std::vector<LatLongImage> pyramid;
+            pyramid.push_back(source);
+            while (pyramid.back().width > 32 && pyramid.back().height > 16)
+            {
+                pyramid.push_back(halveImage(pyramid.back()));
+            }
+            std::vector<SourceLevel> levels;
+            levels.reserve(pyramid.size());
+            for (const auto& image : pyramid)
+            {
+                levels.push_back(makeSourceLevel(image));
+            }
+            auto levelForSize = [&](int size) -> const SourceLevel& {
+                size_t best = 0;
+                for (size_t i = 0; i < levels.size(); ++i)
+                {
+                    if (levels[i].image->width >= size * 2)
+                    {
+                        best = i;
+                    }
+                }
+                return levels[best];
+            };
+
+            // One job per face and mip: the rough mips cost far more per texel than the sharp ones
+            env.faces.resize(static_cast<size_t>(env.mipCount) * 6);
+            JobSystem& jobSystem = JobSystem::instance();
+            std::vector<JobSystem::JobHandle> jobs;
+            for (int mip = 0; mip < env.mipCount; ++mip)
+            {
+                for (int face = 0; face < 6; ++face)
+                {
+                    jobs.push_back(jobSystem.submit([&, face, mip]() {
+                        const int size = env.faceSize >> mip;
+                        const float roughness = env.mipCount > 1 ? static_cast<float>(mip) / static_cast<float>(env.mipCount - 1) : 0.0f;
+                        const float exponent = std::max(2.0f / (roughness * roughness + 1e-6f) - 2.0f, 1.0f);
+                        const SourceLevel& level = levelForSize(size);
+
+                        auto& pixels = env.faces[static_cast<size_t>(mip) * 6 + face];
+                        pixels.resize(static_cast<size_t>(size) * size * 3);
+                        if (mip == 0)
+                        {
+                            resampleFace(source, face, size, pixels.data());
+                            return;
+                        }
+                        for (int y = 0; y < size; ++y)
+                        {
+                            for (int x = 0; x < size; ++x)
+                            {
+                                const glm::vec3 color = convolve(level, faceDirection(face, x, y, size), exponent);
+                                float* dst = &pixels[(static_cast<size_t>(y) * size + x) * 3];
+                                dst[0] = color.r;
+                                dst[1] = color.g;
+                                dst[2] = color.b;
+                            }
+                        }
+                    }));
+                }
+            }
+
+            env.irradianceSH = projectIrradianceSH(levelForSize(32));
+            jobSystem.wait(jobs);
+
+            const auto end = std::chrono::high_resolution_clock::now();
+            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+            log(LogLevel::Info, "Environment bake (" + std::to_string(env.faceSize) + "px faces, " + std::to_string(env.mipCount) +
+                " mips) time: " + std::to_string(duration.count()) + "ms");
+            return env;
+        }
+    }
+} // namespace cg
@@ -0,0 +1,314 @@
+#include "loader/ExrStreamReader.h"
+
+#include "util/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#define TINYEXR_IMPLEMENTATION
+#include <tinyexr.h>
+
+namespace cg
+{
+    struct ExrStreamReader::HeaderStorage
+    {
+        EXRHeader header{};
+        std::vector<size_t> channelOffsets;
+        int pixelDataSize{0};
+
+        HeaderStorage() { InitEXRHeader(&header); }
+        ~HeaderStorage() { FreeEXRHeader(&header); }
+    };
+
+    namespace
+    {
+        int scanlinesPerChunk(int compressionType)
+        {
+            switch (compressionType)
+            {
+            case TINYEXR_COMPRESSIONTYPE_NONE:
+            case TINYEXR_COMPRESSIONTYPE_RLE:
+            case TINYEXR_COMPRESSIONTYPE_ZIPS:
+                return 1;
+            case TINYEXR_COMPRESSIONTYPE_ZIP:
+            case TINYEXR_COMPRESSIONTYPE_ZFP:
+                return 16;
+            case TINYEXR_COMPRESSIONTYPE_PIZ:
+                return 32;
+            default:
+                return 0;
+            }
+        }
+
+        void logExrError(const std::string& path, const char* what, const char* err)
+        {
+            std::string msg = "EXR stream: " + std::string(what) + ": " + path;
+            if (err != nullptr)
+            {
+                msg += " (" + std::string(err) + ")";
+                FreeEXRErrorMessage(err);
+            }
+            log(LogLevel::Error, msg);
+        }
+    } // namespace
+
+    ExrStreamReader::ExrStreamReader() = default;
+    ExrStreamReader::~ExrStreamReader() = default;
+
+    void ExrStreamReader::close()
+    {
+        m_file.close();
+        m_header.reset();
+        m_offsets.clear();
+        m_width = 0;
+        m_height = 0;
+        std::fill(std::begin(m_channelIndex), std::end(m_channelIndex), -1);
+    }
+
+    bool ExrStreamReader::open(const std::string& path)
+    {
+        close();
+        m_path = path;
+        if (!m_file.open(path))
+        {
+            log(LogLevel::Error, "Cannot open EXR file: " + path);
+            return false;
+        }
+        if (m_file.size() < static_cast<size_t>(tinyexr::kEXRVersionSize))
+        {
+            log(LogLevel::Error, "EXR file is truncated: " + path);
+            return false;
+        }
+
+        EXRVersion version{};
+        if (ParseEXRVersionFromMemory(&version, m_file.bytes(), m_file.size()) != TINYEXR_SUCCESS)
+        {
+            log(LogLevel::Error, "Not an EXR file: " + path);
+            return false;
+        }
+        if (version.multipart || version.non_image)
+        {
+            log(LogLevel::Error, "Multipart and deep EXR files are not supported for streaming: " + path);
+            return false;
+        }
+
+        const char* err = nullptr;
+        m_header = std::make_unique<HeaderStorage>();
+        if (ParseEXRHeaderFromMemory(&m_header->header, &version, m_file.bytes(), m_file.size(), &err) != TINYEXR_SUCCESS)
+        {
+            logExrError(path, "failed to parse header", err);
+            return false;
+        }
+
+        EXRHeader& header = m_header->header;
+        for (int c = 0; c < header.num_channels; ++c)
+        {
+            header.requested_pixel_types[c] = TINYEXR_PIXELTYPE_FLOAT;
+            const std::string name = header.channels[c].name;
+            if (name == "R") m_channelIndex[0] = c;
+            else if (name == "G") m_channelIndex[1] = c;
+            else if (name == "B") m_channelIndex[2] = c;
+            else if (name == "A") m_channelIndex[3] = c;
+        }
+        if (m_channelIndex[0] < 0 || m_channelIndex[1] < 0 || m_channelIndex[2] < 0)
+        {
+            if (header.num_channels != 1)
+            {
+                log(LogLevel::Error, "EXR file has no RGB channels: " + path);
+                return false;
+            }
+            // Single-channel luminance image: replicate into RGB
+            m_channelIndex[0] = m_channelIndex[1] = m_channelIndex[2] = 0;
+        }
+
+        size_t channelOffset = 0;
+        if (!tinyexr::ComputeChannelLayout(&m_header->channelOffsets, &m_header->pixelDataSize, &channelOffset,
+                                           header.num_channels, header.channels))
+        {
+            log(LogLevel::Error, "Unsupported EXR channel layout: " + path);
+            return false;
+        }
+
+        m_width = header.data_window.max_x - header.data_window.min_x + 1;
+        m_height = header.data_window.max_y - header.data_window.min_y + 1;
+        m_minY = header.data_window.min_y;
+        if (m_width <= 0 || m_height <= 0)
+        {
+            log(LogLevel::Error, "EXR data window is empty: " + path);
+            return false;
+        }
+
+        size_t chunkCount = 0;
+        m_tiled = header.tiled != 0;
+        if (m_tiled)
+        {
+            // Level 0 tiles come first in the offset table for every level mode, so
+            // mip/rip levels stored in the file are simply never read.
+            m_blockWidth = header.tile_size_x;
+            m_blockHeight = header.tile_size_y;
+            if (m_blockWidth <= 0 || m_blockHeight <= 0)
+            {
+                log(LogLevel::Error, "Invalid EXR tile size: " + path);
+                return false;
+            }
+            m_tilesX = (m_width + m_blockWidth - 1) / m_blockWidth;
+            const int tilesY = (m_height + m_blockHeight - 1) / m_blockHeight;
+            chunkCount = static_cast<size_t>(m_tilesX) * static_cast<size_t>(tilesY);
+        }
+        else
+        {
+            m_blockWidth = m_width;
+            m_blockHeight = scanlinesPerChunk(header.compression_type);
+            if (m_blockHeight == 0)
+            {
+                log(LogLevel::Error, "Unsupported EXR compression for streaming: " + path);
+                return false;
+            }
+            chunkCount = static_cast<size_t>((m_height + m_blockHeight - 1) / m_blockHeight);
+        }
+
+        const uint64_t tableOffset = static_cast<uint64_t>(tinyexr::kEXRVersionSize) + header.header_len;
+        const uint64_t fileSize = m_file.size();
+        if (tableOffset + chunkCount * sizeof(uint64_t) > fileSize)
+        {
+            log(LogLevel::Error, "EXR offset table is truncated: " + path);
+            return false;
+        }
+        m_offsets.resize(chunkCount);
+        std::memcpy(m_offsets.data(), m_file.data() + tableOffset, chunkCount * sizeof(uint64_t));
+        for (auto& offset : m_offsets)
+        {
+            tinyexr::swap8(reinterpret_cast<tinyexr::tinyexr_uint64*>(&offset));
+            if (offset == 0 || offset >= fileSize)
+            {
+                log(LogLevel::Error, "EXR offset table is incomplete (partially written file?): " + path);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool ExrStreamReader::readBlocks(const BlockSink& sink)
+    {
+        if (!m_header || m_offsets.empty())
+        {
+            return false;
+        }
+
+        const EXRHeader& header = m_header->header;
+        const size_t numChannels = static_cast<size_t>(header.num_channels);
+        const size_t blockPixels = maxBlockPixels();
+
+        // Per-channel planar output of tinyexr, then one interleaved RGBA block for the sink
+        std::vector<std::vector<float>> planes(numChannels, std::vector<float>(blockPixels));
+        std::vector<unsigned char*> planePtrs(numChannels);
+        for (size_t c = 0; c < numChannels; ++c)
+        {
+            planePtrs[c] = reinterpret_cast<unsigned char*>(planes[c].data());
+        }
+        std::vector<float> rgba(blockPixels * 4);
+        const uint64_t fileSize = m_file.size();
+
+        const size_t chunkHeaderSize = m_tiled ? sizeof(int) * 5 : sizeof(int) * 2;
+        for (size_t i = 0; i < m_offsets.size(); ++i)
+        {
+            int fields[5]{};
+            if (m_offsets[i] + chunkHeaderSize > fileSize)
+            {
+                log(LogLevel::Error, "EXR chunk header is truncated: " + m_path);
+                return false;
+            }
+            std::memcpy(fields, m_file.data() + m_offsets[i], chunkHeaderSize);
+            for (auto& field : fields)
+            {
+                tinyexr::swap4(&field);
+            }
+
+            const int dataLen = m_tiled ? fields[4] : fields[1];
+            if (dataLen <= 0 || m_offsets[i] + chunkHeaderSize + static_cast<uint64_t>(dataLen) > fileSize)
+            {
+                log(LogLevel::Error, "EXR chunk data is truncated: " + m_path);
+                return false;
+            }
+            const unsigned char* chunk = m_file.bytes() + m_offsets[i] + chunkHeaderSize;
+            const size_t chunkSize = static_cast<size_t>(dataLen);
+
+            Block block;
+            bool decoded = false;
+            if (m_tiled)
+            {
+                const int tileX = fields[0];
+                const int tileY = fields[1];
+                if (fields[2] != 0 || fields[3] != 0)
+                {
+                    continue;  // Belongs to a lower mip/rip level
+                }
+                decoded = tinyexr::DecodeTiledPixelData(
+                    planePtrs.data(), &block.width, &block.height, header.requested_pixel_types,
+                    chunk, chunkSize, header.compression_type, m_width, m_height,
+                    tileX, tileY, m_blockWidth, m_blockHeight,
+                    static_cast<size_t>(m_header->pixelDataSize),
+                    static_cast<size_t>(header.num_custom_attributes), header.custom_attributes,
+                    numChannels, header.channels, m_header->channelOffsets);
+                block.x = tileX * m_blockWidth;
+                block.y = tileY * m_blockHeight;
+            }
+            else
+            {
+                const int lineNo = fields[0] - m_minY;
+                if (lineNo < 0 || lineNo >= m_height)
+                {
+                    log(LogLevel::Error, "EXR chunk has an invalid scanline: " + m_path);
+                    return false;
+                }
+                block.x = 0;
+                block.y = lineNo;
+                block.width = m_width;
+                block.height = std::min(m_blockHeight, m_height - lineNo);
+                // Decode as a standalone image of block.height lines so the planes stay chunk sized
+                decoded = tinyexr::DecodePixelData(
+                    planePtrs.data(), header.requested_pixel_types,
+                    chunk, chunkSize, header.compression_type, /* line_order */ 0,
+                    m_width, block.height, /* x_stride */ m_width, /* y */ 0, /* line_no */ 0, block.height,
+                    static_cast<size_t>(m_header->pixelDataSize),
+                    static_cast<size_t>(header.num_custom_attributes), header.custom_attributes,
+                    numChannels, header.channels, m_header->channelOffsets);
+            }
+
+            if (!decoded)
+            {
+                log(LogLevel::Error, "Failed to decode EXR chunk " + std::to_string(i) + ": " + m_path);
+                return false;
+            }
+
+            // Tiles use tile_size_x as the row stride; scanline blocks use the image width
+            const size_t stride = static_cast<size_t>(m_blockWidth);
+            for (int row = 0; row < block.height; ++row)
+            {
+                float* dst = rgba.data() + static_cast<size_t>(row) * static_cast<size_t>(block.width) * 4;
+                const size_t srcRow = static_cast<size_t>(row) * stride;
+                for (int col = 0; col < block.width; ++col)
+                {
+                    const size_t src = srcRow + static_cast<size_t>(col);
+                    dst[col * 4 + 0] = planes[m_channelIndex[0]][src];
+                    dst[col * 4 + 1] = planes[m_channelIndex[1]][src];
+                    dst[col * 4 + 2] = planes[m_channelIndex[2]][src];
+                    dst[col * 4 + 3] = m_channelIndex[3] >= 0 ? planes[m_channelIndex[3]][src] : 1.0f;
+                }
+            }
+
+            // Compressed bytes are not needed again; let the OS drop them from the resident set
+            m_file.release(static_cast<size_t>(m_offsets[i]), chunkHeaderSize + chunkSize);
+
+            block.rgba = rgba.data();
+            if (!sink(block))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+} // namespace cg
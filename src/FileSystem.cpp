@@ -1,34 +1,197 @@
 #include "util/FileSystem.h"
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace cg
 {
     std::string readTextFile(const std::string& path)
     {
-        std::ifstream file(path);
-        if (!file)
+        MappedFile file;
+        if (!file.open(path))
         {
             throw std::runtime_error("Failed to open file: " + path);
         }
 
-        std::ostringstream oss;
-        oss << file.rdbuf();
-        return oss.str();
+        return std::string(file.data(), file.size());
     }
 
     std::vector<char> readBinaryFile(const std::string& path)
     {
-        std::ifstream file(path, std::ios::binary);
-        if (!file)
+        MappedFile file;
+        if (!file.open(path))
         {
             throw std::runtime_error("Failed to open file: " + path);
         }
 
-        return std::vector<char>((std::istreambuf_iterator<char>(file)),
-                                 std::istreambuf_iterator<char>());
+        return std::vector<char>(file.data(), file.data() + file.size());
     }
-} // namespace cg
 
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+            std::swap(m_open, other.m_open);
+#ifdef _WIN32
+            std::swap(m_file, other.m_file);
+            std::swap(m_mapping, other.m_mapping);
+#endif
+        }
+        return *this;
+    }
+
+#ifdef _WIN32
+    bool MappedFile::open(const std::string& path, Access access)
+    {
+        close();
+        const DWORD flags = access == Access::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file = file;
+        m_size = static_cast<size_t>(size.QuadPart);
+        m_open = true;
+        if (m_size == 0)
+        {
+            return true;
+        }
+
+        m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view)
+        {
+            close();
+            return false;
+        }
+        m_data = static_cast<const char*>(view);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping)
+        {
+            CloseHandle(static_cast<HANDLE>(m_mapping));
+        }
+        if (m_file)
+        {
+            CloseHandle(static_cast<HANDLE>(m_file));
+        }
+        m_data = nullptr;
+        m_mapping = nullptr;
+        m_file = nullptr;
+        m_size = 0;
+        m_open = false;
+    }
+
+    void MappedFile::release(size_t, size_t) const
+    {
+    }
+#else
+    bool MappedFile::open(const std::string& path, Access access)
+    {
+        close();
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        m_size = static_cast<size_t>(st.st_size);
+        m_open = true;
+        if (m_size == 0)
+        {
+            ::close(fd);
+            return true;
+        }
+
+        void* view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps its own reference to the file
+        ::close(fd);
+        if (view == MAP_FAILED)
+        {
+            m_size = 0;
+            m_open = false;
+            return false;
+        }
+        madvise(view, m_size, access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        m_data = static_cast<const char*>(view);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data)
+        {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_open = false;
+    }
+
+    void MappedFile::release(size_t offset, size_t size) const
+    {
+        if (!m_data || offset >= m_size)
+        {
+            return;
+        }
+        // madvise needs a page-aligned start; only whole pages inside the range are dropped
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t begin = (offset + page - 1) / page * page;
+        const size_t end = std::min(offset + size, m_size) / page * page;
+        if (end > begin)
+        {
+            madvise(const_cast<char*>(m_data) + begin, end - begin, MADV_DONTNEED);
+        }
+    }
+#endif
+} // namespace cg
@@ -0,0 +1,147 @@
+#include "render/GpuParticleSimulation.h"
+
+#include <glad/glad.h>
+#ifndef GLFW_INCLUDE_NONE
+#define GLFW_INCLUDE_NONE
+#endif
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace cg
+{
+    namespace
+    {
+        // GL 4.3 pieces the 4.0 loader does not provide
+        constexpr GLenum kShaderStorageBuffer = 0x90D2;
+        constexpr GLbitfield kVertexAttribArrayBarrierBit = 0x00000001;
+        constexpr GLbitfield kCommandBarrierBit = 0x00000040;
+        constexpr GLbitfield kBufferUpdateBarrierBit = 0x00000200;
+        constexpr GLbitfield kShaderStorageBarrierBit = 0x00002000;
+        using DispatchComputeProc = void(APIENTRYP)(GLuint, GLuint, GLuint);
+        using MemoryBarrierProc = void(APIENTRYP)(GLbitfield);
+        DispatchComputeProc dispatchCompute = nullptr;
+        MemoryBarrierProc memoryBarrier = nullptr;
+
+        constexpr GLuint kWorkGroupSize = 64;  // local_size_x in particle_simulate.comp
+
+        struct DrawCommand
+        {
+            uint32_t count;
+            uint32_t instanceCount;
+            uint32_t first;
+            uint32_t baseInstance;
+        };
+
+        GLuint groupsFor(size_t count)
+        {
+            return static_cast<GLuint>((count + kWorkGroupSize - 1) / kWorkGroupSize);
+        }
+    }
+
+    bool GpuParticleSimulation::isSupported()
+    {
+        if (GLVersion.major < 4 || (GLVersion.major == 4 && GLVersion.minor < 3))
+        {
+            return false;
+        }
+        dispatchCompute = reinterpret_cast<DispatchComputeProc>(glfwGetProcAddress("glDispatchCompute"));
+        memoryBarrier = reinterpret_cast<MemoryBarrierProc>(glfwGetProcAddress("glMemoryBarrier"));
+        return dispatchCompute && memoryBarrier;
+    }
+
+    GpuParticleSimulation::GpuParticleSimulation(size_t capacity, unsigned vertexBuffer)
+        : m_capacity(capacity)
+        , m_vertexBuffer(vertexBuffer)
+    {
+        m_shader = std::make_unique<Shader>("shaders/particle_simulate.comp");
+
+        glGenBuffers(2, m_particleBuffers);
+        glGenBuffers(1, &m_spawnBuffer);
+        glGenBuffers(1, &m_commandBuffer);
+        for (GLuint buffer : {m_particleBuffers[0], m_particleBuffers[1], m_spawnBuffer})
+        {
+            glBindBuffer(kShaderStorageBuffer, buffer);
+            glBufferData(kShaderStorageBuffer, static_cast<GLsizeiptr>(m_capacity * sizeof(Spawn)), nullptr, GL_DYNAMIC_DRAW);
+        }
+        const DrawCommand commands[2] = {{0, 1, 0, 0}, {0, 1, 0, 0}};
+        glBindBuffer(kShaderStorageBuffer, m_commandBuffer);
+        glBufferData(kShaderStorageBuffer, sizeof(commands), commands, GL_DYNAMIC_DRAW);
+        glBindBuffer(kShaderStorageBuffer, 0);
+    }
+
+    GpuParticleSimulation::~GpuParticleSimulation()
+    {
+        glDeleteBuffers(2, m_particleBuffers);
+        glDeleteBuffers(1, &m_spawnBuffer);
+        glDeleteBuffers(1, &m_commandBuffer);
+    }
+
+    void GpuParticleSimulation::update(const std::vector<Spawn>& spawns, float deltaSeconds)
+    {
+        const int source = m_current;
+        const int destination = 1 - m_current;
+        const size_t spawnCount = std::min(spawns.size(), m_capacity);
+
+        // Only the destination's vertex count restarts; the rest of the command is constant
+        const uint32_t zero = 0;
+        glBindBuffer(kShaderStorageBuffer, m_commandBuffer);
+        glBufferSubData(kShaderStorageBuffer, static_cast<GLintptr>(destination * sizeof(DrawCommand)), sizeof(zero), &zero);
+        if (spawnCount > 0)
+        {
+            glBindBuffer(kShaderStorageBuffer, m_spawnBuffer);
+            glBufferSubData(kShaderStorageBuffer, 0, static_cast<GLsizeiptr>(spawnCount * sizeof(Spawn)), spawns.data());
+        }
+        glBindBuffer(kShaderStorageBuffer, 0);
+
+        glBindBufferBase(kShaderStorageBuffer, 0, m_particleBuffers[source]);
+        glBindBufferBase(kShaderStorageBuffer, 1, m_particleBuffers[destination]);
+        glBindBufferBase(kShaderStorageBuffer, 2, m_commandBuffer);
+        glBindBufferBase(kShaderStorageBuffer, 3, m_vertexBuffer);
+
+        m_shader->bind();
+        m_shader->setInt("uSource", source);
+        m_shader->setInt("uDestination", destination);
+        m_shader->setFloat("uDeltaSeconds", std::max(0.0f, deltaSeconds));
+        m_shader->setUInt("uCapacity", static_cast<unsigned>(m_capacity));
+        m_shader->setUInt("uSpawnCount", static_cast<unsigned>(spawnCount));
+
+        // Every slot of the source may be live; invocations past its count return at once
+        m_shader->setInt("uPass", 0);
+        dispatchCompute(groupsFor(m_capacity), 1, 1);
+        memoryBarrier(kShaderStorageBarrierBit);
+
+        if (spawnCount > 0)
+        {
+            glBindBufferBase(kShaderStorageBuffer, 0, m_spawnBuffer);
+            m_shader->setInt("uPass", 1);
+            dispatchCompute(groupsFor(spawnCount), 1, 1);
+        }
+        memoryBarrier(kVertexAttribArrayBarrierBit | kCommandBarrierBit | kShaderStorageBarrierBit);
+        glUseProgram(0);
+
+        m_current = destination;
+    }
+
+    void GpuParticleSimulation::draw() const
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+        glDrawArraysIndirect(GL_POINTS, reinterpret_cast<const void*>(static_cast<uintptr_t>(m_current * sizeof(DrawCommand))));
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    std::vector<GpuParticleSimulation::Spawn> GpuParticleSimulation::readBack() const
+    {
+        memoryBarrier(kBufferUpdateBarrierBit);
+
+        DrawCommand command{};
+        glBindBuffer(kShaderStorageBuffer, m_commandBuffer);
+        glGetBufferSubData(kShaderStorageBuffer, static_cast<GLintptr>(m_current * sizeof(DrawCommand)), sizeof(command), &command);
+        std::vector<Spawn> particles(std::min<size_t>(command.count, m_capacity));
+        glBindBuffer(kShaderStorageBuffer, m_particleBuffers[m_current]);
+        glGetBufferSubData(kShaderStorageBuffer, 0, static_cast<GLsizeiptr>(particles.size() * sizeof(Spawn)), particles.data());
+        glBindBuffer(kShaderStorageBuffer, 0);
+        return particles;
+    }
+} // namespace cg
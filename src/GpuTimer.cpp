@@ -0,0 +1,49 @@
+#include "render/GpuTimer.h"
+
+#include <glad/glad.h>
+
+namespace cg
+{
+    GpuTimer::GpuTimer()
+    {
+        glGenQueries(kQueries, m_queries);
+    }
+
+    GpuTimer::~GpuTimer()
+    {
+        glDeleteQueries(kQueries, m_queries);
+    }
+
+    void GpuTimer::collect(bool wait)
+    {
+        while (m_pending > 0)
+        {
+            const GLuint query = m_queries[(m_next - m_pending + kQueries) % kQueries];
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available && !wait)
+            {
+                return;
+            }
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+            m_latestMs = static_cast<double>(nanoseconds) * 1e-6;
+            --m_pending;
+            wait = false;
+        }
+    }
+
+    void GpuTimer::begin()
+    {
+        // Blocks only when every query is still in flight, with the GPU kQueries frames behind
+        collect(m_pending == kQueries);
+        glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next]);
+    }
+
+    void GpuTimer::end()
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_next = (m_next + 1) % kQueries;
+        ++m_pending;
+    }
+} // namespace cg
@@ -2,6 +2,7 @@
 #include "loader/ObjLoader.h"
 #include "util/MeshUtils.h"
 #include "util/Log.h"
+#include "util/Parallel.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -9,9 +10,11 @@
 #include <filesystem>
 #include <vector>
 #include <algorithm>
+#include <chrono>
 #include <random>
 #include <map>
 #include <limits>
+#include <optional>
 
 namespace cg
 {
@@ -19,6 +22,8 @@ namespace cg
     {
         namespace
         {
+            namespace fs = std::filesystem;
+
             struct GroundTilePrototype
             {
                 Mesh mesh;
@@ -68,8 +73,24 @@ namespace cg
                 return {0.0f, true};
             }
 
-            std::string selectTexturePath(const std::filesystem::path& texturesDir, const std::string& meshName)
+            // Candidate ground textures, each checked on disk once per tile set instead of once
+            // per tile; empty when the file does not exist
+            struct GroundTextureSet
             {
+                std::string grass;
+                std::string detail;
+                std::string stone;
+                std::string fallback;
+            };
+
+            GroundTextureSet resolveGroundTextures(const std::filesystem::path& texturesDir)
+            {
+                GroundTextureSet set;
+                if (!std::filesystem::exists(texturesDir))
+                {
+                    return set;
+                }
+
                 auto ensure = [&](const std::string& file) -> std::string
                 {
                     const auto full = texturesDir / file;
@@ -80,50 +101,46 @@ namespace cg
                     return {};
                 };
 
+                set.grass = ensure("Grass_Diffuse.jpg");
+                if (set.grass.empty()) set.grass = ensure("Grass_Diffuse.tga");
+                set.detail = ensure("StoneFloorDetails_Diffuse.jpg");
+                set.stone = ensure("StoneFloor_Diffuse.jpg");
+                set.fallback = ensure("StoneFloorGrass_Diffuse.tga");
+                return set;
+            }
+
+            std::string selectTexturePath(const GroundTextureSet& textures, const std::string& meshName)
+            {
                 std::string lower = meshName;
                 std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
 
-                if (lower.find("grass") != std::string::npos)
+                if (lower.find("grass") != std::string::npos && !textures.grass.empty())
                 {
-                    if (auto tex = ensure("Grass_Diffuse.jpg"); !tex.empty()) return tex;
-                    if (auto tex = ensure("Grass_Diffuse.tga"); !tex.empty()) return tex;
+                    return textures.grass;
                 }
 
-                if (lower.find("detail") != std::string::npos)
+                if (lower.find("detail") != std::string::npos && !textures.detail.empty())
                 {
-                    if (auto tex = ensure("StoneFloorDetails_Diffuse.jpg"); !tex.empty()) return tex;
+                    return textures.detail;
                 }
 
-                if (auto tex = ensure("StoneFloor_Diffuse.jpg"); !tex.empty()) return tex;
-                if (auto fallback = ensure("StoneFloorGrass_Diffuse.tga"); !fallback.empty()) return fallback;
-                return {};
+                return !textures.stone.empty() ? textures.stone : textures.fallback;
             }
 
-            std::vector<GroundTilePrototype> loadGroundTileSet(const std::string& groundPath)
+            fs::path groundTexturesDir(const fs::path& groundPath)
             {
-                namespace fs = std::filesystem;
-                std::vector<GroundTilePrototype> tiles;
-                if (groundPath.empty())
-                {
-                    return tiles;
-                }
-
-                const fs::path path(groundPath);
-                if (!fs::exists(path))
-                {
-                    log(LogLevel::Warn, "Ground path not found: " + groundPath);
-                    return tiles;
-                }
-
-                fs::path texturesDir = path;
+                fs::path texturesDir = groundPath;
                 if (!fs::is_directory(texturesDir))
                 {
                     texturesDir = texturesDir.parent_path();
                 }
-                texturesDir = texturesDir / "Textures";
+                return texturesDir / "Textures";
+            }
 
-                // First pass: load all candidate tiles (Fragment and Slab)
-                std::vector<GroundTilePrototype> candidateTiles;
+            // Candidate tile files (Fragment and Slab) in a stable order
+            std::vector<std::string> collectTileFiles(const fs::path& path)
+            {
+                std::vector<std::string> tileFiles;
                 if (fs::is_directory(path))
                 {
                     std::vector<fs::path> objFiles;
@@ -153,44 +170,69 @@ namespace cg
                             continue;
                         }
                         
-                        if (auto mesh = ObjLoader::loadObjAsMesh(objPath.string()))
-                        {
-                            GroundTilePrototype proto;
-                            proto.bounds = MeshUtils::computeBounds(*mesh);
-                            auto classification = classifyTile(mesh->name);
-                            proto.weight = classification.weight;
-                            proto.decoration = classification.decoration;
-                            if (fs::exists(texturesDir))
-                            {
-                                mesh->diffuseTexture = selectTexturePath(texturesDir, mesh->name);
-                            }
-                            proto.mesh = std::move(*mesh);
-                            // Collect all candidates first (even if weight > 0)
-                            if (proto.weight > 0.0f)
-                            {
-                                candidateTiles.push_back(std::move(proto));
-                            }
-                        }
+                        tileFiles.push_back(objPath.string());
                     }
                 }
                 else
                 {
-                    if (auto mesh = ObjLoader::loadObjAsMesh(path.string()))
+                    tileFiles.push_back(path.string());
+                }
+                return tileFiles;
+            }
+
+            std::optional<GroundTilePrototype> loadTilePrototype(const std::string& objPath, const GroundTextureSet& textures)
+            {
+                auto mesh = ObjLoader::loadObjAsMesh(objPath);
+                if (!mesh)
+                {
+                    return std::nullopt;
+                }
+
+                GroundTilePrototype proto;
+                proto.bounds = MeshUtils::computeBounds(*mesh);
+                auto classification = classifyTile(mesh->name);
+                proto.weight = classification.weight;
+                proto.decoration = classification.decoration;
+                mesh->diffuseTexture = selectTexturePath(textures, mesh->name);
+                proto.mesh = std::move(*mesh);
+                return proto;
+            }
+
+            std::vector<GroundTilePrototype> loadGroundTileSet(const std::string& groundPath)
+            {
+                namespace fs = std::filesystem;
+                std::vector<GroundTilePrototype> tiles;
+                if (groundPath.empty())
+                {
+                    return tiles;
+                }
+
+                const fs::path path(groundPath);
+                if (!fs::exists(path))
+                {
+                    log(LogLevel::Warn, "Ground path not found: " + groundPath);
+                    return tiles;
+                }
+
+                const GroundTextureSet textures = resolveGroundTextures(groundTexturesDir(path));
+                const std::vector<std::string> tileFiles = collectTileFiles(path);
+
+                // Load the candidates in parallel; slots keep the sorted file order
+                const auto loadStart = std::chrono::high_resolution_clock::now();
+                std::vector<std::optional<GroundTilePrototype>> loaded(tileFiles.size());
+                parallelFor(tileFiles.size(), [&](size_t i) {
+                    loaded[i] = loadTilePrototype(tileFiles[i], textures);
+                });
+                const auto loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - loadStart);
+                log(LogLevel::Info, "Loaded " + std::to_string(tileFiles.size()) + " ground tile files in " + std::to_string(loadTime.count()) + "ms");
+
+                // Collect all candidates first (even if weight > 0)
+                std::vector<GroundTilePrototype> candidateTiles;
+                for (auto& proto : loaded)
+                {
+                    if (proto && proto->weight > 0.0f)
                     {
-                        GroundTilePrototype proto;
-                        proto.bounds = MeshUtils::computeBounds(*mesh);
-                        auto classification = classifyTile(mesh->name);
-                        proto.weight = classification.weight;
-                        proto.decoration = classification.decoration;
-                        if (fs::exists(texturesDir))
-                        {
-                            mesh->diffuseTexture = selectTexturePath(texturesDir, mesh->name);
-                        }
-                        proto.mesh = std::move(*mesh);
-                        if (proto.weight > 0.0f)
-                        {
-                            candidateTiles.push_back(std::move(proto));
-                        }
+                        candidateTiles.push_back(std::move(*proto));
                     }
                 }
 
@@ -428,6 +470,24 @@ namespace cg
 
             return meshes;
         }
+
+        GroundAssets listGroundAssets(const std::string& groundMeshPath)
+        {
+            GroundAssets assets;
+            if (groundMeshPath.empty() || !fs::exists(groundMeshPath))
+            {
+                return assets;
+            }
+            assets.tileFiles = collectTileFiles(groundMeshPath);
+            const GroundTextureSet textures = resolveGroundTextures(groundTexturesDir(groundMeshPath));
+            for (const std::string* texture : {&textures.grass, &textures.detail, &textures.stone, &textures.fallback})
+            {
+                if (!texture->empty())
+                {
+                    assets.textures.push_back(*texture);
+                }
+            }
+            return assets;
+        }
     }
 } // namespace cg
-
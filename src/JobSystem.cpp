@@ -0,0 +1,313 @@
+#include "util/JobSystem.h"
+
+#include "util/Log.h"
+
+#include <chrono>
+
+namespace cg
+{
+    struct JobSystem::Job
+    {
+        std::function<void()> fn;
+        bool mainThread{false};
+        std::atomic<int> pending{0};  // Unfinished dependencies, plus one while being created
+        std::atomic<bool> done{false};
+        std::mutex mutex;  // Guards finished and continuations
+        bool finished{false};
+        std::vector<JobHandle> continuations;
+    };
+
+    namespace
+    {
+        // Worker identity of the current thread, for pushing onto its own deque
+        thread_local const JobSystem* t_system = nullptr;
+        thread_local size_t t_worker = 0;
+    }
+
+    JobSystem& JobSystem::instance()
+    {
+        // One thread short of the hardware: the main thread works too whenever it waits
+        static JobSystem system(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return system;
+    }
+
+    JobSystem::JobSystem(size_t workerCount)
+        : m_mainThread(std::this_thread::get_id())
+    {
+        workerCount = std::max<size_t>(1, workerCount);
+        for (size_t i = 0; i < workerCount; ++i)
+        {
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        }
+        m_workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; ++i)
+        {
+            m_workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stopping = true;
+        }
+        m_workAvailable.notify_all();
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    JobSystem::JobHandle JobSystem::submit(std::function<void()> fn, const std::vector<JobHandle>& dependencies)
+    {
+        return create(std::move(fn), false, dependencies);
+    }
+
+    JobSystem::JobHandle JobSystem::submitMain(std::function<void()> fn, const std::vector<JobHandle>& dependencies)
+    {
+        return create(std::move(fn), true, dependencies);
+    }
+
+    JobSystem::JobHandle JobSystem::create(std::function<void()> fn, bool mainThread, const std::vector<JobHandle>& dependencies)
+    {
+        auto job = std::make_shared<Job>();
+        job->fn = std::move(fn);
+        job->mainThread = mainThread;
+        job->pending = 1;
+        for (const JobHandle& dependency : dependencies)
+        {
+            if (!dependency)
+            {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(dependency->mutex);
+            if (!dependency->finished)
+            {
+                dependency->continuations.push_back(job);
+                ++job->pending;
+            }
+        }
+        if (--job->pending == 0)
+        {
+            schedule(job);
+        }
+        return job;
+    }
+
+    void JobSystem::schedule(JobHandle job)
+    {
+        if (job->mainThread)
+        {
+            std::lock_guard<std::mutex> lock(m_mainQueue.mutex);
+            m_mainQueue.jobs.push_back(std::move(job));
+        }
+        else
+        {
+            WorkQueue& queue = t_system == this ? *m_queues[t_worker] : m_injection;
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(std::move(job));
+            ++m_queued;
+        }
+
+        // Taking the lock orders this against a sleeper's predicate check: no lost wakeups
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_workAvailable.notify_one();
+        if (m_waiters > 0)
+        {
+            m_progress.notify_all();
+        }
+    }
+
+    JobSystem::JobHandle JobSystem::findWork()
+    {
+        if (m_queued == 0)
+        {
+            return nullptr;
+        }
+        auto take = [this](WorkQueue& queue, bool back) -> JobHandle {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.jobs.empty())
+            {
+                return nullptr;
+            }
+            JobHandle job;
+            if (back)
+            {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            }
+            else
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            }
+            --m_queued;
+            return job;
+        };
+
+        // Own deque newest-first (its data is still in cache), then the injection queue,
+        // then steal the oldest job of another worker
+        const bool isWorker = t_system == this;
+        const size_t self = isWorker ? t_worker : 0;
+        if (isWorker)
+        {
+            if (JobHandle job = take(*m_queues[self], true))
+            {
+                return job;
+            }
+        }
+        if (JobHandle job = take(m_injection, false))
+        {
+            return job;
+        }
+        for (size_t offset = isWorker ? 1 : 0; offset < m_queues.size(); ++offset)
+        {
+            if (JobHandle job = take(*m_queues[(self + offset) % m_queues.size()], false))
+            {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    bool JobSystem::runOneMainThreadJob()
+    {
+        JobHandle job;
+        {
+            std::lock_guard<std::mutex> lock(m_mainQueue.mutex);
+            if (m_mainQueue.jobs.empty())
+            {
+                return false;
+            }
+            job = std::move(m_mainQueue.jobs.front());
+            m_mainQueue.jobs.pop_front();
+        }
+        execute(job);
+        return true;
+    }
+
+    size_t JobSystem::runMainThreadJobs()
+    {
+        // Only what is queued now: continuations queued by these jobs wait for the next call
+        size_t available = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mainQueue.mutex);
+            available = m_mainQueue.jobs.size();
+        }
+        size_t ran = 0;
+        while (ran < available && runOneMainThreadJob())
+        {
+            ++ran;
+        }
+        return ran;
+    }
+
+    void JobSystem::execute(const JobHandle& job)
+    {
+        try
+        {
+            job->fn();
+        }
+        catch (const std::exception& e)
+        {
+            log(LogLevel::Error, std::string("Exception in job: ") + e.what());
+        }
+        catch (...)
+        {
+            log(LogLevel::Error, "Exception in job: unknown exception");
+        }
+        job->fn = nullptr;  // Release captures before dependents run
+
+        std::vector<JobHandle> continuations;
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->finished = true;
+            continuations.swap(job->continuations);
+        }
+        job->done = true;
+        for (JobHandle& continuation : continuations)
+        {
+            if (--continuation->pending == 0)
+            {
+                schedule(std::move(continuation));
+            }
+        }
+        if (m_waiters > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+            }
+            m_progress.notify_all();
+        }
+    }
+
+    bool JobSystem::finished(const JobHandle& job)
+    {
+        return !job || job->done;
+    }
+
+    void JobSystem::wait(const JobHandle& job)
+    {
+        const bool mainThread = isMainThread();
+        while (!finished(job))
+        {
+            if (mainThread && runOneMainThreadJob())
+            {
+                continue;
+            }
+            if (JobHandle work = findWork())
+            {
+                execute(work);
+                continue;
+            }
+
+            // Nothing to help with: sleep until a job finishes or new work shows up
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            ++m_waiters;
+            m_progress.wait_for(lock, std::chrono::milliseconds(10), [&]() {
+                if (finished(job) || m_queued > 0)
+                {
+                    return true;
+                }
+                if (!mainThread)
+                {
+                    return false;
+                }
+                std::lock_guard<std::mutex> mainLock(m_mainQueue.mutex);
+                return !m_mainQueue.jobs.empty();
+            });
+            --m_waiters;
+        }
+    }
+
+    void JobSystem::wait(const std::vector<JobHandle>& jobs)
+    {
+        for (const JobHandle& job : jobs)
+        {
+            wait(job);
+        }
+    }
+
+    void JobSystem::workerLoop(size_t index)
+    {
+        t_system = this;
+        t_worker = index;
+        for (;;)
+        {
+            if (JobHandle job = findWork())
+            {
+                execute(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_workAvailable.wait(lock, [this]() { return m_stopping || m_queued > 0; });
+            if (m_stopping && m_queued == 0)
+            {
+                return;
+            }
+        }
+    }
+} // namespace cg
@@ -0,0 +1,72 @@
+#include "util/MemoryStats.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+namespace cg
+{
+    namespace MemoryStats
+    {
+#ifdef _WIN32
+        size_t currentResidentBytes()
+        {
+            PROCESS_MEMORY_COUNTERS counters{};
+            if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            {
+                return 0;
+            }
+            return static_cast<size_t>(counters.WorkingSetSize);
+        }
+
+        size_t peakResidentBytes()
+        {
+            PROCESS_MEMORY_COUNTERS counters{};
+            if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            {
+                return 0;
+            }
+            return static_cast<size_t>(counters.PeakWorkingSetSize);
+        }
+#else
+        size_t currentResidentBytes()
+        {
+            FILE* file = std::fopen("/proc/self/statm", "r");
+            if (!file)
+            {
+                return 0;
+            }
+            unsigned long pages = 0;
+            unsigned long resident = 0;
+            const int read = std::fscanf(file, "%lu %lu", &pages, &resident);
+            std::fclose(file);
+            return read == 2 ? static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+        }
+
+        size_t peakResidentBytes()
+        {
+            rusage usage{};
+            if (getrusage(RUSAGE_SELF, &usage) != 0)
+            {
+                return 0;
+            }
+#ifdef __APPLE__
+            return static_cast<size_t>(usage.ru_maxrss);  // bytes
+#else
+            return static_cast<size_t>(usage.ru_maxrss) * 1024;  // kilobytes
+#endif
+        }
+#endif
+    }
+} // namespace cg
@@ -0,0 +1,480 @@
+#include "loader/MeshCache.h"
+
+#include "loader/AssetBake.h"
+#include "util/FileSystem.h"
+#include "util/Log.h"
+#include "util/Parallel.h"
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace cg
+{
+    namespace MeshCache
+    {
+        namespace
+        {
+            namespace fs = std::filesystem;
+
+            constexpr char kMagic[4] = {'C', 'G', 'M', 'S'};
+            constexpr uint32_t kVersion = 4;
+            constexpr uint64_t kAlignment = 16;
+
+            static_assert(std::is_trivially_copyable_v<Vertex>, "Vertex is written to the cache as raw bytes");
+
+            // Layout: header, mesh records, dependency records, string table, then per mesh a vertex and an index
+            // section (raw) or a single Draco section, every section starting on a kAlignment
+            // boundary.
+            struct FileHeader
+            {
+                char magic[4]{};
+                uint32_t version{0};
+                uint64_t sourceSize{0};
+                int64_t sourceTime{0};
+                uint32_t layout{0};
+                uint32_t meshCount{0};
+                uint32_t vertexStride{0};
+                uint32_t compression{0};
+                uint64_t stringsOffset{0};
+                uint64_t stringsSize{0};
+                uint64_t fileSize{0};
+                uint32_t dependencyCount{0};
+                // DracoMeshCodec::Options the sections were encoded with; zero when uncompressed
+                int32_t dracoSpeed{0};
+                int32_t dracoPositionBits{0};
+                int32_t dracoNormalBits{0};
+                int32_t dracoUvBits{0};
+                int32_t dracoColorBits{0};
+            };
+
+            struct DependencyRecord
+            {
+                uint64_t size{0};
+                int64_t time{0};
+                uint32_t pathOffset{0};
+                uint32_t pathLength{0};
+            };
+
+            enum class Encoding : uint32_t
+            {
+                Raw = 0,
+                Draco = 1
+            };
+
+            // Draco records keep their blob in vertexOffset/encodedSize; the counts stay zero
+            // since welding only settles the final vertex count during encoding. Instances
+            // (instanceOf = source index + 1) have no sections at all.
+            struct MeshRecord
+            {
+                uint32_t encoding{0};
+                uint32_t instanceOf{0};
+                uint64_t encodedSize{0};
+                uint64_t vertexOffset{0};
+                uint64_t vertexCount{0};
+                uint64_t indexOffset{0};
+                uint64_t indexCount{0};
+                uint32_t nameOffset{0};
+                uint32_t nameLength{0};
+                uint32_t textureOffset{0};
+                uint32_t textureLength{0};
+                float transform[16]{};
+            };
+
+            Options g_options;
+
+            uint64_t alignUp(uint64_t value)
+            {
+                return (value + kAlignment - 1) / kAlignment * kAlignment;
+            }
+
+            // Returns false when the source model cannot be stat'ed; everything but the
+            // source size and time is filled in either way
+            bool makeHeader(const std::string& sourcePath, Layout layout, FileHeader& header)
+            {
+                std::memcpy(header.magic, kMagic, sizeof(header.magic));
+                header.version = kVersion;
+                header.layout = static_cast<uint32_t>(layout);
+                header.vertexStride = static_cast<uint32_t>(sizeof(Vertex));
+                header.compression = static_cast<uint32_t>(g_options.compression);
+                if (g_options.compression == Compression::Draco)
+                {
+                    header.dracoSpeed = g_options.draco.speed;
+                    header.dracoPositionBits = g_options.draco.positionBits;
+                    header.dracoNormalBits = g_options.draco.normalBits;
+                    header.dracoUvBits = g_options.draco.uvBits;
+                    header.dracoColorBits = g_options.draco.colorBits;
+                }
+
+                std::error_code ec;
+                const auto size = fs::file_size(sourcePath, ec);
+                if (ec) return false;
+                const auto time = fs::last_write_time(sourcePath, ec);
+                if (ec) return false;
+                header.sourceSize = static_cast<uint64_t>(size);
+                header.sourceTime = static_cast<int64_t>(time.time_since_epoch().count());
+                return true;
+            }
+
+            std::string megabytes(uint64_t bytes)
+            {
+                return std::to_string(bytes / 1024 / 1024) + "." + std::to_string(bytes * 10 / 1024 / 1024 % 10) + "MB";
+            }
+
+            void pad(std::ofstream& file, uint64_t& offset)
+            {
+                static const char zeros[kAlignment]{};
+                const uint64_t aligned = alignUp(offset);
+                file.write(zeros, static_cast<std::streamsize>(aligned - offset));
+                offset = aligned;
+            }
+
+            bool sameDracoOptions(const FileHeader& a, const FileHeader& b)
+            {
+                return a.dracoSpeed == b.dracoSpeed && a.dracoPositionBits == b.dracoPositionBits &&
+                       a.dracoNormalBits == b.dracoNormalBits && a.dracoUvBits == b.dracoUvBits &&
+                       a.dracoColorBits == b.dracoColorBits;
+            }
+
+            // validateSource also checks the dependency stamps and rejects caches written with
+            // other compression settings (Draco quantization included); baked files are taken
+            // as they are
+            std::optional<std::vector<Mesh>> readFile(const std::string& path, const FileHeader& expected, bool validateSource)
+            {
+                const auto start = std::chrono::high_resolution_clock::now();
+                MappedFile file;
+                if (!file.open(path) || file.size() < sizeof(FileHeader))
+                {
+                    return std::nullopt;
+                }
+
+                FileHeader header;
+                std::memcpy(&header, file.data(), sizeof(header));
+                if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+                    header.version != expected.version ||
+                    header.layout != expected.layout ||
+                    header.vertexStride != expected.vertexStride ||
+                    header.fileSize != file.size() ||
+                    (validateSource && (header.sourceSize != expected.sourceSize ||
+                                    header.sourceTime != expected.sourceTime ||
+                                    header.compression != expected.compression ||
+                                    !sameDracoOptions(header, expected))))
+                {
+                    log(LogLevel::Info, "Mesh cache is stale, rebuilding: " + path);
+                    return std::nullopt;
+                }
+
+                const uint64_t dependenciesOffset = sizeof(FileHeader) + static_cast<uint64_t>(header.meshCount) * sizeof(MeshRecord);
+                const uint64_t recordsEnd = dependenciesOffset + static_cast<uint64_t>(header.dependencyCount) * sizeof(DependencyRecord);
+                if (recordsEnd > file.size() || header.stringsOffset + header.stringsSize > file.size())
+                {
+                    log(LogLevel::Warn, "Mesh cache is corrupt: " + path);
+                    return std::nullopt;
+                }
+                const char* strings = file.data() + header.stringsOffset;
+
+                for (uint32_t i = 0; validateSource && i < header.dependencyCount; ++i)
+                {
+                    DependencyRecord record;
+                    std::memcpy(&record, file.data() + dependenciesOffset + i * sizeof(DependencyRecord), sizeof(record));
+                    if (static_cast<uint64_t>(record.pathOffset) + record.pathLength > header.stringsSize)
+                    {
+                        log(LogLevel::Warn, "Mesh cache is corrupt: " + path);
+                        return std::nullopt;
+                    }
+                    const AssetBake::Dependency current = AssetBake::dependencyStamp(std::string(strings + record.pathOffset, record.pathLength));
+                    if (current.size != record.size || current.time != record.time)
+                    {
+                        log(LogLevel::Info, "Mesh cache is stale (" + current.path + " changed), rebuilding: " + path);
+                        return std::nullopt;
+                    }
+                }
+
+                std::vector<Mesh> meshes(header.meshCount);
+                std::vector<MeshRecord> encoded;
+                std::vector<size_t> encodedMeshes;
+                uint64_t encodedBytes = 0;
+                for (uint32_t i = 0; i < header.meshCount; ++i)
+                {
+                    MeshRecord record;
+                    std::memcpy(&record, file.data() + sizeof(FileHeader) + i * sizeof(MeshRecord), sizeof(record));
+                    const bool isDraco = record.encoding == static_cast<uint32_t>(Encoding::Draco);
+                    const uint64_t vertexBytes = isDraco ? record.encodedSize : record.vertexCount * sizeof(Vertex);
+                    const uint64_t indexBytes = record.indexCount * sizeof(uint32_t);
+                    if ((!isDraco && record.encoding != static_cast<uint32_t>(Encoding::Raw)) ||
+                        record.vertexOffset + vertexBytes > file.size() || record.indexOffset + indexBytes > file.size() ||
+                        static_cast<uint64_t>(record.nameOffset) + record.nameLength > header.stringsSize ||
+                        static_cast<uint64_t>(record.textureOffset) + record.textureLength > header.stringsSize ||
+                        record.instanceOf > i)
+                    {
+                        log(LogLevel::Warn, "Mesh cache is corrupt: " + path);
+                        return std::nullopt;
+                    }
+
+                    Mesh& mesh = meshes[i];
+                    mesh.name.assign(strings + record.nameOffset, record.nameLength);
+                    mesh.diffuseTexture.assign(strings + record.textureOffset, record.textureLength);
+                    std::memcpy(&mesh.transform[0][0], record.transform, sizeof(record.transform));
+                    mesh.instanceOf = static_cast<int>(record.instanceOf) - 1;
+                    if (isDraco)
+                    {
+                        encoded.push_back(record);
+                        encodedMeshes.push_back(i);
+                        encodedBytes += record.encodedSize;
+                        continue;
+                    }
+                    mesh.vertices.resize(static_cast<size_t>(record.vertexCount));
+                    std::memcpy(mesh.vertices.data(), file.data() + record.vertexOffset, static_cast<size_t>(vertexBytes));
+                    mesh.indices.resize(static_cast<size_t>(record.indexCount));
+                    std::memcpy(mesh.indices.data(), file.data() + record.indexOffset, static_cast<size_t>(indexBytes));
+                }
+
+                long long decodeTime = 0;
+                if (!encoded.empty())
+                {
+                    const auto decodeStart = std::chrono::high_resolution_clock::now();
+                    std::atomic<bool> decoded{true};
+                    parallelFor(encoded.size(), [&](size_t i) {
+                        const MeshRecord& record = encoded[i];
+                        if (!DracoMeshCodec::decode(file.data() + record.vertexOffset, static_cast<size_t>(record.encodedSize), meshes[encodedMeshes[i]]))
+                        {
+                            decoded = false;
+                        }
+                    });
+                    if (!decoded)
+                    {
+                        log(LogLevel::Warn, "Mesh cache could not be decoded: " + path);
+                        return std::nullopt;
+                    }
+                    decodeTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - decodeStart).count();
+                }
+
+                const auto end = std::chrono::high_resolution_clock::now();
+                const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+                std::string message = "Loaded " + std::to_string(meshes.size()) + " meshes from cache " + path +
+                    " time: " + std::to_string(duration.count()) + "ms";
+                if (!encoded.empty())
+                {
+                    uint64_t decodedBytes = 0;
+                    for (const size_t index : encodedMeshes)
+                    {
+                        decodedBytes += meshes[index].vertices.size() * sizeof(Vertex) + meshes[index].indices.size() * sizeof(uint32_t);
+                    }
+                    message += " (Draco " + megabytes(encodedBytes) + " -> " + megabytes(decodedBytes) +
+                        ", decode " + std::to_string(decodeTime) + "ms)";
+                }
+                log(LogLevel::Info, message);
+                return meshes;
+            }
+        } // namespace
+
+        void configure(const Options& options)
+        {
+            g_options = options;
+            if (g_options.compression == Compression::Draco && !DracoMeshCodec::available())
+            {
+                log(LogLevel::Warn, "Draco mesh cache compression requested but this build has no Draco support; caches stay uncompressed");
+                g_options.compression = Compression::None;
+            }
+        }
+
+        std::string cachePath(const std::string& sourcePath)
+        {
+            return fs::path(sourcePath).replace_extension(".cgmesh").string();
+        }
+
+        std::string bakeVariant(Layout layout)
+        {
+            switch (layout)
+            {
+            case Layout::PerMaterial: return "mesh.materials";
+            case Layout::ImportedScene: return "mesh.scene";
+            default: return "mesh.single";
+            }
+        }
+
+        std::optional<std::vector<Mesh>> load(const std::string& sourcePath, Layout layout)
+        {
+            if (const auto baked = AssetBake::find(sourcePath, bakeVariant(layout)))
+            {
+                if (auto meshes = loadFile(*baked, layout))
+                {
+                    return meshes;
+                }
+            }
+
+            FileHeader expected;
+            if (!makeHeader(sourcePath, layout, expected))
+            {
+                if (fs::exists(cachePath(sourcePath)))
+                {
+                    log(LogLevel::Warn, "Source model missing, ignoring its mesh cache: " + cachePath(sourcePath));
+                }
+                return std::nullopt;
+            }
+            return readFile(cachePath(sourcePath), expected, true);
+        }
+
+        std::optional<std::vector<Mesh>> loadFile(const std::string& path, Layout layout)
+        {
+            FileHeader expected;
+            makeHeader({}, layout, expected);
+            return readFile(path, expected, false);
+        }
+
+        void store(const std::string& sourcePath, const std::vector<std::string>& dependencies, Layout layout,
+                   const Mesh* meshes, size_t count)
+        {
+            storeFile(cachePath(sourcePath), sourcePath, dependencies, layout, meshes, count);
+        }
+
+        bool storeFile(const std::string& path, const std::string& sourcePath, const std::vector<std::string>& dependencies,
+                       Layout layout, const Mesh* meshes, size_t count)
+        {
+            FileHeader header;
+            if (!makeHeader(sourcePath, layout, header))
+            {
+                return false;
+            }
+            header.meshCount = static_cast<uint32_t>(count);
+            header.dependencyCount = static_cast<uint32_t>(dependencies.size());
+
+            // Encode up front so the section sizes are known; meshes Draco rejects stay raw
+            std::vector<std::vector<char>> encoded(count);
+            long long encodeTime = 0;
+            if (g_options.compression == Compression::Draco)
+            {
+                const auto encodeStart = std::chrono::high_resolution_clock::now();
+                parallelFor(count, [&](size_t i) {
+                    if (meshes[i].instanceOf >= 0 || !DracoMeshCodec::encode(meshes[i], g_options.draco, encoded[i]))
+                    {
+                        encoded[i].clear();
+                    }
+                });
+                encodeTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - encodeStart).count();
+            }
+
+            // Lay out every section before writing anything
+            std::string strings;
+            std::vector<DependencyRecord> dependencyRecords(dependencies.size());
+            for (size_t i = 0; i < dependencies.size(); ++i)
+            {
+                const AssetBake::Dependency stamp = AssetBake::dependencyStamp(dependencies[i]);
+                DependencyRecord& record = dependencyRecords[i];
+                record.size = stamp.size;
+                record.time = stamp.time;
+                record.pathOffset = static_cast<uint32_t>(strings.size());
+                record.pathLength = static_cast<uint32_t>(dependencies[i].size());
+                strings += dependencies[i];
+            }
+            std::vector<MeshRecord> records(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Mesh& mesh = meshes[i];
+                MeshRecord& record = records[i];
+                record.nameOffset = static_cast<uint32_t>(strings.size());
+                record.nameLength = static_cast<uint32_t>(mesh.name.size());
+                strings += mesh.name;
+                record.textureOffset = static_cast<uint32_t>(strings.size());
+                record.textureLength = static_cast<uint32_t>(mesh.diffuseTexture.size());
+                strings += mesh.diffuseTexture;
+                if (mesh.instanceOf >= 0 && static_cast<size_t>(mesh.instanceOf) < i)
+                {
+                    record.instanceOf = static_cast<uint32_t>(mesh.instanceOf) + 1;
+                }
+                else if (!encoded[i].empty())
+                {
+                    record.encoding = static_cast<uint32_t>(Encoding::Draco);
+                    record.encodedSize = encoded[i].size();
+                }
+                else
+                {
+                    record.vertexCount = mesh.vertices.size();
+                    record.indexCount = mesh.indices.size();
+                }
+                std::memcpy(record.transform, &mesh.transform[0][0], sizeof(record.transform));
+            }
+
+            uint64_t offset = sizeof(FileHeader) + static_cast<uint64_t>(count) * sizeof(MeshRecord) +
+                dependencyRecords.size() * sizeof(DependencyRecord);
+            header.stringsOffset = offset;
+            header.stringsSize = strings.size();
+            offset += strings.size();
+            for (auto& record : records)
+            {
+                if (record.encoding == static_cast<uint32_t>(Encoding::Draco))
+                {
+                    record.vertexOffset = alignUp(offset);
+                    offset = record.vertexOffset + record.encodedSize;
+                    continue;
+                }
+                record.vertexOffset = alignUp(offset);
+                offset = record.vertexOffset + record.vertexCount * sizeof(Vertex);
+                record.indexOffset = alignUp(offset);
+                offset = record.indexOffset + record.indexCount * sizeof(uint32_t);
+            }
+            header.fileSize = offset;
+
+            const std::string tempPath = path + ".tmp";
+            std::error_code ec;
+            bool written = false;
+            {
+                std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(MeshRecord)));
+                file.write(reinterpret_cast<const char*>(dependencyRecords.data()),
+                           static_cast<std::streamsize>(dependencyRecords.size() * sizeof(DependencyRecord)));
+                file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+                offset = header.stringsOffset + strings.size();
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (!encoded[i].empty())
+                    {
+                        pad(file, offset);
+                        file.write(encoded[i].data(), static_cast<std::streamsize>(encoded[i].size()));
+                        offset += encoded[i].size();
+                        continue;
+                    }
+                    pad(file, offset);
+                    file.write(reinterpret_cast<const char*>(meshes[i].vertices.data()), static_cast<std::streamsize>(records[i].vertexCount * sizeof(Vertex)));
+                    offset += records[i].vertexCount * sizeof(Vertex);
+                    pad(file, offset);
+                    file.write(reinterpret_cast<const char*>(meshes[i].indices.data()), static_cast<std::streamsize>(records[i].indexCount * sizeof(uint32_t)));
+                    offset += records[i].indexCount * sizeof(uint32_t);
+                }
+                written = file.good();
+            }
+            if (!written)
+            {
+                log(LogLevel::Warn, "Failed to write mesh cache: " + path);
+                fs::remove(tempPath, ec);
+                return false;
+            }
+
+            fs::rename(tempPath, path, ec);
+            if (ec)
+            {
+                log(LogLevel::Warn, "Failed to write mesh cache: " + path + " (" + ec.message() + ")");
+                fs::remove(tempPath, ec);
+                return false;
+            }
+            if (g_options.compression == Compression::Draco)
+            {
+                uint64_t rawBytes = 0;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    rawBytes += meshes[i].vertices.size() * sizeof(Vertex) + meshes[i].indices.size() * sizeof(uint32_t);
+                }
+                log(LogLevel::Info, "Wrote mesh cache: " + path + " (Draco " + megabytes(rawBytes) + " -> " +
+                    megabytes(header.fileSize) + ", encode " + std::to_string(encodeTime) + "ms)");
+                return true;
+            }
+            log(LogLevel::Info, "Wrote mesh cache: " + path);
+            return true;
+        }
+    }
+} // namespace cg
@@ -2,11 +2,43 @@
 
 #include <glm/glm.hpp>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
 
 namespace cg
 {
     namespace MeshUtils
     {
+        namespace
+        {
+            static_assert(sizeof(Vertex) % sizeof(uint32_t) == 0, "Vertex is hashed as 32-bit words");
+
+            // Bitwise identity: only vertices that are byte-for-byte equal get merged
+            struct VertexHash
+            {
+                size_t operator()(const Vertex& vertex) const
+                {
+                    uint32_t words[sizeof(Vertex) / sizeof(uint32_t)];
+                    std::memcpy(words, &vertex, sizeof(Vertex));
+                    uint64_t hash = 1469598103934665603ull;
+                    for (const uint32_t word : words)
+                    {
+                        hash = (hash ^ word) * 1099511628211ull;
+                    }
+                    return static_cast<size_t>(hash ^ (hash >> 32));
+                }
+            };
+
+            struct VertexEqual
+            {
+                bool operator()(const Vertex& a, const Vertex& b) const
+                {
+                    return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+                }
+            };
+        } // namespace
+
         MeshBounds computeBounds(const Mesh& mesh)
         {
             MeshBounds bounds;
@@ -85,6 +117,33 @@ namespace cg
                 vertex.normal = glm::normalize(glm::vec3(vertex.normal.x, vertex.normal.z, vertex.normal.y));
             }
         }
+
+        void weldVertices(Mesh& mesh)
+        {
+            if (mesh.indices.empty())
+            {
+                return;
+            }
+
+            std::unordered_map<Vertex, uint32_t, VertexHash, VertexEqual> unique;
+            unique.reserve(mesh.vertices.size());
+            std::vector<Vertex> welded;
+            welded.reserve(mesh.vertices.size());
+            std::vector<uint32_t> remap(mesh.vertices.size());
+            for (size_t i = 0; i < mesh.vertices.size(); ++i)
+            {
+                const auto [it, inserted] = unique.try_emplace(mesh.vertices[i], static_cast<uint32_t>(welded.size()));
+                if (inserted)
+                {
+                    welded.push_back(mesh.vertices[i]);
+                }
+                remap[i] = it->second;
+            }
+            for (auto& index : mesh.indices)
+            {
+                index = remap[index];
+            }
+            mesh.vertices = std::move(welded);
+        }
     }
 } // namespace cg
-
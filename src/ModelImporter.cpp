@@ -0,0 +1,327 @@
+#include "loader/ModelImporter.h"
+
+#include "loader/MeshCache.h"
+#include "loader/ObjParser.h"
+#include "util/DirectoryIndex.h"
+#include "util/FileSystem.h"
+#include "util/Log.h"
+#include "util/Parallel.h"
+
+#ifdef CG_HAS_ASSIMP
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#endif
+
+#include <rapidjson/document.h>
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+
+namespace cg
+{
+    namespace ModelImporter
+    {
+        namespace
+        {
+            namespace fs = std::filesystem;
+
+            std::string lowerExtension(const std::string& path)
+            {
+                std::string extension = fs::path(path).extension().string();
+                std::transform(extension.begin(), extension.end(), extension.begin(),
+                    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                return extension;
+            }
+
+#ifdef CG_HAS_ASSIMP
+            // No aiProcess_PreTransformVertices or OptimizeGraph: both would flatten instances
+            constexpr unsigned kImportFlags = aiProcess_Triangulate |
+                aiProcess_JoinIdenticalVertices |
+                aiProcess_GenSmoothNormals |
+                aiProcess_SortByPType |
+                aiProcess_ImproveCacheLocality;
+
+            glm::mat4 toGlm(const aiMatrix4x4& m)
+            {
+                // aiMatrix4x4 is row-major, glm column-major
+                glm::mat4 result(1.0f);
+                for (int row = 0; row < 4; ++row)
+                {
+                    for (int column = 0; column < 4; ++column)
+                    {
+                        result[column][row] = m[row][column];
+                    }
+                }
+                return result;
+            }
+
+            struct NodeMesh
+            {
+                unsigned mesh{0};
+                glm::mat4 transform{1.0f};
+                std::string name;
+            };
+
+            void collectNodes(const aiNode* node, const glm::mat4& parent, std::vector<NodeMesh>& out)
+            {
+                const glm::mat4 transform = parent * toGlm(node->mTransformation);
+                for (unsigned i = 0; i < node->mNumMeshes; ++i)
+                {
+                    std::string name = node->mName.C_Str();
+                    if (node->mNumMeshes > 1)
+                    {
+                        name += "_" + std::to_string(i);
+                    }
+                    out.push_back({node->mMeshes[i], transform, std::move(name)});
+                }
+                for (unsigned i = 0; i < node->mNumChildren; ++i)
+                {
+                    collectNodes(node->mChildren[i], transform, out);
+                }
+            }
+
+            struct MaterialInfo
+            {
+                glm::vec3 color{0.2f, 0.2f, 0.2f};
+                std::string texture;
+            };
+
+            // Same lookup order as ObjLoader: next to the model, then anywhere below it by
+            // file name (FBX exports often carry absolute paths from the exporting machine)
+            std::string resolveTexture(const std::string& baseDir, const std::string& reference)
+            {
+                const fs::path relative = fs::path(baseDir) / reference;
+                std::error_code ec;
+                if (fs::exists(relative, ec))
+                {
+                    return relative.generic_string();
+                }
+                if (auto indexed = DirectoryIndex::findFile(baseDir, fs::path(reference).filename().string()))
+                {
+                    return *indexed;
+                }
+                return {};
+            }
+
+            MaterialInfo readMaterial(const aiMaterial* material, const std::string& baseDir)
+            {
+                MaterialInfo info;
+                aiColor4D color;
+                if (material->Get(AI_MATKEY_BASE_COLOR, color) == AI_SUCCESS ||
+                    material->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS)
+                {
+                    if (color.r > 0.0f || color.g > 0.0f || color.b > 0.0f)
+                    {
+                        info.color = glm::vec3(color.r, color.g, color.b);
+                    }
+                }
+
+                aiString reference;
+                if (material->GetTexture(aiTextureType_BASE_COLOR, 0, &reference) != AI_SUCCESS &&
+                    material->GetTexture(aiTextureType_DIFFUSE, 0, &reference) != AI_SUCCESS)
+                {
+                    return info;
+                }
+                const std::string name = reference.C_Str();
+                if (!name.empty() && name[0] == '*')
+                {
+                    log(LogLevel::Warn, "Embedded texture " + name + " is not supported (mesh will use vertex colors)");
+                    return info;
+                }
+                info.texture = resolveTexture(baseDir, name);
+                if (info.texture.empty())
+                {
+                    log(LogLevel::Warn, "Texture not found: " + name + " (mesh will use vertex colors)");
+                }
+                return info;
+            }
+
+            void convertMesh(const aiMesh* source, const MaterialInfo& material, Mesh& mesh)
+            {
+                mesh.diffuseTexture = material.texture;
+                mesh.vertices.resize(source->mNumVertices);
+                const bool hasColors = source->HasVertexColors(0);
+                const bool hasUvs = source->HasTextureCoords(0);
+                for (unsigned i = 0; i < source->mNumVertices; ++i)
+                {
+                    Vertex& vertex = mesh.vertices[i];
+                    vertex.position = glm::vec3(source->mVertices[i].x, source->mVertices[i].y, source->mVertices[i].z);
+                    if (source->mNormals)
+                    {
+                        vertex.normal = glm::vec3(source->mNormals[i].x, source->mNormals[i].y, source->mNormals[i].z);
+                    }
+                    if (hasUvs)
+                    {
+                        vertex.uv = glm::vec2(source->mTextureCoords[0][i].x, source->mTextureCoords[0][i].y);
+                    }
+                    vertex.color = hasColors
+                        ? glm::vec3(source->mColors[0][i].r, source->mColors[0][i].g, source->mColors[0][i].b)
+                        : material.color;
+                }
+
+                mesh.indices.reserve(static_cast<size_t>(source->mNumFaces) * 3);
+                for (unsigned f = 0; f < source->mNumFaces; ++f)
+                {
+                    const aiFace& face = source->mFaces[f];
+                    if (face.mNumIndices != 3)
+                    {
+                        continue;  // Points and lines left over by SortByPType
+                    }
+                    mesh.indices.insert(mesh.indices.end(), face.mIndices, face.mIndices + 3);
+                }
+            }
+#endif
+        } // namespace
+
+        bool supports(const std::string& path)
+        {
+            const std::string extension = lowerExtension(path);
+            return extension == ".fbx" || extension == ".gltf" || extension == ".glb";
+        }
+
+        bool available()
+        {
+#ifdef CG_HAS_ASSIMP
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        std::vector<Mesh> loadScene(const std::string& path)
+        {
+            if (auto cached = MeshCache::load(path, MeshCache::Layout::ImportedScene))
+            {
+                return std::move(*cached);
+            }
+#ifdef CG_HAS_ASSIMP
+            const auto start = std::chrono::high_resolution_clock::now();
+            if (!fs::exists(path))
+            {
+                log(LogLevel::Error, "Model not found: " + path);
+                return {};
+            }
+
+            Assimp::Importer importer;
+            // Drop point and line primitives instead of turning them into meshes
+            importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+            const aiScene* scene = importer.ReadFile(path, kImportFlags);
+            if (!scene || !scene->mRootNode || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE))
+            {
+                log(LogLevel::Error, "Failed to import " + path + ": " + importer.GetErrorString());
+                return {};
+            }
+            const auto parseEnd = std::chrono::high_resolution_clock::now();
+
+            std::vector<NodeMesh> nodes;
+            collectNodes(scene->mRootNode, glm::mat4(1.0f), nodes);
+
+            const std::string baseDir = fs::path(path).parent_path().string();
+            std::vector<MaterialInfo> materials;
+            materials.reserve(scene->mNumMaterials);
+            for (unsigned i = 0; i < scene->mNumMaterials; ++i)
+            {
+                materials.push_back(readMaterial(scene->mMaterials[i], baseDir));
+            }
+
+            // The first node referencing an aiMesh owns its geometry; later ones instance it
+            std::vector<Mesh> meshes(nodes.size());
+            std::vector<size_t> owners;
+            std::unordered_map<unsigned, size_t> ownerOf;
+            for (size_t i = 0; i < nodes.size(); ++i)
+            {
+                Mesh& mesh = meshes[i];
+                mesh.name = nodes[i].name;
+                mesh.transform = nodes[i].transform;
+                const auto [it, inserted] = ownerOf.try_emplace(nodes[i].mesh, i);
+                if (inserted)
+                {
+                    owners.push_back(i);
+                    continue;
+                }
+                mesh.instanceOf = static_cast<int>(it->second);
+                mesh.diffuseTexture = materials[scene->mMeshes[nodes[i].mesh]->mMaterialIndex].texture;
+            }
+
+            parallelFor(owners.size(), [&](size_t o) {
+                const size_t i = owners[o];
+                const aiMesh* source = scene->mMeshes[nodes[i].mesh];
+                convertMesh(source, materials[source->mMaterialIndex], meshes[i]);
+            });
+
+            size_t vertexCount = 0;
+            size_t triangleCount = 0;
+            for (const size_t i : owners)
+            {
+                vertexCount += meshes[i].vertices.size();
+                triangleCount += meshes[i].indices.size() / 3;
+            }
+            const auto end = std::chrono::high_resolution_clock::now();
+            log(LogLevel::Info, "Imported " + path + ": " + std::to_string(meshes.size()) + " meshes (" +
+                std::to_string(meshes.size() - owners.size()) + " instances), " + std::to_string(vertexCount) + " vertices, " +
+                std::to_string(triangleCount) + " triangles; parse " +
+                std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(parseEnd - start).count()) + "ms, convert " +
+                std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(end - parseEnd).count()) + "ms");
+
+            MeshCache::store(path, dependencies(path), MeshCache::Layout::ImportedScene, meshes.data(), meshes.size());
+            return meshes;
+#else
+            log(LogLevel::Error, "Cannot import " + path + ": this build has no FBX/glTF support (CG_ENABLE_ASSIMP)");
+            return {};
+#endif
+        }
+
+        std::vector<std::string> dependencies(const std::string& path)
+        {
+            std::vector<std::string> files;
+            const std::string extension = lowerExtension(path);
+            if (extension != ".gltf" && extension != ".obj")
+            {
+                return files;
+            }
+
+            MappedFile file;
+            if (!file.open(path))
+            {
+                return files;
+            }
+            if (extension == ".obj")
+            {
+                // Same base directory ObjLoader hands the parser
+                return ObjParser::materialLibraries(file.data(), file.size(), fs::path(path).parent_path().string());
+            }
+            rapidjson::Document document;
+            document.Parse(file.data(), file.size());
+            if (document.HasParseError() || !document.IsObject())
+            {
+                return files;
+            }
+
+            // Images are baked on their own; data: URIs are part of the file itself
+            const auto buffers = document.FindMember("buffers");
+            if (buffers == document.MemberEnd() || !buffers->value.IsArray())
+            {
+                return files;
+            }
+            const fs::path baseDir = fs::path(path).parent_path();
+            for (const auto& buffer : buffers->value.GetArray())
+            {
+                if (!buffer.IsObject() || !buffer.HasMember("uri") || !buffer["uri"].IsString())
+                {
+                    continue;
+                }
+                const std::string uri = buffer["uri"].GetString();
+                if (uri.rfind("data:", 0) != 0)
+                {
+                    files.push_back((baseDir / uri).generic_string());
+                }
+            }
+            return files;
+        }
+    }
+} // namespace cg
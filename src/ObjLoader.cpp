@@ -1,19 +1,19 @@
 #include "loader/ObjLoader.h"
+#include "loader/MeshCache.h"
+#include "loader/ObjParser.h"
 #include "util/MeshUtils.h"
+#include "util/DirectoryIndex.h"
+#include "util/FileSystem.h"
 #include "util/Log.h"
+#include "util/Parallel.h"
 
 #include <glm/glm.hpp>
 #include <filesystem>
-#include <fstream>
-#include <sstream>
 #include <vector>
-#include <map>
 #include <algorithm>
 #include <cctype>
 #include <chrono>
-
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
+#include <limits>
 
 namespace cg
 {
@@ -21,6 +21,8 @@ namespace cg
     {
         namespace
         {
+            // Faces per unit of work when bucketing faces by material
+            constexpr size_t kFacesPerRange = 1 << 16;
         }
 
         std::optional<Mesh> loadObjAsMesh(const std::string& path)
@@ -31,6 +33,11 @@ namespace cg
             }
 
             const std::filesystem::path filePath(path);
+            if (auto cached = MeshCache::load(path, MeshCache::Layout::SingleMesh); cached && cached->size() == 1)
+            {
+                return std::move(cached->front());
+            }
+
             if (!std::filesystem::exists(filePath))
             {
                 log(LogLevel::Error, "OBJ not found: " + path);
@@ -44,47 +51,26 @@ namespace cg
             std::string err;
             const std::string baseDir = filePath.parent_path().string();
 
-            // Optimized: read entire file into memory first, then parse from memory
-            std::ifstream fileStream(path, std::ios::binary | std::ios::ate);
-            if (!fileStream)
+            // Parse straight from the page cache
+            MappedFile file;
+            if (!file.open(path))
             {
                 log(LogLevel::Error, "Cannot open OBJ file: " + path);
                 return std::nullopt;
             }
             
-            std::streamsize fileSize = fileStream.tellg();
-            fileStream.seekg(0, std::ios::beg);
-            
-            std::vector<char> fileBuffer(static_cast<size_t>(fileSize));
-            if (!fileStream.read(fileBuffer.data(), fileSize))
-            {
-                log(LogLevel::Error, "Failed to read OBJ file: " + path);
-                return std::nullopt;
-            }
-            fileStream.close();
-            
-            // Parse from memory stream
-            std::istringstream objStream(std::string(fileBuffer.data(), static_cast<size_t>(fileSize)));
-            tinyobj::MaterialFileReader matFileReader(baseDir);
-            
-            const bool loaded = tinyobj::LoadObj(
-                &attrib,
-                &shapes,
-                &materials,
-                &warn,
-                &err,
-                &objStream,
-                &matFileReader,
-                true);
+            const bool loaded = ObjParser::parse(file.data(), file.size(), baseDir, attrib, shapes, materials, warn, err);
+            const std::vector<std::string> materialLibraries = ObjParser::materialLibraries(file.data(), file.size(), baseDir);
+            file.close();
 
             if (!warn.empty())
             {
-                log(LogLevel::Warn, "TinyObjLoader warn: " + warn);
+                log(LogLevel::Warn, "OBJ parser warn: " + warn);
             }
 
             if (!loaded)
             {
-                log(LogLevel::Error, "TinyObjLoader failed: " + err);
+                log(LogLevel::Error, "OBJ parser failed: " + err);
                 return std::nullopt;
             }
 
@@ -223,6 +209,7 @@ namespace cg
 
             mesh.transform = glm::mat4(1.0f);
             log(LogLevel::Info, "Loaded OBJ '" + mesh.name + "' (" + std::to_string(mesh.vertices.size()) + " verts)");
+            MeshCache::store(path, materialLibraries, MeshCache::Layout::SingleMesh, &mesh, 1);
             return mesh;
         }
 
@@ -236,16 +223,22 @@ namespace cg
             }
 
             const std::filesystem::path filePath(path);
+
+            // Record loading start time
+            std::chrono::high_resolution_clock::time_point loadStart = std::chrono::high_resolution_clock::now();
+            log(LogLevel::Info, "Starting to load model: " + path);
+
+            if (auto cached = MeshCache::load(path, MeshCache::Layout::PerMaterial))
+            {
+                return std::move(*cached);
+            }
+
             if (!std::filesystem::exists(filePath))
             {
                 log(LogLevel::Error, "OBJ not found: " + path);
                 return meshes;
             }
 
-            // Record loading start time
-            std::chrono::high_resolution_clock::time_point loadStart = std::chrono::high_resolution_clock::now();
-            log(LogLevel::Info, "Starting to load model: " + path);
-
             tinyobj::attrib_t attrib;
             std::vector<tinyobj::shape_t> shapes;
             std::vector<tinyobj::material_t> materials;
@@ -253,266 +246,236 @@ namespace cg
             std::string err;
             const std::string baseDir = filePath.parent_path().string();
 
-            // Optimized file reading: read entire file into memory first, then parse from memory
+            // Map the OBJ file; the parser reads it straight from the page cache
             std::chrono::high_resolution_clock::time_point fileReadStart = std::chrono::high_resolution_clock::now();
-            
-            // Read entire OBJ file into memory in one operation
-            std::ifstream fileStream(path, std::ios::binary | std::ios::ate);
-            if (!fileStream)
+            MappedFile file;
+            if (!file.open(path))
             {
                 log(LogLevel::Error, "Cannot open OBJ file: " + path);
                 return meshes;
             }
             
-            std::streamsize fileSize = fileStream.tellg();
-            fileStream.seekg(0, std::ios::beg);
-            
-            std::vector<char> fileBuffer(static_cast<size_t>(fileSize));
-            if (!fileStream.read(fileBuffer.data(), fileSize))
-            {
-                log(LogLevel::Error, "Failed to read OBJ file: " + path);
-                return meshes;
-            }
-            fileStream.close();
-            
             std::chrono::high_resolution_clock::time_point fileReadEnd = std::chrono::high_resolution_clock::now();
             long long fileReadTime = std::chrono::duration_cast<std::chrono::milliseconds>(fileReadEnd - fileReadStart).count();
-            log(LogLevel::Info, "File read into memory, time: " + std::to_string(fileReadTime) + "ms, size: " + 
-                std::to_string(fileSize / 1024 / 1024) + "MB");
-            
-            // Parse from memory stream (much faster than reading from disk line by line)
-            std::istringstream objStream(std::string(fileBuffer.data(), static_cast<size_t>(fileSize)));
-            tinyobj::MaterialFileReader matFileReader(baseDir);
+            log(LogLevel::Info, "File mapped, time: " + std::to_string(fileReadTime) + "ms, size: " + 
+                std::to_string(file.size() / 1024 / 1024) + "MB");
             
+            // Parse straight from the buffer, chunked across worker threads
             std::chrono::high_resolution_clock::time_point parseStart = std::chrono::high_resolution_clock::now();
-            const bool loaded = tinyobj::LoadObj(
-                &attrib,
-                &shapes,
-                &materials,
-                &warn,
-                &err,
-                &objStream,
-                &matFileReader,
-                true);
+            const bool loaded = ObjParser::parse(file.data(), file.size(), baseDir, attrib, shapes, materials, warn, err);
+            const std::vector<std::string> materialLibraries = ObjParser::materialLibraries(file.data(), file.size(), baseDir);
+            file.close();
             std::chrono::high_resolution_clock::time_point parseEnd = std::chrono::high_resolution_clock::now();
             long long parseTime = std::chrono::duration_cast<std::chrono::milliseconds>(parseEnd - parseStart).count();
             log(LogLevel::Info, "File parsing completed, time: " + std::to_string(parseTime) + "ms");
 
             if (!warn.empty())
             {
-                log(LogLevel::Warn, "TinyObjLoader warn: " + warn);
+                log(LogLevel::Warn, "OBJ parser warn: " + warn);
             }
 
             if (!loaded)
             {
-                log(LogLevel::Error, "TinyObjLoader failed: " + err);
+                log(LogLevel::Error, "OBJ parser failed: " + err);
                 return meshes;
             }
 
-            // Check if normals exist
-            bool hasNormals = false;
-            for (const auto& shape : shapes)
+            // Bucket faces by material with a two-pass counting sort over fixed-size face ranges:
+            // count per range in parallel, prefix-sum into exact-size arrays, then scatter in
+            // parallel. Ranges are laid out in file order, so every mesh keeps its face order.
+            std::chrono::high_resolution_clock::time_point bucketStart = std::chrono::high_resolution_clock::now();
+            const int materialCount = static_cast<int>(materials.size());
+            const size_t bucketCount = materials.size() + 1;  // bucket 0 holds faces without a valid material
+            auto bucketOf = [materialCount](int materialId) -> size_t {
+                return (materialId >= 0 && materialId < materialCount) ? static_cast<size_t>(materialId) + 1 : 0;
+            };
+
+            struct FaceRange
             {
-                size_t indexOffset = 0;
-                for (size_t faceIdx = 0; faceIdx < shape.mesh.num_face_vertices.size(); ++faceIdx)
+                size_t shape{0};
+                size_t faceBegin{0};
+                size_t faceEnd{0};
+                size_t indexBegin{0};  // offset into shape.mesh.indices
+                size_t indexCount{0};
+                std::vector<size_t> bucketVertices;  // counts after pass 1, write offsets after the prefix sum
+                std::vector<size_t> bucketsInOrder;  // buckets in order of first appearance in this range
+                bool hasNormals{false};
+            };
+
+            std::vector<FaceRange> ranges;
+            for (size_t s = 0; s < shapes.size(); ++s)
+            {
+                const size_t faceCount = shapes[s].mesh.num_face_vertices.size();
+                for (size_t begin = 0; begin < faceCount; begin += kFacesPerRange)
                 {
-                    const auto& faceVertexCount = shape.mesh.num_face_vertices[faceIdx];
-                    for (size_t v = 0; v < faceVertexCount; ++v)
+                    FaceRange range;
+                    range.shape = s;
+                    range.faceBegin = begin;
+                    range.faceEnd = std::min(faceCount, begin + kFacesPerRange);
+                    ranges.push_back(std::move(range));
+                }
+            }
+
+            // Pass 1: vertex count per material in every range
+            parallelFor(ranges.size(), [&](size_t r) {
+                FaceRange& range = ranges[r];
+                const auto& shapeMesh = shapes[range.shape].mesh;
+                range.bucketVertices.assign(bucketCount, 0);
+                for (size_t faceIdx = range.faceBegin; faceIdx < range.faceEnd; ++faceIdx)
+                {
+                    const int materialId = faceIdx < shapeMesh.material_ids.size() ? shapeMesh.material_ids[faceIdx] : -1;
+                    const size_t bucket = bucketOf(materialId);
+                    if (range.bucketVertices[bucket] == 0)
                     {
-                        const tinyobj::index_t idx = shape.mesh.indices[indexOffset + v];
-                        if (idx.normal_index >= 0)
-                        {
-                            hasNormals = true;
-                            break;
-                        }
+                        range.bucketsInOrder.push_back(bucket);
                     }
-                    if (hasNormals) break;
-                    indexOffset += faceVertexCount;
+                    range.bucketVertices[bucket] += shapeMesh.num_face_vertices[faceIdx];
+                    range.indexCount += shapeMesh.num_face_vertices[faceIdx];
                 }
-                if (hasNormals) break;
-            }
+            });
 
-            // Map material ID to mesh index
-            std::map<int, size_t> materialToMeshIndex;
-            
-            // First pass: collect all faces grouped by material
-            for (const auto& shape : shapes)
+            // Prefix sums: each range's offset into its shape's indices and its write offset in
+            // every bucket. Meshes are created in order of first appearance, as before.
+            std::vector<size_t> bucketTotals(bucketCount, 0);
+            std::vector<size_t> bucketMesh(bucketCount, std::numeric_limits<size_t>::max());
+            std::vector<size_t> meshBuckets;
+            for (size_t r = 0; r < ranges.size(); ++r)
             {
-                size_t indexOffset = 0;
-                for (size_t faceIdx = 0; faceIdx < shape.mesh.num_face_vertices.size(); ++faceIdx)
+                FaceRange& range = ranges[r];
+                if (r > 0 && ranges[r - 1].shape == range.shape)
                 {
-                    const auto& faceVertexCount = shape.mesh.num_face_vertices[faceIdx];
-                    
-                    // Get material for this face
-                    int materialId = -1;
-                    if (faceIdx < shape.mesh.material_ids.size())
+                    range.indexBegin = ranges[r - 1].indexBegin + ranges[r - 1].indexCount;
+                }
+                for (const size_t bucket : range.bucketsInOrder)
+                {
+                    if (bucketMesh[bucket] == std::numeric_limits<size_t>::max())
                     {
-                        materialId = shape.mesh.material_ids[faceIdx];
+                        bucketMesh[bucket] = meshBuckets.size();
+                        meshBuckets.push_back(bucket);
                     }
-                    
-                    // Find or create mesh for this material
-                    size_t meshIndex = 0;
-                    if (materialToMeshIndex.find(materialId) == materialToMeshIndex.end())
+                    const size_t count = range.bucketVertices[bucket];
+                    range.bucketVertices[bucket] = bucketTotals[bucket];
+                    bucketTotals[bucket] += count;
+                }
+            }
+
+            // Create one exact-size mesh per material; texture lookups stay serial so the log
+            // reads in material order
+            std::vector<glm::vec3> bucketColors(bucketCount, glm::vec3(0.2f, 0.2f, 0.2f));
+            meshes.resize(meshBuckets.size());
+            for (size_t m = 0; m < meshBuckets.size(); ++m)
+            {
+                const size_t bucket = meshBuckets[m];
+                const int materialId = bucket == 0 ? -1 : static_cast<int>(bucket) - 1;
+                Mesh& mesh = meshes[m];
+                mesh.name = filePath.filename().string() + "_mat_" + std::to_string(materialId);
+                if (materialId < 0)
+                {
+                    continue;
+                }
+
+                const auto& mat = materials[materialId];
+                // Diffuse color from the material, falling back to ambient, then dark gray
+                if (mat.diffuse[0] > 0.0f || mat.diffuse[1] > 0.0f || mat.diffuse[2] > 0.0f)
+                {
+                    bucketColors[bucket] = glm::vec3(mat.diffuse[0], mat.diffuse[1], mat.diffuse[2]);
+                }
+                else if (mat.ambient[0] > 0.0f || mat.ambient[1] > 0.0f || mat.ambient[2] > 0.0f)
+                {
+                    bucketColors[bucket] = glm::vec3(mat.ambient[0], mat.ambient[1], mat.ambient[2]);
+                }
+
+                // Set texture path from material
+                if (!mat.diffuse_texname.empty())
+                {
+                    std::filesystem::path texPath = std::filesystem::path(baseDir) / mat.diffuse_texname;
+                    if (std::filesystem::exists(texPath))
                     {
-                        // Create new mesh for this material
-                        Mesh newMesh;
-                        newMesh.name = filePath.filename().string() + "_mat_" + std::to_string(materialId);
-                        if (materialId >= 0 && materialId < static_cast<int>(materials.size()))
-                        {
-                            const auto& mat = materials[materialId];
-                            // Set texture path from material
-                            if (!mat.diffuse_texname.empty())
-                            {
-                                std::filesystem::path texPath = std::filesystem::path(baseDir) / mat.diffuse_texname;
-                                if (std::filesystem::exists(texPath))
-                                {
-                                    newMesh.diffuseTexture = texPath.generic_string();
-                                    log(LogLevel::Info, "Material " + std::to_string(materialId) + " uses texture: " + newMesh.diffuseTexture);
-                                }
-                                else
-                                {
-                                    // Try to find texture file with different case or extension
-                                    std::string texName = mat.diffuse_texname;
-                                    std::transform(texName.begin(), texName.end(), texName.begin(), ::tolower);
-                                    
-                                    // Search in base directory first
-                                    bool found = false;
-                                    for (const auto& entry : std::filesystem::directory_iterator(baseDir))
-                                    {
-                                        if (entry.is_regular_file())
-                                        {
-                                            std::string entryName = entry.path().filename().string();
-                                            std::string entryNameLower = entryName;
-                                            std::transform(entryNameLower.begin(), entryNameLower.end(), entryNameLower.begin(), ::tolower);
-                                            
-                                            if (entryNameLower == texName || entryNameLower.find(texName) != std::string::npos)
-                                            {
-                                                newMesh.diffuseTexture = entry.path().generic_string();
-                                                log(LogLevel::Info, "Found texture for material " + std::to_string(materialId) + ": " + newMesh.diffuseTexture);
-                                                found = true;
-                                                break;
-                                            }
-                                        }
-                                    }
-                                    
-                                    // If not found, try searching in subdirectories
-                                    if (!found)
-                                    {
-                                        for (const auto& entry : std::filesystem::directory_iterator(baseDir))
-                                        {
-                                            if (entry.is_directory())
-                                            {
-                                                for (const auto& subEntry : std::filesystem::directory_iterator(entry.path()))
-                                                {
-                                                    if (subEntry.is_regular_file())
-                                                    {
-                                                        std::string entryName = subEntry.path().filename().string();
-                                                        std::string entryNameLower = entryName;
-                                                        std::transform(entryNameLower.begin(), entryNameLower.end(), entryNameLower.begin(), ::tolower);
-                                                        
-                                                        if (entryNameLower == texName || entryNameLower.find(texName) != std::string::npos)
-                                                        {
-                                                            newMesh.diffuseTexture = subEntry.path().generic_string();
-                                                            log(LogLevel::Info, "Found texture for material " + std::to_string(materialId) + " in subdirectory: " + newMesh.diffuseTexture);
-                                                            found = true;
-                                                            break;
-                                                        }
-                                                    }
-                                                }
-                                                if (found) break;
-                                            }
-                                        }
-                                    }
-                                    
-                                    if (!found)
-                                    {
-                                        log(LogLevel::Warn, "Texture not found for material " + std::to_string(materialId) + ": " + mat.diffuse_texname + " (mesh will use vertex colors)");
-                                    }
-                                }
-                            }
-                        }
-                        meshes.push_back(newMesh);
-                        meshIndex = meshes.size() - 1;
-                        materialToMeshIndex[materialId] = meshIndex;
+                        mesh.diffuseTexture = texPath.generic_string();
+                        log(LogLevel::Info, "Material " + std::to_string(materialId) + " uses texture: " + mesh.diffuseTexture);
                     }
-                    else
+                    else if (auto indexed = DirectoryIndex::findFile(baseDir, mat.diffuse_texname))
                     {
-                        meshIndex = materialToMeshIndex[materialId];
+                        // Different case, or stored in a subdirectory of the OBJ's folder
+                        mesh.diffuseTexture = *indexed;
+                        log(LogLevel::Info, "Found texture for material " + std::to_string(materialId) + ": " + mesh.diffuseTexture);
                     }
-                    
-                    Mesh& mesh = meshes[meshIndex];
-                    
-                    // Get diffuse color from material
-                    glm::vec3 faceColor = glm::vec3(0.2f, 0.2f, 0.2f);
-                    if (materialId >= 0 && materialId < static_cast<int>(materials.size()))
+                    else
                     {
-                        const auto& mat = materials[materialId];
-                        if (mat.diffuse[0] > 0.0f || mat.diffuse[1] > 0.0f || mat.diffuse[2] > 0.0f)
-                        {
-                            faceColor = glm::vec3(mat.diffuse[0], mat.diffuse[1], mat.diffuse[2]);
-                        }
-                        else if (mat.ambient[0] > 0.0f || mat.ambient[1] > 0.0f || mat.ambient[2] > 0.0f)
-                        {
-                            faceColor = glm::vec3(mat.ambient[0], mat.ambient[1], mat.ambient[2]);
-                        }
+                        log(LogLevel::Warn, "Texture not found for material " + std::to_string(materialId) + ": " + mat.diffuse_texname + " (mesh will use vertex colors)");
                     }
-                    
-                    bool hasVertexColors = !attrib.colors.empty();
-                    
-                    // Add vertices for this face
-                    size_t faceStartIndex = mesh.vertices.size();
+                }
+            }
+            parallelFor(meshes.size(), [&](size_t m) {
+                const size_t total = bucketTotals[meshBuckets[m]];
+                meshes[m].vertices.resize(total);
+                meshes[m].indices.resize(total);
+            });
+
+            // Pass 2: scatter every face's vertices straight into its material's mesh
+            const bool hasVertexColors = !attrib.colors.empty();
+            parallelFor(ranges.size(), [&](size_t r) {
+                FaceRange& range = ranges[r];
+                const auto& shapeMesh = shapes[range.shape].mesh;
+                size_t indexOffset = range.indexBegin;
+                for (size_t faceIdx = range.faceBegin; faceIdx < range.faceEnd; ++faceIdx)
+                {
+                    const size_t faceVertexCount = shapeMesh.num_face_vertices[faceIdx];
+                    const int materialId = faceIdx < shapeMesh.material_ids.size() ? shapeMesh.material_ids[faceIdx] : -1;
+                    const size_t bucket = bucketOf(materialId);
+                    const glm::vec3& faceColor = bucketColors[bucket];
+                    Mesh& mesh = meshes[bucketMesh[bucket]];
+                    size_t& cursor = range.bucketVertices[bucket];
+
                     for (size_t v = 0; v < faceVertexCount; ++v)
                     {
-                        const tinyobj::index_t idx = shape.mesh.indices[indexOffset + v];
-                        Vertex vertex{};
-                        
+                        const tinyobj::index_t idx = shapeMesh.indices[indexOffset + v];
+                        Vertex& vertex = mesh.vertices[cursor];
+                        vertex.color = faceColor;
+
                         if (idx.vertex_index >= 0)
                         {
                             vertex.position = glm::vec3(
                                 attrib.vertices[3 * idx.vertex_index + 0],
                                 attrib.vertices[3 * idx.vertex_index + 1],
                                 attrib.vertices[3 * idx.vertex_index + 2]);
-                            
-                            if (hasVertexColors && idx.vertex_index >= 0 && 
-                                3 * idx.vertex_index + 2 < attrib.colors.size())
+
+                            if (hasVertexColors && 3 * static_cast<size_t>(idx.vertex_index) + 2 < attrib.colors.size())
                             {
                                 vertex.color = glm::vec3(
                                     attrib.colors[3 * idx.vertex_index + 0],
                                     attrib.colors[3 * idx.vertex_index + 1],
                                     attrib.colors[3 * idx.vertex_index + 2]);
                             }
-                            else
-                            {
-                                vertex.color = faceColor;
-                            }
-                        }
-                        else
-                        {
-                            vertex.color = faceColor;
                         }
-                        
+
                         if (idx.normal_index >= 0)
                         {
+                            range.hasNormals = true;
                             vertex.normal = glm::vec3(
                                 attrib.normals[3 * idx.normal_index + 0],
                                 attrib.normals[3 * idx.normal_index + 1],
                                 attrib.normals[3 * idx.normal_index + 2]);
                         }
-                        
+
                         if (idx.texcoord_index >= 0)
                         {
                             vertex.uv = glm::vec2(
                                 attrib.texcoords[2 * idx.texcoord_index + 0],
                                 attrib.texcoords[2 * idx.texcoord_index + 1]);
                         }
-                        
-                        mesh.vertices.push_back(vertex);
-                        mesh.indices.push_back(static_cast<uint32_t>(mesh.vertices.size() - 1));
+
+                        mesh.indices[cursor] = static_cast<uint32_t>(cursor);
+                        ++cursor;
                     }
-                    
                     indexOffset += faceVertexCount;
                 }
-            }
+            });
+
+            const bool hasNormals = std::any_of(ranges.begin(), ranges.end(), [](const FaceRange& range) { return range.hasNormals; });
+            std::chrono::high_resolution_clock::time_point bucketEnd = std::chrono::high_resolution_clock::now();
+            long long bucketTime = std::chrono::duration_cast<std::chrono::milliseconds>(bucketEnd - bucketStart).count();
+            log(LogLevel::Info, "Bucketed " + std::to_string(ranges.size()) + " face ranges by material, time: " + std::to_string(bucketTime) + "ms");
             
             // Log mesh information before processing
             log(LogLevel::Info, "Created " + std::to_string(meshes.size()) + " meshes from materials");
@@ -524,9 +487,9 @@ namespace cg
                     ", texture='" + meshes[i].diffuseTexture + "'");
             }
             
-            // Calculate normals for meshes that don't have them
-            for (auto& mesh : meshes)
-            {
+            // Generate missing normals and fix Z-up orientation per mesh, in parallel
+            parallelFor(meshes.size(), [&](size_t m) {
+                Mesh& mesh = meshes[m];
                 if (!hasNormals && mesh.vertices.size() >= 3)
                 {
                     MeshUtils::calculateNormals(mesh);
@@ -542,7 +505,7 @@ namespace cg
                 }
                 
                 mesh.transform = glm::mat4(1.0f);
-            }
+            });
             
             // Remove empty meshes (meshes with no vertices or indices)
             meshes.erase(std::remove_if(meshes.begin(), meshes.end(), 
@@ -567,8 +530,8 @@ namespace cg
                 " | Mesh count: " + std::to_string(meshes.size()) +
                 " | Vertices: " + std::to_string(totalVertices) +
                 " | Faces: " + std::to_string(totalFaces));
-            log(LogLevel::Info, "Model loading optimized: files are read into memory first, then parsed from memory for better I/O performance");
-            
+
+            MeshCache::store(path, materialLibraries, MeshCache::Layout::PerMaterial, meshes.data(), meshes.size());
             return meshes;
         }
     }
@@ -0,0 +1,851 @@
+#include "loader/ObjParser.h"
+
+#include "util/Parallel.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <thread>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+namespace cg
+{
+    namespace ObjParser
+    {
+        namespace
+        {
+            using tinyobj::real_t;
+
+            constexpr size_t kMinChunkBytes = 1u << 20;
+
+            // Statements whose effect crosses chunk boundaries; replayed in file order after parsing
+            enum class EventType
+            {
+                MaterialLibrary,
+                UseMaterial,
+                Smoothing,
+                Group,
+                Object
+            };
+
+            struct Event
+            {
+                EventType type{EventType::Group};
+                size_t face{0};        // Faces of the chunk parsed before this statement
+                size_t triangle{0};    // Triangles of the chunk emitted before it (set when triangulating)
+                size_t line{0};
+                std::string text;
+                int value{0};          // Material id or smoothing group once resolved
+            };
+
+            // Face corner with 0-based indices; -1 means absent. Negative OBJ indices are stored
+            // relative to the chunk's own attribute counts and rebased once all chunks are known.
+            struct Corner
+            {
+                int v{-1};
+                int vt{-1};
+                int vn{-1};
+                uint8_t relative{0};
+            };
+
+            enum : uint8_t
+            {
+                kRelativeV = 1,
+                kRelativeVt = 2,
+                kRelativeVn = 4
+            };
+
+            struct Message
+            {
+                size_t line{0};
+                std::string text;    // Followed by the global line number
+                const char* suffix{").\n"};
+            };
+
+            struct Chunk
+            {
+                const char* begin{nullptr};
+                const char* end{nullptr};
+                size_t lineCount{0};
+
+                std::vector<real_t> vertices;
+                std::vector<real_t> weights;
+                std::vector<real_t> colors;
+                std::vector<real_t> normals;
+                std::vector<real_t> texcoords;
+                std::vector<Corner> corners;
+                std::vector<uint32_t> faceSizes;
+                std::vector<Event> events;
+                std::vector<Message> warnings;
+                Message error;
+                bool failed{false};
+
+                // Most negative chunk-relative index per attribute (v, vt, vn), checked after rebasing
+                int minRelative[3]{0, 0, 0};
+                size_t minRelativeLine[3]{0, 0, 0};
+
+                // Filled in once every chunk has been parsed
+                size_t lineBase{0};
+                int vertexBase{0};
+                int texcoordBase{0};
+                int normalBase{0};
+                int initialMaterial{-1};
+                int initialSmoothing{0};
+                std::vector<tinyobj::index_t> indices;
+                std::vector<int> materialIds;
+                std::vector<unsigned int> smoothingIds;
+                std::string triangulateWarnings;
+                int greatest[3]{-1, -1, -1};
+            };
+
+            inline bool isSpace(char c)
+            {
+                return c == ' ' || c == '\t';
+            }
+
+            inline const char* skipSpace(const char* p, const char* end)
+            {
+                while (p < end && isSpace(*p))
+                {
+                    ++p;
+                }
+                return p;
+            }
+
+            inline const char* skipToken(const char* p, const char* end)
+            {
+                while (p < end && !isSpace(*p) && *p != '\r')
+                {
+                    ++p;
+                }
+                return p;
+            }
+
+            // Same contract as tinyobj's parseReal: consumes one token, returns false if it is not a number
+            inline bool parseReal(const char*& p, const char* end, real_t& value)
+            {
+                p = skipSpace(p, end);
+                const char* tokenEnd = skipToken(p, end);
+                if (p == tokenEnd)
+                {
+                    return false;
+                }
+                const char* first = (*p == '+') ? p + 1 : p;
+                real_t parsed = 0;
+                const auto result = std::from_chars(first, tokenEnd, parsed);
+                p = tokenEnd;
+                if (result.ec != std::errc())
+                {
+                    return false;
+                }
+                value = parsed;
+                return true;
+            }
+
+            // atoi() semantics: leading sign, stops at the first non-digit, 0 when nothing parses
+            inline int parseInt(const char* p, const char* end)
+            {
+                p = skipSpace(p, end);
+                if (p < end && *p == '+')
+                {
+                    ++p;
+                }
+                int value = 0;
+                std::from_chars(p, end, value);
+                return value;
+            }
+
+            inline const char* skipIndex(const char* p, const char* end)
+            {
+                while (p < end && *p != '/' && !isSpace(*p) && *p != '\r')
+                {
+                    ++p;
+                }
+                return p;
+            }
+
+            std::string parseName(const char*& p, const char* end)
+            {
+                p = skipSpace(p, end);
+                const char* nameEnd = skipToken(p, end);
+                std::string name(p, nameEnd);
+                p = nameEnd;
+                return name;
+            }
+
+            // File names of an mtllib line; the first one that loads is used
+            std::vector<std::string> materialLibraryNames(const std::string& text)
+            {
+                std::vector<std::string> fileNames;
+                const char* p = text.data();
+                const char* textEnd = p + text.size();
+                while ((p = skipSpace(p, textEnd)) < textEnd)
+                {
+                    fileNames.push_back(parseName(p, textEnd));
+                }
+                return fileNames;
+            }
+
+            // Converts one OBJ index; which: 0 = v, 1 = vt, 2 = vn. Returns false for an invalid v index.
+            bool fixIndex(Chunk& chunk, Corner& corner, int which, int raw, int count)
+            {
+                int* target = which == 0 ? &corner.v : (which == 1 ? &corner.vt : &corner.vn);
+                if (raw > 0)
+                {
+                    *target = raw - 1;
+                    return true;
+                }
+                if (raw == 0)
+                {
+                    chunk.warnings.push_back({chunk.lineCount, "A zero value index found (will have a value of -1 for normal and tex indices. Line "});
+                    *target = -1;
+                    return which != 0;
+                }
+
+                *target = count + raw;
+                corner.relative |= static_cast<uint8_t>(1u << which);
+                if (*target < chunk.minRelative[which])
+                {
+                    chunk.minRelative[which] = *target;
+                    chunk.minRelativeLine[which] = chunk.lineCount;
+                }
+                return true;
+            }
+
+            bool parseFace(Chunk& chunk, const char* p, const char* end)
+            {
+                const int vertexCount = static_cast<int>(chunk.vertices.size() / 3);
+                const int texcoordCount = static_cast<int>(chunk.texcoords.size() / 2);
+                const int normalCount = static_cast<int>(chunk.normals.size() / 3);
+
+                uint32_t cornerCount = 0;
+                p = skipSpace(p, end);
+                while (p < end && *p != '#')
+                {
+                    Corner corner;
+                    if (!fixIndex(chunk, corner, 0, parseInt(p, end), vertexCount))
+                    {
+                        return false;
+                    }
+                    p = skipIndex(p, end);
+                    if (p < end && *p == '/')
+                    {
+                        ++p;
+                        if (p < end && *p == '/')
+                        {
+                            ++p;
+                            fixIndex(chunk, corner, 2, parseInt(p, end), normalCount);
+                            p = skipIndex(p, end);
+                        }
+                        else
+                        {
+                            fixIndex(chunk, corner, 1, parseInt(p, end), texcoordCount);
+                            p = skipIndex(p, end);
+                            if (p < end && *p == '/')
+                            {
+                                ++p;
+                                fixIndex(chunk, corner, 2, parseInt(p, end), normalCount);
+                                p = skipIndex(p, end);
+                            }
+                        }
+                    }
+                    chunk.corners.push_back(corner);
+                    ++cornerCount;
+                    while (p < end && (isSpace(*p) || *p == '\r'))
+                    {
+                        ++p;
+                    }
+                }
+                chunk.faceSizes.push_back(cornerCount);
+                return true;
+            }
+
+            void parseLine(Chunk& chunk, const char* p, const char* end)
+            {
+                p = skipSpace(p, end);
+                if (p == end || *p == '#')
+                {
+                    return;
+                }
+
+                const char c0 = *p;
+                const char c1 = (p + 1 < end) ? p[1] : '\0';
+                const char c2 = (p + 2 < end) ? p[2] : '\0';
+
+                if (c0 == 'v' && isSpace(c1))
+                {
+                    p += 2;
+                    real_t xyz[3]{0, 0, 0};
+                    for (real_t& value : xyz)
+                    {
+                        parseReal(p, end, value);
+                    }
+                    // Optional w, or r g b; tinyobj stores w in place of r when only four values are given
+                    real_t r = 1, g = 1, b = 1;
+                    if (parseReal(p, end, r))
+                    {
+                        if (!parseReal(p, end, g))
+                        {
+                            g = b = 1;
+                        }
+                        else if (!parseReal(p, end, b))
+                        {
+                            r = g = b = 1;
+                        }
+                    }
+                    chunk.vertices.insert(chunk.vertices.end(), xyz, xyz + 3);
+                    chunk.weights.push_back(r);
+                    chunk.colors.push_back(r);
+                    chunk.colors.push_back(g);
+                    chunk.colors.push_back(b);
+                    return;
+                }
+
+                if (c0 == 'v' && c1 == 'n' && isSpace(c2))
+                {
+                    p += 3;
+                    real_t xyz[3]{0, 0, 0};
+                    for (real_t& value : xyz)
+                    {
+                        parseReal(p, end, value);
+                    }
+                    chunk.normals.insert(chunk.normals.end(), xyz, xyz + 3);
+                    return;
+                }
+
+                if (c0 == 'v' && c1 == 't' && isSpace(c2))
+                {
+                    p += 3;
+                    real_t uv[2]{0, 0};
+                    parseReal(p, end, uv[0]);
+                    parseReal(p, end, uv[1]);
+                    chunk.texcoords.insert(chunk.texcoords.end(), uv, uv + 2);
+                    return;
+                }
+
+                if (c0 == 'f' && isSpace(c1))
+                {
+                    if (!parseFace(chunk, p + 2, end))
+                    {
+                        chunk.failed = true;
+                        chunk.error = {chunk.lineCount, "Failed to parse `f' line (e.g. a zero value for vertex index or invalid relative vertex index). Line "};
+                    }
+                    return;
+                }
+
+                Event event;
+                event.face = chunk.faceSizes.size();
+                event.line = chunk.lineCount;
+
+                const size_t length = static_cast<size_t>(end - p);
+                if (length >= 6 && std::strncmp(p, "usemtl", 6) == 0)
+                {
+                    p += 6;
+                    event.type = EventType::UseMaterial;
+                    event.text = parseName(p, end);
+                }
+                else if (length >= 7 && std::strncmp(p, "mtllib", 6) == 0 && isSpace(p[6]))
+                {
+                    event.type = EventType::MaterialLibrary;
+                    event.text.assign(p + 7, end);
+                }
+                else if (c0 == 'g' && isSpace(c1))
+                {
+                    event.type = EventType::Group;
+                    p += 2;
+                    while (p < end && *p != '#')
+                    {
+                        const std::string name = parseName(p, end);
+                        if (!event.text.empty())
+                        {
+                            event.text += ' ';
+                        }
+                        event.text += name;
+                        while (p < end && (isSpace(*p) || *p == '\r'))
+                        {
+                            ++p;
+                        }
+                    }
+                    if (event.text.empty())
+                    {
+                        chunk.warnings.push_back({chunk.lineCount, "Empty group name. line: ", "\n"});
+                    }
+                }
+                else if (c0 == 'o' && isSpace(c1))
+                {
+                    event.type = EventType::Object;
+                    event.text.assign(p + 2, end);
+                }
+                else if (c0 == 's' && isSpace(c1))
+                {
+                    p = skipSpace(p + 2, end);
+                    if (p == end || *p == '\r')
+                    {
+                        return;
+                    }
+                    event.type = EventType::Smoothing;
+                    if (length >= 3 && std::strncmp(p, "off", 3) == 0)
+                    {
+                        event.value = 0;
+                    }
+                    else
+                    {
+                        event.value = std::max(0, parseInt(p, end));
+                    }
+                }
+                else
+                {
+                    // l, p, t, vw and unknown statements
+                    return;
+                }
+                chunk.events.push_back(std::move(event));
+            }
+
+            void parseChunk(Chunk& chunk)
+            {
+                const char* p = chunk.begin;
+                while (p < chunk.end && !chunk.failed)
+                {
+                    const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(chunk.end - p)));
+                    if (!lineEnd)
+                    {
+                        lineEnd = chunk.end;
+                    }
+                    const char* contentEnd = lineEnd;
+                    if (contentEnd > p && contentEnd[-1] == '\r')
+                    {
+                        --contentEnd;
+                    }
+                    ++chunk.lineCount;
+                    parseLine(chunk, p, contentEnd);
+                    p = lineEnd + 1;
+                }
+            }
+
+            // Ear clipping in the polygon's dominant plane, for faces with five or more corners
+            void triangulatePolygon(const tinyobj::index_t* polygon, size_t count, const std::vector<real_t>& v, std::vector<tinyobj::index_t>& out)
+            {
+                double normal[3]{0.0, 0.0, 0.0};
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const real_t* a = &v[3 * static_cast<size_t>(polygon[i].vertex_index)];
+                    const real_t* b = &v[3 * static_cast<size_t>(polygon[(i + 1) % count].vertex_index)];
+                    normal[0] += (a[1] - b[1]) * (a[2] + b[2]);
+                    normal[1] += (a[2] - b[2]) * (a[0] + b[0]);
+                    normal[2] += (a[0] - b[0]) * (a[1] + b[1]);
+                }
+                int dropAxis = 0;
+                if (std::fabs(normal[1]) > std::fabs(normal[dropAxis])) dropAxis = 1;
+                if (std::fabs(normal[2]) > std::fabs(normal[dropAxis])) dropAxis = 2;
+                const int axisU = (dropAxis + 1) % 3;
+                const int axisV = (dropAxis + 2) % 3;
+                const double orientation = normal[dropAxis] >= 0.0 ? 1.0 : -1.0;
+
+                std::vector<double> points(count * 2);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const real_t* p = &v[3 * static_cast<size_t>(polygon[i].vertex_index)];
+                    points[2 * i + 0] = p[axisU];
+                    points[2 * i + 1] = p[axisV];
+                }
+                auto cross = [&](size_t a, size_t b, size_t c) {
+                    return ((points[2 * b] - points[2 * a]) * (points[2 * c + 1] - points[2 * a + 1]) -
+                            (points[2 * b + 1] - points[2 * a + 1]) * (points[2 * c] - points[2 * a])) * orientation;
+                };
+
+                std::vector<size_t> remaining(count);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    remaining[i] = i;
+                }
+                while (remaining.size() > 3)
+                {
+                    const size_t n = remaining.size();
+                    size_t ear = 0;
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        const size_t a = remaining[(i + n - 1) % n];
+                        const size_t b = remaining[i];
+                        const size_t c = remaining[(i + 1) % n];
+                        if (cross(a, b, c) <= 0.0)
+                        {
+                            continue;
+                        }
+                        bool containsPoint = false;
+                        for (size_t j = 0; j < n && !containsPoint; ++j)
+                        {
+                            const size_t q = remaining[j];
+                            containsPoint = q != a && q != b && q != c &&
+                                cross(a, b, q) >= 0.0 && cross(b, c, q) >= 0.0 && cross(c, a, q) >= 0.0;
+                        }
+                        if (!containsPoint)
+                        {
+                            ear = i;
+                            break;
+                        }
+                    }
+                    // Degenerate polygons find no ear; clipping the first corner still emits every triangle
+                    out.push_back(polygon[remaining[(ear + n - 1) % n]]);
+                    out.push_back(polygon[remaining[ear]]);
+                    out.push_back(polygon[remaining[(ear + 1) % n]]);
+                    remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(ear));
+                }
+                out.push_back(polygon[remaining[0]]);
+                out.push_back(polygon[remaining[1]]);
+                out.push_back(polygon[remaining[2]]);
+            }
+
+            void triangulateChunk(Chunk& chunk, const std::vector<real_t>& v)
+            {
+                chunk.indices.reserve(chunk.corners.size() + chunk.corners.size() / 2);
+                const size_t vertexCount = v.size() / 3;
+
+                int material = chunk.initialMaterial;
+                int smoothing = chunk.initialSmoothing;
+                size_t eventIndex = 0;
+                size_t cornerOffset = 0;
+                std::vector<tinyobj::index_t> polygon;
+
+                auto applyEvents = [&](size_t face) {
+                    for (; eventIndex < chunk.events.size() && chunk.events[eventIndex].face <= face; ++eventIndex)
+                    {
+                        Event& event = chunk.events[eventIndex];
+                        event.triangle = chunk.materialIds.size();
+                        if (event.type == EventType::UseMaterial)
+                        {
+                            material = event.value;
+                        }
+                        else if (event.type == EventType::Smoothing)
+                        {
+                            smoothing = event.value;
+                        }
+                    }
+                };
+
+                for (size_t face = 0; face < chunk.faceSizes.size(); ++face)
+                {
+                    applyEvents(face);
+                    const size_t count = chunk.faceSizes[face];
+                    polygon.resize(count);
+                    bool validVertices = true;
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        const Corner& corner = chunk.corners[cornerOffset + i];
+                        tinyobj::index_t& index = polygon[i];
+                        index.vertex_index = corner.v + ((corner.relative & kRelativeV) ? chunk.vertexBase : 0);
+                        index.texcoord_index = corner.vt + ((corner.relative & kRelativeVt) ? chunk.texcoordBase : 0);
+                        index.normal_index = corner.vn + ((corner.relative & kRelativeVn) ? chunk.normalBase : 0);
+                        chunk.greatest[0] = std::max(chunk.greatest[0], index.vertex_index);
+                        chunk.greatest[1] = std::max(chunk.greatest[1], index.texcoord_index);
+                        chunk.greatest[2] = std::max(chunk.greatest[2], index.normal_index);
+                        validVertices = validVertices && static_cast<size_t>(index.vertex_index) < vertexCount;
+                    }
+                    cornerOffset += count;
+
+                    const size_t firstIndex = chunk.indices.size();
+                    if (count < 3)
+                    {
+                        chunk.triangulateWarnings += "Degenerated face found\n.";
+                        continue;
+                    }
+                    if (count == 3)
+                    {
+                        chunk.indices.insert(chunk.indices.end(), polygon.begin(), polygon.end());
+                    }
+                    else if (!validVertices)
+                    {
+                        chunk.triangulateWarnings += "Face with invalid vertex index found.\n";
+                        continue;
+                    }
+                    else if (count == 4)
+                    {
+                        // Split along the shorter diagonal, exactly as tinyobj does
+                        const real_t* p0 = &v[3 * static_cast<size_t>(polygon[0].vertex_index)];
+                        const real_t* p1 = &v[3 * static_cast<size_t>(polygon[1].vertex_index)];
+                        const real_t* p2 = &v[3 * static_cast<size_t>(polygon[2].vertex_index)];
+                        const real_t* p3 = &v[3 * static_cast<size_t>(polygon[3].vertex_index)];
+                        const real_t e02x = p2[0] - p0[0], e02y = p2[1] - p0[1], e02z = p2[2] - p0[2];
+                        const real_t e13x = p3[0] - p1[0], e13y = p3[1] - p1[1], e13z = p3[2] - p1[2];
+                        const real_t sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+                        const real_t sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+                        const tinyobj::index_t split02[6]{polygon[0], polygon[1], polygon[2], polygon[0], polygon[2], polygon[3]};
+                        const tinyobj::index_t split13[6]{polygon[0], polygon[1], polygon[3], polygon[1], polygon[2], polygon[3]};
+                        const tinyobj::index_t* split = sqr02 < sqr13 ? split02 : split13;
+                        chunk.indices.insert(chunk.indices.end(), split, split + 6);
+                    }
+                    else
+                    {
+                        triangulatePolygon(polygon.data(), count, v, chunk.indices);
+                    }
+
+                    const size_t triangles = (chunk.indices.size() - firstIndex) / 3;
+                    chunk.materialIds.insert(chunk.materialIds.end(), triangles, material);
+                    chunk.smoothingIds.insert(chunk.smoothingIds.end(), triangles, static_cast<unsigned int>(smoothing));
+                }
+                applyEvents(chunk.faceSizes.size());
+            }
+
+            void appendTriangles(tinyobj::shape_t& shape, const Chunk& chunk, size_t first, size_t last)
+            {
+                if (first >= last)
+                {
+                    return;
+                }
+                auto& mesh = shape.mesh;
+                mesh.indices.insert(mesh.indices.end(), chunk.indices.begin() + 3 * first, chunk.indices.begin() + 3 * last);
+                mesh.num_face_vertices.insert(mesh.num_face_vertices.end(), last - first, static_cast<unsigned int>(3));
+                mesh.material_ids.insert(mesh.material_ids.end(), chunk.materialIds.begin() + first, chunk.materialIds.begin() + last);
+                mesh.smoothing_group_ids.insert(mesh.smoothing_group_ids.end(), chunk.smoothingIds.begin() + first, chunk.smoothingIds.begin() + last);
+            }
+
+            template <typename T>
+            void concatenate(std::vector<T>& target, std::vector<Chunk>& chunks, std::vector<T> Chunk::*member)
+            {
+                size_t total = 0;
+                for (const auto& chunk : chunks)
+                {
+                    total += (chunk.*member).size();
+                }
+                target.clear();
+                target.reserve(total);
+                for (auto& chunk : chunks)
+                {
+                    target.insert(target.end(), (chunk.*member).begin(), (chunk.*member).end());
+                    std::vector<T>().swap(chunk.*member);
+                }
+            }
+        } // namespace
+
+        bool parse(const char* data, size_t size, const std::string& materialBaseDir,
+                   tinyobj::attrib_t& attrib, std::vector<tinyobj::shape_t>& shapes,
+                   std::vector<tinyobj::material_t>& materials, std::string& warn, std::string& err)
+        {
+            attrib = tinyobj::attrib_t();
+            shapes.clear();
+            materials.clear();
+
+            if (size >= 3 && static_cast<unsigned char>(data[0]) == 0xEF &&
+                static_cast<unsigned char>(data[1]) == 0xBB && static_cast<unsigned char>(data[2]) == 0xBF)
+            {
+                data += 3;
+                size -= 3;
+            }
+            const char* const end = data + size;
+
+            // Split on line boundaries into roughly equal chunks
+            const size_t threads = static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()));
+            const size_t chunkCount = std::max<size_t>(1, std::min(threads, size / kMinChunkBytes));
+            std::vector<Chunk> chunks(chunkCount);
+            const char* cursor = data;
+            for (size_t i = 0; i < chunkCount; ++i)
+            {
+                chunks[i].begin = cursor;
+                const char* split = (i + 1 == chunkCount) ? end : data + size * (i + 1) / chunkCount;
+                split = std::max(split, cursor);
+                const char* newline = (split < end) ? static_cast<const char*>(std::memchr(split, '\n', static_cast<size_t>(end - split))) : nullptr;
+                cursor = newline ? newline + 1 : end;
+                chunks[i].end = cursor;
+            }
+
+            // Parse chunks in parallel
+            parallelFor(chunkCount, [&chunks](size_t i) { parseChunk(chunks[i]); });
+
+            // Rebase indices and replay cross-chunk state (materials, smoothing groups) in file order
+            tinyobj::MaterialFileReader materialReader(materialBaseDir);
+            std::map<std::string, int> materialMap;
+            std::vector<std::string> loadedLibraries;
+            size_t lineBase = 0;
+            int vertexBase = 0;
+            int texcoordBase = 0;
+            int normalBase = 0;
+            int material = -1;
+            int smoothing = 0;
+            for (auto& chunk : chunks)
+            {
+                chunk.lineBase = lineBase;
+                chunk.vertexBase = vertexBase;
+                chunk.texcoordBase = texcoordBase;
+                chunk.normalBase = normalBase;
+                chunk.initialMaterial = material;
+                chunk.initialSmoothing = smoothing;
+
+                for (const auto& message : chunk.warnings)
+                {
+                    warn += message.text + std::to_string(lineBase + message.line) + message.suffix;
+                }
+                if (chunk.failed)
+                {
+                    err += chunk.error.text + std::to_string(lineBase + chunk.error.line) + chunk.error.suffix;
+                    return false;
+                }
+                const int bases[3]{vertexBase, texcoordBase, normalBase};
+                for (int i = 0; i < 3; ++i)
+                {
+                    if (bases[i] + chunk.minRelative[i] < 0)
+                    {
+                        err += "Failed to parse `f' line (e.g. a zero value for vertex index or invalid relative vertex index). Line " +
+                            std::to_string(lineBase + chunk.minRelativeLine[i]) + ").\n";
+                        return false;
+                    }
+                }
+
+                for (auto& event : chunk.events)
+                {
+                    if (event.type == EventType::MaterialLibrary)
+                    {
+                        const std::vector<std::string> fileNames = materialLibraryNames(event.text);
+                        if (fileNames.empty())
+                        {
+                            warn += "Looks like empty filename for mtllib. Use default material (line " + std::to_string(lineBase + event.line) + ".)\n";
+                            continue;
+                        }
+                        bool found = false;
+                        for (const auto& fileName : fileNames)
+                        {
+                            if (std::find(loadedLibraries.begin(), loadedLibraries.end(), fileName) != loadedLibraries.end())
+                            {
+                                found = true;
+                                continue;
+                            }
+                            std::string materialWarn;
+                            std::string materialErr;
+                            const bool ok = materialReader(fileName, &materials, &materialMap, &materialWarn, &materialErr);
+                            warn += materialWarn;
+                            err += materialErr;
+                            if (ok)
+                            {
+                                found = true;
+                                loadedLibraries.push_back(fileName);
+                                break;
+                            }
+                        }
+                        if (!found)
+                        {
+                            warn += "Failed to load material file(s). Use default material.\n";
+                        }
+                    }
+                    else if (event.type == EventType::UseMaterial)
+                    {
+                        const auto it = materialMap.find(event.text);
+                        event.value = (it != materialMap.end()) ? it->second : -1;
+                        if (it == materialMap.end())
+                        {
+                            warn += "material [ '" + event.text + "' ] not found in .mtl\n";
+                        }
+                        material = event.value;
+                    }
+                    else if (event.type == EventType::Smoothing)
+                    {
+                        smoothing = event.value;
+                    }
+                }
+
+                lineBase += chunk.lineCount;
+                vertexBase += static_cast<int>(chunk.vertices.size() / 3);
+                texcoordBase += static_cast<int>(chunk.texcoords.size() / 2);
+                normalBase += static_cast<int>(chunk.normals.size() / 3);
+            }
+
+            concatenate(attrib.vertices, chunks, &Chunk::vertices);
+            concatenate(attrib.vertex_weights, chunks, &Chunk::weights);
+            concatenate(attrib.colors, chunks, &Chunk::colors);
+            concatenate(attrib.normals, chunks, &Chunk::normals);
+            concatenate(attrib.texcoords, chunks, &Chunk::texcoords);
+
+            // Triangulate in parallel now that every index is global
+            parallelFor(chunkCount, [&chunks, &attrib](size_t i) { triangulateChunk(chunks[i], attrib.vertices); });
+
+            // Stitch shapes: 'g' and 'o' close the current shape if it has faces
+            tinyobj::shape_t shape;
+            int greatest[3]{-1, -1, -1};
+            for (auto& chunk : chunks)
+            {
+                warn += chunk.triangulateWarnings;
+                for (int i = 0; i < 3; ++i)
+                {
+                    greatest[i] = std::max(greatest[i], chunk.greatest[i]);
+                }
+
+                size_t first = 0;
+                for (const auto& event : chunk.events)
+                {
+                    if (event.type != EventType::Group && event.type != EventType::Object)
+                    {
+                        continue;
+                    }
+                    appendTriangles(shape, chunk, first, event.triangle);
+                    first = event.triangle;
+                    if (!shape.mesh.indices.empty())
+                    {
+                        shapes.push_back(std::move(shape));
+                    }
+                    shape = tinyobj::shape_t();
+                    shape.name = event.text;
+                }
+                appendTriangles(shape, chunk, first, chunk.materialIds.size());
+                std::vector<tinyobj::index_t>().swap(chunk.indices);
+            }
+            if (!shape.mesh.indices.empty())
+            {
+                shapes.push_back(std::move(shape));
+            }
+
+            const std::string lastLine = std::to_string(lineBase);
+            if (greatest[0] >= static_cast<int>(attrib.vertices.size() / 3))
+            {
+                warn += "Vertex indices out of bounds (line " + lastLine + ".)\n\n";
+            }
+            if (greatest[2] >= static_cast<int>(attrib.normals.size() / 3))
+            {
+                warn += "Vertex normal indices out of bounds (line " + lastLine + ".)\n\n";
+            }
+            if (greatest[1] >= static_cast<int>(attrib.texcoords.size() / 2))
+            {
+                warn += "Vertex texcoord indices out of bounds (line " + lastLine + ".)\n\n";
+            }
+            return true;
+        }
+
+        std::vector<std::string> materialLibraries(const char* data, size_t size, const std::string& materialBaseDir)
+        {
+            std::vector<std::string> paths;
+            if (size >= 3 && static_cast<unsigned char>(data[0]) == 0xEF &&
+                static_cast<unsigned char>(data[1]) == 0xBB && static_cast<unsigned char>(data[2]) == 0xBF)
+            {
+                data += 3;
+                size -= 3;
+            }
+            const char* const end = data + size;
+            for (const char* p = data; p < end;)
+            {
+                const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+                if (!lineEnd)
+                {
+                    lineEnd = end;
+                }
+                const char* contentEnd = (lineEnd > p && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+                const char* line = skipSpace(p, contentEnd);
+                if (contentEnd - line >= 7 && std::strncmp(line, "mtllib", 6) == 0 && isSpace(line[6]))
+                {
+                    for (const auto& fileName : materialLibraryNames(std::string(line + 7, contentEnd)))
+                    {
+                        // tinyobj's JoinPath
+                        std::string path = materialBaseDir.empty() || materialBaseDir.back() == '/'
+                            ? materialBaseDir + fileName : materialBaseDir + '/' + fileName;
+                        if (std::find(paths.begin(), paths.end(), path) == paths.end())
+                        {
+                            paths.push_back(std::move(path));
+                        }
+                    }
+                }
+                p = lineEnd + 1;
+            }
+            return paths;
+        }
+    }
+} // namespace cg
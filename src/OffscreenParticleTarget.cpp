@@ -0,0 +1,159 @@
+#include "render/OffscreenParticleTarget.h"
+
+#include "util/Log.h"
+
+#include <glad/glad.h>
+
+#include <string>
+
+namespace cg
+{
+    namespace
+    {
+        constexpr GLint kParticleUnit = 0;
+        constexpr GLint kParticleDepthUnit = 1;
+        constexpr GLint kSceneDepthUnit = 2;
+
+        GLuint createTexture(GLint internalFormat, GLenum format, GLenum type, int width, int height)
+        {
+            GLuint texture = 0;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            return texture;
+        }
+    }
+
+    OffscreenParticleTarget::OffscreenParticleTarget()
+    {
+        m_downsampleShader = std::make_unique<Shader>("shaders/fullscreen.vert", "shaders/particle_depth_downsample.frag");
+        m_compositeShader = std::make_unique<Shader>("shaders/fullscreen.vert", "shaders/particle_composite.frag");
+        glGenVertexArrays(1, &m_emptyVao);
+    }
+
+    OffscreenParticleTarget::~OffscreenParticleTarget()
+    {
+        release();
+        if (m_emptyVao != 0)
+        {
+            glDeleteVertexArrays(1, &m_emptyVao);
+        }
+    }
+
+    void OffscreenParticleTarget::release()
+    {
+        glDeleteFramebuffers(1, &m_sceneDepthFbo);
+        glDeleteFramebuffers(1, &m_particleFbo);
+        glDeleteTextures(1, &m_sceneDepth);
+        glDeleteTextures(1, &m_particleColor);
+        glDeleteTextures(1, &m_particleDepth);
+        m_sceneDepthFbo = m_particleFbo = 0;
+        m_sceneDepth = m_particleColor = m_particleDepth = 0;
+        m_width = m_height = 0;
+    }
+
+    void OffscreenParticleTarget::resize(int width, int height, int divisor)
+    {
+        release();
+        m_width = width;
+        m_height = height;
+        m_divisor = divisor;
+        const int lowWidth = (width + divisor - 1) / divisor;
+        const int lowHeight = (height + divisor - 1) / divisor;
+
+        // Must match the default framebuffer's depth format (GLFW asks for 24-bit depth and
+        // 8-bit stencil) for the multisample resolve blit
+        m_sceneDepth = createTexture(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, width, height);
+        glGenFramebuffers(1, &m_sceneDepthFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_sceneDepthFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_sceneDepth, 0);
+
+        m_particleColor = createTexture(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, lowWidth, lowHeight);
+        m_particleDepth = createTexture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, lowWidth, lowHeight);
+        glGenFramebuffers(1, &m_particleFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_particleFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_particleColor, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_particleDepth, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            log(LogLevel::Error, "Offscreen particle target is incomplete");
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        log(LogLevel::Info, "Particles render at " + std::to_string(lowWidth) + "x" + std::to_string(lowHeight) +
+                                " (1/" + std::to_string(divisor) + " resolution)");
+    }
+
+    void OffscreenParticleTarget::begin(int width, int height, int divisor)
+    {
+        if (width != m_width || height != m_height || divisor != m_divisor)
+        {
+            resize(width, height, divisor);
+        }
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_sceneDepthFbo);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_particleFbo);
+        glViewport(0, 0, (width + divisor - 1) / divisor, (height + divisor - 1) / divisor);
+
+        // Depth only: every fragment writes, so no clear is needed first
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_ALWAYS);
+        glDepthMask(GL_TRUE);
+        m_downsampleShader->bind();
+        m_downsampleShader->setInt("uSceneDepth", kSceneDepthUnit);
+        m_downsampleShader->setInt("uDivisor", divisor);
+        glActiveTexture(GL_TEXTURE0 + kSceneDepthUnit);
+        glBindTexture(GL_TEXTURE_2D, m_sceneDepth);
+        glBindVertexArray(m_emptyVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glDepthFunc(GL_LESS);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    void OffscreenParticleTarget::composite(const glm::mat4& projection)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, m_width, m_height);
+
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        m_compositeShader->bind();
+        m_compositeShader->setInt("uParticles", kParticleUnit);
+        m_compositeShader->setInt("uParticleDepth", kParticleDepthUnit);
+        m_compositeShader->setInt("uSceneDepth", kSceneDepthUnit);
+        m_compositeShader->setVec2("uDepthParams", glm::vec2(projection[2][2], projection[3][2]));
+        glActiveTexture(GL_TEXTURE0 + kParticleUnit);
+        glBindTexture(GL_TEXTURE_2D, m_particleColor);
+        glActiveTexture(GL_TEXTURE0 + kParticleDepthUnit);
+        glBindTexture(GL_TEXTURE_2D, m_particleDepth);
+        glActiveTexture(GL_TEXTURE0 + kSceneDepthUnit);
+        glBindTexture(GL_TEXTURE_2D, m_sceneDepth);
+        glBindVertexArray(m_emptyVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+
+        for (GLint unit : {kParticleUnit, kParticleDepthUnit, kSceneDepthUnit})
+        {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        glActiveTexture(GL_TEXTURE0);
+        glUseProgram(0);
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+    }
+} // namespace cg
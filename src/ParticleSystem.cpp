@@ -1,9 +1,21 @@
 #include "render/ParticleSystem.h"
 
+#include "util/Log.h"
+#include "util/Parallel.h"
+#include "util/Random.h"
+
 #include <glad/glad.h>
 
 #include <algorithm>
-#include <future>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CG_PARTICLES_SSE 1
+#include <xmmintrin.h>
+#endif
 
 namespace cg
 {
@@ -12,11 +24,128 @@ namespace cg
         constexpr GLuint kParticlePosLocation = 0;
         constexpr GLuint kParticleColorLocation = 1;
         constexpr GLuint kParticleSizeLocation = 2;
+
+        // Particles per update task; also the granularity of dead-particle bookkeeping.
+        // A multiple of 8 keeps every batch start aligned for the SIMD loads.
+        constexpr size_t kBatchSize = 1024;
+
+        // particle.vert sets gl_PointSize to size * clamp(kPointSizeDistance / viewDistance, min, max)
+        constexpr float kPointSizeDistance = 800.0f;
+        constexpr float kPointSizeMinScale = 0.5f;
+        constexpr float kPointSizeMaxScale = 8.0f;
+
+        // Where sampleBurst writes each field of a burst; the CPU simulation points most of
+        // these into particle storage, the GPU path into scratch it then packs into spawns
+        struct BurstColumns
+        {
+            float* positionX;
+            float* positionY;
+            float* positionZ;
+            float* velocityX;  // The local direction until the final pass
+            float* velocityY;
+            float* velocityZ;
+            float* inverseLifetime;
+            float* startSize;
+            float* endSize;
+            float* brighten;
+            float* speed;
+            float* offset;
+            float* jitter[4];
+        };
+        constexpr size_t kScratchColumnsCpu = 7;  // brighten through jitter
+        constexpr size_t kScratchColumnsGpu = 16;  // every column
+
+        void sampleBurst(const ParticleSystem::BurstParams& burst, size_t count, Random& random, const BurstColumns& c)
+        {
+            random.fillUniform(c.inverseLifetime, count, burst.minLifetime, burst.maxLifetime);
+            for (size_t i = 0; i < count; ++i)
+            {
+                c.inverseLifetime[i] = 1.0f / std::max(0.01f, c.inverseLifetime[i]);
+            }
+            random.fillUniform(c.startSize, count, burst.minStartSize, burst.maxStartSize);
+            random.fillUniform(c.endSize, count, burst.minEndSize, burst.maxEndSize);
+            random.fillUniform(c.brighten, count, 0.0f, std::max(0.0f, burst.maxBrighten));
+            random.fillUnitVectors(c.velocityX, c.velocityY, c.velocityZ, count,
+                                   std::cos(std::clamp(burst.coneAngle, 0.0f, glm::pi<float>())));
+            random.fillUniform(c.speed, count, burst.minSpeed, burst.maxSpeed);
+            random.fillUniform(c.offset, count, burst.minOffset, burst.maxOffset);
+            for (float* jitter : c.jitter)
+            {
+                random.fillUniform(jitter, count, -1.0f, 1.0f);
+            }
+
+            // The directions were drawn around +Z; turn them to the burst direction
+            const glm::vec3 axis = glm::length(burst.direction) > 0.0f ? glm::normalize(burst.direction) : glm::vec3(0.0f, 1.0f, 0.0f);
+            const glm::vec3 helper = std::abs(axis.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+            const glm::vec3 tangent = glm::normalize(glm::cross(helper, axis));
+            const glm::vec3 bitangent = glm::cross(axis, tangent);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const glm::vec3 dir = tangent * c.velocityX[i] + bitangent * c.velocityY[i] + axis * c.velocityZ[i];
+                const glm::vec3 position = burst.origin + dir * c.offset[i] +
+                                           burst.positionJitter[0] * c.jitter[0][i] + burst.positionJitter[1] * c.jitter[1][i];
+                const glm::vec3 velocity = dir * c.speed[i] +
+                                           burst.velocityJitter[0] * c.jitter[2][i] + burst.velocityJitter[1] * c.jitter[3][i];
+                c.positionX[i] = position.x;
+                c.positionY[i] = position.y;
+                c.positionZ[i] = position.z;
+                c.velocityX[i] = velocity.x;
+                c.velocityY[i] = velocity.y;
+                c.velocityZ[i] = velocity.z;
+            }
+        }
+
+        // verifyGpuSimulation: fixed seed, step length, and how far the two sides may drift
+        // apart (relative, or absolute below 1)
+        constexpr uint64_t kCheckSeed = 0x5eed;
+        constexpr float kCheckStepSeconds = 1.0f / 60.0f;
+        constexpr float kCheckTolerance = 1e-4f;
+
+        bool nearlyEqual(const glm::vec4& actual, const glm::vec4& expected)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                if (std::abs(actual[i] - expected[i]) > kCheckTolerance * std::max(1.0f, std::abs(expected[i])))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        glm::vec4 burstColor(const ParticleSystem::BurstParams& burst, size_t index, float brighten)
+        {
+            const glm::vec4 base = burst.palette.empty() ? glm::vec4(1.0f) : burst.palette[index % burst.palette.size()];
+            return glm::vec4(glm::mix(glm::vec3(base), glm::vec3(1.0f), brighten), base.a);
+        }
     }
 
-    ParticleSystem::ParticleSystem(size_t maxParticles)
+    ParticleSystem::ParticleSystem(size_t maxParticles, bool gpuSimulation)
         : m_maxParticles(maxParticles)
     {
+        if (gpuSimulation && !GpuParticleSimulation::isSupported())
+        {
+            log(LogLevel::Warn, "GPU particle simulation needs OpenGL 4.3 compute shaders; simulating on the CPU");
+            gpuSimulation = false;
+        }
+        if (gpuSimulation)
+        {
+            m_pendingSpawns.reserve(m_maxParticles);
+        }
+        else
+        {
+            for (AlignedVector<float>* field : {
+                 &m_particles.positionX, &m_particles.positionY, &m_particles.positionZ,
+                 &m_particles.velocityX, &m_particles.velocityY, &m_particles.velocityZ,
+                 &m_particles.accelerationX, &m_particles.accelerationY, &m_particles.accelerationZ,
+                 &m_particles.age, &m_particles.inverseLifetime, &m_particles.startSize, &m_particles.endSize})
+            {
+                field->resize(m_maxParticles);
+            }
+            m_particles.baseColor.resize(m_maxParticles);
+            m_drawList.resize(m_maxParticles);
+        }
+
         m_shader = std::make_unique<Shader>("shaders/particle.vert", "shaders/particle.frag");
 
         glGenVertexArrays(1, &m_vao);
@@ -36,10 +165,17 @@ namespace cg
         glVertexAttribPointer(kParticleSizeLocation, 1, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), reinterpret_cast<void*>(offsetof(GpuParticle, size)));
 
         glBindVertexArray(0);
+
+        if (gpuSimulation)
+        {
+            m_gpuSimulation = std::make_unique<GpuParticleSimulation>(m_maxParticles, m_vbo);
+            log(LogLevel::Info, "Particles simulated on the GPU");
+        }
     }
 
     ParticleSystem::~ParticleSystem()
     {
+        m_gpuSimulation.reset();
         if (m_vbo != 0)
         {
             glDeleteBuffers(1, &m_vbo);
@@ -52,108 +188,362 @@ namespace cg
 
     void ParticleSystem::emit(const SpawnParams& params)
     {
-        if (m_particles.size() >= m_maxParticles)
+        if (m_gpuSimulation)
+        {
+            if (m_pendingSpawns.size() < m_maxParticles)
+            {
+                m_pendingSpawns.push_back(GpuParticleSimulation::Spawn{
+                    glm::vec4(params.position, 0.0f),
+                    glm::vec4(params.velocity, 1.0f / std::max(0.01f, params.lifetime)),
+                    glm::vec4(params.acceleration, params.startSize),
+                    params.color,
+                    glm::vec4(params.endSize, 0.0f, 0.0f, 0.0f)});
+            }
+            return;
+        }
+        if (m_count >= m_maxParticles)
         {
             return;
         }
 
-        Particle particle;
-        particle.position = params.position;
-        particle.velocity = params.velocity;
-        particle.acceleration = params.acceleration;
-        particle.baseColor = params.color;
-        particle.startSize = params.startSize;
-        particle.endSize = params.endSize;
-        particle.lifetime = std::max(0.01f, params.lifetime);
-        particle.age = 0.0f;
-        particle.renderColor = params.color;
-        particle.renderSize = params.startSize;
+        const size_t i = m_count++;
+        Particles& p = m_particles;
+        p.positionX[i] = params.position.x;
+        p.positionY[i] = params.position.y;
+        p.positionZ[i] = params.position.z;
+        p.velocityX[i] = params.velocity.x;
+        p.velocityY[i] = params.velocity.y;
+        p.velocityZ[i] = params.velocity.z;
+        p.accelerationX[i] = params.acceleration.x;
+        p.accelerationY[i] = params.acceleration.y;
+        p.accelerationZ[i] = params.acceleration.z;
+        p.age[i] = 0.0f;
+        p.inverseLifetime[i] = 1.0f / std::max(0.01f, params.lifetime);
+        p.startSize[i] = params.startSize;
+        p.endSize[i] = params.endSize;
+        p.baseColor[i] = params.color;
+
+        // Drawn as spawned until the next update
+        m_drawList[i] = GpuParticle{params.position, params.color, params.startSize};
+    }
 
-        m_particles.push_back(particle);
+    void ParticleSystem::seedRandom(uint64_t seed)
+    {
+        m_random.seed(seed);
     }
 
-    void ParticleSystem::update(float deltaSeconds)
+    size_t ParticleSystem::emitBurst(const BurstParams& burst)
     {
-        if (m_particles.empty())
+        const size_t first = m_gpuSimulation ? m_pendingSpawns.size() : m_count;
+        const size_t count = std::min(burst.count, m_maxParticles - first);
+        if (count == 0)
         {
-            return;
+            return 0;
         }
 
-        const float dt = std::max(0.0f, deltaSeconds);
-        auto processRange = [&](size_t begin, size_t end)
+        // Scratch columns start 32-byte aligned like the particle storage
+        const size_t stride = (count + 7) & ~size_t(7);
+        m_burstScratch.resize(stride * (m_gpuSimulation ? kScratchColumnsGpu : kScratchColumnsCpu));
+        float* scratch = m_burstScratch.data();
+        auto nextColumn = [&]() {
+            float* column = scratch;
+            scratch += stride;
+            return column;
+        };
+
+        BurstColumns columns{};
+        if (m_gpuSimulation)
         {
-            for (size_t i = begin; i < end; ++i)
+            for (float** column : {&columns.positionX, &columns.positionY, &columns.positionZ,
+                                   &columns.velocityX, &columns.velocityY, &columns.velocityZ,
+                                   &columns.inverseLifetime, &columns.startSize, &columns.endSize})
             {
-                Particle& particle = m_particles[i];
-                particle.age += dt;
-                particle.velocity += particle.acceleration * dt;
-                particle.position += particle.velocity * dt;
-
-                const float lifeRatio = std::clamp(particle.age / particle.lifetime, 0.0f, 1.0f);
-                const float alpha = std::clamp(1.0f - lifeRatio, 0.0f, 1.0f);
-                particle.renderColor = glm::vec4(glm::vec3(particle.baseColor), particle.baseColor.a * alpha);
-                particle.renderSize = glm::mix(particle.startSize, particle.endSize, lifeRatio);
+                *column = nextColumn();
             }
-        };
+        }
+        else
+        {
+            Particles& p = m_particles;
+            columns.positionX = &p.positionX[first];
+            columns.positionY = &p.positionY[first];
+            columns.positionZ = &p.positionZ[first];
+            columns.velocityX = &p.velocityX[first];
+            columns.velocityY = &p.velocityY[first];
+            columns.velocityZ = &p.velocityZ[first];
+            columns.inverseLifetime = &p.inverseLifetime[first];
+            columns.startSize = &p.startSize[first];
+            columns.endSize = &p.endSize[first];
+        }
+        columns.brighten = nextColumn();
+        columns.speed = nextColumn();
+        columns.offset = nextColumn();
+        for (float*& jitter : columns.jitter)
+        {
+            jitter = nextColumn();
+        }
 
-        constexpr size_t kParallelThreshold = 1200;
-        if (m_particles.size() > kParallelThreshold)
+        sampleBurst(burst, count, m_random, columns);
+
+        if (m_gpuSimulation)
         {
-            const size_t mid = m_particles.size() / 2;
-            auto future = std::async(std::launch::async, processRange, mid, m_particles.size());
-            processRange(0, mid);
-            future.get();
+            m_pendingSpawns.resize(first + count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                m_pendingSpawns[first + i] = GpuParticleSimulation::Spawn{
+                    glm::vec4(columns.positionX[i], columns.positionY[i], columns.positionZ[i], 0.0f),
+                    glm::vec4(columns.velocityX[i], columns.velocityY[i], columns.velocityZ[i], columns.inverseLifetime[i]),
+                    glm::vec4(burst.acceleration, columns.startSize[i]),
+                    burstColor(burst, i, columns.brighten[i]),
+                    glm::vec4(columns.endSize[i], 0.0f, 0.0f, 0.0f)};
+            }
+            return count;
         }
-        else
+
+        const size_t end = first + count;
+        Particles& p = m_particles;
+        std::fill(p.age.begin() + first, p.age.begin() + end, 0.0f);
+        std::fill(p.accelerationX.begin() + first, p.accelerationX.begin() + end, burst.acceleration.x);
+        std::fill(p.accelerationY.begin() + first, p.accelerationY.begin() + end, burst.acceleration.y);
+        std::fill(p.accelerationZ.begin() + first, p.accelerationZ.begin() + end, burst.acceleration.z);
+        for (size_t i = first; i < end; ++i)
         {
-            processRange(0, m_particles.size());
+            p.baseColor[i] = burstColor(burst, i - first, columns.brighten[i - first]);
+            m_drawList[i] = GpuParticle{{p.positionX[i], p.positionY[i], p.positionZ[i]}, p.baseColor[i], p.startSize[i]};
         }
 
-        m_particles.erase(std::remove_if(m_particles.begin(), m_particles.end(),
-            [](const Particle& particle) { return particle.age >= particle.lifetime; }),
-            m_particles.end());
+        m_count = end;
+        return count;
     }
 
-    void ParticleSystem::uploadParticlesToGpu()
+    void ParticleSystem::update(float deltaSeconds)
     {
-        m_gpuBuffer.clear();
-        m_gpuBuffer.reserve(m_particles.size());
+        if (m_gpuSimulation)
+        {
+            m_pendingDeltaSeconds += std::max(0.0f, deltaSeconds);
+            return;
+        }
+        if (m_count == 0)
+        {
+            return;
+        }
 
-        for (const auto& particle : m_particles)
+        const float dt = std::max(0.0f, deltaSeconds);
+        const size_t count = m_count;
+        const size_t batches = (count + kBatchSize - 1) / kBatchSize;
+        m_deadPerBatch.assign(batches, 0);
+        parallelFor(batches, [&](size_t batch) {
+            const size_t begin = batch * kBatchSize;
+            updateRange(begin, std::min(count, begin + kBatchSize), dt);
+        });
+
+        // Swap-with-last from the top down: everything above i is already known to be alive
+        for (size_t batch = batches; batch-- > 0;)
         {
-            if (particle.renderColor.a <= 0.001f || particle.renderSize <= 0.0f)
+            if (m_deadPerBatch[batch] == 0)
             {
                 continue;
             }
+            const size_t begin = batch * kBatchSize;
+            for (size_t i = std::min(m_count, begin + kBatchSize); i-- > begin;)
+            {
+                if (m_particles.age[i] * m_particles.inverseLifetime[i] >= 1.0f)
+                {
+                    moveParticle(--m_count, i);
+                }
+            }
+        }
+    }
 
-            GpuParticle gpuParticle;
-            gpuParticle.position = particle.position;
-            gpuParticle.color = particle.renderColor;
-            gpuParticle.size = particle.renderSize;
-            m_gpuBuffer.push_back(gpuParticle);
+    void ParticleSystem::updateRange(size_t begin, size_t end, float dt)
+    {
+        // Integrates [begin, end), writes each particle's draw entry and counts the ones
+        // that died; they are removed afterwards so batches never touch each other
+        Particles& p = m_particles;
+        size_t dead = 0;
+        size_t i = begin;
+
+#ifdef CG_PARTICLES_SSE
+        const __m128 dt4 = _mm_set1_ps(dt);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        alignas(16) float x[4], y[4], z[4], alpha[4], size[4];
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 age = _mm_add_ps(_mm_load_ps(&p.age[i]), dt4);
+            const __m128 vx = _mm_add_ps(_mm_load_ps(&p.velocityX[i]), _mm_mul_ps(_mm_load_ps(&p.accelerationX[i]), dt4));
+            const __m128 vy = _mm_add_ps(_mm_load_ps(&p.velocityY[i]), _mm_mul_ps(_mm_load_ps(&p.accelerationY[i]), dt4));
+            const __m128 vz = _mm_add_ps(_mm_load_ps(&p.velocityZ[i]), _mm_mul_ps(_mm_load_ps(&p.accelerationZ[i]), dt4));
+            const __m128 px = _mm_add_ps(_mm_load_ps(&p.positionX[i]), _mm_mul_ps(vx, dt4));
+            const __m128 py = _mm_add_ps(_mm_load_ps(&p.positionY[i]), _mm_mul_ps(vy, dt4));
+            const __m128 pz = _mm_add_ps(_mm_load_ps(&p.positionZ[i]), _mm_mul_ps(vz, dt4));
+            _mm_store_ps(&p.age[i], age);
+            _mm_store_ps(&p.velocityX[i], vx);
+            _mm_store_ps(&p.velocityY[i], vy);
+            _mm_store_ps(&p.velocityZ[i], vz);
+            _mm_store_ps(&p.positionX[i], px);
+            _mm_store_ps(&p.positionY[i], py);
+            _mm_store_ps(&p.positionZ[i], pz);
+
+            const __m128 lifeRatio = _mm_mul_ps(age, _mm_load_ps(&p.inverseLifetime[i]));
+            dead += static_cast<size_t>(std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_cmpge_ps(lifeRatio, one)))));
+            const __m128 t = _mm_min_ps(_mm_max_ps(lifeRatio, zero), one);
+            const __m128 startSize = _mm_load_ps(&p.startSize[i]);
+            _mm_store_ps(alpha, _mm_sub_ps(one, t));
+            _mm_store_ps(size, _mm_add_ps(startSize, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&p.endSize[i]), startSize), t)));
+            _mm_store_ps(x, px);
+            _mm_store_ps(y, py);
+            _mm_store_ps(z, pz);
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                const glm::vec4& color = p.baseColor[i + lane];
+                m_drawList[i + lane] = GpuParticle{{x[lane], y[lane], z[lane]}, {color.r, color.g, color.b, color.a * alpha[lane]}, size[lane]};
+            }
         }
+#endif
 
-        if (m_gpuBuffer.empty())
+        for (; i < end; ++i)
         {
-            return;
+            p.age[i] += dt;
+            p.velocityX[i] += p.accelerationX[i] * dt;
+            p.velocityY[i] += p.accelerationY[i] * dt;
+            p.velocityZ[i] += p.accelerationZ[i] * dt;
+            p.positionX[i] += p.velocityX[i] * dt;
+            p.positionY[i] += p.velocityY[i] * dt;
+            p.positionZ[i] += p.velocityZ[i] * dt;
+
+            const float lifeRatio = p.age[i] * p.inverseLifetime[i];
+            dead += lifeRatio >= 1.0f ? 1 : 0;
+            const float t = std::clamp(lifeRatio, 0.0f, 1.0f);
+            const glm::vec4& color = p.baseColor[i];
+            m_drawList[i] = GpuParticle{{p.positionX[i], p.positionY[i], p.positionZ[i]},
+                                        {color.r, color.g, color.b, color.a * (1.0f - t)},
+                                        p.startSize[i] + (p.endSize[i] - p.startSize[i]) * t};
         }
 
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, m_gpuBuffer.size() * sizeof(GpuParticle), m_gpuBuffer.data());
+        m_deadPerBatch[begin / kBatchSize] = dead;
+    }
+
+    void ParticleSystem::moveParticle(size_t from, size_t to)
+    {
+        if (from == to)
+        {
+            return;
+        }
+        Particles& p = m_particles;
+        for (AlignedVector<float>* field : {
+                 &p.positionX, &p.positionY, &p.positionZ,
+                 &p.velocityX, &p.velocityY, &p.velocityZ,
+                 &p.accelerationX, &p.accelerationY, &p.accelerationZ,
+                 &p.age, &p.inverseLifetime, &p.startSize, &p.endSize})
+        {
+            (*field)[to] = (*field)[from];
+        }
+        p.baseColor[to] = p.baseColor[from];
+        m_drawList[to] = m_drawList[from];
     }
 
-    void ParticleSystem::draw(const Camera& camera, float aspectRatio)
+    void ParticleSystem::buildFrame(Frame& frame, const Camera& camera, int viewportWidth, int viewportHeight)
     {
-        if (m_particles.empty())
+        if (m_gpuSimulation)
         {
+            frame.spawns.swap(m_pendingSpawns);
+            m_pendingSpawns.clear();
+            frame.deltaSeconds = m_pendingDeltaSeconds;
+            m_pendingDeltaSeconds = 0.0f;
             return;
         }
 
-        uploadParticlesToGpu();
-        if (m_gpuBuffer.empty())
+        frame.cullStats = CullStats{};
+        if (viewportWidth <= 0 || viewportHeight <= 0)
+        {
+            frame.particles.assign(m_drawList.begin(), m_drawList.begin() + static_cast<std::ptrdiff_t>(m_count));
+            frame.cullStats.visible = m_count;
+            return;
+        }
+
+        // The copy into the frame is the only pass over the draw list before upload, so the
+        // culling rides along with it. Batches compact into their own slice of the frame,
+        // then slide down over the gaps the culled particles left.
+        const glm::mat4 viewProjection = camera.projectionMatrix(static_cast<float>(viewportWidth) / static_cast<float>(viewportHeight)) * camera.viewMatrix();
+        const float ndcPerPixelX = 1.0f / static_cast<float>(viewportWidth);  // Half a sprite of d pixels spans d / width in NDC
+        const float ndcPerPixelY = 1.0f / static_cast<float>(viewportHeight);
+        const float nearPlane = camera.nearPlane();
+        const size_t count = m_count;
+        const size_t batches = (count + kBatchSize - 1) / kBatchSize;
+        frame.particles.resize(count);
+        m_batchCullStats.assign(batches, CullStats{});
+        parallelFor(batches, [&](size_t batch) {
+            const size_t begin = batch * kBatchSize;
+            const size_t end = std::min(count, begin + kBatchSize);
+            CullStats& stats = m_batchCullStats[batch];
+            GpuParticle* out = frame.particles.data() + begin;
+            for (size_t i = begin; i < end; ++i)
+            {
+                const GpuParticle& particle = m_drawList[i];
+                const glm::vec4 clip = viewProjection * glm::vec4(particle.position, 1.0f);
+                // clip.w is the view distance
+                if (clip.w <= nearPlane)
+                {
+                    ++stats.outsideFrustum;
+                    continue;
+                }
+                const float pixels = particle.size * std::clamp(kPointSizeDistance / clip.w, kPointSizeMinScale, kPointSizeMaxScale);
+                if (pixels < m_minPixelSize || particle.color.a <= 0.0f)
+                {
+                    ++stats.belowMinSize;
+                    continue;
+                }
+                if (std::abs(clip.x) > clip.w * (1.0f + pixels * ndcPerPixelX) ||
+                    std::abs(clip.y) > clip.w * (1.0f + pixels * ndcPerPixelY) ||
+                    clip.z > clip.w)
+                {
+                    ++stats.outsideFrustum;
+                    continue;
+                }
+                *out++ = particle;
+            }
+            stats.visible = static_cast<size_t>(out - (frame.particles.data() + begin));
+        });
+
+        size_t visible = 0;
+        for (size_t batch = 0; batch < batches; ++batch)
+        {
+            const CullStats& stats = m_batchCullStats[batch];
+            const auto first = frame.particles.begin() + static_cast<std::ptrdiff_t>(batch * kBatchSize);
+            if (visible != batch * kBatchSize)
+            {
+                std::copy(first, first + static_cast<std::ptrdiff_t>(stats.visible), frame.particles.begin() + static_cast<std::ptrdiff_t>(visible));
+            }
+            visible += stats.visible;
+            frame.cullStats.outsideFrustum += stats.outsideFrustum;
+            frame.cullStats.belowMinSize += stats.belowMinSize;
+        }
+        frame.particles.resize(visible);
+        frame.cullStats.visible = visible;
+    }
+
+    void ParticleSystem::uploadParticlesToGpu(const std::vector<GpuParticle>& particles)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, particles.size() * sizeof(GpuParticle), particles.data());
+    }
+
+    void ParticleSystem::draw(Frame& frame, const Camera& camera, float aspectRatio, float pointScale)
+    {
+        if (m_gpuSimulation)
+        {
+            m_gpuSimulation->update(frame.spawns, frame.deltaSeconds);
+            frame.spawns.clear();
+            frame.deltaSeconds = 0.0f;
+        }
+        else if (frame.particles.empty())
         {
             return;
         }
+        else
+        {
+            uploadParticlesToGpu(frame.particles);
+        }
 
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE);
@@ -163,15 +553,110 @@ namespace cg
         m_shader->bind();
         m_shader->setMat4("uView", camera.viewMatrix());
         m_shader->setMat4("uProj", camera.projectionMatrix(aspectRatio));
+        m_shader->setFloat("uPointScale", pointScale);
 
         glBindVertexArray(m_vao);
-        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_gpuBuffer.size()));
+        if (m_gpuSimulation)
+        {
+            m_gpuSimulation->draw();
+        }
+        else
+        {
+            glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(frame.particles.size()));
+        }
         glBindVertexArray(0);
 
         glDisable(GL_PROGRAM_POINT_SIZE);
         glDepthMask(GL_TRUE);
         glDisable(GL_BLEND);
     }
-} // namespace cg
 
+    bool ParticleSystem::verifyGpuSimulation(size_t particleCount, int steps)
+    {
+        if (!GpuParticleSimulation::isSupported())
+        {
+            log(LogLevel::Info, "GPU particle check skipped: no OpenGL 4.3 compute shaders");
+            return true;
+        }
+
+        ParticleSystem cpu(particleCount, false);
+        ParticleSystem gpu(particleCount, true);
+        Random random(kCheckSeed);
+        for (size_t i = 0; i < particleCount; ++i)
+        {
+            SpawnParams params;
+            params.position = random.unitVector() * random.uniform(0.0f, 500.0f);
+            params.velocity = random.unitVector() * random.uniform(0.0f, 200.0f);
+            params.acceleration = glm::vec3(0.0f, random.uniform(-50.0f, 0.0f), 0.0f);
+            params.color = glm::vec4(random.nextFloat(), random.nextFloat(), random.nextFloat(), random.uniform(0.5f, 1.0f));
+            params.startSize = random.uniform(10.0f, 60.0f);
+            // Doubles as the particle's id: each side compacts the survivors in its own order
+            params.endSize = static_cast<float>(i);
+            // Half a step clear of any death, so rounding cannot decide who survives
+            params.lifetime = (static_cast<float>(random.uniformInt(1, 2 * steps)) + 0.5f) * kCheckStepSeconds;
+            cpu.emit(params);
+            gpu.emit(params);
+        }
+
+        // The GPU appends spawns after integrating, so they go in with a zero step
+        gpu.m_gpuSimulation->update(gpu.m_pendingSpawns, 0.0f);
+        gpu.m_pendingSpawns.clear();
+        for (int step = 0; step < steps; ++step)
+        {
+            cpu.update(kCheckStepSeconds);
+            gpu.m_gpuSimulation->update({}, kCheckStepSeconds);
+        }
+
+        const std::vector<GpuParticleSimulation::Spawn> state = gpu.m_gpuSimulation->readBack();
+        std::vector<GpuParticle> vertices(state.size());
+        glBindBuffer(GL_ARRAY_BUFFER, gpu.m_vbo);
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(vertices.size() * sizeof(GpuParticle)), vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        constexpr size_t kMissing = std::numeric_limits<size_t>::max();
+        const Particles& p = cpu.m_particles;
+        std::vector<size_t> cpuIndex(particleCount, kMissing);
+        for (size_t i = 0; i < cpu.m_count; ++i)
+        {
+            cpuIndex[static_cast<size_t>(p.endSize[i])] = i;
+        }
+
+        std::string mismatch;
+        if (state.size() != cpu.m_count)
+        {
+            mismatch = std::to_string(state.size()) + " particles alive on the GPU, " + std::to_string(cpu.m_count) + " on the CPU";
+        }
+        for (size_t g = 0; g < state.size() && mismatch.empty(); ++g)
+        {
+            const GpuParticleSimulation::Spawn& actual = state[g];
+            const float id = actual.endSize.x;
+            const size_t i = id >= 0.0f && id < static_cast<float>(particleCount) ? cpuIndex[static_cast<size_t>(id)] : kMissing;
+            if (i == kMissing)
+            {
+                mismatch = "particle " + std::to_string(id) + " is alive only on the GPU";
+                break;
+            }
+            cpuIndex[static_cast<size_t>(id)] = kMissing;  // A duplicate is reported as GPU-only
+
+            const GpuParticle& expected = cpu.m_drawList[i];
+            const bool same =
+                nearlyEqual(actual.positionAge, glm::vec4(p.positionX[i], p.positionY[i], p.positionZ[i], p.age[i])) &&
+                nearlyEqual(glm::vec4(glm::vec3(actual.velocityInverseLifetime), 0.0f), glm::vec4(p.velocityX[i], p.velocityY[i], p.velocityZ[i], 0.0f)) &&
+                nearlyEqual(glm::vec4(vertices[g].position, vertices[g].size), glm::vec4(expected.position, expected.size)) &&
+                nearlyEqual(vertices[g].color, expected.color);
+            if (!same)
+            {
+                mismatch = "particle " + std::to_string(static_cast<size_t>(id)) + " differs";
+            }
+        }
 
+        const std::string summary = std::to_string(particleCount) + " particles, " + std::to_string(steps) + " steps";
+        if (!mismatch.empty())
+        {
+            log(LogLevel::Warn, "GPU particle simulation does not match the CPU (" + summary + "): " + mismatch);
+            return false;
+        }
+        log(LogLevel::Info, "GPU particle simulation matches the CPU (" + summary + ")");
+        return true;
+    }
+} // namespace cg
\ No newline at end of file
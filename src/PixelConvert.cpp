@@ -0,0 +1,517 @@
+#include "util/PixelConvert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CG_PIXELCONVERT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace cg
+{
+    namespace PixelConvert
+    {
+        namespace
+        {
+            constexpr float kRgb9e5Max = 65408.0f;  // (2^9 - 1) / 2^9 * 2^16
+            constexpr int kRgb9e5Bias = 15;
+            constexpr int kRgb9e5MantissaBits = 9;
+
+            // BC6H interpolation weights for 4-bit indices
+            constexpr int kBc6hWeights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+            constexpr int kBc6hMaxHalf = 0x7bff;
+
+            float clampRgb9e5(float value)
+            {
+                // NaN and negatives map to 0
+                return value > 0.0f ? std::min(value, kRgb9e5Max) : 0.0f;
+            }
+
+            uint32_t packRgb9e5(float r, float g, float b)
+            {
+                const float rc = clampRgb9e5(r);
+                const float gc = clampRgb9e5(g);
+                const float bc = clampRgb9e5(b);
+                const float maxRgb = std::max(rc, std::max(gc, bc));
+                if (maxRgb <= 0.0f)
+                {
+                    return 0;
+                }
+
+                int exponent = 0;
+                std::frexp(maxRgb, &exponent);  // maxRgb = m * 2^exponent, m in [0.5, 1)
+                int sharedExp = std::max(-kRgb9e5Bias - 1, exponent - 1) + 1 + kRgb9e5Bias;
+                float scale = std::ldexp(1.0f, kRgb9e5Bias + kRgb9e5MantissaBits - sharedExp);
+                if (static_cast<int>(std::floor(maxRgb * scale + 0.5f)) == (1 << kRgb9e5MantissaBits))
+                {
+                    scale *= 0.5f;
+                    ++sharedExp;
+                }
+
+                const uint32_t rm = static_cast<uint32_t>(std::floor(rc * scale + 0.5f));
+                const uint32_t gm = static_cast<uint32_t>(std::floor(gc * scale + 0.5f));
+                const uint32_t bm = static_cast<uint32_t>(std::floor(bc * scale + 0.5f));
+                return rm | (gm << 9) | (bm << 18) | (static_cast<uint32_t>(sharedExp) << 27);
+            }
+
+            // Endpoint quantization for 10-bit unsigned BC6H: the decoder expands q to
+            // ((q << 16) + 0x8000) >> 10 and then scales by 31/64, i.e. roughly q * 31 + 15.
+            int quantizeBc6hEndpoint(float halfValue)
+            {
+                return std::clamp(static_cast<int>(std::lround((halfValue - 15.0f) / 31.0f)), 0, 1023);
+            }
+
+            int unquantizeBc6hEndpoint(int q)
+            {
+                if (q == 0) return 0;
+                if (q == 1023) return 0xffff;
+                return ((q << 16) + 0x8000) >> 10;
+            }
+
+            class BitWriter
+            {
+            public:
+                explicit BitWriter(uint8_t* dst) : m_dst(dst) { std::memset(m_dst, 0, 16); }
+
+                void write(uint32_t value, int bits)
+                {
+                    for (int i = 0; i < bits; ++i, ++m_pos)
+                    {
+                        m_dst[m_pos >> 3] |= static_cast<uint8_t>(((value >> i) & 1u) << (m_pos & 7));
+                    }
+                }
+
+            private:
+                uint8_t* m_dst;
+                int m_pos{0};
+            };
+
+            // Principal axis of a block's texels, clipped to the range their projections span
+            void fitPrincipalAxis(const float (&texels)[16][3], float (&lo)[3], float (&hi)[3])
+            {
+                float mean[3] = {0.0f, 0.0f, 0.0f};
+                for (const auto& t : texels)
+                {
+                    for (int c = 0; c < 3; ++c) mean[c] += t[c];
+                }
+                for (float& m : mean) m /= 16.0f;
+
+                float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+                for (const auto& t : texels)
+                {
+                    const float d0 = t[0] - mean[0];
+                    const float d1 = t[1] - mean[1];
+                    const float d2 = t[2] - mean[2];
+                    cov[0] += d0 * d0; cov[1] += d0 * d1; cov[2] += d0 * d2;
+                    cov[3] += d1 * d1; cov[4] += d1 * d2; cov[5] += d2 * d2;
+                }
+                float axis[3] = {1.0f, 1.0f, 1.0f};
+                for (int iter = 0; iter < 6; ++iter)
+                {
+                    const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+                    const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+                    const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+                    const float len = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+                    if (len <= 0.0f) break;
+                    axis[0] = x / len; axis[1] = y / len; axis[2] = z / len;
+                }
+
+                float minT = 0.0f;
+                float maxT = 0.0f;
+                for (const auto& t : texels)
+                {
+                    const float proj = (t[0] - mean[0]) * axis[0] + (t[1] - mean[1]) * axis[1] + (t[2] - mean[2]) * axis[2];
+                    minT = std::min(minT, proj);
+                    maxT = std::max(maxT, proj);
+                }
+                const float axisLen2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+                if (axisLen2 > 0.0f)
+                {
+                    minT /= axisLen2;
+                    maxT /= axisLen2;
+                }
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    lo[c] = mean[c] + axis[c] * minT;
+                    hi[c] = mean[c] + axis[c] * maxT;
+                }
+            }
+
+            // texels: 16 RGB values as half-float bit patterns (non-negative, <= kBc6hMaxHalf)
+            void encodeBc6hBlock(const float (&texels)[16][3], uint8_t* dst)
+            {
+                // Principal axis of the block in half-bit space
+                float lo[3];
+                float hi[3];
+                fitPrincipalAxis(texels, lo, hi);
+
+                int q[2][3];
+                for (int c = 0; c < 3; ++c)
+                {
+                    q[0][c] = quantizeBc6hEndpoint(lo[c]);
+                    q[1][c] = quantizeBc6hEndpoint(hi[c]);
+                }
+
+                // Decoded palette exactly as the hardware sees it (before the final * 31 / 64)
+                int palette[16][3];
+                for (int c = 0; c < 3; ++c)
+                {
+                    const int e0 = unquantizeBc6hEndpoint(q[0][c]);
+                    const int e1 = unquantizeBc6hEndpoint(q[1][c]);
+                    for (int i = 0; i < 16; ++i)
+                    {
+                        const int w = kBc6hWeights[i];
+                        palette[i][c] = (((64 - w) * e0 + w * e1 + 32) >> 6) * 31 >> 6;
+                    }
+                }
+
+                int indices[16];
+                for (int p = 0; p < 16; ++p)
+                {
+                    int best = 0;
+                    float bestError = std::numeric_limits<float>::max();
+                    for (int i = 0; i < 16; ++i)
+                    {
+                        const float d0 = texels[p][0] - static_cast<float>(palette[i][0]);
+                        const float d1 = texels[p][1] - static_cast<float>(palette[i][1]);
+                        const float d2 = texels[p][2] - static_cast<float>(palette[i][2]);
+                        const float error = d0 * d0 + d1 * d1 + d2 * d2;
+                        if (error < bestError)
+                        {
+                            bestError = error;
+                            best = i;
+                        }
+                    }
+                    indices[p] = best;
+                }
+
+                // The first index is stored with an implicit 0 MSB; swap endpoints if needed
+                if (indices[0] >= 8)
+                {
+                    for (int c = 0; c < 3; ++c) std::swap(q[0][c], q[1][c]);
+                    for (int& index : indices) index = 15 - index;
+                }
+
+                // Mode 11: 5 mode bits, two 10-bit RGB endpoints, 63 index bits
+                BitWriter writer(dst);
+                writer.write(0x03, 5);
+                for (int e = 0; e < 2; ++e)
+                {
+                    for (int c = 0; c < 3; ++c) writer.write(static_cast<uint32_t>(q[e][c]), 10);
+                }
+                writer.write(static_cast<uint32_t>(indices[0]), 3);
+                for (int p = 1; p < 16; ++p) writer.write(static_cast<uint32_t>(indices[p]), 4);
+            }
+
+            uint16_t packRgb565(const float (&rgb)[3])
+            {
+                const int r = std::clamp(static_cast<int>(std::lround(rgb[0] * 31.0f / 255.0f)), 0, 31);
+                const int g = std::clamp(static_cast<int>(std::lround(rgb[1] * 63.0f / 255.0f)), 0, 63);
+                const int b = std::clamp(static_cast<int>(std::lround(rgb[2] * 31.0f / 255.0f)), 0, 31);
+                return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+            }
+
+            void unpackRgb565(uint16_t color, int (&rgb)[3])
+            {
+                const int r = color >> 11;
+                const int g = (color >> 5) & 0x3f;
+                const int b = color & 0x1f;
+                rgb[0] = (r << 3) | (r >> 2);
+                rgb[1] = (g << 2) | (g >> 4);
+                rgb[2] = (b << 3) | (b >> 2);
+            }
+
+            void writeLittleEndian(uint8_t* dst, uint64_t value, int bytes)
+            {
+                for (int i = 0; i < bytes; ++i)
+                {
+                    dst[i] = static_cast<uint8_t>(value >> (8 * i));
+                }
+            }
+
+            // texels: 16 RGB values in 0-255. Always uses the four-color mode (color0 > color1),
+            // which is also the only mode BC3 color blocks have.
+            void encodeBc1ColorBlock(const float (&texels)[16][3], uint8_t* dst)
+            {
+                float lo[3];
+                float hi[3];
+                fitPrincipalAxis(texels, lo, hi);
+                uint16_t color0 = packRgb565(hi);
+                uint16_t color1 = packRgb565(lo);
+                if (color0 < color1)
+                {
+                    std::swap(color0, color1);
+                }
+
+                // Equal endpoints leave every index at 0, which selects color0
+                uint32_t indices = 0;
+                if (color0 != color1)
+                {
+                    int e0[3];
+                    int e1[3];
+                    unpackRgb565(color0, e0);
+                    unpackRgb565(color1, e1);
+                    int palette[4][3];
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        palette[0][c] = e0[c];
+                        palette[1][c] = e1[c];
+                        palette[2][c] = (2 * e0[c] + e1[c]) / 3;
+                        palette[3][c] = (e0[c] + 2 * e1[c]) / 3;
+                    }
+                    for (int p = 0; p < 16; ++p)
+                    {
+                        int best = 0;
+                        float bestError = std::numeric_limits<float>::max();
+                        for (int i = 0; i < 4; ++i)
+                        {
+                            const float d0 = texels[p][0] - static_cast<float>(palette[i][0]);
+                            const float d1 = texels[p][1] - static_cast<float>(palette[i][1]);
+                            const float d2 = texels[p][2] - static_cast<float>(palette[i][2]);
+                            const float error = d0 * d0 + d1 * d1 + d2 * d2;
+                            if (error < bestError)
+                            {
+                                bestError = error;
+                                best = i;
+                            }
+                        }
+                        indices |= static_cast<uint32_t>(best) << (2 * p);
+                    }
+                }
+
+                writeLittleEndian(dst, color0, 2);
+                writeLittleEndian(dst + 2, color1, 2);
+                writeLittleEndian(dst + 4, indices, 4);
+            }
+
+            // Eight-value mode: alpha0 = max > alpha1 = min, six interpolated steps between
+            void encodeBc3AlphaBlock(const uint8_t (&alpha)[16], uint8_t* dst)
+            {
+                const uint8_t alpha0 = *std::max_element(std::begin(alpha), std::end(alpha));
+                const uint8_t alpha1 = *std::min_element(std::begin(alpha), std::end(alpha));
+
+                uint64_t indices = 0;
+                if (alpha0 != alpha1)
+                {
+                    int palette[8];
+                    palette[0] = alpha0;
+                    palette[1] = alpha1;
+                    for (int i = 2; i < 8; ++i)
+                    {
+                        palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7;
+                    }
+                    for (int p = 0; p < 16; ++p)
+                    {
+                        int best = 0;
+                        int bestError = 256;
+                        for (int i = 0; i < 8; ++i)
+                        {
+                            const int error = std::abs(static_cast<int>(alpha[p]) - palette[i]);
+                            if (error < bestError)
+                            {
+                                bestError = error;
+                                best = i;
+                            }
+                        }
+                        indices |= static_cast<uint64_t>(best) << (3 * p);
+                    }
+                }
+
+                dst[0] = alpha0;
+                dst[1] = alpha1;
+                writeLittleEndian(dst + 2, indices, 6);
+            }
+
+            // Gathers a 4x4 RGBA8 block; partial edge blocks repeat the last row/column
+            void fetchRgba8Block(const uint8_t* src, int width, int height, int bx, int by, float (&rgb)[16][3], uint8_t (&alpha)[16])
+            {
+                for (int p = 0; p < 16; ++p)
+                {
+                    const int x = std::min(bx * 4 + (p & 3), width - 1);
+                    const int y = std::min(by * 4 + (p >> 2), height - 1);
+                    const uint8_t* pixel = src + (static_cast<size_t>(y) * width + x) * 4;
+                    rgb[p][0] = pixel[0];
+                    rgb[p][1] = pixel[1];
+                    rgb[p][2] = pixel[2];
+                    alpha[p] = pixel[3];
+                }
+            }
+        } // namespace
+
+        uint16_t floatToHalf(float value)
+        {
+            uint32_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            const uint32_t sign = (bits >> 16) & 0x8000u;
+            uint32_t absBits = bits & 0x7fffffffu;
+
+            if (absBits >= 0x7f800000u)
+            {
+                // Inf stays Inf, NaN becomes a quiet NaN
+                return static_cast<uint16_t>(sign | (absBits > 0x7f800000u ? 0x7e00u : 0x7c00u));
+            }
+            if (absBits >= 0x477ff000u)
+            {
+                return static_cast<uint16_t>(sign | 0x7c00u);
+            }
+            if (absBits < 0x38800000u)
+            {
+                // Denormal half: let the FPU do the rounding via a magic add
+                float f = 0.0f;
+                std::memcpy(&f, &absBits, sizeof(f));
+                f += 0.5f;
+                uint32_t denorm = 0;
+                std::memcpy(&denorm, &f, sizeof(denorm));
+                return static_cast<uint16_t>(sign | (denorm - 0x3f000000u));
+            }
+
+            // Rebias exponent and round to nearest even
+            const uint32_t mantOdd = (absBits >> 13) & 1u;
+            absBits += 0xc8000fffu + mantOdd;
+            return static_cast<uint16_t>(sign | (absBits >> 13));
+        }
+
+        void floatToHalf(const float* src, uint16_t* dst, size_t count)
+        {
+            size_t i = 0;
+#ifdef CG_PIXELCONVERT_SSE2
+            const __m128i maskAbs = _mm_set1_epi32(0x7fffffff);
+            const __m128i infBits = _mm_set1_epi32(0x7f800000);
+            const __m128i maxNormal = _mm_set1_epi32(0x477ff000);  // largest float that rounds below half Inf
+            const __m128i minNormal = _mm_set1_epi32(0x38800000);  // smallest normal half
+            const __m128i rebias = _mm_set1_epi32(static_cast<int>(0xc8000fffu));
+            const __m128i one = _mm_set1_epi32(1);
+            const __m128i halfInf = _mm_set1_epi32(0x7c00);
+            const __m128i halfNaN = _mm_set1_epi32(0x7e00);
+            const __m128 denormMagic = _mm_set1_ps(0.5f);
+            const __m128i denormBias = _mm_set1_epi32(0x3f000000);
+
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128i bits = _mm_castps_si128(_mm_loadu_ps(src + i));
+                const __m128i absBits = _mm_and_si128(bits, maskAbs);
+                const __m128i sign = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(0x8000));
+
+                // Normal range
+                const __m128i mantOdd = _mm_and_si128(_mm_srli_epi32(absBits, 13), one);
+                const __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(absBits, rebias), mantOdd), 13);
+
+                // Denormal range
+                const __m128 denormF = _mm_add_ps(_mm_castsi128_ps(absBits), denormMagic);
+                const __m128i denorm = _mm_sub_epi32(_mm_castps_si128(denormF), denormBias);
+
+                // Overflow / Inf / NaN
+                const __m128i isNaN = _mm_cmpgt_epi32(absBits, infBits);
+                const __m128i special = _mm_or_si128(_mm_and_si128(isNaN, halfNaN), _mm_andnot_si128(isNaN, halfInf));
+
+                const __m128i isDenorm = _mm_cmplt_epi32(absBits, minNormal);
+                const __m128i isOverflow = _mm_cmpgt_epi32(absBits, _mm_sub_epi32(maxNormal, one));
+
+                __m128i result = _mm_or_si128(_mm_and_si128(isDenorm, denorm), _mm_andnot_si128(isDenorm, normal));
+                result = _mm_or_si128(_mm_and_si128(isOverflow, special), _mm_andnot_si128(isOverflow, result));
+                result = _mm_or_si128(result, sign);
+
+                // Sign-extend the low 16 bits so the saturating pack keeps them intact
+                result = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+                const __m128i packed = _mm_packs_epi32(result, result);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), packed);
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                dst[i] = floatToHalf(src[i]);
+            }
+        }
+
+        void floatToRgb9e5(const float* src, int channels, uint32_t* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                const float* p = src + i * static_cast<size_t>(channels);
+                dst[i] = packRgb9e5(p[0], p[1], p[2]);
+            }
+        }
+
+        size_t bc6hSize(int width, int height)
+        {
+            return static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4) * 16;
+        }
+
+        void encodeBc6h(const float* src, int channels, int width, int height, uint8_t* dst)
+        {
+            const int blocksX = (width + 3) / 4;
+            const int blocksY = (height + 3) / 4;
+            float texels[16][3];
+            for (int by = 0; by < blocksY; ++by)
+            {
+                for (int bx = 0; bx < blocksX; ++bx)
+                {
+                    for (int p = 0; p < 16; ++p)
+                    {
+                        const int x = std::min(bx * 4 + (p & 3), width - 1);
+                        const int y = std::min(by * 4 + (p >> 2), height - 1);
+                        const float* pixel = src + (static_cast<size_t>(y) * width + x) * static_cast<size_t>(channels);
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            // Unsigned BC6H works on half bit patterns; negatives and NaN become 0
+                            const float v = pixel[c] > 0.0f ? pixel[c] : 0.0f;
+                            texels[p][c] = static_cast<float>(std::min<int>(floatToHalf(v), kBc6hMaxHalf));
+                        }
+                    }
+                    encodeBc6hBlock(texels, dst + (static_cast<size_t>(by) * blocksX + bx) * 16);
+                }
+            }
+        }
+
+        size_t bc1Size(int width, int height)
+        {
+            return static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4) * 8;
+        }
+
+        size_t bc3Size(int width, int height)
+        {
+            return static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4) * 16;
+        }
+
+        void encodeBc1(const uint8_t* src, int width, int height, uint8_t* dst)
+        {
+            const int blocksX = (width + 3) / 4;
+            const int blocksY = (height + 3) / 4;
+            float rgb[16][3];
+            uint8_t alpha[16];
+            for (int by = 0; by < blocksY; ++by)
+            {
+                for (int bx = 0; bx < blocksX; ++bx)
+                {
+                    fetchRgba8Block(src, width, height, bx, by, rgb, alpha);
+                    encodeBc1ColorBlock(rgb, dst + (static_cast<size_t>(by) * blocksX + bx) * 8);
+                }
+            }
+        }
+
+        void encodeBc3(const uint8_t* src, int width, int height, uint8_t* dst)
+        {
+            const int blocksX = (width + 3) / 4;
+            const int blocksY = (height + 3) / 4;
+            float rgb[16][3];
+            uint8_t alpha[16];
+            for (int by = 0; by < blocksY; ++by)
+            {
+                for (int bx = 0; bx < blocksX; ++bx)
+                {
+                    uint8_t* block = dst + (static_cast<size_t>(by) * blocksX + bx) * 16;
+                    fetchRgba8Block(src, width, height, bx, by, rgb, alpha);
+                    encodeBc3AlphaBlock(alpha, block);
+                    encodeBc1ColorBlock(rgb, block + 8);
+                }
+            }
+        }
+    }
+} // namespace cg
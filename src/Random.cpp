@@ -0,0 +1,213 @@
+#include "util/Random.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CG_RANDOM_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace cg
+{
+    namespace
+    {
+        // splitmix64, the usual way to spread one seed over xoshiro state
+        uint64_t splitMix64(uint64_t& x)
+        {
+            uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        // The top 24 bits: xoshiro128+'s low bits are its weakest
+        float toUnitFloat(uint32_t value)
+        {
+            return static_cast<float>(value >> 8) * 0x1.0p-24f;
+        }
+
+#ifndef CG_RANDOM_SSE
+        uint32_t rotateLeft(uint32_t value, int bits)
+        {
+            return (value << bits) | (value >> (32 - bits));
+        }
+#endif
+    }
+
+    Random::Random(uint64_t seed)
+    {
+        this->seed(seed);
+    }
+
+    void Random::seed(uint64_t seed)
+    {
+        for (size_t lane = 0; lane < kLanes; ++lane)
+        {
+            const uint64_t a = splitMix64(seed);
+            const uint64_t b = splitMix64(seed);
+            m_state[0][lane] = static_cast<uint32_t>(a);
+            m_state[1][lane] = static_cast<uint32_t>(a >> 32);
+            m_state[2][lane] = static_cast<uint32_t>(b);
+            m_state[3][lane] = static_cast<uint32_t>(b >> 32);
+        }
+        m_buffered = 0;
+    }
+
+    uint64_t Random::entropySeed()
+    {
+        std::random_device device;
+        return (static_cast<uint64_t>(device()) << 32) ^ device();
+    }
+
+    void Random::step(uint32_t* out)
+    {
+#ifdef CG_RANDOM_SSE
+        __m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[0]));
+        __m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[1]));
+        __m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[2]));
+        __m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_state[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_add_epi32(s0, s3));
+        const __m128i t = _mm_slli_epi32(s1, 9);
+        s2 = _mm_xor_si128(s2, s0);
+        s3 = _mm_xor_si128(s3, s1);
+        s1 = _mm_xor_si128(s1, s2);
+        s0 = _mm_xor_si128(s0, s3);
+        s2 = _mm_xor_si128(s2, t);
+        s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+        _mm_store_si128(reinterpret_cast<__m128i*>(m_state[0]), s0);
+        _mm_store_si128(reinterpret_cast<__m128i*>(m_state[1]), s1);
+        _mm_store_si128(reinterpret_cast<__m128i*>(m_state[2]), s2);
+        _mm_store_si128(reinterpret_cast<__m128i*>(m_state[3]), s3);
+#else
+        for (size_t lane = 0; lane < kLanes; ++lane)
+        {
+            uint32_t& s0 = m_state[0][lane];
+            uint32_t& s1 = m_state[1][lane];
+            uint32_t& s2 = m_state[2][lane];
+            uint32_t& s3 = m_state[3][lane];
+            out[lane] = s0 + s3;
+            const uint32_t t = s1 << 9;
+            s2 ^= s0;
+            s3 ^= s1;
+            s1 ^= s2;
+            s0 ^= s3;
+            s2 ^= t;
+            s3 = rotateLeft(s3, 11);
+        }
+#endif
+    }
+
+    uint32_t Random::nextUInt()
+    {
+        if (m_buffered == 0)
+        {
+            step(m_buffer);
+            m_buffered = kLanes;
+        }
+        return m_buffer[--m_buffered];
+    }
+
+    float Random::nextFloat()
+    {
+        return toUnitFloat(nextUInt());
+    }
+
+    float Random::uniform(float minValue, float maxValue)
+    {
+        return minValue + (maxValue - minValue) * nextFloat();
+    }
+
+    int Random::uniformInt(int minValue, int maxValue)
+    {
+        if (minValue > maxValue)
+        {
+            std::swap(minValue, maxValue);
+        }
+        // Multiply-shift range reduction; the bias is below 2^-32 per value for small ranges
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(maxValue) - minValue) + 1;
+        return static_cast<int>(minValue + static_cast<int64_t>((nextUInt() * range) >> 32));
+    }
+
+    glm::vec3 Random::unitVector()
+    {
+        const float z = uniform(-1.0f, 1.0f);
+        const float theta = uniform(0.0f, glm::two_pi<float>());
+        const float radius = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        return glm::vec3(radius * std::cos(theta), radius * std::sin(theta), z);
+    }
+
+    void Random::fillUniform(float* out, size_t count, float minValue, float maxValue)
+    {
+        const float scale = (maxValue - minValue) * 0x1.0p-24f;
+        size_t i = 0;
+#ifdef CG_RANDOM_SSE
+        const __m128 scale4 = _mm_set1_ps(scale);
+        const __m128 min4 = _mm_set1_ps(minValue);
+        alignas(16) uint32_t bits[kLanes];
+        for (; i + kLanes <= count; i += kLanes)
+        {
+            step(bits);
+            const __m128i top = _mm_srli_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(bits)), 8);
+            _mm_storeu_ps(out + i, _mm_add_ps(min4, _mm_mul_ps(_mm_cvtepi32_ps(top), scale4)));
+        }
+#else
+        uint32_t bits[kLanes];
+        for (; i + kLanes <= count; i += kLanes)
+        {
+            step(bits);
+            for (size_t lane = 0; lane < kLanes; ++lane)
+            {
+                out[i + lane] = minValue + static_cast<float>(bits[lane] >> 8) * scale;
+            }
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            out[i] = minValue + static_cast<float>(nextUInt() >> 8) * scale;
+        }
+    }
+
+    void Random::fillUnitVectors(float* x, float* y, float* z, size_t count, float minCosine)
+    {
+        // z uniform over [minCosine, 1] is uniform over the cap's area (Archimedes);
+        // x and y hold the angle until the last pass turns it into the ring position
+        fillUniform(z, count, std::clamp(minCosine, -1.0f, 1.0f), 1.0f);
+        fillUniform(x, count, 0.0f, glm::two_pi<float>());
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float radius = std::sqrt(std::max(0.0f, 1.0f - z[i] * z[i]));
+            const float angle = x[i];
+            x[i] = radius * std::cos(angle);
+            y[i] = radius * std::sin(angle);
+        }
+    }
+
+    void Random::fillDisk(float* x, float* y, size_t count, float radius)
+    {
+        fillUniform(x, count, 0.0f, 1.0f);
+        fillUniform(y, count, 0.0f, glm::two_pi<float>());
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float r = radius * std::sqrt(x[i]);
+            const float angle = y[i];
+            x[i] = r * std::cos(angle);
+            y[i] = r * std::sin(angle);
+        }
+    }
+
+    void Random::fillBall(float* x, float* y, float* z, size_t count, float radius)
+    {
+        fillUnitVectors(x, y, z, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float r = radius * std::cbrt(nextFloat());
+            x[i] *= r;
+            y[i] *= r;
+            z[i] *= r;
+        }
+    }
+} // namespace cg
@@ -0,0 +1,135 @@
+#include "core/RenderThread.h"
+
+#include "util/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <string>
+
+namespace cg
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double millisecondsSince(Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+    }
+
+    RenderThread::RenderThread(Window& window, size_t queueLength, RenderFn render, PresentedFn presented)
+        : m_window(window)
+        , m_render(std::move(render))
+        , m_presented(std::move(presented))
+    {
+        const size_t poolSize = std::max<size_t>(1, queueLength) + 2;
+        for (size_t i = 0; i < poolSize; ++i)
+        {
+            m_free.push_back(std::make_unique<FramePacket>());
+        }
+
+        // A context can be current on one thread at a time
+        glfwMakeContextCurrent(nullptr);
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    RenderThread::~RenderThread()
+    {
+        stop();
+    }
+
+    void RenderThread::stop()
+    {
+        if (!m_thread.joinable())
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_packetQueued.notify_all();
+        m_thread.join();
+        glfwMakeContextCurrent(m_window.rawHandle());
+    }
+
+    std::unique_ptr<FramePacket> RenderThread::acquire()
+    {
+        const Clock::time_point start = Clock::now();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_packetFreed.wait(lock, [this]() { return !m_free.empty(); });
+        std::unique_ptr<FramePacket> packet = std::move(m_free.back());
+        m_free.pop_back();
+        m_stats.acquireWaitMs += millisecondsSince(start);
+        return packet;
+    }
+
+    void RenderThread::submit(std::unique_ptr<FramePacket> packet)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.submitted;
+            m_stats.queueDepthSum += m_queue.size();
+            m_stats.maxQueueDepth = std::max(m_stats.maxQueueDepth, m_queue.size());
+            m_queue.push_back(std::move(packet));
+        }
+        m_packetQueued.notify_one();
+    }
+
+    size_t RenderThread::queueDepth() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queue.size();
+    }
+
+    RenderThread::Stats RenderThread::takeStats()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats = m_stats;
+        m_stats = Stats{};
+        return stats;
+    }
+
+    void RenderThread::run()
+    {
+        glfwMakeContextCurrent(m_window.rawHandle());
+        for (;;)
+        {
+            std::unique_ptr<FramePacket> packet;
+            {
+                const Clock::time_point start = Clock::now();
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_packetQueued.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+                if (m_stopping)
+                {
+                    break;
+                }
+                packet = std::move(m_queue.front());
+                m_queue.pop_front();
+                m_stats.renderWaitMs += millisecondsSince(start);
+            }
+
+            try
+            {
+                const Clock::time_point renderStart = Clock::now();
+                m_render(*packet);
+                const double renderMs = millisecondsSince(renderStart);
+                m_window.swapBuffers();
+                m_presented(*packet, renderMs);
+            }
+            catch (const std::exception& e)
+            {
+                log(LogLevel::Error, std::string("Exception on the render thread: ") + e.what());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_free.push_back(std::move(packet));
+            }
+            m_packetFreed.notify_one();
+        }
+        glfwMakeContextCurrent(nullptr);
+    }
+} // namespace cg
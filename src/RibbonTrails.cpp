@@ -0,0 +1,189 @@
+#include "render/RibbonTrails.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cg
+{
+    namespace
+    {
+        constexpr GLuint kRibbonPosLocation = 0;
+        constexpr GLuint kRibbonColorLocation = 1;
+        constexpr GLuint kRibbonAcrossLocation = 2;
+    }
+
+    RibbonTrails::RibbonTrails(const Settings& settings, std::span<const glm::vec4> colors)
+        : m_settings(settings)
+    {
+        m_settings.sampleInterval = std::max(0.01f, m_settings.sampleInterval);
+        m_settings.lifetime = std::max(m_settings.sampleInterval, m_settings.lifetime);
+        // Every point expires before the ring wraps onto it, with one slot to spare
+        const size_t capacity = static_cast<size_t>(std::ceil(m_settings.lifetime / m_settings.sampleInterval)) + 2;
+        for (const glm::vec4& color : colors)
+        {
+            Trail& trail = m_trails.emplace_back();
+            trail.color = color;
+            trail.ring.resize(capacity);
+        }
+
+        m_shader = std::make_unique<Shader>("shaders/ribbon.vert", "shaders/ribbon.frag");
+
+        glGenVertexArrays(1, &m_vao);
+        glGenBuffers(1, &m_vbo);
+
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+        glEnableVertexAttribArray(kRibbonPosLocation);
+        glVertexAttribPointer(kRibbonPosLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
+
+        glEnableVertexAttribArray(kRibbonColorLocation);
+        glVertexAttribPointer(kRibbonColorLocation, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, color)));
+
+        glEnableVertexAttribArray(kRibbonAcrossLocation);
+        glVertexAttribPointer(kRibbonAcrossLocation, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, across)));
+
+        glBindVertexArray(0);
+    }
+
+    RibbonTrails::~RibbonTrails()
+    {
+        if (m_vbo != 0)
+        {
+            glDeleteBuffers(1, &m_vbo);
+        }
+        if (m_vao != 0)
+        {
+            glDeleteVertexArrays(1, &m_vao);
+        }
+    }
+
+    void RibbonTrails::update(float deltaSeconds)
+    {
+        const float dt = std::max(0.0f, deltaSeconds);
+        for (Trail& trail : m_trails)
+        {
+            trail.wasEmitting = trail.emitting;
+            trail.emitting = false;
+            trail.sinceSample += dt;
+
+            for (size_t i = 0; i < trail.count; ++i)
+            {
+                Point& point = trail.ring[(trail.head + trail.ring.size() - i) % trail.ring.size()];
+                point.age += dt;
+                point.velocity += m_settings.acceleration * dt;
+                point.position += point.velocity * dt;
+            }
+            // The oldest points are at the end of the newest-first order
+            while (trail.count > 0 && trail.fromNewest(trail.count - 1).age >= m_settings.lifetime)
+            {
+                --trail.count;
+            }
+        }
+    }
+
+    void RibbonTrails::record(size_t index, const glm::vec3& position, const glm::vec3& velocity)
+    {
+        if (index >= m_trails.size())
+        {
+            return;
+        }
+        Trail& trail = m_trails[index];
+        trail.emitting = true;
+        trail.emitter = position;
+
+        if (trail.count > 0 && trail.wasEmitting && trail.sinceSample < m_settings.sampleInterval)
+        {
+            return;
+        }
+        trail.head = (trail.head + 1) % trail.ring.size();
+        trail.ring[trail.head] = Point{position, velocity, 0.0f, trail.count > 0 && trail.wasEmitting};
+        trail.count = std::min(trail.count + 1, trail.ring.size());
+        trail.sinceSample = 0.0f;
+    }
+
+    void RibbonTrails::buildFrame(Frame& frame, const glm::vec3& cameraPosition) const
+    {
+        frame.vertices.clear();
+        frame.stripFirsts.clear();
+        frame.stripCounts.clear();
+
+        std::vector<Point> strip;
+        for (const Trail& trail : m_trails)
+        {
+            strip.clear();
+            // While emitting, the ribbon reaches all the way to the emitter
+            if (trail.emitting && (trail.count == 0 || glm::length(trail.emitter - trail.fromNewest(0).position) > 1e-3f))
+            {
+                strip.push_back(Point{trail.emitter, glm::vec3(0.0f), 0.0f, true});
+            }
+            for (size_t i = 0; i < trail.count; ++i)
+            {
+                const Point& point = trail.fromNewest(i);
+                strip.push_back(point);
+                if (!point.joinsOlder)
+                {
+                    appendStrip(frame, trail, strip, cameraPosition);
+                    strip.clear();
+                }
+            }
+            appendStrip(frame, trail, strip, cameraPosition);
+        }
+    }
+
+    void RibbonTrails::appendStrip(Frame& frame, const Trail& trail, std::span<const Point> points, const glm::vec3& cameraPosition) const
+    {
+        if (points.size() < 2)
+        {
+            return;
+        }
+
+        frame.stripFirsts.push_back(static_cast<GLint>(frame.vertices.size()));
+        frame.stripCounts.push_back(static_cast<GLsizei>(points.size() * 2));
+        glm::vec3 side(0.0f, 1.0f, 0.0f);
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            const Point& point = points[i];
+            const glm::vec3 tangent = points[i > 0 ? i - 1 : 0].position - points[std::min(i + 1, points.size() - 1)].position;
+            const glm::vec3 across = glm::cross(tangent, cameraPosition - point.position);
+            const float length = glm::length(across);
+            if (length > 1e-4f)
+            {
+                side = across / length;  // Otherwise keep the previous point's side
+            }
+
+            const float t = std::clamp(point.age / m_settings.lifetime, 0.0f, 1.0f);
+            const float halfWidth = 0.5f * (m_settings.startWidth + (m_settings.endWidth - m_settings.startWidth) * t);
+            const glm::vec4 color(glm::vec3(trail.color), trail.color.a * (1.0f - t));
+            frame.vertices.push_back(Vertex{point.position + side * halfWidth, color, 1.0f});
+            frame.vertices.push_back(Vertex{point.position - side * halfWidth, color, -1.0f});
+        }
+    }
+
+    void RibbonTrails::draw(const Frame& frame, const Camera& camera, float aspectRatio)
+    {
+        if (frame.stripCounts.empty())
+        {
+            return;
+        }
+
+        // Orphaned and refilled every frame; a few hundred vertices at most
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(frame.vertices.size() * sizeof(Vertex)), frame.vertices.data(), GL_STREAM_DRAW);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        glDepthMask(GL_FALSE);
+
+        m_shader->bind();
+        m_shader->setMat4("uView", camera.viewMatrix());
+        m_shader->setMat4("uProj", camera.projectionMatrix(aspectRatio));
+
+        glBindVertexArray(m_vao);
+        glMultiDrawArrays(GL_TRIANGLE_STRIP, frame.stripFirsts.data(), frame.stripCounts.data(), static_cast<GLsizei>(frame.stripCounts.size()));
+        glBindVertexArray(0);
+
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
+    }
+} // namespace cg
@@ -19,7 +19,9 @@ Scene::Scene(std::vector<Mesh> meshes)
 
     for (const auto& mesh : m_meshes)
     {
-        for (const auto& vertex : mesh.vertices)
+        const bool shared = mesh.instanceOf >= 0 && static_cast<size_t>(mesh.instanceOf) < m_meshes.size();
+        const auto& vertices = shared ? m_meshes[static_cast<size_t>(mesh.instanceOf)].vertices : mesh.vertices;
+        for (const auto& vertex : vertices)
         {
             const glm::vec4 worldPos = mesh.transform * glm::vec4(vertex.position, 1.0f);
             minBounds = glm::min(minBounds, glm::vec3(worldPos));
@@ -30,5 +32,11 @@ Scene::Scene(std::vector<Mesh> meshes)
     m_bounds.min = minBounds;
     m_bounds.max = maxBounds;
 }
+
+Scene::Scene(std::vector<Mesh> meshes, const SceneBounds& bounds)
+    : m_meshes(std::move(meshes))
+    , m_bounds(bounds)
+{
+}
 } // namespace cg
 
@@ -0,0 +1,398 @@
+#include "scene/SceneLoader.h"
+
+#include "loader/AssetBake.h"
+#include "loader/MeshCache.h"
+#include "loader/ModelImporter.h"
+#include "loader/ObjLoader.h"
+#include "scene/FlagGenerator.h"
+#include "scene/GroundBuilder.h"
+#include "util/DirectoryIndex.h"
+#include "util/Log.h"
+#include "util/TaskGraph.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <unordered_map>
+
+namespace cg
+{
+    namespace SceneLoader
+    {
+        namespace
+        {
+            namespace fs = std::filesystem;
+            using namespace SceneManifest;
+
+            std::vector<Mesh> loadModel(const std::string& path)
+            {
+                return ModelImporter::supports(path) ? ModelImporter::loadScene(path) : ObjLoader::loadObjAsMeshes(path);
+            }
+
+            std::vector<Mesh> loadMeshes(const Asset& asset)
+            {
+                std::vector<Mesh> meshes;
+                const MeshCache::Layout layout = ModelImporter::supports(asset.path)
+                    ? MeshCache::Layout::ImportedScene : MeshCache::Layout::PerMaterial;
+                if (fs::exists(asset.path) || AssetBake::find(asset.path, MeshCache::bakeVariant(layout)))
+                {
+                    meshes = loadModel(asset.path);
+                }
+                if (!meshes.empty() || !asset.searchDirectory)
+                {
+                    return meshes;
+                }
+
+                // Any loadable model next to the configured one
+                const fs::path modelDir = fs::path(asset.path).parent_path();
+                if (!fs::is_directory(modelDir))
+                {
+                    log(LogLevel::Error, "Model directory does not exist: " + modelDir.string());
+                    return meshes;
+                }
+                log(LogLevel::Warn, "Failed to load " + asset.id + " from explicit path: " + asset.path + ", searching directory...");
+                for (const auto& entry : fs::directory_iterator(modelDir))
+                {
+                    if (entry.is_regular_file() && (entry.path().extension() == ".obj" || ModelImporter::supports(entry.path().string())))
+                    {
+                        log(LogLevel::Info, "Trying to load " + asset.id + " from: " + entry.path().string());
+                        meshes = loadModel(entry.path().string());
+                        if (!meshes.empty())
+                        {
+                            log(LogLevel::Info, "Successfully loaded " + asset.id + " from: " + entry.path().string());
+                            break;
+                        }
+                    }
+                }
+                return meshes;
+            }
+
+            std::vector<Mesh> loadAsset(const Asset& asset)
+            {
+                std::vector<Mesh> meshes;
+                switch (asset.type)
+                {
+                case AssetType::Mesh:
+                    if (auto mesh = ObjLoader::loadObjAsMesh(asset.path))
+                    {
+                        meshes.push_back(std::move(*mesh));
+                    }
+                    break;
+                case AssetType::Meshes:
+                    meshes = loadMeshes(asset);
+                    break;
+                case AssetType::Ground:
+                    meshes = GroundBuilder::buildDemoScene(asset.path, asset.tilesPerSide);
+                    break;
+                case AssetType::Flagpole:
+                {
+                    const FlagpoleParams& pole = asset.flagpole;
+                    meshes = FlagGenerator::generateFlagpole(pole.height, pole.radius, pole.ballRadius, pole.segments, pole.color, pole.ballColor);
+                    break;
+                }
+                case AssetType::Flag:
+                {
+                    const FlagParams& flag = asset.flag;
+                    meshes.push_back(FlagGenerator::generateBezierFlag(flag.width, flag.height, flag.controlPointsU, flag.controlPointsV,
+                        flag.segmentsU, flag.segmentsV));
+                    break;
+                }
+                case AssetType::FlagControlPoints:
+                {
+                    const FlagParams& flag = asset.flag;
+                    meshes.push_back(FlagGenerator::generateFlagControlPointDebugMesh(flag.width, flag.height, flag.controlPointsU,
+                        flag.controlPointsV, flag.markerSize, flag.markerColor));
+                    break;
+                }
+                }
+                return meshes;
+            }
+
+            std::string expandName(const std::string& pattern, int copy)
+            {
+                std::string name;
+                for (size_t i = 0; i < pattern.size(); ++i)
+                {
+                    if (pattern.compare(i, 3, "{i}") == 0 || pattern.compare(i, 3, "{n}") == 0)
+                    {
+                        name += std::to_string(pattern[i + 1] == 'i' ? copy : copy + 1);
+                        i += 2;
+                        continue;
+                    }
+                    name += pattern[i];
+                }
+                return name;
+            }
+
+            // Single-mesh assets take the node's name; meshes of larger ones are prefixed with it
+            std::string meshName(const std::string& nodeName, const std::string& sourceName, size_t sourceCount)
+            {
+                if (nodeName.empty())
+                {
+                    return sourceName;
+                }
+                return sourceCount == 1 ? nodeName : nodeName + "_" + sourceName;
+            }
+
+            // Asset indices ordered so every asset follows everything in its "after" list;
+            // empty if the lists form a cycle
+            std::vector<size_t> loadOrder(const Manifest& manifest, const std::unordered_map<std::string, size_t>& indexOf)
+            {
+                const size_t count = manifest.assets.size();
+                std::vector<size_t> waiting(count, 0);
+                std::vector<std::vector<size_t>> dependents(count);
+                for (size_t a = 0; a < count; ++a)
+                {
+                    for (const std::string& dependency : manifest.assets[a].after)
+                    {
+                        dependents[indexOf.at(dependency)].push_back(a);
+                        ++waiting[a];
+                    }
+                }
+                std::deque<size_t> ready;
+                for (size_t a = 0; a < count; ++a)
+                {
+                    if (waiting[a] == 0)
+                    {
+                        ready.push_back(a);
+                    }
+                }
+                std::vector<size_t> order;
+                while (!ready.empty())
+                {
+                    const size_t a = ready.front();
+                    ready.pop_front();
+                    order.push_back(a);
+                    for (const size_t dependent : dependents[a])
+                    {
+                        if (--waiting[dependent] == 0)
+                        {
+                            ready.push_back(dependent);
+                        }
+                    }
+                }
+                if (order.size() != count)
+                {
+                    order.clear();
+                }
+                return order;
+            }
+        } // namespace
+
+        bool load(const Manifest& manifest, std::vector<Mesh>& meshes, std::string& breakdown)
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            const std::vector<Asset>& assets = manifest.assets;
+            const std::vector<Node>& nodes = manifest.nodes;
+
+            std::unordered_map<std::string, size_t> indexOf;
+            for (size_t a = 0; a < assets.size(); ++a)
+            {
+                indexOf.emplace(assets[a].id, a);
+            }
+            const std::vector<size_t> order = loadOrder(manifest, indexOf);
+            if (order.size() != assets.size())
+            {
+                log(LogLevel::Error, "Scene manifest assets wait for each other in a cycle");
+                return false;
+            }
+
+            // The node holding each node's geometry: itself when tinted, otherwise the first
+            // untinted node placing the same asset. Everything else becomes instances of it.
+            std::vector<size_t> assetOf(nodes.size());
+            std::vector<size_t> geometryNode(nodes.size());
+            std::vector<size_t> users(assets.size(), 0);
+            std::vector<size_t> sharedNode(assets.size(), nodes.size());
+            for (size_t n = 0; n < nodes.size(); ++n)
+            {
+                const size_t a = indexOf.at(nodes[n].asset);
+                assetOf[n] = a;
+                ++users[a];
+                geometryNode[n] = n;
+                if (nodes[n].tintAmount > 0.0f || nodes[n].count <= 0)
+                {
+                    continue;
+                }
+                if (sharedNode[a] == nodes.size())
+                {
+                    sharedNode[a] = n;
+                }
+                geometryNode[n] = sharedNode[a];
+            }
+
+            std::vector<std::vector<Mesh>> loaded(assets.size());
+            std::vector<std::vector<Mesh>> placed(nodes.size());
+            TaskGraph graph;
+            std::vector<TaskGraph::TaskId> assetTask(assets.size());
+            for (const size_t a : order)
+            {
+                std::vector<TaskGraph::TaskId> dependencies;
+                for (const std::string& dependency : assets[a].after)
+                {
+                    dependencies.push_back(assetTask[indexOf.at(dependency)]);
+                }
+                assetTask[a] = graph.add(assets[a].id, [&, a]() {
+                    loaded[a] = loadAsset(assets[a]);
+                }, std::move(dependencies));
+            }
+
+            std::vector<TaskGraph::TaskId> nodeTask(nodes.size());
+            for (size_t n = 0; n < nodes.size(); ++n)
+            {
+                nodeTask[n] = graph.add("node " + nodes[n].name, [&, n]() {
+                    const Node& node = nodes[n];
+                    const size_t a = assetOf[n];
+                    std::vector<Mesh>& source = loaded[a];
+                    const size_t count = static_cast<size_t>(std::max(0, node.count));
+                    if (source.empty() || count == 0)
+                    {
+                        return;
+                    }
+                    const bool ownsGeometry = geometryNode[n] == n;
+                    // Sole user of a single copy: take the asset's meshes instead of copying them
+                    const bool takeSource = ownsGeometry && users[a] == 1 && count == 1;
+                    const glm::mat4 placement = node.transform.matrix();
+
+                    std::vector<Mesh>& out = placed[n];
+                    out.reserve(count * source.size());
+                    for (size_t copy = 0; copy < count; ++copy)
+                    {
+                        const std::string name = expandName(node.name, static_cast<int>(copy));
+                        for (size_t j = 0; j < source.size(); ++j)
+                        {
+                            Mesh& sourceMesh = source[j];
+                            Mesh mesh;
+                            // instanceOf is relative to the geometry node's first copy until assembly
+                            if (ownsGeometry && copy == 0)
+                            {
+                                mesh = takeSource ? std::move(sourceMesh) : sourceMesh;
+                                if (node.tintAmount > 0.0f)
+                                {
+                                    for (auto& vertex : mesh.vertices)
+                                    {
+                                        vertex.color = glm::mix(vertex.color, node.tint, node.tintAmount);
+                                    }
+                                }
+                            }
+                            else
+                            {
+                                mesh.name = sourceMesh.name;
+                                mesh.transform = sourceMesh.transform;
+                                mesh.diffuseTexture = sourceMesh.diffuseTexture;
+                                mesh.instanceOf = sourceMesh.instanceOf >= 0 ? sourceMesh.instanceOf : static_cast<int>(j);
+                            }
+                            mesh.name = meshName(name, mesh.name, source.size());
+                            mesh.transform = placement * mesh.transform;
+                            if (!node.texture.empty())
+                            {
+                                mesh.diffuseTexture = node.texture;
+                            }
+                            out.push_back(std::move(mesh));
+                        }
+                    }
+                }, {assetTask[assetOf[n]]});
+            }
+
+            graph.run();
+            DirectoryIndex::logStatistics();
+
+            bool success = true;
+            for (size_t a = 0; a < assets.size(); ++a)
+            {
+                breakdown += "\n  asset " + assets[a].id + " (" + typeName(assets[a].type) + "): " +
+                    std::to_string(graph.milliseconds(assetTask[a])) + "ms, " + std::to_string(loaded[a].size()) + " meshes";
+                if (!loaded[a].empty())
+                {
+                    continue;
+                }
+                if (assets[a].required)
+                {
+                    log(LogLevel::Error, "Failed to load required asset " + assets[a].id + (assets[a].path.empty() ? "" : " (" + assets[a].path + ")"));
+                    success = false;
+                }
+                else if (users[a] > 0)
+                {
+                    log(LogLevel::Warn, "Asset " + assets[a].id + " produced no meshes; nodes placing it are skipped");
+                }
+            }
+            if (!success)
+            {
+                return false;
+            }
+
+            long long nodeMilliseconds = 0;
+            std::vector<size_t> base(nodes.size(), 0);
+            size_t total = 0;
+            for (size_t n = 0; n < nodes.size(); ++n)
+            {
+                nodeMilliseconds += graph.milliseconds(nodeTask[n]);
+                base[n] = total;
+                total += placed[n].size();
+            }
+
+            size_t instances = 0;
+            meshes.clear();
+            meshes.reserve(total);
+            for (size_t n = 0; n < nodes.size(); ++n)
+            {
+                for (Mesh& mesh : placed[n])
+                {
+                    if (mesh.instanceOf >= 0)
+                    {
+                        mesh.instanceOf += static_cast<int>(base[geometryNode[n]]);
+                        ++instances;
+                    }
+                    meshes.push_back(std::move(mesh));
+                }
+            }
+
+            const long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+            breakdown += "\n  nodes (copy, tint, place; summed): " + std::to_string(nodeMilliseconds) + "ms";
+            breakdown += "\n  scene graph (" + std::to_string(assets.size()) + " assets, " + std::to_string(nodes.size()) +
+                " nodes, overlapped): " + std::to_string(elapsed) + "ms";
+            log(LogLevel::Info, "Scene assembled: " + std::to_string(meshes.size()) + " meshes (" + std::to_string(instances) +
+                " instances) from " + std::to_string(assets.size()) + " assets in " + std::to_string(elapsed) + "ms");
+            return true;
+        }
+
+        std::vector<std::string> inputFiles(const Manifest& manifest)
+        {
+            std::vector<std::string> files;
+            for (const Asset& asset : manifest.assets)
+            {
+                if (asset.type == AssetType::Mesh || asset.type == AssetType::Meshes)
+                {
+                    files.push_back(asset.path);
+                    for (std::string& dependency : ModelImporter::dependencies(asset.path))
+                    {
+                        files.push_back(std::move(dependency));
+                    }
+                }
+                else if (asset.type == AssetType::Ground)
+                {
+                    GroundBuilder::GroundAssets ground = GroundBuilder::listGroundAssets(asset.path);
+                    for (const std::string& tile : ground.tileFiles)
+                    {
+                        // Tiles are OBJs whose .mtl colours end up in the vertices
+                        files.push_back(tile);
+                        for (std::string& dependency : ModelImporter::dependencies(tile))
+                        {
+                            files.push_back(std::move(dependency));
+                        }
+                    }
+                    files.insert(files.end(), ground.textures.begin(), ground.textures.end());
+                }
+            }
+            for (const Node& node : manifest.nodes)
+            {
+                if (!node.texture.empty())
+                {
+                    files.push_back(node.texture);
+                }
+            }
+            return files;
+        }
+    }
+} // namespace cg
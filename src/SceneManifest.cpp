@@ -0,0 +1,597 @@
+#include "scene/SceneManifest.h"
+
+#include "core/AppConfig.h"
+#include "util/FileSystem.h"
+#include "util/Log.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <set>
+
+namespace cg
+{
+    namespace SceneManifest
+    {
+        namespace
+        {
+            using Value = rapidjson::Value;
+
+            struct TypeEntry
+            {
+                AssetType type;
+                const char* name;
+            };
+
+            constexpr TypeEntry kTypes[] = {
+                {AssetType::Mesh, "mesh"},
+                {AssetType::Meshes, "meshes"},
+                {AssetType::Ground, "ground"},
+                {AssetType::Flagpole, "flagpole"},
+                {AssetType::Flag, "flag"},
+                {AssetType::FlagControlPoints, "flagControlPoints"},
+            };
+
+            // Reads optional members; the first type mismatch is kept in error and logged by
+            // the caller together with the file name
+            class Reader
+            {
+            public:
+                std::string error;
+
+                bool ok() const { return error.empty(); }
+
+                void fail(const std::string& message)
+                {
+                    if (error.empty())
+                    {
+                        error = message;
+                    }
+                }
+
+                const Value* member(const Value& object, const char* key)
+                {
+                    const auto it = object.FindMember(key);
+                    return it == object.MemberEnd() ? nullptr : &it->value;
+                }
+
+                void read(const Value& object, const char* key, std::string& out)
+                {
+                    if (const Value* value = member(object, key))
+                    {
+                        value->IsString() ? void(out = value->GetString()) : fail(std::string(key) + " must be a string");
+                    }
+                }
+
+                void read(const Value& object, const char* key, bool& out)
+                {
+                    if (const Value* value = member(object, key))
+                    {
+                        value->IsBool() ? void(out = value->GetBool()) : fail(std::string(key) + " must be true or false");
+                    }
+                }
+
+                void read(const Value& object, const char* key, int& out)
+                {
+                    if (const Value* value = member(object, key))
+                    {
+                        value->IsInt() ? void(out = value->GetInt()) : fail(std::string(key) + " must be an integer");
+                    }
+                }
+
+                void read(const Value& object, const char* key, float& out)
+                {
+                    if (const Value* value = member(object, key))
+                    {
+                        value->IsNumber() ? void(out = value->GetFloat()) : fail(std::string(key) + " must be a number");
+                    }
+                }
+
+                // [x, y, z], or one number for all three
+                void read(const Value& object, const char* key, glm::vec3& out)
+                {
+                    const Value* value = member(object, key);
+                    if (!value)
+                    {
+                        return;
+                    }
+                    if (value->IsNumber())
+                    {
+                        out = glm::vec3(value->GetFloat());
+                        return;
+                    }
+                    if (!value->IsArray() || value->Size() != 3 ||
+                        !(*value)[0].IsNumber() || !(*value)[1].IsNumber() || !(*value)[2].IsNumber())
+                    {
+                        fail(std::string(key) + " must be a number or an array of three numbers");
+                        return;
+                    }
+                    out = glm::vec3((*value)[0].GetFloat(), (*value)[1].GetFloat(), (*value)[2].GetFloat());
+                }
+
+                void read(const Value& object, const char* key, std::vector<std::string>& out)
+                {
+                    const Value* value = member(object, key);
+                    if (!value)
+                    {
+                        return;
+                    }
+                    if (!value->IsArray())
+                    {
+                        fail(std::string(key) + " must be an array of strings");
+                        return;
+                    }
+                    for (const auto& item : value->GetArray())
+                    {
+                        if (!item.IsString())
+                        {
+                            fail(std::string(key) + " must be an array of strings");
+                            return;
+                        }
+                        out.push_back(item.GetString());
+                    }
+                }
+            };
+
+            Asset readAsset(Reader& reader, const Value& object)
+            {
+                Asset asset;
+                reader.read(object, "id", asset.id);
+                std::string type;
+                reader.read(object, "type", type);
+                bool known = false;
+                for (const TypeEntry& entry : kTypes)
+                {
+                    if (type == entry.name)
+                    {
+                        asset.type = entry.type;
+                        known = true;
+                    }
+                }
+                if (!known)
+                {
+                    reader.fail("asset " + asset.id + " has unknown type \"" + type + "\"");
+                }
+                reader.read(object, "path", asset.path);
+                reader.read(object, "required", asset.required);
+                reader.read(object, "searchDirectory", asset.searchDirectory);
+                reader.read(object, "tilesPerSide", asset.tilesPerSide);
+                reader.read(object, "after", asset.after);
+
+                if (asset.type == AssetType::Flagpole)
+                {
+                    FlagpoleParams& pole = asset.flagpole;
+                    reader.read(object, "height", pole.height);
+                    reader.read(object, "radius", pole.radius);
+                    reader.read(object, "ballRadius", pole.ballRadius);
+                    reader.read(object, "segments", pole.segments);
+                    reader.read(object, "color", pole.color);
+                    reader.read(object, "ballColor", pole.ballColor);
+                }
+                else if (asset.type == AssetType::Flag || asset.type == AssetType::FlagControlPoints)
+                {
+                    FlagParams& flag = asset.flag;
+                    reader.read(object, "width", flag.width);
+                    reader.read(object, "height", flag.height);
+                    reader.read(object, "controlPointsU", flag.controlPointsU);
+                    reader.read(object, "controlPointsV", flag.controlPointsV);
+                    reader.read(object, "segmentsU", flag.segmentsU);
+                    reader.read(object, "segmentsV", flag.segmentsV);
+                    reader.read(object, "markerSize", flag.markerSize);
+                    reader.read(object, "markerColor", flag.markerColor);
+                }
+                return asset;
+            }
+
+            Node readNode(Reader& reader, const Value& object)
+            {
+                Node node;
+                reader.read(object, "name", node.name);
+                reader.read(object, "asset", node.asset);
+                reader.read(object, "count", node.count);
+                reader.read(object, "texture", node.texture);
+                reader.read(object, "tint", node.tint);
+                reader.read(object, "tintAmount", node.tintAmount);
+                if (const Value* transform = reader.member(object, "transform"))
+                {
+                    if (!transform->IsObject())
+                    {
+                        reader.fail("transform of node " + node.name + " must be an object");
+                        return node;
+                    }
+                    reader.read(*transform, "translate", node.transform.translate);
+                    reader.read(*transform, "rotateY", node.transform.rotateY);
+                    reader.read(*transform, "scale", node.transform.scale);
+                    reader.read(*transform, "hidden", node.transform.hidden);
+                }
+                return node;
+            }
+
+            bool validate(const Manifest& manifest, std::string& error)
+            {
+                std::set<std::string> ids;
+                for (const Asset& asset : manifest.assets)
+                {
+                    if (asset.id.empty())
+                    {
+                        error = "asset without an id";
+                        return false;
+                    }
+                    if (!ids.insert(asset.id).second)
+                    {
+                        error = "duplicate asset id " + asset.id;
+                        return false;
+                    }
+                    const bool needsPath = asset.type == AssetType::Mesh || asset.type == AssetType::Meshes;
+                    if (needsPath && asset.path.empty())
+                    {
+                        error = "asset " + asset.id + " has no path";
+                        return false;
+                    }
+                }
+                for (const Asset& asset : manifest.assets)
+                {
+                    for (const std::string& dependency : asset.after)
+                    {
+                        if (!ids.count(dependency))
+                        {
+                            error = "asset " + asset.id + " waits for unknown asset " + dependency;
+                            return false;
+                        }
+                    }
+                }
+                for (const Node& node : manifest.nodes)
+                {
+                    if (!ids.count(node.asset))
+                    {
+                        error = "node \"" + node.name + "\" places unknown asset \"" + node.asset + "\"";
+                        return false;
+                    }
+                    if (node.count < 0)
+                    {
+                        error = "node \"" + node.name + "\" has a negative count";
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            using Writer = rapidjson::Writer<rapidjson::StringBuffer>;
+
+            void writeVec3(Writer& writer, const char* key, const glm::vec3& value)
+            {
+                writer.Key(key);
+                writer.StartArray();
+                writer.Double(value.x);
+                writer.Double(value.y);
+                writer.Double(value.z);
+                writer.EndArray();
+            }
+
+            void writeString(Writer& writer, const char* key, const std::string& value)
+            {
+                writer.Key(key);
+                writer.String(value.c_str(), static_cast<rapidjson::SizeType>(value.size()));
+            }
+        } // namespace
+
+        glm::mat4 Transform::matrix() const
+        {
+            glm::mat4 result = glm::translate(glm::mat4(1.0f), translate);
+            if (rotateY != 0.0f)
+            {
+                result = glm::rotate(result, glm::radians(rotateY), glm::vec3(0.0f, 1.0f, 0.0f));
+            }
+            const glm::vec3 s = hidden ? glm::vec3(0.0f) : scale;
+            result[0] *= s.x;
+            result[1] *= s.y;
+            result[2] *= s.z;
+            return result;
+        }
+
+        const Asset* Manifest::findAsset(const std::string& id) const
+        {
+            for (const Asset& asset : assets)
+            {
+                if (asset.id == id)
+                {
+                    return &asset;
+                }
+            }
+            return nullptr;
+        }
+
+        const char* typeName(AssetType type)
+        {
+            for (const TypeEntry& entry : kTypes)
+            {
+                if (entry.type == type)
+                {
+                    return entry.name;
+                }
+            }
+            return "unknown";
+        }
+
+        bool parse(const char* json, size_t size, const std::string& source, Manifest& manifest)
+        {
+            rapidjson::Document document;
+            document.Parse<rapidjson::kParseCommentsFlag | rapidjson::kParseTrailingCommasFlag>(json, size);
+            if (document.HasParseError())
+            {
+                log(LogLevel::Error, "Scene manifest " + source + ": " + rapidjson::GetParseError_En(document.GetParseError()) +
+                    " at offset " + std::to_string(document.GetErrorOffset()));
+                return false;
+            }
+            if (!document.IsObject())
+            {
+                log(LogLevel::Error, "Scene manifest " + source + ": top level must be an object");
+                return false;
+            }
+
+            Reader reader;
+            Manifest parsed;
+            const Value* assets = reader.member(document, "assets");
+            const Value* nodes = reader.member(document, "nodes");
+            if (!assets || !assets->IsArray() || !nodes || !nodes->IsArray())
+            {
+                log(LogLevel::Error, "Scene manifest " + source + ": \"assets\" and \"nodes\" must be arrays");
+                return false;
+            }
+            for (const auto& asset : assets->GetArray())
+            {
+                asset.IsObject() ? parsed.assets.push_back(readAsset(reader, asset)) : reader.fail("assets must be objects");
+            }
+            for (const auto& node : nodes->GetArray())
+            {
+                node.IsObject() ? parsed.nodes.push_back(readNode(reader, node)) : reader.fail("nodes must be objects");
+            }
+
+            std::string error = reader.error;
+            if (!reader.ok() || !validate(parsed, error))
+            {
+                log(LogLevel::Error, "Scene manifest " + source + ": " + error);
+                return false;
+            }
+            manifest = std::move(parsed);
+            return true;
+        }
+
+        bool load(const std::string& path, Manifest& manifest)
+        {
+            MappedFile file;
+            if (!file.open(path))
+            {
+                log(LogLevel::Error, "Failed to open scene manifest " + path);
+                return false;
+            }
+            return parse(file.data(), file.size(), path, manifest);
+        }
+
+        std::string toJson(const Manifest& manifest)
+        {
+            rapidjson::StringBuffer buffer;
+            Writer writer(buffer);
+            writer.StartObject();
+            writer.Key("assets");
+            writer.StartArray();
+            for (const Asset& asset : manifest.assets)
+            {
+                writer.StartObject();
+                writeString(writer, "id", asset.id);
+                writeString(writer, "type", typeName(asset.type));
+                writeString(writer, "path", asset.path);
+                writer.Key("required");
+                writer.Bool(asset.required);
+                writer.Key("searchDirectory");
+                writer.Bool(asset.searchDirectory);
+                writer.Key("tilesPerSide");
+                writer.Int(asset.tilesPerSide);
+                if (asset.type == AssetType::Flagpole)
+                {
+                    const FlagpoleParams& pole = asset.flagpole;
+                    writer.Key("height");
+                    writer.Double(pole.height);
+                    writer.Key("radius");
+                    writer.Double(pole.radius);
+                    writer.Key("ballRadius");
+                    writer.Double(pole.ballRadius);
+                    writer.Key("segments");
+                    writer.Int(pole.segments);
+                    writeVec3(writer, "color", pole.color);
+                    writeVec3(writer, "ballColor", pole.ballColor);
+                }
+                else if (asset.type == AssetType::Flag || asset.type == AssetType::FlagControlPoints)
+                {
+                    const FlagParams& flag = asset.flag;
+                    writer.Key("width");
+                    writer.Double(flag.width);
+                    writer.Key("height");
+                    writer.Double(flag.height);
+                    writer.Key("controlPointsU");
+                    writer.Int(flag.controlPointsU);
+                    writer.Key("controlPointsV");
+                    writer.Int(flag.controlPointsV);
+                    writer.Key("segmentsU");
+                    writer.Int(flag.segmentsU);
+                    writer.Key("segmentsV");
+                    writer.Int(flag.segmentsV);
+                    writer.Key("markerSize");
+                    writer.Double(flag.markerSize);
+                    writeVec3(writer, "markerColor", flag.markerColor);
+                }
+                writer.Key("after");
+                writer.StartArray();
+                for (const std::string& dependency : asset.after)
+                {
+                    writer.String(dependency.c_str(), static_cast<rapidjson::SizeType>(dependency.size()));
+                }
+                writer.EndArray();
+                writer.EndObject();
+            }
+            writer.EndArray();
+
+            writer.Key("nodes");
+            writer.StartArray();
+            for (const Node& node : manifest.nodes)
+            {
+                writer.StartObject();
+                writeString(writer, "name", node.name);
+                writeString(writer, "asset", node.asset);
+                writer.Key("count");
+                writer.Int(node.count);
+                writer.Key("transform");
+                writer.StartObject();
+                writeVec3(writer, "translate", node.transform.translate);
+                writer.Key("rotateY");
+                writer.Double(node.transform.rotateY);
+                writeVec3(writer, "scale", node.transform.scale);
+                writer.Key("hidden");
+                writer.Bool(node.transform.hidden);
+                writer.EndObject();
+                writeString(writer, "texture", node.texture);
+                writeVec3(writer, "tint", node.tint);
+                writer.Key("tintAmount");
+                writer.Double(node.tintAmount);
+                writer.EndObject();
+            }
+            writer.EndArray();
+            writer.EndObject();
+            return std::string(buffer.GetString(), buffer.GetSize());
+        }
+
+        Manifest fromConfig(const AppConfig& config)
+        {
+            Manifest manifest;
+            auto addAsset = [&manifest](std::string id, AssetType type, std::string path) -> Asset& {
+                Asset asset;
+                asset.id = std::move(id);
+                asset.type = type;
+                asset.path = std::move(path);
+                manifest.assets.push_back(std::move(asset));
+                return manifest.assets.back();
+            };
+            auto addNode = [&manifest](std::string name, std::string asset) -> Node& {
+                Node node;
+                node.name = std::move(name);
+                node.asset = std::move(asset);
+                manifest.nodes.push_back(std::move(node));
+                return manifest.nodes.back();
+            };
+
+            // Ground tiles go first in the mesh list
+            addAsset("ground", AssetType::Ground, config.groundMeshPath).tilesPerSide = config.groundTilesPerSide;
+            addNode("", "ground");
+
+            // Airplanes spawn later by rescaling their meshes; until then they are hidden
+            const bool airplanesHidden = config.airplaneSpawnTime > 0.0f;
+            if (!config.airplaneModelPath.empty())
+            {
+                addAsset("airplane", AssetType::Mesh, config.airplaneModelPath).required = true;
+                Node& airplane = addNode("airplane", "airplane");
+                const glm::vec3 forward = glm::normalize(config.airplaneDirection);
+                airplane.transform.translate = config.airplaneStartPosition + glm::vec3(0.0f, config.airplaneHeight, 0.0f);
+                airplane.transform.rotateY = glm::degrees(std::atan2(forward.z, forward.x)) + 90.0f;
+                airplane.transform.scale = config.airplaneScale;
+                airplane.transform.hidden = airplanesHidden;
+            }
+            if (!config.wingmanModelPath.empty())
+            {
+                // One load shared with the airplane when both use the same model
+                std::string wingmanAsset = "airplane";
+                if (config.wingmanModelPath != config.airplaneModelPath)
+                {
+                    wingmanAsset = "wingman";
+                    addAsset(wingmanAsset, AssetType::Mesh, config.wingmanModelPath);
+                }
+                for (const char* side : {"wingman_left{n}", "wingman_right{n}"})
+                {
+                    Node& wingmen = addNode(side, wingmanAsset);
+                    wingmen.count = 2;
+                    wingmen.transform.hidden = airplanesHidden;
+                }
+            }
+            if (!config.missileModelPath.empty())
+            {
+                addAsset("missile", AssetType::Mesh, config.missileModelPath).required = true;
+                Node& missile = addNode("missile", "missile");
+                missile.transform.hidden = true;
+                const std::filesystem::path bodyTexture = std::filesystem::path(config.missileModelPath).parent_path() / "body.bmp";
+                std::error_code ec;
+                if (std::filesystem::exists(bodyTexture, ec))
+                {
+                    missile.texture = bodyTexture.generic_string();
+                }
+            }
+            if (config.enableAncientCity && !config.ancientCityModelPath.empty())
+            {
+                addAsset("ancientCity", AssetType::Meshes, config.ancientCityModelPath).searchDirectory = true;
+                Node& city = addNode("ancientCity", "ancientCity");
+                city.transform.translate = config.ancientCityPosition;
+                city.transform.rotateY = config.ancientCityRotationY;
+                city.transform.scale = config.ancientCityScale;
+            }
+            if (config.enableFlagpole)
+            {
+                Asset& pole = addAsset("flagpole", AssetType::Flagpole, "");
+                pole.flagpole.height = config.flagpoleHeight;
+                pole.flagpole.radius = config.flagpoleRadius;
+                pole.flagpole.ballRadius = config.flagpoleBallRadius;
+                pole.flagpole.segments = config.flagpoleSegments;
+                pole.flagpole.color = config.flagpoleColor;
+                pole.flagpole.ballColor = config.flagpoleBallColor;
+                addNode("", "flagpole").transform.translate = config.flagpolePosition;
+            }
+            if (config.enableFlagpole && config.enableFlag)
+            {
+                FlagParams flag;
+                flag.width = config.flagWidth;
+                flag.height = config.flagHeight;
+                flag.controlPointsU = config.flagControlPointsU;
+                flag.controlPointsV = config.flagControlPointsV;
+                flag.segmentsU = config.flagSegmentsU;
+                flag.segmentsV = config.flagSegmentsV;
+                addAsset("flag", AssetType::Flag, "").flag = flag;
+
+                // Top-left corner of the flag at the bottom of the ball
+                Node& node = addNode("flag", "flag");
+                node.transform.translate = config.flagpolePosition +
+                    glm::vec3(config.flagWidth * 0.5f, config.flagpoleHeight - config.flagHeight * 0.5f, 0.0f);
+                node.texture = config.flagTexturePath;
+                const Transform flagTransform = node.transform;
+                if (config.debugShowFlagControlPoints)
+                {
+                    addAsset("flagControlPoints", AssetType::FlagControlPoints, "").flag = flag;
+                    addNode("flag_control_points", "flagControlPoints").transform = flagTransform;
+                }
+            }
+            if (config.enableLanterns && !config.lanternModelPath.empty())
+            {
+                // The pool: hidden until App::spawnLantern moves one into the sky
+                addAsset("lantern", AssetType::Mesh, config.lanternModelPath);
+                Node& lanterns = addNode("lantern_{i}", "lantern");
+                lanterns.count = std::max(0, config.lanternPoolSize);
+                lanterns.transform.hidden = true;
+                lanterns.tint = config.lanternLightColor;
+                lanterns.tintAmount = 0.3f;
+            }
+            return manifest;
+        }
+
+        bool resolve(const AppConfig& config, Manifest& manifest)
+        {
+            if (config.sceneManifestPath.empty())
+            {
+                manifest = fromConfig(config);
+                return true;
+            }
+            return load(config.sceneManifestPath, manifest);
+        }
+    }
+} // namespace cg
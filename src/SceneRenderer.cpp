@@ -2,21 +2,23 @@
 
 #include <glad/glad.h>
 
+#include "loader/AssetBake.h"
+#include "loader/BakedTexture.h"
+#include "util/FileSystem.h"
+#include "util/JobSystem.h"
 #include "util/Log.h"
 
 #include <cstddef>
 #include <stb/stb_image.h>
 #include <glm/glm.hpp>
 #include <string>
-#include <thread>
-#include <mutex>
-#include <future>
 #include <vector>
 #include <algorithm>
 #include <chrono>
 #include <unordered_map>
 #include <cmath>
 #include <cctype>
+#include <cstring>
 
 namespace cg
 {
@@ -26,6 +28,59 @@ namespace cg
         constexpr GLuint kNormalLocation = 1;
         constexpr GLuint kUvLocation = 2;
         constexpr GLuint kColorLocation = 3;
+
+        // EXT_texture_compression_s3tc + EXT_texture_sRGB; not in the generated GL header
+        constexpr GLenum kCompressedSrgbS3tcDxt1 = 0x8C4C;
+        constexpr GLenum kCompressedSrgbAlphaS3tcDxt5 = 0x8C4F;
+
+        bool hasExtension(const char* name)
+        {
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count; ++i)
+            {
+                const auto* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+                if (extension && std::strcmp(extension, name) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool supportsSrgbS3tc()
+        {
+            return hasExtension("GL_EXT_texture_compression_s3tc") &&
+                   (hasExtension("GL_EXT_texture_sRGB") || hasExtension("GL_EXT_texture_compression_s3tc_srgb"));
+        }
+
+        // Uploads every level of a baked texture; the chain is complete, so no glGenerateMipmap
+        void uploadBakedTexture(const BakedTexture::Texture& texture)
+        {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            for (size_t level = 0; level < texture.levels.size(); ++level)
+            {
+                const BakedTexture::Level& data = texture.levels[level];
+                const GLint mip = static_cast<GLint>(level);
+                switch (texture.format)
+                {
+                case BakedTexture::Format::Bc1:
+                    glCompressedTexImage2D(GL_TEXTURE_2D, mip, kCompressedSrgbS3tcDxt1, data.width, data.height, 0,
+                                           static_cast<GLsizei>(data.size), data.data);
+                    break;
+                case BakedTexture::Format::Bc3:
+                    glCompressedTexImage2D(GL_TEXTURE_2D, mip, kCompressedSrgbAlphaS3tcDxt5, data.width, data.height, 0,
+                                           static_cast<GLsizei>(data.size), data.data);
+                    break;
+                default:
+                    glTexImage2D(GL_TEXTURE_2D, mip, GL_SRGB8_ALPHA8, data.width, data.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data);
+                    break;
+                }
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(texture.levels.size()) - 1);
+        }
     }
 
     SceneRenderer::SceneRenderer(const Scene& scene)
@@ -81,10 +136,17 @@ namespace cg
         m_materialToggles = toggles;
     }
 
-    void SceneRenderer::setEnvironmentMaps(unsigned dayTexture, unsigned nightTexture)
+    void SceneRenderer::setEnvironmentMaps(unsigned dayCubemap, unsigned nightCubemap, int mipCount)
     {
-        m_environmentMapDay = dayTexture;
-        m_environmentMapNight = nightTexture;
+        m_environmentMapDay = dayCubemap;
+        m_environmentMapNight = nightCubemap;
+        m_environmentMipCount = std::max(mipCount, 1);
+    }
+
+    void SceneRenderer::setEnvironmentIrradiance(const std::array<glm::vec3, 9>& day, const std::array<glm::vec3, 9>& night)
+    {
+        m_dayIrradianceSH = day;
+        m_nightIrradianceSH = night;
     }
 
     void SceneRenderer::setLanternLights(const std::vector<LanternLight>& lights)
@@ -96,6 +158,10 @@ namespace cg
     {
         for (const auto& mesh : m_meshes)
         {
+            if (mesh.sharedGeometry)
+            {
+                continue;
+            }
             glDeleteVertexArrays(1, &mesh.vao);
             glDeleteBuffers(1, &mesh.vbo);
             glDeleteBuffers(1, &mesh.ebo);
@@ -152,12 +218,18 @@ namespace cg
         if (envAvailable)
         {
             glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, m_environmentMapDay);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, m_environmentMapDay);
             m_shader->setInt("uEnvironmentDay", 1);
             glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, m_environmentMapNight);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, m_environmentMapNight);
             m_shader->setInt("uEnvironmentNight", 2);
             glActiveTexture(GL_TEXTURE0);
+            m_shader->setFloat("uEnvironmentMaxLod", static_cast<float>(m_environmentMipCount - 1));
+            m_shader->setFloat("uEnvironmentAmbientWeight", m_environmentAmbientWeight);
+            for (size_t i = 0; i < m_dayIrradianceSH.size(); ++i)
+            {
+                m_shader->setVec3("uEnvironmentSH[" + std::to_string(i) + "]", glm::mix(m_dayIrradianceSH[i], m_nightIrradianceSH[i], blend));
+            }
         }
 
         constexpr int kMaxLanternLights = 32;
@@ -202,9 +274,9 @@ namespace cg
         if (envAvailable)
         {
             glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, 0);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
             glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, 0);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
             glActiveTexture(GL_TEXTURE0);
         }
     }
@@ -228,29 +300,42 @@ namespace cg
             gpuMesh.transform = mesh.transform;
             gpuMesh.name = mesh.name;
 
-            glGenVertexArrays(1, &gpuMesh.vao);
-            glGenBuffers(1, &gpuMesh.vbo);
-            glGenBuffers(1, &gpuMesh.ebo);
+            if (mesh.instanceOf >= 0 && static_cast<size_t>(mesh.instanceOf) < m_meshes.size())
+            {
+                // Repeated node of an imported scene: draw the original's buffers
+                const GpuMesh& source = m_meshes[static_cast<size_t>(mesh.instanceOf)];
+                gpuMesh.vao = source.vao;
+                gpuMesh.vbo = source.vbo;
+                gpuMesh.ebo = source.ebo;
+                gpuMesh.indexCount = source.indexCount;
+                gpuMesh.sharedGeometry = true;
+            }
+            else
+            {
+                glGenVertexArrays(1, &gpuMesh.vao);
+                glGenBuffers(1, &gpuMesh.vbo);
+                glGenBuffers(1, &gpuMesh.ebo);
 
-            glBindVertexArray(gpuMesh.vao);
+                glBindVertexArray(gpuMesh.vao);
 
-            glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.vbo);
-            glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(Vertex), mesh.vertices.data(), GL_STATIC_DRAW);
+                glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.vbo);
+                glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(Vertex), mesh.vertices.data(), GL_STATIC_DRAW);
 
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpuMesh.ebo);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(uint32_t), mesh.indices.data(), GL_STATIC_DRAW);
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpuMesh.ebo);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(uint32_t), mesh.indices.data(), GL_STATIC_DRAW);
 
-            glEnableVertexAttribArray(kPosLocation);
-            glVertexAttribPointer(kPosLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
+                glEnableVertexAttribArray(kPosLocation);
+                glVertexAttribPointer(kPosLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
 
-            glEnableVertexAttribArray(kNormalLocation);
-            glVertexAttribPointer(kNormalLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, normal)));
+                glEnableVertexAttribArray(kNormalLocation);
+                glVertexAttribPointer(kNormalLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, normal)));
 
-            glEnableVertexAttribArray(kUvLocation);
-            glVertexAttribPointer(kUvLocation, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, uv)));
+                glEnableVertexAttribArray(kUvLocation);
+                glVertexAttribPointer(kUvLocation, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, uv)));
 
-            glEnableVertexAttribArray(kColorLocation);
-            glVertexAttribPointer(kColorLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, color)));
+                glEnableVertexAttribArray(kColorLocation);
+                glVertexAttribPointer(kColorLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, color)));
+            }
 
             if (!mesh.diffuseTexture.empty())
             {
@@ -364,7 +449,9 @@ namespace cg
         int width = 0;
         int height = 0;
         int channels = 0;
-        stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        MappedFile file;
+        stbi_uc* data = file.open(path) ? stbi_load_from_memory(file.bytes(), static_cast<int>(file.size()), &width, &height, &channels, 4) : nullptr;
+        file.close();
         if (!data)
         {
             log(LogLevel::Warn, "Failed to load texture: " + path);
@@ -447,92 +534,85 @@ namespace cg
             return;
         }
         
-        // Determine number of threads (use hardware concurrency, but limit to reasonable number)
-        const size_t numThreads = std::min(pathsToLoad.size(), 
-            static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency())));
-        
-        log(LogLevel::Info, "Using " + std::to_string(numThreads) + " threads to load textures in parallel");
-        
-        // Split texture paths into chunks for each thread
-        const size_t chunkSize = (pathsToLoad.size() + numThreads - 1) / numThreads;
-        std::vector<std::vector<std::string>> chunks;
-        for (size_t i = 0; i < pathsToLoad.size(); i += chunkSize)
-        {
-            chunks.push_back(std::vector<std::string>(
-                pathsToLoad.begin() + i,
-                pathsToLoad.begin() + std::min(i + chunkSize, pathsToLoad.size())));
-        }
-        
-        // Structure to hold loaded texture data
+        // Block-compressed bakes are only usable when the driver has sRGB S3TC
+        const bool compressedSupported = supportsSrgbS3tc();
+
+        // Texture data: decoded on the workers, or a baked texture's mapping
         struct TextureData
         {
             std::string path;
-            int width;
-            int height;
-            int channels;
-            stbi_uc* data;
+            int width{0};
+            int height{0};
+            int channels{0};
+            stbi_uc* data{nullptr};
+            BakedTexture::Texture baked;
+            bool loaded{false};
         };
-        
-        // Load texture data in parallel (I/O operations)
-        std::mutex dataMutex;
-        std::vector<TextureData> loadedTextures;
-        std::vector<std::future<void>> futures;
-        
-        for (const auto& chunk : chunks)
+        std::vector<TextureData> textures(pathsToLoad.size());
+
+        // Each decode job is followed by its upload on the main thread (GL), which runs while
+        // the wait below is helping; uploads of early textures overlap decodes of later ones
+        JobSystem& jobs = JobSystem::instance();
+        std::vector<JobSystem::JobHandle> uploads;
+        uploads.reserve(pathsToLoad.size());
+        for (size_t i = 0; i < pathsToLoad.size(); ++i)
         {
-            futures.push_back(std::async(std::launch::async, [&chunk, &dataMutex, &loadedTextures]() {
-                for (const auto& path : chunk)
+            TextureData& texture = textures[i];
+            texture.path = pathsToLoad[i];
+            const JobSystem::JobHandle decode = jobs.submit([&texture, compressedSupported]() {
+                if (const auto bakedPath = AssetBake::find(texture.path, BakedTexture::kBakeVariant))
                 {
-                    // Load texture data (I/O operation, can be done in parallel)
-                    int width = 0;
-                    int height = 0;
-                    int channels = 0;
-                    stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
-                    
-                    if (data)
+                    if (BakedTexture::open(*bakedPath, texture.baked) &&
+                        (texture.baked.format == BakedTexture::Format::Rgba8 || compressedSupported))
                     {
-                        std::lock_guard<std::mutex> lock(dataMutex);
-                        loadedTextures.push_back({path, width, height, channels, data});
-                    }
-                    else
-                    {
-                        log(LogLevel::Warn, "Failed to load texture: " + path);
+                        texture.loaded = true;
+                        return;
                     }
+                    texture.baked = {};
+                }
+
+                MappedFile file;
+                texture.data = file.open(texture.path)
+                    ? stbi_load_from_memory(file.bytes(), static_cast<int>(file.size()), &texture.width, &texture.height, &texture.channels, 4)
+                    : nullptr;
+                texture.loaded = texture.data != nullptr;
+                if (!texture.loaded)
+                {
+                    log(LogLevel::Warn, "Failed to load texture: " + texture.path);
+                }
+            });
+            uploads.push_back(jobs.submitMain([this, &texture]() {
+                if (!texture.loaded || m_textureCache.find(texture.path) != m_textureCache.end())
+                {
+                    stbi_image_free(texture.data);
+                    return;
                 }
-            }));
-        }
-        
-        // Wait for all threads to complete loading
-        for (auto& future : futures)
-        {
-            future.wait();
-        }
-        
-        // Upload textures to GPU on main thread (OpenGL operations must be on main thread)
-        for (const auto& texData : loadedTextures)
-        {
-            // Check again if texture was loaded by another thread
-            if (m_textureCache.find(texData.path) == m_textureCache.end())
-            {
                 GLuint tex = 0;
                 glGenTextures(1, &tex);
                 glBindTexture(GL_TEXTURE_2D, tex);
-                
+
                 // Use SRGB format for better color accuracy
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, texData.width, texData.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texData.data);
-                
+                if (texture.data)
+                {
+                    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, texture.width, texture.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texture.data);
+                }
+                else
+                {
+                    uploadBakedTexture(texture.baked);
+                }
+
                 // Enhanced filtering to reduce moiré patterns
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-                
+
                 // Use high-quality filtering with better mipmap selection
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                
+
                 // Enhanced anisotropic filtering
                 constexpr GLenum GL_MAX_TEXTURE_MAX_ANISOTROPY = 0x84FF;
                 constexpr GLenum GL_TEXTURE_MAX_ANISOTROPY = 0x84FE;
-                
+
                 float maxAniso = 0.0f;
                 glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAniso);
                 if (maxAniso > 0.0f)
@@ -540,20 +620,25 @@ namespace cg
                     const float anisoLevel = glm::clamp(m_textureAnisotropyLevel, 1.0f, maxAniso);
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, anisoLevel);
                 }
-                
-                // Generate mipmaps with high quality
-                glGenerateMipmap(GL_TEXTURE_2D);
-                
+
+                // Generate mipmaps with high quality (baked textures bring their own)
+                if (texture.data)
+                {
+                    glGenerateMipmap(GL_TEXTURE_2D);
+                }
+
                 // Set LOD bias to reduce moiré at distance (slight negative bias for sharper distant textures)
                 glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, -0.5f);
-                
+
                 glBindTexture(GL_TEXTURE_2D, 0);
-                
-                m_textureCache[texData.path] = tex;
-            }
-            
-            stbi_image_free(texData.data);
+
+                m_textureCache[texture.path] = tex;
+                stbi_image_free(texture.data);
+                texture.data = nullptr;
+                texture.baked = {};  // Unmaps the baked file
+            }, {decode}));
         }
+        jobs.wait(uploads);
     }
 
     int SceneRenderer::determineMaterialMode(const GpuMesh& mesh) const
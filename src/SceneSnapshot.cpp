@@ -0,0 +1,306 @@
+#include "scene/SceneSnapshot.h"
+
+#include "loader/AssetBake.h"
+#include "util/FileSystem.h"
+#include "util/Log.h"
+#include "util/Parallel.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+#include <unordered_map>
+
+namespace cg
+{
+    namespace SceneSnapshot
+    {
+        namespace
+        {
+            namespace fs = std::filesystem;
+
+            constexpr char kMagic[4] = {'C', 'G', 'S', 'N'};
+            constexpr uint32_t kVersion = 1;
+            constexpr uint64_t kAlignment = 16;
+
+            static_assert(std::is_trivially_copyable_v<Vertex>, "Vertex is written to the snapshot as raw bytes");
+
+            // Layout: header, mesh records, string table, then a vertex and an index section
+            // per geometry owner, every section starting on a kAlignment boundary
+            struct FileHeader
+            {
+                char magic[4]{};
+                uint32_t version{0};
+                uint64_t key{0};
+                uint32_t vertexStride{0};
+                uint32_t meshCount{0};
+                float boundsMin[3]{};
+                float boundsMax[3]{};
+                uint64_t stringsOffset{0};
+                uint64_t stringsSize{0};
+                uint64_t fileSize{0};
+            };
+
+            // Instances (instanceOf = owner index + 1) have no sections
+            struct MeshRecord
+            {
+                uint64_t vertexOffset{0};
+                uint64_t vertexCount{0};
+                uint64_t indexOffset{0};
+                uint64_t indexCount{0};
+                uint32_t nameOffset{0};
+                uint32_t nameLength{0};
+                uint32_t textureOffset{0};
+                uint32_t textureLength{0};
+                uint32_t instanceOf{0};
+                uint32_t reserved{0};
+                float transform[16]{};
+            };
+
+            uint64_t alignUp(uint64_t value)
+            {
+                return (value + kAlignment - 1) / kAlignment * kAlignment;
+            }
+
+            void pad(std::ofstream& file, uint64_t& offset)
+            {
+                static const char zeros[kAlignment]{};
+                const uint64_t aligned = alignUp(offset);
+                file.write(zeros, static_cast<std::streamsize>(aligned - offset));
+                offset = aligned;
+            }
+
+            bool sameGeometry(const Mesh& a, const Mesh& b)
+            {
+                return a.vertices.size() == b.vertices.size() && a.indices.size() == b.indices.size() &&
+                    std::memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(Vertex)) == 0 &&
+                    std::memcmp(a.indices.data(), b.indices.data(), a.indices.size() * sizeof(uint32_t)) == 0;
+            }
+
+            // For each mesh, the index of the mesh whose geometry it is drawn with: existing
+            // instances keep their source, identical copies (ground tiles, wingmen, lantern
+            // pool) collapse onto the first one
+            std::vector<size_t> findOwners(const std::vector<Mesh>& meshes, const std::vector<std::string>& keepUnique)
+            {
+                std::vector<uint64_t> hashes(meshes.size(), 0);
+                parallelFor(meshes.size(), [&](size_t i) {
+                    AssetBake::Hasher hasher;
+                    hasher.update(meshes[i].vertices.data(), meshes[i].vertices.size() * sizeof(Vertex));
+                    hasher.update(meshes[i].indices.data(), meshes[i].indices.size() * sizeof(uint32_t));
+                    hashes[i] = hasher.digest();
+                });
+
+                std::vector<size_t> owners(meshes.size());
+                std::unordered_multimap<uint64_t, size_t> byHash;
+                for (size_t i = 0; i < meshes.size(); ++i)
+                {
+                    owners[i] = i;
+                    const Mesh& mesh = meshes[i];
+                    if (mesh.instanceOf >= 0 && static_cast<size_t>(mesh.instanceOf) < i)
+                    {
+                        owners[i] = owners[static_cast<size_t>(mesh.instanceOf)];
+                        continue;
+                    }
+                    if (mesh.vertices.empty() ||
+                        std::find(keepUnique.begin(), keepUnique.end(), mesh.name) != keepUnique.end())
+                    {
+                        continue;
+                    }
+                    const auto [first, last] = byHash.equal_range(hashes[i]);
+                    const auto match = std::find_if(first, last, [&](const auto& entry) { return sameGeometry(meshes[entry.second], mesh); });
+                    if (match != last)
+                    {
+                        owners[i] = match->second;
+                        continue;
+                    }
+                    byHash.emplace(hashes[i], i);
+                }
+                return owners;
+            }
+        } // namespace
+
+        std::unique_ptr<Scene> load(const std::string& path, uint64_t key)
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            MappedFile file;
+            if (!file.open(path) || file.size() < sizeof(FileHeader))
+            {
+                return nullptr;
+            }
+
+            FileHeader header;
+            std::memcpy(&header, file.data(), sizeof(header));
+            if (std::memcmp(header.magic, kMagic, sizeof(header.magic)) != 0 || header.version != kVersion ||
+                header.vertexStride != sizeof(Vertex) || header.fileSize != file.size())
+            {
+                log(LogLevel::Info, "Scene snapshot is from another build, rebuilding: " + path);
+                return nullptr;
+            }
+            if (header.key != key)
+            {
+                log(LogLevel::Info, "Scene snapshot is stale (config or inputs changed), rebuilding: " + path);
+                return nullptr;
+            }
+
+            const uint64_t recordsEnd = sizeof(FileHeader) + static_cast<uint64_t>(header.meshCount) * sizeof(MeshRecord);
+            if (recordsEnd > file.size() || header.stringsOffset + header.stringsSize > file.size())
+            {
+                log(LogLevel::Warn, "Scene snapshot is corrupt: " + path);
+                return nullptr;
+            }
+            std::vector<MeshRecord> records(header.meshCount);
+            std::memcpy(records.data(), file.data() + sizeof(FileHeader), records.size() * sizeof(MeshRecord));
+            const char* strings = file.data() + header.stringsOffset;
+
+            std::vector<Mesh> meshes(records.size());
+            for (size_t i = 0; i < records.size(); ++i)
+            {
+                const MeshRecord& record = records[i];
+                if (record.vertexOffset + record.vertexCount * sizeof(Vertex) > file.size() ||
+                    record.indexOffset + record.indexCount * sizeof(uint32_t) > file.size() ||
+                    static_cast<uint64_t>(record.nameOffset) + record.nameLength > header.stringsSize ||
+                    static_cast<uint64_t>(record.textureOffset) + record.textureLength > header.stringsSize ||
+                    record.instanceOf > i)
+                {
+                    log(LogLevel::Warn, "Scene snapshot is corrupt: " + path);
+                    return nullptr;
+                }
+                Mesh& mesh = meshes[i];
+                mesh.name.assign(strings + record.nameOffset, record.nameLength);
+                mesh.diffuseTexture.assign(strings + record.textureOffset, record.textureLength);
+                std::memcpy(&mesh.transform[0][0], record.transform, sizeof(record.transform));
+                mesh.instanceOf = static_cast<int>(record.instanceOf) - 1;
+            }
+
+            // Copy the sections out of the mapping in parallel; page faults overlap as well
+            parallelFor(records.size(), [&](size_t i) {
+                const MeshRecord& record = records[i];
+                Mesh& mesh = meshes[i];
+                mesh.vertices.resize(static_cast<size_t>(record.vertexCount));
+                std::memcpy(mesh.vertices.data(), file.data() + record.vertexOffset, mesh.vertices.size() * sizeof(Vertex));
+                mesh.indices.resize(static_cast<size_t>(record.indexCount));
+                std::memcpy(mesh.indices.data(), file.data() + record.indexOffset, mesh.indices.size() * sizeof(uint32_t));
+            });
+
+            SceneBounds bounds;
+            std::memcpy(&bounds.min[0], header.boundsMin, sizeof(header.boundsMin));
+            std::memcpy(&bounds.max[0], header.boundsMax, sizeof(header.boundsMax));
+
+            const size_t instances = static_cast<size_t>(std::count_if(meshes.begin(), meshes.end(), [](const Mesh& mesh) { return mesh.instanceOf >= 0; }));
+            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+            log(LogLevel::Info, "Loaded scene snapshot " + path + ": " + std::to_string(meshes.size()) + " meshes (" +
+                std::to_string(instances) + " instances), " + std::to_string(file.size() / 1024 / 1024) + "MB, time: " +
+                std::to_string(duration.count()) + "ms");
+            return std::make_unique<Scene>(std::move(meshes), bounds);
+        }
+
+        bool store(const std::string& path, uint64_t key, const Scene& scene, const std::vector<std::string>& keepUnique)
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            const std::vector<Mesh>& meshes = scene.meshes();
+            const std::vector<size_t> owners = findOwners(meshes, keepUnique);
+
+            FileHeader header;
+            std::memcpy(header.magic, kMagic, sizeof(header.magic));
+            header.version = kVersion;
+            header.key = key;
+            header.vertexStride = static_cast<uint32_t>(sizeof(Vertex));
+            header.meshCount = static_cast<uint32_t>(meshes.size());
+            std::memcpy(header.boundsMin, &scene.bounds().min[0], sizeof(header.boundsMin));
+            std::memcpy(header.boundsMax, &scene.bounds().max[0], sizeof(header.boundsMax));
+
+            // Lay out every section before writing anything
+            std::string strings;
+            std::vector<MeshRecord> records(meshes.size());
+            for (size_t i = 0; i < meshes.size(); ++i)
+            {
+                const Mesh& mesh = meshes[i];
+                MeshRecord& record = records[i];
+                record.nameOffset = static_cast<uint32_t>(strings.size());
+                record.nameLength = static_cast<uint32_t>(mesh.name.size());
+                strings += mesh.name;
+                record.textureOffset = static_cast<uint32_t>(strings.size());
+                record.textureLength = static_cast<uint32_t>(mesh.diffuseTexture.size());
+                strings += mesh.diffuseTexture;
+                std::memcpy(record.transform, &mesh.transform[0][0], sizeof(record.transform));
+                if (owners[i] != i)
+                {
+                    record.instanceOf = static_cast<uint32_t>(owners[i]) + 1;
+                    continue;
+                }
+                record.vertexCount = mesh.vertices.size();
+                record.indexCount = mesh.indices.size();
+            }
+
+            uint64_t offset = sizeof(FileHeader) + records.size() * sizeof(MeshRecord);
+            header.stringsOffset = offset;
+            header.stringsSize = strings.size();
+            offset += strings.size();
+            for (size_t i = 0; i < records.size(); ++i)
+            {
+                if (owners[i] != i)
+                {
+                    continue;
+                }
+                records[i].vertexOffset = alignUp(offset);
+                offset = records[i].vertexOffset + records[i].vertexCount * sizeof(Vertex);
+                records[i].indexOffset = alignUp(offset);
+                offset = records[i].indexOffset + records[i].indexCount * sizeof(uint32_t);
+            }
+            header.fileSize = offset;
+
+            std::error_code ec;
+            fs::create_directories(fs::path(path).parent_path(), ec);
+            const std::string tempPath = path + ".tmp";
+            bool written = false;
+            {
+                std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(MeshRecord)));
+                file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+                offset = header.stringsOffset + strings.size();
+                for (size_t i = 0; i < meshes.size(); ++i)
+                {
+                    if (owners[i] != i)
+                    {
+                        continue;
+                    }
+                    pad(file, offset);
+                    file.write(reinterpret_cast<const char*>(meshes[i].vertices.data()), static_cast<std::streamsize>(records[i].vertexCount * sizeof(Vertex)));
+                    offset += records[i].vertexCount * sizeof(Vertex);
+                    pad(file, offset);
+                    file.write(reinterpret_cast<const char*>(meshes[i].indices.data()), static_cast<std::streamsize>(records[i].indexCount * sizeof(uint32_t)));
+                    offset += records[i].indexCount * sizeof(uint32_t);
+                }
+                written = file.good();
+            }
+            if (!written)
+            {
+                log(LogLevel::Warn, "Failed to write scene snapshot: " + path);
+                fs::remove(tempPath, ec);
+                return false;
+            }
+            fs::rename(tempPath, path, ec);
+            if (ec)
+            {
+                log(LogLevel::Warn, "Failed to write scene snapshot: " + path + " (" + ec.message() + ")");
+                fs::remove(tempPath, ec);
+                return false;
+            }
+
+            size_t shared = 0;
+            for (size_t i = 0; i < owners.size(); ++i)
+            {
+                shared += owners[i] != i ? 1 : 0;
+            }
+            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+            log(LogLevel::Info, "Wrote scene snapshot " + path + ": " + std::to_string(meshes.size()) + " meshes (" +
+                std::to_string(shared) + " share geometry), " + std::to_string(header.fileSize / 1024 / 1024) + "MB, time: " +
+                std::to_string(duration.count()) + "ms");
+            return true;
+        }
+    }
+} // namespace cg
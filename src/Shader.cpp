@@ -39,13 +39,28 @@ namespace cg
         GLuint vertexShader = compile(GL_VERTEX_SHADER, vertexSource);
         GLuint fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentSource);
 
+        link({vertexShader, fragmentShader});
+    }
+
+    Shader::Shader(std::string_view computePath)
+    {
+        constexpr GLenum kComputeShader = 0x91B9;  // GL 4.3; the loader is generated for 4.0
+        link({compile(kComputeShader, readTextFile(std::string(computePath)))});
+    }
+
+    void Shader::link(std::initializer_list<GLuint> shaders)
+    {
         m_program = glCreateProgram();
-        glAttachShader(m_program, vertexShader);
-        glAttachShader(m_program, fragmentShader);
+        for (GLuint shader : shaders)
+        {
+            glAttachShader(m_program, shader);
+        }
         glLinkProgram(m_program);
 
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+        for (GLuint shader : shaders)
+        {
+            glDeleteShader(shader);
+        }
 
         GLint success;
         glGetProgramiv(m_program, GL_LINK_STATUS, &success);
@@ -78,6 +93,12 @@ namespace cg
         glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
     }
 
+    void Shader::setVec2(std::string_view name, const glm::vec2& value) const
+    {
+        const GLint location = glGetUniformLocation(m_program, name.data());
+        glUniform2fv(location, 1, &value[0]);
+    }
+
     void Shader::setVec3(std::string_view name, const glm::vec3& value) const
     {
         const GLint location = glGetUniformLocation(m_program, name.data());
@@ -95,5 +116,11 @@ namespace cg
         const GLint location = glGetUniformLocation(m_program, name.data());
         glUniform1i(location, value);
     }
+
+    void Shader::setUInt(std::string_view name, unsigned value) const
+    {
+        const GLint location = glGetUniformLocation(m_program, name.data());
+        glUniform1ui(location, value);
+    }
 } // namespace cg
 
@@ -0,0 +1,508 @@
+#include "render/SkyboxDecoder.h"
+
+#include "util/FileSystem.h"
+#include "util/Log.h"
+#include "util/PixelConvert.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <numeric>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+namespace cg
+{
+    namespace SkyboxDecoder
+    {
+        namespace
+        {
+            constexpr char kCacheMagic[4] = {'C', 'G', 'S', 'K'};
+            constexpr uint32_t kCacheVersion = 3;
+
+            // Streamed bands are at least this tall so each hand-off is a reasonably sized upload
+            constexpr int kMinStreamBandRows = 64;
+
+            // Receives decoded float blocks in any order and writes them, already in the GPU
+            // format, to their final location. BC6H needs whole 4-row block rows, so its input
+            // is gathered into bands that are encoded as soon as they are complete. Without a
+            // target every format is gathered into bands that go to job.writeBand instead.
+            class SkyTextureWriter
+            {
+            public:
+                SkyTextureWriter(const Job& job, int face, int width, int height, int sourceBlockHeight, uint8_t* target)
+                    : m_format(job.format), m_face(face), m_width(width), m_height(height), m_target(target),
+                      m_writeBand(job.writeBand)
+                {
+                    // Source blocks start at multiples of their height, so lcm(height, 4) bands never split one
+                    const int blockHeight = std::max(sourceBlockHeight, 1);
+                    m_bandHeight = blockHeight * 4 / std::gcd(blockHeight, 4);
+                    if (!m_target)
+                    {
+                        m_bandHeight *= (kMinStreamBandRows + m_bandHeight - 1) / m_bandHeight;
+                    }
+                }
+
+                void addBlock(int x, int y, int width, int height, const float* pixels, int channels)
+                {
+                    for (int row = 0; row < height; ++row)
+                    {
+                        addRow(x, y + row, width, pixels + static_cast<size_t>(row) * width * channels, channels);
+                    }
+                }
+
+            private:
+                struct Band
+                {
+                    std::vector<float> rgb;       // BC6H input
+                    std::vector<uint8_t> texels;  // Streamed uncompressed rows
+                    size_t filled{0};
+                };
+
+                SkyboxFormat m_format;
+                int m_face;
+                int m_width;
+                int m_height;
+                int m_bandHeight{4};
+                uint8_t* m_target;
+                const std::function<void(int, int, int, const uint8_t*)>& m_writeBand;
+                std::map<int, Band> m_bands;
+                std::vector<float> m_rgbaRow;
+                std::vector<uint8_t> m_encoded;
+
+                void addRow(int x, int y, int count, const float* src, int channels)
+                {
+                    const int bandStart = y / m_bandHeight * m_bandHeight;
+                    const int bandRows = std::min(m_bandHeight, m_height - bandStart);
+                    if (m_format != SkyboxFormat::Bc6h)
+                    {
+                        if (m_target)
+                        {
+                            convertRow(src, channels, count, m_target + textureByteSize(m_format, 1, 1) * (static_cast<size_t>(y) * m_width + x));
+                            return;
+                        }
+                        Band& band = m_bands[bandStart];
+                        if (band.texels.empty())
+                        {
+                            band.texels.resize(textureByteSize(m_format, m_width, bandRows));
+                        }
+                        convertRow(src, channels, count, band.texels.data() + textureByteSize(m_format, 1, 1) * (static_cast<size_t>(y - bandStart) * m_width + x));
+                        if (completeRows(band, count, bandRows))
+                        {
+                            m_writeBand(m_face, bandStart, bandRows, band.texels.data());
+                            m_bands.erase(bandStart);
+                        }
+                        return;
+                    }
+
+                    Band& band = m_bands[bandStart];
+                    if (band.rgb.empty())
+                    {
+                        band.rgb.resize(static_cast<size_t>(m_width) * bandRows * 3);
+                    }
+                    float* dst = band.rgb.data() + (static_cast<size_t>(y - bandStart) * m_width + x) * 3;
+                    for (int i = 0; i < count; ++i)
+                    {
+                        dst[i * 3 + 0] = src[i * channels + 0];
+                        dst[i * 3 + 1] = src[i * channels + 1];
+                        dst[i * 3 + 2] = src[i * channels + 2];
+                    }
+                    if (completeRows(band, count, bandRows))
+                    {
+                        if (m_target)
+                        {
+                            const size_t blockRowBytes = PixelConvert::bc6hSize(m_width, 4);
+                            PixelConvert::encodeBc6h(band.rgb.data(), 3, m_width, bandRows, m_target + static_cast<size_t>(bandStart / 4) * blockRowBytes);
+                        }
+                        else
+                        {
+                            m_encoded.resize(PixelConvert::bc6hSize(m_width, bandRows));
+                            PixelConvert::encodeBc6h(band.rgb.data(), 3, m_width, bandRows, m_encoded.data());
+                            m_writeBand(m_face, bandStart, bandRows, m_encoded.data());
+                        }
+                        m_bands.erase(bandStart);
+                    }
+                }
+
+                bool completeRows(Band& band, int count, int bandRows) const
+                {
+                    band.filled += static_cast<size_t>(count);
+                    return band.filled == static_cast<size_t>(m_width) * bandRows;
+                }
+
+                void convertRow(const float* src, int channels, int count, uint8_t* dst)
+                {
+                    if (m_format == SkyboxFormat::Rgb9E5)
+                    {
+                        PixelConvert::floatToRgb9e5(src, channels, reinterpret_cast<uint32_t*>(dst), count);
+                        return;
+                    }
+                    if (channels != 4)
+                    {
+                        m_rgbaRow.resize(static_cast<size_t>(count) * 4);
+                        for (int i = 0; i < count; ++i)
+                        {
+                            m_rgbaRow[i * 4 + 0] = src[i * channels + 0];
+                            m_rgbaRow[i * 4 + 1] = src[i * channels + 1];
+                            m_rgbaRow[i * 4 + 2] = src[i * channels + 2];
+                            m_rgbaRow[i * 4 + 3] = 1.0f;
+                        }
+                        src = m_rgbaRow.data();
+                    }
+                    PixelConvert::floatToHalf(src, reinterpret_cast<uint16_t*>(dst), static_cast<size_t>(count) * 4);
+                }
+            };
+
+            // Routes every decoded block to the texture writer and/or the downsampled copies
+            // needed for cubemap conversion and the environment bake.
+            class SkyBlockSink
+            {
+            public:
+                explicit SkyBlockSink(const Job& job)
+                    : m_job(job),
+                      m_cubeSource(job.sourceWidth, job.sourceHeight, job.cubemapFaceSize * 4, job.cubemapFaceSize * 2),
+                      m_environmentSource(job.sourceWidth, job.sourceHeight, job.environmentFaceSize * 4, job.environmentFaceSize * 2)
+                {
+                    if (job.cubemapFaceSize == 0)
+                    {
+                        m_writer = std::make_unique<SkyTextureWriter>(m_job, 0, job.sourceWidth, job.sourceHeight, job.sourceBlockHeight, job.target);
+                    }
+                }
+
+                void addBlock(int x, int y, int width, int height, const float* pixels, int channels)
+                {
+                    if (m_writer)
+                    {
+                        m_writer->addBlock(x, y, width, height, pixels, channels);
+                    }
+                    for (int row = 0; row < height; ++row)
+                    {
+                        const float* src = pixels + static_cast<size_t>(row) * width * channels;
+                        if (m_job.cubemapFaceSize > 0)
+                        {
+                            m_cubeSource.addPixels(x, y + row, src, width, channels);
+                        }
+                        if (m_job.environmentFaceSize > 0)
+                        {
+                            m_environmentSource.addPixels(x, y + row, src, width, channels);
+                        }
+                    }
+                }
+
+                EnvironmentBaker::Environment finish()
+                {
+                    if (m_job.cubemapFaceSize > 0)
+                    {
+                        const int size = m_job.cubemapFaceSize;
+                        const size_t faceBytes = textureByteSize(m_job.format, size, size);
+                        const EnvironmentBaker::LatLongImage source = m_cubeSource.finish();
+                        std::vector<float> face(static_cast<size_t>(size) * size * 3);
+                        for (int f = 0; f < 6; ++f)
+                        {
+                            EnvironmentBaker::resampleFace(source, f, size, face.data());
+                            // The whole face arrives at once, so bands need not align with a source block
+                            SkyTextureWriter writer(m_job, f, size, size, 1, m_job.target ? m_job.target + f * faceBytes : nullptr);
+                            writer.addBlock(0, 0, size, size, face.data(), 3);
+                        }
+                    }
+
+                    if (m_job.environmentFaceSize > 0)
+                    {
+                        return EnvironmentBaker::bake(m_environmentSource.finish(), m_job.environmentFaceSize);
+                    }
+                    return {};
+                }
+
+            private:
+                Job m_job;
+                std::unique_ptr<SkyTextureWriter> m_writer;
+                EnvironmentBaker::LatLongDownsampler m_cubeSource;
+                EnvironmentBaker::LatLongDownsampler m_environmentSource;
+            };
+
+            std::string toLower(std::string str)
+            {
+                std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                return str;
+            }
+        } // namespace
+
+        const char* formatName(SkyboxFormat format)
+        {
+            switch (format)
+            {
+            case SkyboxFormat::Rgb9E5: return "RGB9E5";
+            case SkyboxFormat::Bc6h: return "BC6H";
+            default: return "RGBA16F";
+            }
+        }
+
+        size_t textureByteSize(SkyboxFormat format, int width, int height)
+        {
+            const size_t texels = static_cast<size_t>(width) * static_cast<size_t>(height);
+            switch (format)
+            {
+            case SkyboxFormat::Rgb9E5: return texels * sizeof(uint32_t);
+            case SkyboxFormat::Bc6h: return PixelConvert::bc6hSize(width, height);
+            default: return texels * 4 * sizeof(uint16_t);
+            }
+        }
+
+        size_t outputSize(const Job& job)
+        {
+            if (job.cubemapFaceSize > 0)
+            {
+                return textureByteSize(job.format, job.cubemapFaceSize, job.cubemapFaceSize) * 6;
+            }
+            return textureByteSize(job.format, job.sourceWidth, job.sourceHeight);
+        }
+
+        bool openSource(const std::string& path, Job& job, std::unique_ptr<ExrStreamReader>& reader)
+        {
+            const std::string extension = toLower(std::filesystem::path(path).extension().string());
+            if (extension == ".exr")
+            {
+                reader = std::make_unique<ExrStreamReader>();
+                if (!reader->open(path))
+                {
+                    log(LogLevel::Error, "Failed to load EXR texture: " + path);
+                    reader.reset();
+                    return false;
+                }
+                job.sourceWidth = reader->width();
+                job.sourceHeight = reader->height();
+                job.sourceBlockHeight = reader->blockHeight();
+                return true;
+            }
+
+            int channels = 0;
+            MappedFile file;
+            if (!file.open(path) || !stbi_info_from_memory(file.bytes(), static_cast<int>(file.size()), &job.sourceWidth, &job.sourceHeight, &channels))
+            {
+                log(LogLevel::Error, "Failed to load HDR texture: " + path);
+                return false;
+            }
+            // stb keeps this flag in a global, so set it before any worker starts decoding
+            stbi_set_flip_vertically_on_load(false);
+            return true;
+        }
+
+        bool decode(const std::string& path, std::unique_ptr<ExrStreamReader> reader, const Job& job,
+                    EnvironmentBaker::Environment& environment)
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            SkyBlockSink sink(job);
+            if (reader)
+            {
+                const bool ok = reader->readBlocks([&](const ExrStreamReader::Block& block)
+                {
+                    sink.addBlock(block.x, block.y, block.width, block.height, block.rgba, 4);
+                    return true;
+                });
+                if (!ok)
+                {
+                    log(LogLevel::Error, "Failed to load EXR texture: " + path);
+                    return false;
+                }
+            }
+            else
+            {
+                int width = 0;
+                int height = 0;
+                int channels = 0;
+                MappedFile file;
+                float* data = file.open(path) ? stbi_loadf_from_memory(file.bytes(), static_cast<int>(file.size()), &width, &height, &channels, 0) : nullptr;
+                file.close();
+                if (!data)
+                {
+                    // stbi_failure_reason() is a process-wide string another decode may be overwriting
+                    log(LogLevel::Error, "Failed to load HDR texture: " + path);
+                    return false;
+                }
+                if (channels < 3)
+                {
+                    log(LogLevel::Error, "Skybox texture requires at least 3 channels: " + path);
+                    stbi_image_free(data);
+                    return false;
+                }
+                if (width != job.sourceWidth || height != job.sourceHeight)
+                {
+                    log(LogLevel::Error, "Skybox texture changed while loading: " + path);
+                    stbi_image_free(data);
+                    return false;
+                }
+                for (int y = 0; y < height; ++y)
+                {
+                    sink.addBlock(0, y, width, 1, data + static_cast<size_t>(y) * width * channels, channels);
+                }
+                stbi_image_free(data);
+            }
+            environment = sink.finish();
+
+            const auto end = std::chrono::high_resolution_clock::now();
+            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+            log(LogLevel::Info, "Decoded skybox " + path + " (" + std::to_string(job.sourceWidth) + "x" + std::to_string(job.sourceHeight) +
+                " -> " + formatName(job.format) + (job.cubemapFaceSize > 0 ? " cubemap" : "") + ") time: " +
+                std::to_string(duration.count()) + "ms");
+            return true;
+        }
+
+        bool makeCacheHeader(const std::string& sourcePath, SkyboxFormat format, const Job& job, CacheHeader& header)
+        {
+            namespace fs = std::filesystem;
+            std::error_code ec;
+            const auto size = fs::file_size(sourcePath, ec);
+            if (ec) return false;
+            const auto time = fs::last_write_time(sourcePath, ec);
+            if (ec) return false;
+            std::memcpy(header.magic, kCacheMagic, sizeof(header.magic));
+            header.version = kCacheVersion;
+            header.sourceSize = static_cast<uint64_t>(size);
+            header.sourceTime = static_cast<int64_t>(time.time_since_epoch().count());
+            header.format = static_cast<uint32_t>(format);
+            header.width = job.cubemapFaceSize > 0 ? job.cubemapFaceSize : job.sourceWidth;
+            header.height = job.cubemapFaceSize > 0 ? job.cubemapFaceSize : job.sourceHeight;
+            header.cubemapFaceSize = job.cubemapFaceSize;
+            header.environmentFaceSize = job.environmentFaceSize;
+            return true;
+        }
+
+        bool readCacheHeader(const std::string& cachePath, CacheHeader& header)
+        {
+            std::ifstream file(cachePath, std::ios::binary);
+            if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            {
+                return false;
+            }
+            return std::memcmp(header.magic, kCacheMagic, sizeof(header.magic)) == 0 && header.version == kCacheVersion;
+        }
+
+        bool sameSettings(const CacheHeader& a, const CacheHeader& b)
+        {
+            return a.format == b.format &&
+                   a.cubemapFaceSize == b.cubemapFaceSize &&
+                   a.environmentFaceSize == b.environmentFaceSize;
+        }
+
+        bool sameSource(const CacheHeader& a, const CacheHeader& b)
+        {
+            return sameSettings(a, b) && a.sourceSize == b.sourceSize && a.sourceTime == b.sourceTime;
+        }
+
+        bool readCache(const std::string& cachePath, const CacheHeader& header, std::vector<uint8_t>& data,
+                          EnvironmentBaker::Environment& environment)
+        {
+            MappedFile file;
+            if (!file.open(cachePath))
+            {
+                return false;
+            }
+            // The header describes the whole file, so a truncated or foreign payload is caught up front
+            size_t expectedSize = sizeof(CacheHeader) + header.dataSize;
+            if (header.environmentMipCount > 0)
+            {
+                if (header.environmentBakedFaceSize <= 0 || header.environmentMipCount > 31 ||
+                    (header.environmentBakedFaceSize >> (header.environmentMipCount - 1)) <= 0)
+                {
+                    return false;
+                }
+                expectedSize += sizeof(environment.irradianceSH);
+                for (int mip = 0; mip < header.environmentMipCount; ++mip)
+                {
+                    const size_t size = static_cast<size_t>(header.environmentBakedFaceSize >> mip);
+                    expectedSize += size * size * 3 * sizeof(float) * 6;
+                }
+            }
+            if (expectedSize != file.size())
+            {
+                return false;
+            }
+
+            size_t offset = sizeof(CacheHeader);
+            auto read = [&](void* dst, size_t size) {
+                if (offset + size > file.size())
+                {
+                    return false;
+                }
+                std::memcpy(dst, file.data() + offset, size);
+                offset += size;
+                return true;
+            };
+
+            data.resize(header.dataSize);
+            if (!read(data.data(), data.size()))
+            {
+                return false;
+            }
+            if (header.environmentMipCount > 0)
+            {
+                environment.faceSize = header.environmentBakedFaceSize;
+                environment.mipCount = header.environmentMipCount;
+                if (!read(environment.irradianceSH.data(), sizeof(environment.irradianceSH)))
+                {
+                    return false;
+                }
+                environment.faces.resize(static_cast<size_t>(environment.mipCount) * 6);
+                for (size_t i = 0; i < environment.faces.size(); ++i)
+                {
+                    const int size = environment.faceSize >> (i / 6);
+                    environment.faces[i].resize(static_cast<size_t>(size) * size * 3);
+                    if (!read(environment.faces[i].data(), environment.faces[i].size() * sizeof(float)))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool writeCache(const std::string& cachePath, CacheHeader header, const std::vector<uint8_t>& data,
+                           const EnvironmentBaker::Environment& environment)
+        {
+            namespace fs = std::filesystem;
+            std::error_code ec;
+            fs::create_directories(fs::path(cachePath).parent_path(), ec);
+
+            header.dataSize = data.size();
+            header.environmentMipCount = environment.faces.empty() ? 0 : environment.mipCount;
+            header.environmentBakedFaceSize = environment.faces.empty() ? 0 : environment.faceSize;
+            const std::string tempPath = cachePath + ".tmp";
+            {
+                std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+                if (header.environmentMipCount > 0)
+                {
+                    file.write(reinterpret_cast<const char*>(environment.irradianceSH.data()), sizeof(environment.irradianceSH));
+                    for (const auto& face : environment.faces)
+                    {
+                        file.write(reinterpret_cast<const char*>(face.data()), static_cast<std::streamsize>(face.size() * sizeof(float)));
+                    }
+                }
+                if (!file)
+                {
+                    log(LogLevel::Warn, "Failed to write skybox cache: " + cachePath);
+                    return false;
+                }
+            }
+            fs::rename(tempPath, cachePath, ec);
+            if (ec)
+            {
+                log(LogLevel::Warn, "Failed to write skybox cache: " + cachePath + " (" + ec.message() + ")");
+                return false;
+            }
+            return true;
+        }
+
+        std::string bakeVariant(SkyboxFormat format, int cubemapFaceSize, int environmentFaceSize)
+        {
+            return std::string("sky.") + formatName(format) + ".cube" + std::to_string(cubemapFaceSize) +
+                ".env" + std::to_string(environmentFaceSize);
+        }
+    }
+} // namespace cg
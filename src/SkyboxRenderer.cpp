@@ -1,5 +1,9 @@
 #include "render/SkyboxRenderer.h"
 
+#include "loader/AssetBake.h"
+#include "loader/ExrStreamReader.h"
+#include "render/SkyboxDecoder.h"
+#include "util/JobSystem.h"
 #include "util/Log.h"
 
 #include <glad/glad.h>
@@ -7,17 +11,13 @@
 #include <glm/gtc/constants.hpp>
 
 #include <algorithm>
-#include <cctype>
-#include <cstdlib>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <filesystem>
+#include <mutex>
 #include <vector>
 
-#define TINYEXR_IMPLEMENTATION
-#include <tinyexr.h>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb/stb_image.h>
-
 namespace cg
 {
     namespace
@@ -69,36 +69,160 @@ namespace cg
 
         constexpr int kVertexCount = 36;
 
-        GLuint createTextureFromPixels(int width, int height, int channels, const float* data)
+        constexpr GLenum kCompressedRgbBptcUnsignedFloat = 0x8E8F;  // GL 4.2 / ARB_texture_compression_bptc
+
+        // Staging slots per streamed sky texture; bounds its upload memory to a few bands
+        constexpr size_t kUploadSlots = 4;
+
+        bool supportsBc6h()
         {
-            if (channels != 3 && channels != 4)
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+            std::vector<GLint> formats(static_cast<size_t>(std::max(count, 0)));
+            if (!formats.empty())
             {
-                log(LogLevel::Error, "Unsupported channel count for skybox texture.");
-                return 0;
+                glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
             }
+            return std::find(formats.begin(), formats.end(), static_cast<GLint>(kCompressedRgbBptcUnsignedFloat)) != formats.end();
+        }
 
-            const GLenum format = channels == 4 ? GL_RGBA : GL_RGB;
-            const GLint internalFormat = channels == 4 ? GL_RGBA16F : GL_RGB16F;
+        // A null data only allocates the storage
+        GLuint createSkyTexture(SkyboxFormat format, bool cubemap, int width, int height, const uint8_t* data)
+        {
+            const GLenum target = cubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+            const size_t faceBytes = SkyboxDecoder::textureByteSize(format, width, height);
 
             GLuint texture = 0;
             glGenTextures(1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_FLOAT, data);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glBindTexture(GL_TEXTURE_2D, 0);
+            glBindTexture(target, texture);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+            for (int face = 0; face < (cubemap ? 6 : 1); ++face)
+            {
+                const GLenum faceTarget = cubemap ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+                const void* faceData = reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(data) + face * faceBytes);
+                switch (format)
+                {
+                case SkyboxFormat::Rgb9E5:
+                    glTexImage2D(faceTarget, 0, GL_RGB9_E5, width, height, 0, GL_RGB, GL_UNSIGNED_INT_5_9_9_9_REV, faceData);
+                    break;
+                case SkyboxFormat::Bc6h:
+                    glCompressedTexImage2D(faceTarget, 0, kCompressedRgbBptcUnsignedFloat, width, height, 0,
+                                           static_cast<GLsizei>(faceBytes), faceData);
+                    break;
+                default:
+                    glTexImage2D(faceTarget, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, faceData);
+                    break;
+                }
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+            glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glBindTexture(target, 0);
             return texture;
         }
 
-        std::string toLower(std::string str)
+        void uploadSkyRows(SkyboxFormat format, bool cubemap, GLuint texture, int face, int firstRow, int width, int rows,
+                           const uint8_t* data)
         {
-            std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-            return str;
+            const GLenum target = cubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+            const GLenum faceTarget = cubemap ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+            glBindTexture(target, texture);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+            switch (format)
+            {
+            case SkyboxFormat::Rgb9E5:
+                glTexSubImage2D(faceTarget, 0, 0, firstRow, width, rows, GL_RGB, GL_UNSIGNED_INT_5_9_9_9_REV, data);
+                break;
+            case SkyboxFormat::Bc6h:
+                glCompressedTexSubImage2D(faceTarget, 0, 0, firstRow, width, rows, kCompressedRgbBptcUnsignedFloat,
+                                          static_cast<GLsizei>(SkyboxDecoder::textureByteSize(format, width, rows)), data);
+                break;
+            default:
+                glTexSubImage2D(faceTarget, 0, 0, firstRow, width, rows, GL_RGBA, GL_HALF_FLOAT, data);
+                break;
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glBindTexture(target, 0);
+        }
+
+        GLuint createEnvironmentCubemap(const EnvironmentBaker::Environment& environment)
+        {
+            GLuint texture = 0;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+            for (int mip = 0; mip < environment.mipCount; ++mip)
+            {
+                const int size = environment.faceSize >> mip;
+                for (int face = 0; face < 6; ++face)
+                {
+                    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, mip, GL_RGB16F, size, size, 0, GL_RGB, GL_FLOAT,
+                                 environment.faces[static_cast<size_t>(mip) * 6 + face].data());
+                }
+            }
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, environment.mipCount - 1);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+            // Rough mips are tiny; filter across face edges so they do not show seams
+            glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+            return texture;
         }
     } // namespace
 
+    // Ring of staging slots between a decoding worker and the GL thread. The worker blocks
+    // while every slot still waits for its upload.
+    class SkyboxRenderer::BandUploads
+    {
+    public:
+        explicit BandUploads(size_t slotCount)
+            : m_slots(slotCount)
+        {
+            for (size_t i = 0; i < slotCount; ++i)
+            {
+                m_free.push_back(i);
+            }
+        }
+
+        size_t acquire()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_released.wait(lock, [this]() { return !m_free.empty(); });
+            const size_t slot = m_free.back();
+            m_free.pop_back();
+            return slot;
+        }
+
+        std::vector<uint8_t>& slot(size_t index) { return m_slots[index]; }
+
+        void release(size_t index)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_free.push_back(index);
+            }
+            m_released.notify_one();
+        }
+
+        bool idle() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_free.size() == m_slots.size();
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::condition_variable m_released;
+        std::vector<std::vector<uint8_t>> m_slots;
+        std::vector<size_t> m_free;
+    };
+
     SkyboxRenderer::SkyboxRenderer()
     {
         createCubeGeometry();
@@ -107,6 +231,19 @@ namespace cg
 
     SkyboxRenderer::~SkyboxRenderer()
     {
+        // Never leave a worker writing into a buffer that is about to be released
+        for (PendingTexture* pending : {&m_pendingDay, &m_pendingNight})
+        {
+            if (pending->decoded.valid())
+            {
+                EnvironmentLighting environment;
+                GLuint texture = finishTextureLoad(*pending, environment);
+                if (texture != 0) glDeleteTextures(1, &texture);
+                if (environment.cubemap != 0) glDeleteTextures(1, &environment.cubemap);
+            }
+        }
+        if (m_dayEnvironment.cubemap != 0) glDeleteTextures(1, &m_dayEnvironment.cubemap);
+        if (m_nightEnvironment.cubemap != 0) glDeleteTextures(1, &m_nightEnvironment.cubemap);
         if (m_dayTexture != 0) glDeleteTextures(1, &m_dayTexture);
         if (m_nightTexture != 0) glDeleteTextures(1, &m_nightTexture);
         if (m_vbo != 0) glDeleteBuffers(1, &m_vbo);
@@ -115,8 +252,25 @@ namespace cg
 
     bool SkyboxRenderer::loadEquirectangularTextures(const std::string& dayPath, const std::string& nightPath)
     {
-        m_dayTexture = loadTexture(dayPath);
-        m_nightTexture = loadTexture(nightPath);
+        beginLoadEquirectangularTextures(dayPath, nightPath);
+        return finishLoadEquirectangularTextures();
+    }
+
+    void SkyboxRenderer::beginLoadEquirectangularTextures(const std::string& dayPath, const std::string& nightPath)
+    {
+        beginTextureLoad(dayPath, m_pendingDay);
+        beginTextureLoad(nightPath, m_pendingNight);
+    }
+
+    bool SkyboxRenderer::finishLoadEquirectangularTextures()
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        m_cubemap = m_pendingDay.cubemap;
+        m_dayTexture = finishTextureLoad(m_pendingDay, m_dayEnvironment);
+        m_nightTexture = finishTextureLoad(m_pendingNight, m_nightEnvironment);
+        const auto end = std::chrono::high_resolution_clock::now();
+        const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        log(LogLevel::Info, "Skybox wait + upload time: " + std::to_string(duration.count()) + "ms");
 
         if (m_dayTexture == 0 || m_nightTexture == 0)
         {
@@ -150,84 +304,201 @@ namespace cg
 		m_shader->setFloat("uSkyYOffset", skyYOffset);
 		m_shader->setFloat("uNightBrightness", m_nightBrightness);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, m_dayTexture);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, m_nightTexture);
+        // 2D and cube samplers live on separate units so the unused pair never aliases a bound type
+        const GLenum target = m_cubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+        const int firstUnit = m_cubemap ? 2 : 0;
+        glActiveTexture(GL_TEXTURE0 + firstUnit);
+        glBindTexture(target, m_dayTexture);
+        glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+        glBindTexture(target, m_nightTexture);
 
         m_shader->setInt("uDaySampler", 0);
         m_shader->setInt("uNightSampler", 1);
+        m_shader->setInt("uDayCube", 2);
+        m_shader->setInt("uNightCube", 3);
+        m_shader->setInt("uUseCubemap", m_cubemap ? 1 : 0);
 
         glBindVertexArray(m_vao);
         glDrawArrays(GL_TRIANGLES, 0, kVertexCount);
         glBindVertexArray(0);
 
-        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindTexture(target, 0);
+        glActiveTexture(GL_TEXTURE0 + firstUnit);
+        glBindTexture(target, 0);
         glActiveTexture(GL_TEXTURE0);
 
         glDepthMask(GL_TRUE);
         glDepthFunc(GL_LESS);
     }
 
-    unsigned SkyboxRenderer::loadTexture(const std::string& path) const
+    void SkyboxRenderer::beginTextureLoad(const std::string& path, PendingTexture& pending)
     {
-        const std::string extension = toLower(std::filesystem::path(path).extension().string());
-        if (extension == ".exr")
-        {
-            float* exrData = nullptr;
-            int width = 0;
-            int height = 0;
-            const char* err = nullptr;
-            const int ret = LoadEXR(&exrData, &width, &height, path.c_str(), &err);
-            if (ret != TINYEXR_SUCCESS)
+        pending = PendingTexture{};
+        pending.path = path;
+        pending.format = m_format;
+        pending.cubemap = m_cubemapFaceSize > 0;
+        if (pending.format == SkyboxFormat::Bc6h && !supportsBc6h())
+        {
+            log(LogLevel::Warn, "BC6H textures are not supported by this GPU, using RGB9E5 for the skybox.");
+            pending.format = SkyboxFormat::Rgb9E5;
+        }
+
+        // A baked sky is used in any format and needs neither the source nor a decode
+        if (const auto baked = AssetBake::find(path, SkyboxDecoder::bakeVariant(pending.format, m_cubemapFaceSize, m_environmentFaceSize)))
+        {
+            SkyboxDecoder::CacheHeader cached;
+            if (SkyboxDecoder::readCacheHeader(*baked, cached) && cached.format == static_cast<uint32_t>(pending.format) &&
+                cached.dataSize == SkyboxDecoder::textureByteSize(pending.format, cached.width, cached.height) * (pending.cubemap ? 6 : 1))
             {
-                std::string msg = "Failed to load EXR texture: " + path;
-                if (err != nullptr)
+                pending.width = cached.width;
+                pending.height = cached.height;
+                pending.decoded = JobSystem::instance().async([&pending, cachePath = *baked, cached]() -> bool {
+                    if (!SkyboxDecoder::readCache(cachePath, cached, pending.data, pending.environment))
+                    {
+                        log(LogLevel::Error, "Failed to read baked skybox: " + cachePath);
+                        return false;
+                    }
+                    log(LogLevel::Info, "Loaded baked skybox: " + cachePath);
+                    return true;
+                });
+                return;
+            }
+        }
+
+        SkyboxDecoder::Job job;
+        job.format = pending.format;
+        job.cubemapFaceSize = m_cubemapFaceSize;
+        job.environmentFaceSize = m_environmentFaceSize;
+
+        // Only headers are read here, so the output buffer can be sized on the GL thread
+        std::unique_ptr<ExrStreamReader> reader;
+        if (!SkyboxDecoder::openSource(path, job, reader))
+        {
+            return;
+        }
+
+        pending.width = pending.cubemap ? m_cubemapFaceSize : job.sourceWidth;
+        pending.height = pending.cubemap ? m_cubemapFaceSize : job.sourceHeight;
+        const size_t byteSize = SkyboxDecoder::outputSize(job);
+
+        SkyboxDecoder::CacheHeader cacheHeader;
+        std::string cachePath;
+        if (pending.format == SkyboxFormat::Bc6h && SkyboxDecoder::makeCacheHeader(path, pending.format, job, cacheHeader))
+        {
+            // Encoding is the slow part; results are reused until the source file changes
+            std::string cacheName = std::filesystem::path(path).filename().string();
+            if (pending.cubemap)
+            {
+                cacheName += ".cube" + std::to_string(m_cubemapFaceSize);
+            }
+            cachePath = (std::filesystem::path(m_cacheDirectory) / (cacheName + ".bc6h")).string();
+
+            SkyboxDecoder::CacheHeader cached;
+            if (SkyboxDecoder::readCacheHeader(cachePath, cached) && SkyboxDecoder::sameSource(cached, cacheHeader) &&
+                cached.dataSize == byteSize)
+            {
+                pending.decoded = JobSystem::instance().async([&pending, cachePath, cached]() -> bool {
+                    if (!SkyboxDecoder::readCache(cachePath, cached, pending.data, pending.environment))
+                    {
+                        log(LogLevel::Error, "Failed to read skybox cache: " + cachePath);
+                        return false;
+                    }
+                    log(LogLevel::Info, "Loaded skybox from cache: " + cachePath);
+                    return true;
+                });
+                return;
+            }
+        }
+
+        // Uncompressed formats stream finished bands into the texture while decoding; BC6H keeps
+        // a CPU copy (1 byte per texel) because it is also written to the cache.
+        if (pending.format != SkyboxFormat::Bc6h)
+        {
+            pending.texture = createSkyTexture(pending.format, pending.cubemap, pending.width, pending.height, nullptr);
+            pending.uploads = std::make_shared<BandUploads>(kUploadSlots);
+            job.writeBand = [uploads = pending.uploads, format = pending.format, cubemap = pending.cubemap,
+                             texture = pending.texture, width = pending.width](int face, int firstRow, int rows, const uint8_t* bytes) {
+                JobSystem& jobs = JobSystem::instance();
+                if (jobs.isMainThread())
                 {
-                    msg += " (" + std::string(err) + ")";
-                    FreeEXRErrorMessage(err);
+                    // Decoding inside a main-thread wait(): nothing else would drain the slots
+                    uploadSkyRows(format, cubemap, texture, face, firstRow, width, rows, bytes);
+                    return;
                 }
-                log(LogLevel::Error, msg);
-                if (exrData) free(exrData);
-                return 0;
+                const size_t slot = uploads->acquire();
+                uploads->slot(slot).assign(bytes, bytes + SkyboxDecoder::textureByteSize(format, width, rows));
+                jobs.submitMain([=]() {
+                    uploadSkyRows(format, cubemap, texture, face, firstRow, width, rows, uploads->slot(slot).data());
+                    uploads->release(slot);
+                });
+            };
+        }
+        else
+        {
+            pending.data.resize(byteSize);
+            job.target = pending.data.data();
+        }
+
+        pending.decoded = JobSystem::instance().async([reader = std::move(reader), job, &pending, path, cachePath, cacheHeader]() mutable -> bool {
+            if (!SkyboxDecoder::decode(path, std::move(reader), job, pending.environment))
+            {
+                return false;
             }
+            if (!cachePath.empty())
+            {
+                SkyboxDecoder::writeCache(cachePath, cacheHeader, pending.data, pending.environment);
+            }
+            return true;
+        });
+    }
 
-            std::vector<float> pixels(exrData, exrData + (width * height * 4));
-            free(exrData);
-            return createTextureFromPixels(width, height, 4, pixels.data());
+    unsigned SkyboxRenderer::finishTextureLoad(PendingTexture& pending, EnvironmentLighting& environment)
+    {
+        // Band uploads are main-thread jobs, so keep running them while the decoder works
+        JobSystem& jobs = JobSystem::instance();
+        while (pending.decoded.valid() && pending.decoded.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+        {
+            jobs.runMainThreadJobs();
         }
-
-        stbi_set_flip_vertically_on_load(false);
-        int width = 0;
-        int height = 0;
-        int channels = 0;
-        float* data = stbi_loadf(path.c_str(), &width, &height, &channels, 0);
-        if (!data)
+        while (pending.uploads && !pending.uploads->idle())
         {
-            log(LogLevel::Error, std::string("Failed to load HDR texture: ") + path + " (" + (stbi_failure_reason() ? stbi_failure_reason() : "unknown error") + ")");
-            return 0;
+            jobs.runMainThreadJobs();
         }
+        const bool ok = pending.decoded.valid() && pending.decoded.get();
 
-        if (channels < 3)
+        if (ok && !pending.environment.faces.empty())
         {
-            log(LogLevel::Error, "Skybox texture requires at least 3 channels: " + path);
-            stbi_image_free(data);
-            return 0;
+            environment.cubemap = createEnvironmentCubemap(pending.environment);
+            environment.mipCount = pending.environment.mipCount;
+            environment.irradianceSH = pending.environment.irradianceSH;
         }
 
-        const int usedChannels = channels >= 4 ? 4 : 3;
-        const size_t pixelCount = static_cast<size_t>(width) * static_cast<size_t>(height) * usedChannels;
-        std::vector<float> pixels(pixelCount);
-        for (size_t i = 0; i < static_cast<size_t>(width) * static_cast<size_t>(height); ++i)
+        GLuint texture = 0;
+        if (pending.texture != 0)
         {
-            for (int c = 0; c < usedChannels; ++c)
+            // Already holds every streamed band; a failed decode leaves it incomplete
+            texture = pending.texture;
+            if (!ok)
             {
-                pixels[i * usedChannels + c] = data[i * channels + c];
+                glDeleteTextures(1, &texture);
+                texture = 0;
             }
         }
+        else if (ok)
+        {
+            texture = createSkyTexture(pending.format, pending.cubemap, pending.width, pending.height, pending.data.data());
+        }
+
+        if (texture != 0)
+        {
+            const size_t bytes = SkyboxDecoder::textureByteSize(pending.format, pending.width, pending.height) * (pending.cubemap ? 6 : 1);
+            log(LogLevel::Info, "Skybox texture " + pending.path + ": " + SkyboxDecoder::formatName(pending.format) + " " +
+                std::to_string(pending.width) + "x" + std::to_string(pending.height) + (pending.cubemap ? " x6" : "") + ", " +
+                std::to_string(bytes / (1024 * 1024)) + " MB");
+        }
 
-        stbi_image_free(data);
-        return createTextureFromPixels(width, height, usedChannels, pixels.data());
+        pending = PendingTexture{};
+        return texture;
     }
 
     void SkyboxRenderer::createCubeGeometry()
@@ -0,0 +1,65 @@
+#include "util/TaskGraph.h"
+
+#include "util/JobSystem.h"
+#include "util/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace cg
+{
+    TaskGraph::TaskId TaskGraph::add(std::string name, std::function<void()> fn, std::vector<TaskId> dependencies)
+    {
+        const TaskId id = m_tasks.size();
+        Task task;
+        task.name = std::move(name);
+        task.fn = std::move(fn);
+        std::sort(dependencies.begin(), dependencies.end());
+        dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+        for (const TaskId dependency : dependencies)
+        {
+            if (dependency >= id)
+            {
+                log(LogLevel::Error, "Task " + task.name + " depends on a task added after it; dependency ignored");
+                continue;
+            }
+            task.dependencies.push_back(dependency);
+        }
+        m_tasks.push_back(std::move(task));
+        return id;
+    }
+
+    void TaskGraph::run()
+    {
+        JobSystem& jobs = JobSystem::instance();
+        std::vector<JobSystem::JobHandle> handles(m_tasks.size());
+        for (TaskId id = 0; id < m_tasks.size(); ++id)
+        {
+            Task& task = m_tasks[id];
+            std::vector<JobSystem::JobHandle> dependencies;
+            dependencies.reserve(task.dependencies.size());
+            for (const TaskId dependency : task.dependencies)
+            {
+                dependencies.push_back(handles[dependency]);
+            }
+            handles[id] = jobs.submit([&task]() {
+                const auto start = std::chrono::high_resolution_clock::now();
+                try
+                {
+                    task.fn();
+                }
+                catch (const std::exception& e)
+                {
+                    log(LogLevel::Error, "Exception in task " + task.name + ": " + e.what());
+                }
+                catch (...)
+                {
+                    log(LogLevel::Error, "Exception in task " + task.name + ": unknown exception");
+                }
+                task.milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+            }, dependencies);
+        }
+        jobs.wait(handles);
+    }
+} // namespace cg
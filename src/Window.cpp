@@ -10,6 +10,8 @@
 namespace
 {
     constexpr const char* kInputStateKey = "cg_input_state";
+    // A poll that has not returned after this long is taken to be inside a modal loop
+    constexpr double kModalLoopSeconds = 0.05;
 }
 
 namespace cg
@@ -50,11 +52,14 @@ namespace cg
 
         glfwSwapInterval(enableVSync ? 1 : 0);
 
-        glfwSetFramebufferSizeCallback(m_window, framebufferSizeCallback);
         glfwSetCursorPosCallback(m_window, cursorPosCallback);
         glfwSetMouseButtonCallback(m_window, mouseButtonCallback);
         glfwSetKeyCallback(m_window, keyCallback);
         glfwSetScrollCallback(m_window, scrollCallback);
+        glfwSetWindowRefreshCallback(m_window, refreshCallback);
+        glfwSetFramebufferSizeCallback(m_window, framebufferSizeCallback);
+        glfwSetWindowPosCallback(m_window, positionCallback);
+        glfwSetWindowUserPointer(m_window, this);
     }
 
     Window::~Window()
@@ -76,14 +81,18 @@ namespace cg
         glfwSwapBuffers(m_window);
     }
 
-    void Window::pollEvents()
+    bool Window::pollEvents()
     {
+        m_pollStart = glfwGetTime();
+        m_refreshedDuringPoll = false;
         glfwPollEvents();
+        m_pollStart = -1.0;
+        return m_refreshedDuringPoll;
     }
 
     void Window::setInputState(InputState* inputState)
     {
-        glfwSetWindowUserPointer(m_window, inputState);
+        m_input = inputState;
         if (inputState)
         {
             inputState->cursorInitialized = false;
@@ -91,14 +100,9 @@ namespace cg
         }
     }
 
-    void Window::framebufferSizeCallback(GLFWwindow*, int width, int height)
-    {
-        glViewport(0, 0, width, height);
-    }
-
     void Window::cursorPosCallback(GLFWwindow* window, double xpos, double ypos)
     {
-        auto* input = static_cast<InputState*>(glfwGetWindowUserPointer(window));
+        InputState* input = inputState(window);
         if (!input) return;
 
         if (!input->freeLook) return;
@@ -117,7 +121,7 @@ namespace cg
 
     void Window::mouseButtonCallback(GLFWwindow* window, int button, int action, int)
     {
-        auto* input = static_cast<InputState*>(glfwGetWindowUserPointer(window));
+        InputState* input = inputState(window);
         if (!input) return;
 
         if (button == GLFW_MOUSE_BUTTON_RIGHT)
@@ -132,7 +136,7 @@ namespace cg
 
     void Window::keyCallback(GLFWwindow* window, int key, int, int action, int)
     {
-        auto* input = static_cast<InputState*>(glfwGetWindowUserPointer(window));
+        InputState* input = inputState(window);
         if (!input) return;
 
         const bool pressed = action != GLFW_RELEASE;
@@ -146,6 +150,7 @@ namespace cg
         case GLFW_KEY_E: input->up = pressed; break;
         case GLFW_KEY_LEFT_SHIFT:
         case GLFW_KEY_RIGHT_SHIFT: input->boost = pressed; break;
+        case GLFW_KEY_P: if (action == GLFW_PRESS) ++input->particleResolutionPresses; break;
         case GLFW_KEY_ESCAPE: if (pressed) glfwSetWindowShouldClose(window, GLFW_TRUE); break;
         default: break;
         }
@@ -153,9 +158,35 @@ namespace cg
 
     void Window::scrollCallback(GLFWwindow* window, double, double yoffset)
     {
-        auto* input = static_cast<InputState*>(glfwGetWindowUserPointer(window));
+        InputState* input = inputState(window);
         if (!input) return;
         input->scrollDelta += static_cast<float>(yoffset);
     }
+
+    void Window::refreshCallback(GLFWwindow* window)
+    {
+        auto* self = static_cast<Window*>(glfwGetWindowUserPointer(window));
+        if (!self || !self->m_refreshHandler || self->m_pollStart < 0.0) return;
+        // The caller produces a frame as soon as an ordinary poll returns
+        if (glfwGetTime() - self->m_pollStart < kModalLoopSeconds) return;
+        self->m_refreshedDuringPoll = true;
+        self->m_refreshHandler();
+    }
+
+    void Window::framebufferSizeCallback(GLFWwindow* window, int, int)
+    {
+        refreshCallback(window);
+    }
+
+    void Window::positionCallback(GLFWwindow* window, int, int)
+    {
+        refreshCallback(window);
+    }
+
+    InputState* Window::inputState(GLFWwindow* window)
+    {
+        auto* self = static_cast<Window*>(glfwGetWindowUserPointer(window));
+        return self ? self->m_input : nullptr;
+    }
 } // namespace cg
 
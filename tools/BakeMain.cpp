@@ -0,0 +1,394 @@
+// cg_bake: conditions every asset the app loads at startup into the content-addressed bake
+// directory (AppConfig::bakedAssetDirectory). Re-running it only rebakes assets whose source
+// bytes or bake options changed.
+//
+//   cg_bake [--output <dir>] [--force] [--no-weld] [--no-texture-compression] [--draco]
+
+#include "core/AppConfig.h"
+#include "loader/AssetBake.h"
+#include "loader/BakedTexture.h"
+#include "loader/MeshCache.h"
+#include "loader/ModelImporter.h"
+#include "loader/ObjLoader.h"
+#include "render/SkyboxDecoder.h"
+#include "scene/GroundBuilder.h"
+#include "scene/SceneManifest.h"
+#include "util/Log.h"
+#include "util/MeshUtils.h"
+#include "util/Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace cg;
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    // Bumped whenever an artifact format or the conditioning itself changes
+    constexpr const char* kBakeVersion = "cgbake-1";
+
+    struct BakeOptions
+    {
+        std::string outputDirectory;
+        bool force{false};
+        bool weld{true};
+        bool compressTextures{true};
+        bool draco{false};
+        DracoMeshCodec::Options dracoOptions;  // Used when draco is set
+    };
+
+    enum class Outcome
+    {
+        Baked,
+        UpToDate,
+        Failed
+    };
+
+    struct BakeStats
+    {
+        std::atomic<int> baked{0};
+        std::atomic<int> upToDate{0};
+        std::atomic<int> failed{0};
+
+        void add(Outcome outcome)
+        {
+            switch (outcome)
+            {
+            case Outcome::Baked: ++baked; break;
+            case Outcome::UpToDate: ++upToDate; break;
+            default: ++failed; break;
+            }
+        }
+    };
+
+    struct MeshAsset
+    {
+        std::string path;
+        MeshCache::Layout layout{MeshCache::Layout::SingleMesh};
+    };
+
+    class Baker
+    {
+    public:
+        explicit Baker(const BakeOptions& options)
+            : m_options(options), m_index(options.outputDirectory)
+        {
+            m_index.load();
+        }
+
+        // Hashes the source, its dependencies and the options; produce() only runs when no
+        // artifact with that key exists yet
+        Outcome bake(const std::string& source, const std::string& variant, const std::string& options,
+                     const std::vector<std::string>& dependencies, const char* extension,
+                     const std::function<bool(const std::string&)>& produce)
+        {
+            AssetBake::Entry entry;
+            entry.source = source;
+            entry.variant = variant;
+            AssetBake::Hasher hasher;
+            hasher.update(std::string(kBakeVersion));
+            hasher.update(variant);
+            hasher.update(options);
+            if (!AssetBake::sourceStamp(source, entry.sourceSize, entry.sourceTime) || !hasher.updateFile(source))
+            {
+                log(LogLevel::Warn, "Cannot read " + source + ", skipping");
+                return Outcome::Failed;
+            }
+            for (const std::string& dependency : dependencies)
+            {
+                hasher.update(fs::path(dependency).filename().string());
+                hasher.updateFile(dependency);
+                entry.dependencies.push_back(AssetBake::dependencyStamp(dependency));
+            }
+            entry.artifact = AssetBake::keyString(hasher.digest()) + extension;
+
+            const std::string artifactPath = m_index.artifactPath(entry.artifact);
+            Outcome outcome = Outcome::UpToDate;
+            std::error_code ec;
+            if (m_options.force || !fs::exists(artifactPath, ec))
+            {
+                const auto start = std::chrono::high_resolution_clock::now();
+                if (!produce(artifactPath))
+                {
+                    log(LogLevel::Error, "Failed to bake " + source + " (" + variant + ")");
+                    return Outcome::Failed;
+                }
+                const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+                log(LogLevel::Info, "Baked " + source + " (" + variant + ") -> " + entry.artifact + " in " + std::to_string(duration.count()) + "ms");
+                outcome = Outcome::Baked;
+            }
+            m_index.set(std::move(entry));
+            return outcome;
+        }
+
+        // Loads, welds and stores one model; adds the textures its meshes use to textures
+        Outcome bakeMesh(const MeshAsset& asset, std::set<std::string>& textures, std::mutex& texturesMutex)
+        {
+            std::string options = m_options.weld ? "weld" : "noweld";
+            if (m_options.draco)
+            {
+                const DracoMeshCodec::Options& draco = m_options.dracoOptions;
+                options += ";draco:" + std::to_string(draco.positionBits) + "," + std::to_string(draco.normalBits) + "," +
+                    std::to_string(draco.uvBits) + "," + std::to_string(draco.colorBits) + "," + std::to_string(draco.speed);
+            }
+            const bool imported = asset.layout == MeshCache::Layout::ImportedScene;
+            const auto dependencies = ModelImporter::dependencies(asset.path);
+            std::vector<Mesh> meshes;
+            const Outcome outcome = bake(asset.path, MeshCache::bakeVariant(asset.layout), options, dependencies, ".cgmesh",
+                [&](const std::string& artifactPath) {
+                    if (imported)
+                    {
+                        meshes = ModelImporter::loadScene(asset.path);
+                    }
+                    else if (asset.layout == MeshCache::Layout::PerMaterial)
+                    {
+                        meshes = ObjLoader::loadObjAsMeshes(asset.path);
+                    }
+                    else if (auto mesh = ObjLoader::loadObjAsMesh(asset.path))
+                    {
+                        meshes.push_back(std::move(*mesh));
+                    }
+                    if (meshes.empty())
+                    {
+                        return false;
+                    }
+                    if (m_options.weld)
+                    {
+                        size_t before = 0;
+                        size_t after = 0;
+                        for (auto& mesh : meshes)
+                        {
+                            before += mesh.vertices.size();
+                            MeshUtils::weldVertices(mesh);
+                            after += mesh.vertices.size();
+                        }
+                        log(LogLevel::Info, "Welded " + asset.path + ": " + std::to_string(before) + " -> " + std::to_string(after) + " vertices");
+                    }
+                    return MeshCache::storeFile(artifactPath, asset.path, dependencies, asset.layout, meshes.data(), meshes.size());
+                });
+
+            // An up-to-date artifact still has to say which textures it needs
+            if (outcome == Outcome::UpToDate)
+            {
+                if (const auto entry = m_index.find(asset.path, MeshCache::bakeVariant(asset.layout)))
+                {
+                    if (auto baked = MeshCache::loadFile(m_index.artifactPath(entry->artifact), asset.layout))
+                    {
+                        meshes = std::move(*baked);
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lock(texturesMutex);
+            for (const auto& mesh : meshes)
+            {
+                if (!mesh.diffuseTexture.empty())
+                {
+                    textures.insert(mesh.diffuseTexture);
+                }
+            }
+            return outcome;
+        }
+
+        Outcome bakeTexture(const std::string& path)
+        {
+            const bool compress = m_options.compressTextures;
+            return bake(path, BakedTexture::kBakeVariant, compress ? "bc" : "rgba8", {}, ".cgtex",
+                [&](const std::string& artifactPath) {
+                    return BakedTexture::bake(path, compress, artifactPath);
+                });
+        }
+
+        Outcome bakeSky(const std::string& path, SkyboxFormat format, int cubemapFaceSize, int environmentFaceSize)
+        {
+            const std::string variant = SkyboxDecoder::bakeVariant(format, cubemapFaceSize, environmentFaceSize);
+            return bake(path, variant, {}, {}, ".cgsky",
+                [&](const std::string& artifactPath) {
+                    SkyboxDecoder::Job job;
+                    job.format = format;
+                    job.cubemapFaceSize = cubemapFaceSize;
+                    job.environmentFaceSize = environmentFaceSize;
+                    std::unique_ptr<ExrStreamReader> reader;
+                    SkyboxDecoder::CacheHeader header;
+                    if (!SkyboxDecoder::openSource(path, job, reader) || !SkyboxDecoder::makeCacheHeader(path, format, job, header))
+                    {
+                        return false;
+                    }
+                    std::vector<uint8_t> data(SkyboxDecoder::outputSize(job));
+                    job.target = data.data();
+                    EnvironmentBaker::Environment environment;
+                    return SkyboxDecoder::decode(path, std::move(reader), job, environment) &&
+                           SkyboxDecoder::writeCache(artifactPath, header, data, environment);
+                });
+        }
+
+        bool saveIndex() const
+        {
+            return m_index.save();
+        }
+
+    private:
+        BakeOptions m_options;
+        AssetBake::Index m_index;
+    };
+
+    bool parseArguments(int argc, char** argv, BakeOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            if (argument == "--output" && i + 1 < argc)
+            {
+                options.outputDirectory = argv[++i];
+            }
+            else if (argument == "--force")
+            {
+                options.force = true;
+            }
+            else if (argument == "--no-weld")
+            {
+                options.weld = false;
+            }
+            else if (argument == "--no-texture-compression")
+            {
+                options.compressTextures = false;
+            }
+            else if (argument == "--draco")
+            {
+                options.draco = true;
+            }
+            else
+            {
+                log(LogLevel::Error, "Unknown argument: " + argument);
+                log(LogLevel::Info, "Usage: cg_bake [--output <dir>] [--force] [--no-weld] [--no-texture-compression] [--draco]");
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const AppConfig config;
+    BakeOptions options;
+    options.outputDirectory = config.bakedAssetDirectory;
+    options.draco = config.meshCacheDraco;
+    options.dracoOptions.positionBits = config.meshCacheDracoPositionBits;
+    options.dracoOptions.speed = config.meshCacheDracoSpeed;
+    if (!parseArguments(argc, argv, options))
+    {
+        return 2;
+    }
+    if (options.outputDirectory.empty())
+    {
+        log(LogLevel::Error, "No bake directory configured");
+        return 2;
+    }
+    std::error_code ec;
+    fs::create_directories(options.outputDirectory, ec);
+
+    MeshCache::Options meshOptions;
+    meshOptions.compression = options.draco ? MeshCache::Compression::Draco : MeshCache::Compression::None;
+    meshOptions.draco = options.dracoOptions;
+    MeshCache::configure(meshOptions);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    Baker baker(options);
+    BakeStats stats;
+
+    // The same models App::preloadResources loads (its scene manifest), deduplicated
+    SceneManifest::Manifest manifest;
+    if (!SceneManifest::resolve(config, manifest))
+    {
+        return 2;
+    }
+    std::vector<MeshAsset> meshAssets;
+    auto addMesh = [&](const std::string& path, MeshCache::Layout layout) {
+        if (path.empty())
+        {
+            return;
+        }
+        const std::string normalized = AssetBake::normalizePath(path);
+        const bool known = std::any_of(meshAssets.begin(), meshAssets.end(), [&](const MeshAsset& asset) {
+            return AssetBake::normalizePath(asset.path) == normalized && asset.layout == layout;
+        });
+        if (!known)
+        {
+            meshAssets.push_back({path, layout});
+        }
+    };
+    std::set<std::string> textures;
+    for (const auto& asset : manifest.assets)
+    {
+        if (asset.type == SceneManifest::AssetType::Mesh)
+        {
+            addMesh(asset.path, MeshCache::Layout::SingleMesh);
+        }
+        else if (asset.type == SceneManifest::AssetType::Meshes)
+        {
+            addMesh(asset.path, ModelImporter::supports(asset.path)
+                ? MeshCache::Layout::ImportedScene : MeshCache::Layout::PerMaterial);
+        }
+        else if (asset.type == SceneManifest::AssetType::Ground)
+        {
+            const GroundBuilder::GroundAssets ground = GroundBuilder::listGroundAssets(asset.path);
+            for (const auto& tile : ground.tileFiles)
+            {
+                addMesh(tile, MeshCache::Layout::SingleMesh);
+            }
+            textures.insert(ground.textures.begin(), ground.textures.end());
+        }
+    }
+    for (const auto& node : manifest.nodes)
+    {
+        if (!node.texture.empty())
+        {
+            textures.insert(node.texture);
+        }
+    }
+
+    // Meshes first: their materials decide which textures get baked
+    std::mutex texturesMutex;
+    log(LogLevel::Info, "Baking " + std::to_string(meshAssets.size()) + " models into " + options.outputDirectory);
+    parallelFor(meshAssets.size(), [&](size_t i) {
+        stats.add(baker.bakeMesh(meshAssets[i], textures, texturesMutex));
+    });
+
+    // Textures and skies are independent of each other; the skies are the slowest jobs, so
+    // they go first to overlap with the many small textures
+    std::vector<std::function<Outcome()>> jobs;
+    for (const std::string& sky : {config.daySkyboxPath, config.nightSkyboxPath})
+    {
+        if (!sky.empty())
+        {
+            jobs.push_back([&, sky]() {
+                return baker.bakeSky(sky, config.skyboxFormat, config.skyboxCubemapFaceSize, config.environmentMapFaceSize);
+            });
+        }
+    }
+    for (const std::string& texture : textures)
+    {
+        jobs.push_back([&, texture]() { return baker.bakeTexture(texture); });
+    }
+    log(LogLevel::Info, "Baking " + std::to_string(textures.size()) + " textures and skies");
+    parallelFor(jobs.size(), [&](size_t i) {
+        stats.add(jobs[i]());
+    });
+
+    const bool indexSaved = baker.saveIndex();
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+    log(LogLevel::Info, "Bake finished in " + std::to_string(duration.count()) + "ms: " + std::to_string(stats.baked.load()) + " baked, " +
+        std::to_string(stats.upToDate.load()) + " up to date, " + std::to_string(stats.failed.load()) + " failed");
+    return stats.failed.load() == 0 && indexSaved ? 0 : 1;
+}